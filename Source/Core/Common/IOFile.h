@@ -111,6 +111,8 @@ public:
   u64 GetSize() const;
   bool Resize(u64 size);
   bool Flush();
+  // Flushes the file and waits until the OS has written it to the storage device.
+  bool Sync();
 
   // clear error state
   void ClearError()
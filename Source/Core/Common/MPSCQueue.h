@@ -0,0 +1,130 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+// a bounded lockless thread-safe,
+// multiple producer, single consumer ring buffer
+//
+// Each slot carries a sequence number which tells producers whether the slot is free for the
+// current lap of the ring and tells the consumer whether the slot has been published. Producers
+// only contend on a single fetch-and-add style CAS of the write index, and never wait on each
+// other or on the consumer. When the ring is full, TryPush fails and the caller decides what to do.
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+#include "Common/CommonTypes.h"
+
+namespace Common
+{
+template <typename T, size_t N>
+class MPSCQueue
+{
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "MPSCQueue size must be a power of two");
+
+public:
+  MPSCQueue() { Reset(); }
+
+  MPSCQueue(const MPSCQueue&) = delete;
+  MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+  static constexpr size_t Capacity() { return N; }
+
+  // Safe to call from any number of threads.
+  template <typename Arg>
+  bool TryPush(Arg&& t)
+  {
+    size_t pos = m_write_index.load(std::memory_order_relaxed);
+    while (true)
+    {
+      Slot& slot = m_slots[pos & MASK];
+      const size_t seq = slot.sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+      if (diff == 0)
+      {
+        if (m_write_index.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        {
+          slot.value = std::forward<Arg>(t);
+          slot.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+        // pos has been reloaded by compare_exchange_weak
+      }
+      else if (diff < 0)
+      {
+        // The consumer hasn't released this slot from the previous lap yet
+        return false;
+      }
+      else
+      {
+        pos = m_write_index.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Only the consumer thread may call the functions below.
+  bool Empty() const
+  {
+    const Slot& slot = m_slots[m_read_index & MASK];
+    return slot.sequence.load(std::memory_order_acquire) != m_read_index + 1;
+  }
+
+  bool Pop(T& t)
+  {
+    Slot& slot = m_slots[m_read_index & MASK];
+    if (slot.sequence.load(std::memory_order_acquire) != m_read_index + 1)
+      return false;
+
+    t = std::move(slot.value);
+    slot.sequence.store(m_read_index + N, std::memory_order_release);
+    ++m_read_index;
+    return true;
+  }
+
+  // Pops everything that was published at the time of the call, in order.
+  // Returns the number of popped elements.
+  template <typename F>
+  size_t PopAll(F&& f)
+  {
+    size_t count = 0;
+    for (T t; Pop(t); ++count)
+      f(std::move(t));
+    return count;
+  }
+
+  // not thread-safe
+  void Clear()
+  {
+    for (T t; Pop(t);)
+    {
+    }
+    Reset();
+  }
+
+private:
+  static constexpr size_t MASK = N - 1;
+
+  struct Slot
+  {
+    std::atomic<size_t> sequence;
+    T value{};
+  };
+
+  void Reset()
+  {
+    for (size_t i = 0; i < N; ++i)
+      m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    m_write_index.store(0, std::memory_order_relaxed);
+    m_read_index = 0;
+  }
+
+  std::array<Slot, N> m_slots;
+
+  // Keep the producer and consumer indices on separate cache lines
+  alignas(64) std::atomic<size_t> m_write_index;
+  alignas(64) size_t m_read_index;
+};
+}  // namespace Common
@@ -0,0 +1,116 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "Common/MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+
+#include "Common/StringUtil.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef ANDROID
+#include "jni/AndroidCommon/AndroidCommon.h"
+#endif
+
+namespace File
+{
+MappedFile::MappedFile() = default;
+
+MappedFile::MappedFile(const std::string& filename)
+{
+  Open(filename);
+}
+
+MappedFile::~MappedFile()
+{
+  Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0))
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+  std::swap(m_data, other.m_data);
+  std::swap(m_size, other.m_size);
+  return *this;
+}
+
+bool MappedFile::Open(const std::string& filename)
+{
+  Close();
+
+#ifdef _WIN32
+  const HANDLE file = CreateFileW(UTF8ToWString(filename).c_str(), GENERIC_READ,
+                                  FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER size;
+  const HANDLE mapping = GetFileSizeEx(file, &size) && size.QuadPart != 0 ?
+                             CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr) :
+                             nullptr;
+  CloseHandle(file);
+  if (!mapping)
+    return false;
+
+  // The view keeps the mapping alive.
+  const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (!data)
+    return false;
+
+  m_data = static_cast<const u8*>(data);
+  m_size = static_cast<u64>(size.QuadPart);
+#else
+#ifdef ANDROID
+  const int fd = IsPathAndroidContent(filename) ? OpenAndroidContent(filename, "r") :
+                                                  open(filename.c_str(), O_RDONLY);
+#else
+  const int fd = open(filename.c_str(), O_RDONLY);
+#endif
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  void* data = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size != 0)
+    data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping keeps the file alive.
+  close(fd);
+  if (data == MAP_FAILED)
+    return false;
+
+  m_data = static_cast<const u8*>(data);
+  m_size = static_cast<u64>(st.st_size);
+#endif
+
+  return true;
+}
+
+void MappedFile::Close()
+{
+  if (!m_data)
+    return;
+
+#ifdef _WIN32
+  UnmapViewOfFile(m_data);
+#else
+  munmap(const_cast<u8*>(m_data), m_size);
+#endif
+
+  m_data = nullptr;
+  m_size = 0;
+}
+}  // namespace File
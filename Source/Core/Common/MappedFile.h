@@ -0,0 +1,39 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <span>
+#include <string>
+
+#include "Common/CommonTypes.h"
+
+namespace File
+{
+// A read-only memory mapping of a whole file. The file must not be truncated while it is mapped:
+// on POSIX systems, accessing the pages past its new end raises SIGBUS.
+class MappedFile
+{
+public:
+  MappedFile();
+  explicit MappedFile(const std::string& filename);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+
+  bool Open(const std::string& filename);
+  void Close();
+
+  bool IsOpen() const { return m_data != nullptr; }
+  const u8* GetData() const { return m_data; }
+  u64 GetSize() const { return m_size; }
+  std::span<const u8> GetSpan() const { return {m_data, static_cast<size_t>(m_size)}; }
+
+private:
+  const u8* m_data = nullptr;
+  u64 m_size = 0;
+};
+}  // namespace File
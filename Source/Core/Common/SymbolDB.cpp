@@ -3,6 +3,7 @@
 
 #include "Common/SymbolDB.h"
 
+#include <algorithm>
 #include <cstring>
 #include <map>
 #include <string>
@@ -52,6 +53,8 @@ void SymbolDB::Clear(const char* prefix)
   // TODO: honor prefix
   m_functions.clear();
   m_checksum_to_function.clear();
+  m_address_index_starts.clear();
+  m_address_index_symbols.clear();
 }
 
 void SymbolDB::Index()
@@ -63,6 +66,20 @@ void SymbolDB::Index()
   }
 }
 
+Symbol* SymbolDB::GetSymbolFromAddr(u32 addr)
+{
+  // The last symbol that starts at or before the address.
+  const auto it = std::ranges::upper_bound(m_address_index_starts, addr);
+  if (it == m_address_index_starts.begin())
+    return nullptr;
+
+  Symbol* symbol = m_address_index_symbols[it - m_address_index_starts.begin() - 1];
+  if (symbol->address == addr || (addr >= symbol->address && addr < symbol->address + symbol->size))
+    return symbol;
+
+  return nullptr;
+}
+
 Symbol* SymbolDB::GetSymbolFromName(std::string_view name)
 {
   for (auto& func : m_functions)
@@ -108,6 +125,43 @@ std::vector<Symbol*> SymbolDB::GetSymbolsFromHash(u32 hash)
 
 void SymbolDB::AddCompleteSymbol(const Symbol& symbol)
 {
-  m_functions.emplace(symbol.address, symbol);
+  const auto [it, inserted] = m_functions.emplace(symbol.address, symbol);
+  if (inserted)
+    AddToAddressIndex(&it->second);
+}
+
+bool SymbolDB::RemoveSymbol(u32 address)
+{
+  const auto it = m_functions.find(address);
+  if (it == m_functions.end())
+    return false;
+
+  Symbol* symbol = &it->second;
+  if (const auto checksum = m_checksum_to_function.find(symbol->hash);
+      checksum != m_checksum_to_function.end())
+  {
+    checksum->second.erase(symbol);
+    if (checksum->second.empty())
+      m_checksum_to_function.erase(checksum);
+  }
+
+  // Every address is in the index once, as it is the key of the map.
+  const auto start = std::ranges::lower_bound(m_address_index_starts, address);
+  m_address_index_symbols.erase(m_address_index_symbols.begin() +
+                                (start - m_address_index_starts.begin()));
+  m_address_index_starts.erase(start);
+
+  m_functions.erase(it);
+  return true;
+}
+
+void SymbolDB::AddToAddressIndex(Symbol* symbol)
+{
+  // Symbols are mostly added in order of their addresses, e.g. from map files, which makes this
+  // an append.
+  const auto it = std::ranges::upper_bound(m_address_index_starts, symbol->address);
+  const auto offset = it - m_address_index_starts.begin();
+  m_address_index_starts.insert(it, symbol->address);
+  m_address_index_symbols.insert(m_address_index_symbols.begin() + offset, symbol);
 }
 }  // namespace Common
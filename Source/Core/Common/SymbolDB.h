@@ -7,6 +7,7 @@
 #pragma once
 
 #include <map>
+#include <ranges>
 #include <set>
 #include <string>
 #include <string_view>
@@ -75,9 +76,12 @@ public:
   SymbolDB();
   virtual ~SymbolDB();
 
-  virtual Symbol* GetSymbolFromAddr(u32 addr) { return nullptr; }
+  // Returns the symbol that starts at or contains the address.
+  virtual Symbol* GetSymbolFromAddr(u32 addr);
   virtual Symbol* AddFunction(const Core::CPUThreadGuard& guard, u32 start_addr) { return nullptr; }
   void AddCompleteSymbol(const Symbol& symbol);
+  // Returns whether there was a symbol at the address.
+  bool RemoveSymbol(u32 address);
 
   Symbol* GetSymbolFromName(std::string_view name);
   std::vector<Symbol*> GetSymbolsFromName(std::string_view name);
@@ -85,14 +89,26 @@ public:
   std::vector<Symbol*> GetSymbolsFromHash(u32 hash);
 
   const XFuncMap& Symbols() const { return m_functions; }
-  XFuncMap& AccessSymbols() { return m_functions; }
+  // The symbols in order of their addresses. They can be changed through this, except for their
+  // addresses, but symbols can only be added or removed through the functions above.
+  auto AccessSymbols() { return std::views::values(m_functions); }
   bool IsEmpty() const;
   void Clear(const char* prefix = "");
   void List();
   void Index();
 
 protected:
+  // Has to be called after adding a symbol to the map.
+  void AddToAddressIndex(Symbol* symbol);
+
   XFuncMap m_functions;
   XFuncPtrMap m_checksum_to_function;
+
+private:
+  // Address lookups happen all the time (profiling, branch watch, code trace), so they use flat
+  // arrays of the symbol start addresses and the symbols, sorted by address, instead of walking
+  // the map. The arrays are kept up to date as symbols are added, so lookups only read them.
+  std::vector<u32> m_address_index_starts;
+  std::vector<Symbol*> m_address_index_symbols;
 };
 }  // namespace Common
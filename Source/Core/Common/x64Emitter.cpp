@@ -1840,12 +1840,11 @@ static int GetVEXpp(u8 opPrefix)
 }
 
 void XEmitter::WriteVEXOp(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg,
-                          int W, int extrabytes)
+                          int W, int extrabytes, int L)
 {
   int mmmmm = GetVEXmmmmm(op);
   int pp = GetVEXpp(opPrefix);
-  // FIXME: we currently don't support 256-bit instructions, and "size" is not the vector size here
-  arg.WriteVEX(this, regOp1, regOp2, 0, pp, mmmmm, W);
+  arg.WriteVEX(this, regOp1, regOp2, L, pp, mmmmm, W);
   Write8(op & 0xFF);
   arg.WriteRest(this, extrabytes, regOp1);
 }
@@ -1858,11 +1857,19 @@ void XEmitter::WriteVEXOp4(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, co
 }
 
 void XEmitter::WriteAVXOp(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg,
-                          int W, int extrabytes)
+                          int W, int extrabytes, int L)
 {
   if (!cpu_info.bAVX)
     PanicAlertFmt("Trying to use AVX on a system that doesn't support it. Bad programmer.");
-  WriteVEXOp(opPrefix, op, regOp1, regOp2, arg, W, extrabytes);
+  WriteVEXOp(opPrefix, op, regOp1, regOp2, arg, W, extrabytes, L);
+}
+
+void XEmitter::WriteAVX2Op(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg,
+                           int W, int extrabytes, int L)
+{
+  if (!cpu_info.bAVX2)
+    PanicAlertFmt("Trying to use AVX2 on a system that doesn't support it. Bad programmer.");
+  WriteVEXOp(opPrefix, op, regOp1, regOp2, arg, W, extrabytes, L);
 }
 
 void XEmitter::WriteAVXOp4(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg,
@@ -3029,6 +3036,74 @@ void XEmitter::VPXOR(X64Reg regOp1, X64Reg regOp2, const OpArg& arg)
   WriteAVXOp(0x66, 0xEF, regOp1, regOp2, arg);
 }
 
+void XEmitter::VCVTDQ2PS(int bits, X64Reg regOp1, const OpArg& arg)
+{
+  WriteAVXOp(0x00, 0x5B, regOp1, INVALID_REG, arg, 0, 0, bits == 256);
+}
+
+void XEmitter::VMULPS(int bits, X64Reg regOp1, X64Reg regOp2, const OpArg& arg)
+{
+  WriteAVXOp(0x00, sseMUL, regOp1, regOp2, arg, 0, 0, bits == 256);
+}
+
+void XEmitter::VPSHUFB(int bits, X64Reg regOp1, X64Reg regOp2, const OpArg& arg)
+{
+  if (bits == 256)
+    WriteAVX2Op(0x66, 0x3800, regOp1, regOp2, arg, 0, 0, 1);
+  else
+    WriteAVXOp(0x66, 0x3800, regOp1, regOp2, arg);
+}
+
+void XEmitter::VPSRAD(int bits, X64Reg regOp1, X64Reg regOp2, u8 shift)
+{
+  if (bits == 256)
+    WriteAVX2Op(0x66, 0x72, (X64Reg)4, regOp1, R(regOp2), 0, 1, 1);
+  else
+    WriteAVXOp(0x66, 0x72, (X64Reg)4, regOp1, R(regOp2), 0, 1);
+  Write8(shift);
+}
+
+void XEmitter::VMOVD_xmm(X64Reg dest, const OpArg& arg)
+{
+  WriteAVXOp(0x66, 0x6E, dest, INVALID_REG, arg);
+}
+
+void XEmitter::VMOVQ_xmm(X64Reg dest, const OpArg& arg)
+{
+  WriteAVXOp(0xF3, 0x7E, dest, INVALID_REG, arg);
+}
+
+void XEmitter::VMOVDQU(X64Reg dest, const OpArg& arg)
+{
+  WriteAVXOp(0xF3, sseMOVDQfromRM, dest, INVALID_REG, arg);
+}
+
+void XEmitter::VMOVUPS(const OpArg& arg, X64Reg src)
+{
+  WriteAVXOp(0x00, sseMOVUPtoRM, src, INVALID_REG, arg);
+}
+
+void XEmitter::VINSERTI128(X64Reg regOp1, X64Reg regOp2, const OpArg& arg, u8 lane)
+{
+  WriteAVX2Op(0x66, 0x3A38, regOp1, regOp2, arg, 0, 1, 1);
+  Write8(lane);
+}
+
+void XEmitter::VEXTRACTI128(const OpArg& arg, X64Reg regOp1, u8 lane)
+{
+  WriteAVX2Op(0x66, 0x3A39, regOp1, INVALID_REG, arg, 0, 1, 1);
+  Write8(lane);
+}
+
+void XEmitter::VZEROUPPER()
+{
+  if (!cpu_info.bAVX)
+    PanicAlertFmt("Trying to use AVX on a system that doesn't support it. Bad programmer.");
+  Write8(0xC5);
+  Write8(0xF8);
+  Write8(0x77);
+}
+
 void XEmitter::VFMADD132PS(X64Reg regOp1, X64Reg regOp2, const OpArg& arg)
 {
   WriteFMA3Op(0x98, regOp1, regOp2, arg);
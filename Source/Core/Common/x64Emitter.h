@@ -357,11 +357,13 @@ private:
   void WriteSSSE3Op(u8 opPrefix, u16 op, X64Reg regOp, const OpArg& arg, int extrabytes = 0);
   void WriteSSE41Op(u8 opPrefix, u16 op, X64Reg regOp, const OpArg& arg, int extrabytes = 0);
   void WriteVEXOp(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, int W = 0,
-                  int extrabytes = 0);
+                  int extrabytes = 0, int L = 0);
   void WriteVEXOp4(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg,
                    X64Reg regOp3, int W = 0);
   void WriteAVXOp(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, int W = 0,
-                  int extrabytes = 0);
+                  int extrabytes = 0, int L = 0);
+  void WriteAVX2Op(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg,
+                   int W = 0, int extrabytes = 0, int L = 0);
   void WriteAVXOp4(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg,
                    X64Reg regOp3, int W = 0);
   void WriteFMA3Op(u8 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, int W = 0);
@@ -877,6 +879,26 @@ public:
   void VPOR(X64Reg regOp1, X64Reg regOp2, const OpArg& arg);
   void VPXOR(X64Reg regOp1, X64Reg regOp2, const OpArg& arg);
 
+  // 256-bit capable forms. bits selects between the XMM (128) and YMM (256) encoding; the YMM
+  // registers share their numbering with the XMM registers.
+  void VCVTDQ2PS(int bits, X64Reg regOp1, const OpArg& arg);
+  void VMULPS(int bits, X64Reg regOp1, X64Reg regOp2, const OpArg& arg);
+  void VPSHUFB(int bits, X64Reg regOp1, X64Reg regOp2, const OpArg& arg);
+  void VPSRAD(int bits, X64Reg regOp1, X64Reg regOp2, u8 shift);
+
+  // VEX encoded moves, for use while the upper halves of the YMM registers are in use
+  void VMOVD_xmm(X64Reg dest, const OpArg& arg);
+  void VMOVQ_xmm(X64Reg dest, const OpArg& arg);
+  void VMOVDQU(X64Reg dest, const OpArg& arg);
+  void VMOVUPS(const OpArg& arg, X64Reg src);
+
+  // AVX2 lane operations (always 256-bit)
+  void VINSERTI128(X64Reg regOp1, X64Reg regOp2, const OpArg& arg, u8 lane);
+  void VEXTRACTI128(const OpArg& arg, X64Reg regOp1, u8 lane);
+
+  // Clears the upper halves of all YMM registers. Must be used before returning to SSE code.
+  void VZEROUPPER();
+
   // FMA3
   void VFMADD132PS(X64Reg regOp1, X64Reg regOp2, const OpArg& arg);
   void VFMADD213PS(X64Reg regOp1, X64Reg regOp2, const OpArg& arg);
@@ -3,9 +3,13 @@
 
 #include "Core/CheatSearch.h"
 
+#include <algorithm>
+#include <array>
 #include <bit>
+#include <cstring>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <type_traits>
@@ -14,9 +18,13 @@
 
 #include "Common/Align.h"
 #include "Common/Assert.h"
+#include "Common/CPUDetect.h"
 #include "Common/StringUtil.h"
+#include "Common/Swap.h"
+#include "Common/WorkQueueThread.h"
 
 #include "Core/AchievementManager.h"
+#include "Core/CheatSearchScan.h"
 #include "Core/Core.h"
 #include "Core/HW/Memmap.h"
 #include "Core/PowerPC/MMU.h"
@@ -102,115 +110,156 @@ std::vector<u8> Cheats::GetValueAsByteVector(const Cheats::SearchValue& value)
 
 namespace
 {
-template <typename T>
-static std::optional<PowerPC::ReadResult<T>>
-TryReadValueFromEmulatedMemory(const Core::CPUThreadGuard& guard, u32 addr,
-                               PowerPC::RequestedAddressSpace space);
+using Cheats::Scan::PAGE_SIZE;
 
-template <>
-std::optional<PowerPC::ReadResult<u8>>
-TryReadValueFromEmulatedMemory(const Core::CPUThreadGuard& guard, u32 addr,
-                               PowerPC::RequestedAddressSpace space)
-{
-  return PowerPC::MMU::HostTryReadU8(guard, addr, space);
-}
+// Searches are split into chunks of this many previous results for next searches, and of
+// NEW_SEARCH_CHUNK_SIZE bytes of emulated memory for new searches. The chunks are only spread over
+// the workers if there are enough of them to be worth handing out.
+constexpr size_t NEXT_SEARCH_CHUNK_SIZE = 0x4000;
+constexpr size_t NEW_SEARCH_MIN_CHUNKS_PER_THREAD = 8;
+constexpr size_t NEXT_SEARCH_MIN_CHUNKS_PER_THREAD = 4;
+constexpr int MAX_SEARCH_WORKERS = 7;
 
-template <>
-std::optional<PowerPC::ReadResult<u16>>
-TryReadValueFromEmulatedMemory(const Core::CPUThreadGuard& guard, u32 addr,
-                               PowerPC::RequestedAddressSpace space)
+bool IsTranslated(const Core::CPUThreadGuard& guard, PowerPC::RequestedAddressSpace address_space)
 {
-  return PowerPC::MMU::HostTryReadU16(guard, addr, space);
+  return address_space == PowerPC::RequestedAddressSpace::Virtual ||
+         (address_space == PowerPC::RequestedAddressSpace::Effective &&
+          guard.GetSystem().GetPPCState().msr.DR);
 }
 
-template <>
-std::optional<PowerPC::ReadResult<u32>>
-TryReadValueFromEmulatedMemory(const Core::CPUThreadGuard& guard, u32 addr,
-                               PowerPC::RequestedAddressSpace space)
+// Resolves the emulated pages a search reads to host memory up front. Translating addresses
+// through the MMU isn't thread-safe, but once this is done, any thread can read the pages.
+Cheats::Scan::PageMap MapPages(const Core::CPUThreadGuard& guard, std::vector<u32> page_addresses,
+                               PowerPC::RequestedAddressSpace address_space)
 {
-  return PowerPC::MMU::HostTryReadU32(guard, addr, space);
-}
+  std::ranges::sort(page_addresses);
+  const auto duplicates = std::ranges::unique(page_addresses);
+  page_addresses.erase(duplicates.begin(), duplicates.end());
 
-template <>
-std::optional<PowerPC::ReadResult<u64>>
-TryReadValueFromEmulatedMemory(const Core::CPUThreadGuard& guard, u32 addr,
-                               PowerPC::RequestedAddressSpace space)
-{
-  return PowerPC::MMU::HostTryReadU64(guard, addr, space);
-}
+  auto& system = guard.GetSystem();
+  auto& memory = system.GetMemory();
+  auto& mmu = system.GetMMU();
+  const bool translate = IsTranslated(guard, address_space);
 
-template <>
-std::optional<PowerPC::ReadResult<s8>>
-TryReadValueFromEmulatedMemory(const Core::CPUThreadGuard& guard, u32 addr,
-                               PowerPC::RequestedAddressSpace space)
-{
-  auto tmp = PowerPC::MMU::HostTryReadU8(guard, addr, space);
-  if (!tmp)
-    return std::nullopt;
-  return PowerPC::ReadResult<s8>(tmp->translated, std::bit_cast<s8>(tmp->value));
-}
+  Cheats::Scan::PageMap page_map;
+  for (const u32 page_address : page_addresses)
+  {
+    if (!PowerPC::MMU::HostIsRAMAddress(guard, page_address, address_space))
+      continue;
 
-template <>
-std::optional<PowerPC::ReadResult<s16>>
-TryReadValueFromEmulatedMemory(const Core::CPUThreadGuard& guard, u32 addr,
-                               PowerPC::RequestedAddressSpace space)
-{
-  auto tmp = PowerPC::MMU::HostTryReadU16(guard, addr, space);
-  if (!tmp)
-    return std::nullopt;
-  return PowerPC::ReadResult<s16>(tmp->translated, std::bit_cast<s16>(tmp->value));
-}
+    const std::optional<u32> physical_address =
+        translate ? mmu.GetTranslatedAddress(page_address) : page_address;
+    if (!physical_address)
+      continue;
 
-template <>
-std::optional<PowerPC::ReadResult<s32>>
-TryReadValueFromEmulatedMemory(const Core::CPUThreadGuard& guard, u32 addr,
-                               PowerPC::RequestedAddressSpace space)
-{
-  auto tmp = PowerPC::MMU::HostTryReadU32(guard, addr, space);
-  if (!tmp)
-    return std::nullopt;
-  return PowerPC::ReadResult<s32>(tmp->translated, std::bit_cast<s32>(tmp->value));
+    // Only MEM1 and MEM2 can be accessed directly.
+    const u32 segment = *physical_address >> 28;
+    const u32 offset = *physical_address & 0x0FFFFFFF;
+    if ((segment == 0x0 && offset < memory.GetRamSizeReal()) ||
+        (segment == 0x1 && memory.GetEXRAM() && offset < memory.GetExRamSizeReal()))
+    {
+      if (const u8* data = memory.GetPointerForRange(*physical_address, PAGE_SIZE))
+      {
+        page_map.AddPage(page_address, data);
+        continue;
+      }
+    }
+
+    // A page that can't be read completely is left out, so that it can't produce results.
+    std::array<u8, PAGE_SIZE> copy;
+    bool readable = true;
+    for (u32 i = 0; i < PAGE_SIZE && readable; i += sizeof(u32))
+    {
+      const auto value = PowerPC::MMU::HostTryReadU32(guard, page_address + i, address_space);
+      readable = value.has_value();
+      if (readable)
+      {
+        const u32 big_endian_value = Common::swap32(value->value);
+        std::memcpy(copy.data() + i, &big_endian_value, sizeof(u32));
+      }
+    }
+    if (readable)
+      page_map.AddCopiedPage(page_address, copy);
+  }
+  return page_map;
 }
 
-template <>
-std::optional<PowerPC::ReadResult<s64>>
-TryReadValueFromEmulatedMemory(const Core::CPUThreadGuard& guard, u32 addr,
-                               PowerPC::RequestedAddressSpace space)
+// Worker threads which searches share, so that a search doesn't have to start threads of its own.
+// They are started by the first search that is large enough to need them.
+class SearchWorkers
 {
-  auto tmp = PowerPC::MMU::HostTryReadU64(guard, addr, space);
-  if (!tmp)
-    return std::nullopt;
-  return PowerPC::ReadResult<s64>(tmp->translated, std::bit_cast<s64>(tmp->value));
-}
+public:
+  static SearchWorkers& GetInstance()
+  {
+    static SearchWorkers workers;
+    return workers;
+  }
 
-template <>
-std::optional<PowerPC::ReadResult<float>>
-TryReadValueFromEmulatedMemory(const Core::CPUThreadGuard& guard, u32 addr,
-                               PowerPC::RequestedAddressSpace space)
+  // Runs function(i) for every i in [0, count), spread over the calling thread and the workers so
+  // that each gets at least min_count_per_thread of them.
+  template <typename Function>
+  void ParallelFor(size_t count, size_t min_count_per_thread, const Function& function)
+  {
+    std::lock_guard lk(m_lock);
+    const size_t max_threads = count / min_count_per_thread;
+    if (max_threads > 1 && !m_workers_started)
+    {
+      m_workers_started = true;
+      const int num_workers = std::clamp(cpu_info.num_cores - 1, 0, MAX_SEARCH_WORKERS);
+      for (int i = 0; i < num_workers; i++)
+      {
+        m_workers.push_back(std::make_unique<Common::WorkQueueThread<std::function<void()>>>(
+            "Cheat Search Worker", [](const std::function<void()>& job) { job(); }));
+      }
+    }
+
+    const size_t thread_count = std::clamp<size_t>(max_threads, 1, m_workers.size() + 1);
+    const auto run_part = [&](size_t part) {
+      for (size_t i = part; i < count; i += thread_count)
+        function(i);
+    };
+    for (size_t part = 1; part < thread_count; ++part)
+      m_workers[part - 1]->Push([&run_part, part] { run_part(part); });
+    run_part(0);
+    for (size_t part = 1; part < thread_count; ++part)
+      m_workers[part - 1]->WaitForCompletion();
+  }
+
+private:
+  std::mutex m_lock;
+  std::vector<std::unique_ptr<Common::WorkQueueThread<std::function<void()>>>> m_workers;
+  bool m_workers_started = false;
+};
+
+template <typename Function>
+void ParallelFor(size_t count, size_t min_count_per_thread, const Function& function)
 {
-  return PowerPC::MMU::HostTryReadF32(guard, addr, space);
+  SearchWorkers::GetInstance().ParallelFor(count, min_count_per_thread, function);
 }
 
-template <>
-std::optional<PowerPC::ReadResult<double>>
-TryReadValueFromEmulatedMemory(const Core::CPUThreadGuard& guard, u32 addr,
-                               PowerPC::RequestedAddressSpace space)
+template <typename T>
+std::vector<T> Concatenate(std::vector<std::vector<T>>& parts)
 {
-  return PowerPC::MMU::HostTryReadF64(guard, addr, space);
+  size_t size = 0;
+  for (const std::vector<T>& part : parts)
+    size += part.size();
+
+  std::vector<T> result;
+  result.reserve(size);
+  for (std::vector<T>& part : parts)
+  {
+    result.insert(result.end(), part.begin(), part.end());
+    part = {};
+  }
+  return result;
 }
-}  // namespace
 
-template <typename T>
-Common::Result<Cheats::SearchErrorCode, std::vector<Cheats::SearchResult<T>>>
-Cheats::NewSearch(const Core::CPUThreadGuard& guard,
-                  const std::vector<Cheats::MemoryRange>& memory_ranges,
-                  PowerPC::RequestedAddressSpace address_space, bool aligned,
-                  const std::function<bool(const T& value)>& validator)
+std::optional<Cheats::SearchErrorCode>
+CheckCanSearch(const Core::CPUThreadGuard& guard, PowerPC::RequestedAddressSpace address_space)
 {
   if (AchievementManager::GetInstance().IsHardcoreModeActive())
     return Cheats::SearchErrorCode::DisabledInHardcoreMode;
   auto& system = guard.GetSystem();
-  std::vector<Cheats::SearchResult<T>> results;
   const Core::State core_state = Core::GetState(system);
   if (core_state != Core::State::Running && core_state != Core::State::Paused)
     return Cheats::SearchErrorCode::NoEmulationActive;
@@ -219,38 +268,114 @@ Cheats::NewSearch(const Core::CPUThreadGuard& guard,
   if (address_space == PowerPC::RequestedAddressSpace::Virtual && !ppc_state.msr.DR)
     return Cheats::SearchErrorCode::VirtualAddressesCurrentlyNotAccessible;
 
-  for (const Cheats::MemoryRange& range : memory_ranges)
+  return std::nullopt;
+}
+
+Cheats::SearchResultValueState GetValueState(const Core::CPUThreadGuard& guard,
+                                             PowerPC::RequestedAddressSpace address_space)
+{
+  return IsTranslated(guard, address_space) ?
+             Cheats::SearchResultValueState::ValueFromVirtualMemory :
+             Cheats::SearchResultValueState::ValueFromPhysicalMemory;
+}
+
+template <typename T, typename Validator>
+Common::Result<Cheats::SearchErrorCode, std::vector<Cheats::SearchResult<T>>>
+NewSearchImpl(const Core::CPUThreadGuard& guard,
+              const std::vector<Cheats::MemoryRange>& memory_ranges,
+              PowerPC::RequestedAddressSpace address_space, bool aligned,
+              const Validator& validator)
+{
+  if (const auto error = CheckCanSearch(guard, address_space))
+    return *error;
+
+  std::vector<Cheats::Scan::Chunk> chunks;
+  std::vector<u32> page_addresses =
+      Cheats::Scan::SplitIntoChunks(memory_ranges, sizeof(T), aligned, &chunks);
+  const Cheats::Scan::PageMap page_map = MapPages(guard, std::move(page_addresses), address_space);
+  const Cheats::SearchResultValueState value_state = GetValueState(guard, address_space);
+
+  std::vector<std::vector<Cheats::SearchResult<T>>> chunk_results(chunks.size());
+  ParallelFor(chunks.size(), NEW_SEARCH_MIN_CHUNKS_PER_THREAD, [&](size_t chunk_index) {
+    // The stride is a constant so that the loads of a block are contiguous.
+    if (aligned)
+    {
+      Cheats::Scan::ScanChunk<T, sizeof(T)>(page_map, chunks[chunk_index], value_state, validator,
+                                            chunk_results[chunk_index]);
+    }
+    else
+    {
+      Cheats::Scan::ScanChunk<T, 1>(page_map, chunks[chunk_index], value_state, validator,
+                                    chunk_results[chunk_index]);
+    }
+  });
+
+  return Concatenate(chunk_results);
+}
+
+template <typename T, typename Validator>
+Common::Result<Cheats::SearchErrorCode, std::vector<Cheats::SearchResult<T>>>
+NextSearchImpl(const Core::CPUThreadGuard& guard,
+               const std::vector<Cheats::SearchResult<T>>& previous_results,
+               PowerPC::RequestedAddressSpace address_space, const Validator& validator)
+{
+  if (const auto error = CheckCanSearch(guard, address_space))
+    return *error;
+
+  std::vector<u32> page_addresses;
+  for (const auto& previous_result : previous_results)
   {
-    if (range.m_length < sizeof(T))
-      continue;
+    const u32 first_page = Common::AlignDown(previous_result.m_address, PAGE_SIZE);
+    const u32 last_page = Common::AlignDown(previous_result.m_address + sizeof(T) - 1, PAGE_SIZE);
+    if (page_addresses.empty() || page_addresses.back() != first_page)
+      page_addresses.push_back(first_page);
+    if (last_page != first_page)
+      page_addresses.push_back(last_page);
+  }
 
-    const u32 increment_per_loop = aligned ? sizeof(T) : 1;
-    const u32 start_address = aligned ? Common::AlignUp(range.m_start, sizeof(T)) : range.m_start;
-    const u64 aligned_length = range.m_length - (start_address - range.m_start);
+  const Cheats::Scan::PageMap page_map = MapPages(guard, std::move(page_addresses), address_space);
+  const Cheats::SearchResultValueState value_state = GetValueState(guard, address_space);
 
-    if (aligned_length < sizeof(T))
-      continue;
+  const size_t chunk_count =
+      (previous_results.size() + NEXT_SEARCH_CHUNK_SIZE - 1) / NEXT_SEARCH_CHUNK_SIZE;
+  std::vector<std::vector<Cheats::SearchResult<T>>> chunk_results(chunk_count);
+  ParallelFor(chunk_count, NEXT_SEARCH_MIN_CHUNKS_PER_THREAD, [&](size_t chunk_index) {
+    const size_t begin = chunk_index * NEXT_SEARCH_CHUNK_SIZE;
+    const size_t end = std::min(previous_results.size(), begin + NEXT_SEARCH_CHUNK_SIZE);
+    auto& results = chunk_results[chunk_index];
 
-    const u64 length = aligned_length - (sizeof(T) - 1);
-    for (u64 i = 0; i < length; i += increment_per_loop)
+    for (size_t i = begin; i < end; ++i)
     {
-      const u32 addr = start_address + i;
-      const auto current_value = TryReadValueFromEmulatedMemory<T>(guard, addr, address_space);
+      const auto& previous_result = previous_results[i];
+      const u32 addr = previous_result.m_address;
+      const std::optional<T> current_value = page_map.Read<T>(addr);
       if (!current_value)
-        continue;
-
-      if (validator(current_value->value))
       {
         auto& r = results.emplace_back();
-        r.m_value = current_value->value;
-        r.m_value_state = current_value->translated ?
-                              Cheats::SearchResultValueState::ValueFromVirtualMemory :
-                              Cheats::SearchResultValueState::ValueFromPhysicalMemory;
         r.m_address = addr;
+        r.m_value_state = Cheats::SearchResultValueState::AddressNotAccessible;
+        continue;
       }
+
+      // if the previous state was invalid we always update the value to avoid getting stuck in an
+      // invalid state
+      if (!previous_result.IsValueValid() || validator(*current_value, previous_result.m_value))
+        results.push_back({*current_value, value_state, addr});
     }
-  }
-  return results;
+  });
+
+  return Concatenate(chunk_results);
+}
+}  // namespace
+
+template <typename T>
+Common::Result<Cheats::SearchErrorCode, std::vector<Cheats::SearchResult<T>>>
+Cheats::NewSearch(const Core::CPUThreadGuard& guard,
+                  const std::vector<Cheats::MemoryRange>& memory_ranges,
+                  PowerPC::RequestedAddressSpace address_space, bool aligned,
+                  const std::function<bool(const T& value)>& validator)
+{
+  return NewSearchImpl<T>(guard, memory_ranges, address_space, aligned, validator);
 }
 
 template <typename T>
@@ -260,43 +385,7 @@ Cheats::NextSearch(const Core::CPUThreadGuard& guard,
                    PowerPC::RequestedAddressSpace address_space,
                    const std::function<bool(const T& new_value, const T& old_value)>& validator)
 {
-  if (AchievementManager::GetInstance().IsHardcoreModeActive())
-    return Cheats::SearchErrorCode::DisabledInHardcoreMode;
-  auto& system = guard.GetSystem();
-  std::vector<Cheats::SearchResult<T>> results;
-  const Core::State core_state = Core::GetState(system);
-  if (core_state != Core::State::Running && core_state != Core::State::Paused)
-    return Cheats::SearchErrorCode::NoEmulationActive;
-
-  const auto& ppc_state = system.GetPPCState();
-  if (address_space == PowerPC::RequestedAddressSpace::Virtual && !ppc_state.msr.DR)
-    return Cheats::SearchErrorCode::VirtualAddressesCurrentlyNotAccessible;
-
-  for (const auto& previous_result : previous_results)
-  {
-    const u32 addr = previous_result.m_address;
-    const auto current_value = TryReadValueFromEmulatedMemory<T>(guard, addr, address_space);
-    if (!current_value)
-    {
-      auto& r = results.emplace_back();
-      r.m_address = addr;
-      r.m_value_state = Cheats::SearchResultValueState::AddressNotAccessible;
-      continue;
-    }
-
-    // if the previous state was invalid we always update the value to avoid getting stuck in an
-    // invalid state
-    if (!previous_result.IsValueValid() || validator(current_value->value, previous_result.m_value))
-    {
-      auto& r = results.emplace_back();
-      r.m_value = current_value->value;
-      r.m_value_state = current_value->translated ?
-                            Cheats::SearchResultValueState::ValueFromVirtualMemory :
-                            Cheats::SearchResultValueState::ValueFromPhysicalMemory;
-      r.m_address = addr;
-    }
-  }
-  return results;
+  return NextSearchImpl<T>(guard, previous_results, address_space, validator);
 }
 
 Cheats::CheatSearchSessionBase::~CheatSearchSessionBase() = default;
@@ -374,51 +463,28 @@ void Cheats::CheatSearchSession<T>::ResetResults()
   m_search_results.clear();
 }
 
-template <typename T>
-static std::function<bool(const T& new_value)>
-MakeCompareFunctionForSpecificValue(Cheats::CompareType op, const T& old_value)
-{
-  switch (op)
-  {
-  case Cheats::CompareType::Equal:
-    return [&](const T& new_value) { return new_value == old_value; };
-  case Cheats::CompareType::NotEqual:
-    return [&](const T& new_value) { return new_value != old_value; };
-  case Cheats::CompareType::Less:
-    return [&](const T& new_value) { return new_value < old_value; };
-  case Cheats::CompareType::LessOrEqual:
-    return [&](const T& new_value) { return new_value <= old_value; };
-  case Cheats::CompareType::Greater:
-    return [&](const T& new_value) { return new_value > old_value; };
-  case Cheats::CompareType::GreaterOrEqual:
-    return [&](const T& new_value) { return new_value >= old_value; };
-  default:
-    DEBUG_ASSERT(false);
-    return nullptr;
-  }
-}
-
-template <typename T>
-static std::function<bool(const T& old_value, const T& new_value)>
-MakeCompareFunctionForLastValue(Cheats::CompareType op)
+// Calls function with the comparison for op. The comparison is passed as its own type rather than
+// as a std::function, so that searches can inline it.
+template <typename T, typename Function>
+static auto CallWithCompareFunction(Cheats::CompareType op, const Function& function)
 {
   switch (op)
   {
   case Cheats::CompareType::Equal:
-    return std::equal_to<T>();
+    return function(std::equal_to<T>());
   case Cheats::CompareType::NotEqual:
-    return std::not_equal_to<T>();
+    return function(std::not_equal_to<T>());
   case Cheats::CompareType::Less:
-    return std::less<T>();
+    return function(std::less<T>());
   case Cheats::CompareType::LessOrEqual:
-    return std::less_equal<T>();
+    return function(std::less_equal<T>());
   case Cheats::CompareType::Greater:
-    return std::greater<T>();
+    return function(std::greater<T>());
   case Cheats::CompareType::GreaterOrEqual:
-    return std::greater_equal<T>();
+    return function(std::greater_equal<T>());
   default:
     DEBUG_ASSERT(false);
-    return nullptr;
+    return function(std::equal_to<T>());
   }
 }
 
@@ -434,37 +500,38 @@ Cheats::SearchErrorCode Cheats::CheatSearchSession<T>::RunSearch(const Core::CPU
     if (!m_value)
       return Cheats::SearchErrorCode::InvalidParameters;
 
-    auto func = MakeCompareFunctionForSpecificValue<T>(m_compare_type, *m_value);
-    if (m_first_search_done)
-    {
-      result = Cheats::NextSearch<T>(
-          guard, m_search_results, m_address_space,
-          [&func](const T& new_value, const T& old_value) { return func(new_value); });
-    }
-    else
-    {
-      result = Cheats::NewSearch<T>(guard, m_memory_ranges, m_address_space, m_aligned, func);
-    }
+    const T value = *m_value;
+    result = CallWithCompareFunction<T>(m_compare_type, [&](const auto& compare) {
+      if (m_first_search_done)
+      {
+        return NextSearchImpl<T>(
+            guard, m_search_results, m_address_space,
+            [&](const T& new_value, const T& old_value) { return compare(new_value, value); });
+      }
+      return NewSearchImpl<T>(guard, m_memory_ranges, m_address_space, m_aligned,
+                              [&](const T& new_value) { return compare(new_value, value); });
+    });
   }
   else if (m_filter_type == FilterType::CompareAgainstLastValue)
   {
     if (!m_first_search_done)
       return Cheats::SearchErrorCode::InvalidParameters;
 
-    result = Cheats::NextSearch<T>(guard, m_search_results, m_address_space,
-                                   MakeCompareFunctionForLastValue<T>(m_compare_type));
+    result = CallWithCompareFunction<T>(m_compare_type, [&](const auto& compare) {
+      return NextSearchImpl<T>(guard, m_search_results, m_address_space, compare);
+    });
   }
   else if (m_filter_type == FilterType::DoNotFilter)
   {
     if (m_first_search_done)
     {
-      result = Cheats::NextSearch<T>(guard, m_search_results, m_address_space,
-                                     [](const T& v1, const T& v2) { return true; });
+      result = NextSearchImpl<T>(guard, m_search_results, m_address_space,
+                                 [](const T& v1, const T& v2) { return true; });
     }
     else
     {
-      result = Cheats::NewSearch<T>(guard, m_memory_ranges, m_address_space, m_aligned,
-                                    [](const T& v) { return true; });
+      result = NewSearchImpl<T>(guard, m_memory_ranges, m_address_space, m_aligned,
+                                [](const T& v) { return true; });
     }
   }
 
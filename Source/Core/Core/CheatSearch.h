@@ -113,7 +113,8 @@ DataType GetDataType(const SearchValue& value);
 std::vector<u8> GetValueAsByteVector(const SearchValue& value);
 
 // Do a new search across the given memory region in the given address space, only keeping values
-// for which the given validator returns true.
+// for which the given validator returns true. The memory is scanned on several threads, so the
+// validator may be called concurrently.
 template <typename T>
 Common::Result<SearchErrorCode, std::vector<SearchResult<T>>>
 NewSearch(const Core::CPUThreadGuard& guard, const std::vector<MemoryRange>& memory_ranges,
@@ -121,7 +122,7 @@ NewSearch(const Core::CPUThreadGuard& guard, const std::vector<MemoryRange>& mem
           const std::function<bool(const T& value)>& validator);
 
 // Refresh the values for the given results in the given address space, only keeping values for
-// which the given validator returns true.
+// which the given validator returns true. Like NewSearch, this may call the validator concurrently.
 template <typename T>
 Common::Result<SearchErrorCode, std::vector<SearchResult<T>>>
 NextSearch(const Core::CPUThreadGuard& guard, const std::vector<SearchResult<T>>& previous_results,
@@ -0,0 +1,65 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "Core/CheatSearchScan.h"
+
+#include "Common/Align.h"
+#include "Common/Assert.h"
+
+namespace Cheats::Scan
+{
+void PageMap::AddPage(u32 address, const u8* data)
+{
+  DEBUG_ASSERT(m_pages.empty() || m_pages.back().address < address);
+  m_pages.push_back({address, data});
+}
+
+void PageMap::AddCopiedPage(u32 address, const std::array<u8, PAGE_SIZE>& data)
+{
+  AddPage(address, m_copied_pages.emplace_back(data).data());
+}
+
+const u8* PageMap::FindPage(u32 address) const
+{
+  const u32 page_address = Common::AlignDown(address, PAGE_SIZE);
+  const auto it = std::ranges::lower_bound(m_pages, page_address, {}, &Page::address);
+  if (it == m_pages.end() || it->address != page_address)
+    return nullptr;
+  return it->data;
+}
+
+std::vector<u32> SplitIntoChunks(std::span<const MemoryRange> memory_ranges, u32 value_size,
+                                 bool aligned, std::vector<Chunk>* chunks)
+{
+  std::vector<u32> page_addresses;
+  for (const MemoryRange& range : memory_ranges)
+  {
+    if (range.m_length < value_size)
+      continue;
+
+    const u32 start_address = aligned ? Common::AlignUp(range.m_start, value_size) : range.m_start;
+    const u64 aligned_length = range.m_length - (start_address - range.m_start);
+
+    if (aligned_length < value_size)
+      continue;
+
+    const u64 end_address = u64(start_address) + aligned_length - (value_size - 1);
+    for (u64 begin = start_address; begin < end_address;)
+    {
+      // Chunks end on page boundaries, which stay aligned to the values.
+      const u64 end = std::min(end_address, Common::AlignDown(begin, NEW_SEARCH_CHUNK_SIZE) +
+                                                NEW_SEARCH_CHUNK_SIZE);
+      chunks->push_back({static_cast<u32>(begin), end});
+      begin = end;
+    }
+
+    const u64 range_end = u64(range.m_start) + range.m_length;
+    for (u64 page = Common::AlignDown(range.m_start, PAGE_SIZE); page < range_end;
+         page += PAGE_SIZE)
+    {
+      page_addresses.push_back(static_cast<u32>(page));
+    }
+  }
+  return page_addresses;
+}
+}  // namespace Cheats::Scan
@@ -0,0 +1,173 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <deque>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/Swap.h"
+#include "Core/CheatSearch.h"
+
+// The parts of a cheat search that only deal with host memory, and can run on any thread once the
+// pages to search have been resolved on the CPU thread.
+namespace Cheats::Scan
+{
+constexpr u32 PAGE_SIZE = 0x1000;
+
+// New searches are split into chunks of this many bytes of emulated memory.
+constexpr u32 NEW_SEARCH_CHUNK_SIZE = 0x10000;
+
+template <typename T>
+T LoadBigEndian(const u8* data)
+{
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return Common::FromBigEndian(value);
+}
+
+// The emulated pages a search reads, resolved to host memory.
+class PageMap
+{
+public:
+  // Pages have to be added in order of their addresses. The data has to stay valid for as long as
+  // the map is used.
+  void AddPage(u32 address, const u8* data);
+  // For pages that are RAM but can't be accessed in place, such as the locked L1 cache.
+  void AddCopiedPage(u32 address, const std::array<u8, PAGE_SIZE>& data);
+
+  // Returns the host memory of the page that contains the given address, or nullptr if the page
+  // isn't in the map.
+  const u8* FindPage(u32 address) const;
+
+  template <typename T>
+  std::optional<T> Read(u32 address) const
+  {
+    const u32 offset = address % PAGE_SIZE;
+    const u8* page = FindPage(address);
+    if (!page)
+      return std::nullopt;
+    if (offset + sizeof(T) <= PAGE_SIZE)
+      return LoadBigEndian<T>(page + offset);
+
+    // The value crosses into the next page, which may be somewhere else entirely on the host.
+    const u8* next_page = FindPage(address - offset + PAGE_SIZE);
+    if (!next_page)
+      return std::nullopt;
+    std::array<u8, sizeof(T)> bytes;
+    const u32 first_size = PAGE_SIZE - offset;
+    std::memcpy(bytes.data(), page + offset, first_size);
+    std::memcpy(bytes.data() + first_size, next_page, sizeof(T) - first_size);
+    return LoadBigEndian<T>(bytes.data());
+  }
+
+private:
+  struct Page
+  {
+    u32 address;
+    const u8* data;
+  };
+
+  std::vector<Page> m_pages;
+  std::deque<std::array<u8, PAGE_SIZE>> m_copied_pages;
+};
+
+// The start addresses of the values a new search tests, as [begin, end). Chunks don't span more
+// than NEW_SEARCH_CHUNK_SIZE bytes, though the values at their end extend past it.
+struct Chunk
+{
+  u32 begin;
+  u64 end;
+
+  bool operator==(const Chunk&) const = default;
+};
+
+// Splits the memory ranges of a new search into chunks, and returns the addresses of the pages
+// that the values in them touch, which may contain duplicates.
+std::vector<u32> SplitIntoChunks(std::span<const MemoryRange> memory_ranges, u32 value_size,
+                                 bool aligned, std::vector<Chunk>* chunks);
+
+// Tests count values, Stride bytes apart, that all lie within one page. The values are tested in
+// blocks, first storing whether each of them matches and only then writing out the matches, which
+// are usually rare. The comparisons of a block don't branch, so the compiler can vectorize them.
+template <typename T, u32 Stride, typename Validator>
+void ScanPage(const u8* data, u32 address, u32 count, SearchResultValueState value_state,
+              const Validator& validator, std::vector<SearchResult<T>>& results)
+{
+  constexpr u32 BLOCK_SIZE = 64;
+
+  const auto add_result = [&](u32 i) {
+    auto& r = results.emplace_back();
+    r.m_value = LoadBigEndian<T>(data + i * Stride);
+    r.m_value_state = value_state;
+    r.m_address = address + i * Stride;
+  };
+
+  u32 block = 0;
+  for (; block + BLOCK_SIZE <= count; block += BLOCK_SIZE)
+  {
+    const u8* const block_data = data + block * Stride;
+
+    std::array<u8, BLOCK_SIZE> matches;
+    for (u32 i = 0; i < BLOCK_SIZE; ++i)
+      matches[i] = validator(LoadBigEndian<T>(block_data + i * Stride));
+
+    u8 any_match = 0;
+    for (u32 i = 0; i < BLOCK_SIZE; ++i)
+      any_match |= matches[i];
+    if (!any_match)
+      continue;
+
+    for (u32 i = 0; i < BLOCK_SIZE; ++i)
+    {
+      if (matches[i])
+        add_result(block + i);
+    }
+  }
+
+  for (; block < count; ++block)
+  {
+    if (validator(LoadBigEndian<T>(data + block * Stride)))
+      add_result(block);
+  }
+}
+
+// Tests the values of a chunk that lie in pages of the map, Stride bytes apart.
+template <typename T, u32 Stride, typename Validator>
+void ScanChunk(const PageMap& page_map, const Chunk& chunk, SearchResultValueState value_state,
+               const Validator& validator, std::vector<SearchResult<T>>& results)
+{
+  u64 address = chunk.begin;
+  while (address < chunk.end)
+  {
+    const u64 page_address = address - address % PAGE_SIZE;
+    const u64 page_end = std::min(chunk.end, page_address + PAGE_SIZE);
+    if (const u8* page = page_map.FindPage(static_cast<u32>(address)))
+    {
+      // Values that cross into the next page are read separately.
+      const u64 in_page_end = std::min(page_end, page_address + PAGE_SIZE - (sizeof(T) - 1));
+      const u32 count =
+          address < in_page_end ? static_cast<u32>((in_page_end - address - 1) / Stride + 1) : 0;
+      ScanPage<T, Stride>(page + address % PAGE_SIZE, static_cast<u32>(address), count,
+                          value_state, validator, results);
+      address += u64(count) * Stride;
+
+      for (; address < page_end; address += Stride)
+      {
+        const std::optional<T> value = page_map.Read<T>(static_cast<u32>(address));
+        if (value && validator(*value))
+          results.push_back({*value, value_state, static_cast<u32>(address)});
+      }
+    }
+
+    // Aligned values start at multiples of Stride, so the next one is at the start of the page.
+    address = page_end;
+  }
+}
+}  // namespace Cheats::Scan
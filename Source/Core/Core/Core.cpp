@@ -163,7 +163,7 @@ double GetActualEmulationSpeed()
 void FrameUpdateOnCPUThread()
 {
   if (NetPlay::IsNetPlayRunning())
-    NetPlay::NetPlayClient::SendTimeBase();
+    NetPlay::NetPlayClient::SendStateHash();
 }
 
 void OnFrameEnd(Core::System& system)
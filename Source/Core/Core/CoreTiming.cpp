@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -14,7 +15,7 @@
 #include "Common/Assert.h"
 #include "Common/ChunkFile.h"
 #include "Common/Logging/Log.h"
-#include "Common/SPSCQueue.h"
+#include "Common/MPSCQueue.h"
 
 #include "Core/AchievementManager.h"
 #include "Core/CPUThreadConfigCallback.h"
@@ -118,7 +119,6 @@ void CoreTimingManager::Init()
 
 void CoreTimingManager::Shutdown()
 {
-  std::lock_guard lk(m_ts_write_lock);
   MoveEvents();
   ClearPendingEvents();
   UnregisterAllEvents();
@@ -152,7 +152,15 @@ void CoreTimingManager::RefreshConfig()
 
 void CoreTimingManager::DoState(PointerWrap& p)
 {
-  std::lock_guard lk(m_ts_write_lock);
+  // Keep the other threads from scheduling events while the queue (and the timer they are
+  // scheduled relative to) is being saved or replaced. Setting m_ts_overflowed sends new events to
+  // the overflow list, which needs the lock, so only pushes to the ring that are already under way
+  // have to be waited for.
+  std::lock_guard lk(m_ts_overflow_lock);
+  m_ts_overflowed.store(true);
+  while (m_ts_pushing.load() != 0)
+    std::this_thread::yield();
+
   p.Do(m_globals.slice_length);
   p.Do(m_globals.global_timer);
   p.Do(m_idled_cycles);
@@ -166,7 +174,7 @@ void CoreTimingManager::DoState(PointerWrap& p)
 
   p.DoMarker("CoreTimingData");
 
-  MoveEvents();
+  MoveOverflowEvents();
   p.DoEachElement(m_event_queue, [this](PointerWrap& pw, Event& ev) {
     pw.Do(ev.time);
     pw.Do(ev.fifo_order);
@@ -275,11 +283,32 @@ void CoreTimingManager::ScheduleEvent(s64 cycles_into_future, EventType* event_t
                     *event_type->name);
     }
 
-    std::lock_guard lk(m_ts_write_lock);
-    m_ts_queue.Push(Event{m_globals.global_timer + cycles_into_future, 0, userdata, event_type});
+    PushThreadSafeEvent(cycles_into_future, event_type, userdata);
   }
 }
 
+void CoreTimingManager::PushThreadSafeEvent(s64 cycles_into_future, EventType* event_type,
+                                            u64 userdata)
+{
+  // DoState() waits for m_ts_pushing to drop to zero after setting m_ts_overflowed, so either it
+  // sees this push or this push sees the flag and takes the lock.
+  const auto make_event = [&] {
+    return Event{m_globals.global_timer + cycles_into_future, 0, userdata, event_type};
+  };
+  m_ts_pushing.fetch_add(1);
+  const bool pushed = !m_ts_overflowed.load() && m_ts_queue.TryPush(make_event());
+  m_ts_pushing.fetch_sub(1, std::memory_order_release);
+  if (pushed)
+    return;
+
+  // The ring is full (or was full recently and hasn't been drained yet). This only happens if the
+  // CPU thread hasn't called Advance() in a long time, e.g. while the emulation is paused or a
+  // state is being saved or loaded.
+  std::lock_guard lk(m_ts_overflow_lock);
+  m_ts_overflow.push_back(make_event());
+  m_ts_overflowed.store(true, std::memory_order_release);
+}
+
 void CoreTimingManager::RemoveEvent(EventType* event_type)
 {
   const size_t erased =
@@ -311,14 +340,33 @@ void CoreTimingManager::ForceExceptionCheck(s64 cycles)
   }
 }
 
+void CoreTimingManager::PushMovedEvent(Event ev)
+{
+  ev.fifo_order = m_event_fifo_id++;
+  m_event_queue.emplace_back(std::move(ev));
+  std::push_heap(m_event_queue.begin(), m_event_queue.end(), std::greater<Event>());
+}
+
 void CoreTimingManager::MoveEvents()
 {
-  for (Event ev; m_ts_queue.Pop(ev);)
-  {
-    ev.fifo_order = m_event_fifo_id++;
-    m_event_queue.emplace_back(std::move(ev));
-    std::push_heap(m_event_queue.begin(), m_event_queue.end(), std::greater<Event>());
-  }
+  m_ts_queue.PopAll([this](Event&& ev) { PushMovedEvent(std::move(ev)); });
+
+  if (!m_ts_overflowed.load(std::memory_order_acquire))
+    return;
+
+  std::lock_guard lk(m_ts_overflow_lock);
+  MoveOverflowEvents();
+  m_ts_overflowed.store(false, std::memory_order_release);
+}
+
+void CoreTimingManager::MoveOverflowEvents()
+{
+  // Anything that made it into the ring before the overflow list was started has to be moved
+  // first to preserve the submission order of each producer.
+  m_ts_queue.PopAll([this](Event&& ev) { PushMovedEvent(std::move(ev)); });
+  for (Event& ev : m_ts_overflow)
+    PushMovedEvent(std::move(ev));
+  m_ts_overflow.clear();
 }
 
 void CoreTimingManager::Advance()
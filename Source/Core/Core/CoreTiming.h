@@ -16,13 +16,14 @@
 // inside callback:
 //   ScheduleEvent(periodInCycles - cyclesLate, callback, "whatever")
 
+#include <atomic>
 #include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "Common/CommonTypes.h"
-#include "Common/SPSCQueue.h"
+#include "Common/MPSCQueue.h"
 #include "Core/CPUThreadConfigCallback.h"
 
 class PointerWrap;
@@ -169,8 +170,17 @@ private:
   // by the standard adaptor class.
   std::vector<Event> m_event_queue;
   u64 m_event_fifo_id = 0;
-  std::mutex m_ts_write_lock;
-  Common::SPSCQueue<Event, false> m_ts_queue;
+  // Events scheduled from other threads. Producers push into the lock-free ring and the CPU
+  // thread drains it in batches from Advance(). The mutex protected overflow list is only used
+  // when the ring is full; once it is in use, all producers append to it until it has been
+  // drained so that events from a single thread are never reordered.
+  static constexpr size_t TS_QUEUE_SIZE = 1024;
+  Common::MPSCQueue<Event, TS_QUEUE_SIZE> m_ts_queue;
+  std::mutex m_ts_overflow_lock;
+  std::vector<Event> m_ts_overflow;
+  std::atomic<bool> m_ts_overflowed = false;
+  // The number of producers that are currently pushing into the ring.
+  std::atomic<u32> m_ts_pushing = 0;
 
   float m_last_oc_factor = 0.0f;
 
@@ -199,6 +209,10 @@ private:
   double m_emulation_speed = 1.0;
 
   void ResetThrottle(s64 cycle);
+  void PushThreadSafeEvent(s64 cycles_into_future, EventType* event_type, u64 userdata);
+  void PushMovedEvent(Event ev);
+  // Requires m_ts_overflow_lock to be held.
+  void MoveOverflowEvents();
 
   int DowncountToCycles(int downcount) const;
   int CyclesToDowncount(int cycles) const;
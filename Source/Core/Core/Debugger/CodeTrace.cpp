@@ -9,6 +9,7 @@
 
 #include "Common/Event.h"
 #include "Core/Core.h"
+#include "Core/Debugger/CodeTraceFile.h"
 #include "Core/Debugger/PPCDebugInterface.h"
 #include "Core/HW/CPU.h"
 #include "Core/PowerPC/PowerPC.h"
@@ -63,6 +64,22 @@ bool CompareMemoryTargetToTracked(const std::string& instr, const u32 mem_target
   // If the base value doesn't hit, still need to check if longer values overlap.
   return *it_lower < mem_target + GetMemoryTargetSize(instr);
 }
+
+HitType GetStopCondition(CodeTrace::AutoStop stop_on)
+{
+  // Could use bit flags, but I organized it to have decreasing levels of verbosity, so the
+  // less-than comparison ignores what is needed for the current usage.
+  switch (stop_on)
+  {
+  case CodeTrace::AutoStop::Used:
+    return HitType::PASSIVE;
+  case CodeTrace::AutoStop::Changed:
+    return HitType::ACTIVE;
+  case CodeTrace::AutoStop::Always:
+  default:
+    return HitType::SAVELOAD;
+  }
+}
 }  // namespace
 
 void CodeTrace::SetRegTracked(const std::string& reg)
@@ -139,22 +156,13 @@ TraceOutput CodeTrace::SaveCurrentInstruction(const Core::CPUThreadGuard& guard)
   return output;
 }
 
-AutoStepResults CodeTrace::AutoStepping(const Core::CPUThreadGuard& guard, bool continue_previous,
-                                        AutoStop stop_on)
+bool CodeTrace::StartTracking(const TraceOutput& start, bool continue_previous)
 {
-  AutoStepResults results;
-
-  if (m_recording)
-    return results;
-
-  TraceOutput pc_instr = SaveCurrentInstruction(guard);
-  const InstructionAttributes instr = GetInstructionAttributes(pc_instr);
+  const InstructionAttributes instr = GetInstructionAttributes(start);
 
   // Not an instruction we should start autostepping from (ie branches).
   if (instr.reg0.empty() && !continue_previous)
-    return results;
-
-  m_recording = true;
+    return false;
 
   // Once autostep stops, it can be told to continue running without resetting the tracked
   // registers and memory.
@@ -174,19 +182,27 @@ AutoStepResults CodeTrace::AutoStepping(const Core::CPUThreadGuard& guard, bool
     }
   }
 
+  return true;
+}
+
+AutoStepResults CodeTrace::AutoStepping(const Core::CPUThreadGuard& guard, bool continue_previous,
+                                        AutoStop stop_on)
+{
+  AutoStepResults results;
+
+  if (m_recording)
+    return results;
+
+  TraceOutput pc_instr = SaveCurrentInstruction(guard);
+  if (!StartTracking(pc_instr, continue_previous))
+    return results;
+
+  m_recording = true;
+
   // Count is important for feedback on how much work was done.
 
   HitType hit = HitType::SKIP;
-  HitType stop_condition = HitType::SAVELOAD;
-
-  // Could use bit flags, but I organized it to have decreasing levels of verbosity, so the
-  // less-than comparison ignores what is needed for the current usage.
-  if (stop_on == AutoStop::Always)
-    stop_condition = HitType::SAVELOAD;
-  else if (stop_on == AutoStop::Used)
-    stop_condition = HitType::PASSIVE;
-  else if (stop_on == AutoStop::Changed)
-    stop_condition = HitType::ACTIVE;
+  const HitType stop_condition = GetStopCondition(stop_on);
 
   auto& power_pc = guard.GetSystem().GetPowerPC();
   using clock = std::chrono::steady_clock;
@@ -222,6 +238,41 @@ AutoStepResults CodeTrace::AutoStepping(const Core::CPUThreadGuard& guard, bool
   return results;
 }
 
+AutoStepResults CodeTrace::AutoStepping(std::span<const CodeTraceFile::Record> trace,
+                                        bool continue_previous, AutoStop stop_on)
+{
+  AutoStepResults results;
+
+  if (m_recording || trace.empty())
+    return results;
+
+  if (!StartTracking(CodeTraceFile::Decode(trace.front()), continue_previous))
+    return results;
+
+  m_recording = true;
+
+  // Nothing runs, so there is no timeout. Reaching the end of the trace is reported as one
+  // instead, since a longer recording may still find where the value goes.
+  const HitType stop_condition = GetStopCondition(stop_on);
+  results.timed_out = true;
+  for (size_t i = 1; i < trace.size(); i++)
+  {
+    const HitType hit = TraceLogic(CodeTraceFile::Decode(trace[i]));
+    results.count = static_cast<u32>(i);
+    if (hit >= stop_condition || (m_reg_autotrack.empty() && m_mem_autotrack.empty()))
+    {
+      results.timed_out = false;
+      break;
+    }
+  }
+
+  m_recording = false;
+
+  results.reg_tracked = m_reg_autotrack;
+  results.mem_tracked = m_mem_autotrack;
+  return results;
+}
+
 HitType CodeTrace::TraceLogic(const TraceOutput& current_instr, bool first_hit)
 {
   // Tracks the original value that is in the targeted register or memory through loads, stores,
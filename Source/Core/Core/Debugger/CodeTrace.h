@@ -5,6 +5,7 @@
 
 #include <optional>
 #include <set>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -15,6 +16,11 @@ namespace Core
 class CPUThreadGuard;
 }
 
+namespace CodeTraceFile
+{
+struct Record;
+}
+
 struct InstructionAttributes
 {
   u32 address = 0;
@@ -70,8 +76,14 @@ public:
   void SetRegTracked(const std::string& reg);
   AutoStepResults AutoStepping(const Core::CPUThreadGuard& guard, bool continue_previous = false,
                                AutoStop stop_on = AutoStop::Always);
+  // Does the same on a recorded trace, starting from its first instruction. The instruction it
+  // stopped at is the one at index count.
+  AutoStepResults AutoStepping(std::span<const CodeTraceFile::Record> trace,
+                               bool continue_previous = false,
+                               AutoStop stop_on = AutoStop::Always);
 
 private:
+  bool StartTracking(const TraceOutput& start, bool continue_previous);
   InstructionAttributes GetInstructionAttributes(const TraceOutput& line) const;
   TraceOutput SaveCurrentInstruction(const Core::CPUThreadGuard& guard) const;
   HitType TraceLogic(const TraceOutput& current_instr, bool first_hit = false);
@@ -0,0 +1,202 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "Core/Debugger/CodeTraceFile.h"
+
+#include <cstring>
+#include <optional>
+
+#include "Common/GekkoDisassembler.h"
+#include "Common/Logging/Log.h"
+#include "Core/Core.h"
+#include "Core/Debugger/CodeTrace.h"
+#include "Core/PowerPC/Gekko.h"
+#include "Core/PowerPC/MMU.h"
+#include "Core/PowerPC/PPCTables.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/System.h"
+
+namespace CodeTraceFile
+{
+namespace
+{
+// Computes the effective address of a load or store from its fields, which is much cheaper than
+// parsing it out of the disassembly.
+std::optional<u32> GetMemoryTarget(const PowerPC::PowerPCState& ppc_state, UGeckoInstruction inst,
+                                   const GekkoOPInfo& info)
+{
+  if (!(info.flags & FL_LOADSTORE) || info.type == OpType::DataCache ||
+      info.type == OpType::InstructionCache)
+  {
+    return std::nullopt;
+  }
+
+  // Update forms with rA = 0 are invalid, so rA = 0 can always be read as zero.
+  const u32 base = inst.RA == 0 ? 0 : ppc_state.gpr[inst.RA];
+  if (info.flags & FL_IN_B)
+    return base + ppc_state.gpr[inst.RB];
+
+  switch (inst.OPCD)
+  {
+  case 56:  // psq_l
+  case 57:  // psq_lu
+  case 60:  // psq_st
+  case 61:  // psq_stu
+    return base + static_cast<u32>(inst.SIMM_12);
+  case 31:  // lswi and stswi keep the byte count where the offset would be.
+    return base;
+  default:
+    return base + static_cast<u32>(inst.SIMM_16);
+  }
+}
+}  // namespace
+
+Writer::~Writer()
+{
+  Close();
+}
+
+bool Writer::Open(const std::string& path)
+{
+  Close();
+
+  if (!m_file.Open(path, "wb"))
+    return false;
+
+  const Header header;
+  if (!m_file.WriteArray(&header, 1))
+  {
+    m_file.Close();
+    return false;
+  }
+
+  m_buffer.reserve(BUFFER_RECORDS);
+  m_write_failed = false;
+  m_write_thread.Reset("Code Trace Writer", [this](std::vector<Record> records) {
+    if (!m_file.WriteArray(records.data(), records.size()))
+      m_write_failed = true;
+  });
+  return true;
+}
+
+bool Writer::Close()
+{
+  if (!m_file.IsOpen())
+    return true;
+
+  Flush();
+  m_write_thread.Shutdown();
+  const bool success = !m_write_failed && m_file.Close();
+  if (!success)
+    ERROR_LOG_FMT(POWERPC, "Failed to write the code trace");
+  return success;
+}
+
+void Writer::Flush()
+{
+  if (m_buffer.empty())
+    return;
+
+  std::vector<Record> records;
+  records.reserve(BUFFER_RECORDS);
+  std::swap(records, m_buffer);
+  m_write_thread.Push(std::move(records));
+}
+
+bool Reader::Open(const std::string& path)
+{
+  Close();
+
+  if (!m_file.Open(path))
+    return false;
+
+  Header header;
+  if (m_file.GetSize() < sizeof(header))
+  {
+    Close();
+    return false;
+  }
+  std::memcpy(&header, m_file.GetData(), sizeof(header));
+  if (header.magic != Header::MAGIC || header.version != Header::VERSION ||
+      header.record_size != sizeof(Record))
+  {
+    ERROR_LOG_FMT(POWERPC, "{} is not a code trace this version can read", path);
+    Close();
+    return false;
+  }
+
+  // A trace cut short by a crash may end in a partial record, which is left out.
+  const size_t count = (m_file.GetSize() - sizeof(header)) / sizeof(Record);
+  m_records = {reinterpret_cast<const Record*>(m_file.GetData() + sizeof(header)), count};
+  return true;
+}
+
+void Reader::Close()
+{
+  m_records = {};
+  m_file.Close();
+}
+
+RecordResult RecordInstructions(const Core::CPUThreadGuard& guard, Writer& writer,
+                                u64 max_instructions, const std::function<bool(u64)>& progress)
+{
+  auto& power_pc = guard.GetSystem().GetPowerPC();
+  const auto& ppc_state = power_pc.GetPPCState();
+
+  const PowerPC::CoreMode old_mode = power_pc.GetMode();
+  power_pc.SetMode(PowerPC::CoreMode::Interpreter);
+
+  RecordResult result;
+  u64& count = result.count;
+  for (; count < max_instructions; ++count)
+  {
+    // The first instruction is recorded even if it has a breakpoint, since that's usually where
+    // the CPU stopped.
+    if (count != 0 && power_pc.CheckBreakPoints())
+    {
+      result.stop_reason = RecordResult::StopReason::BreakPoint;
+      break;
+    }
+    if (count % PROGRESS_INTERVAL == 0 && count != 0 && !progress(count))
+    {
+      result.stop_reason = RecordResult::StopReason::Canceled;
+      break;
+    }
+
+    Record record{};
+    record.address = ppc_state.pc;
+    record.hex = PowerPC::MMU::HostRead_Instruction(guard, record.address);
+
+    const UGeckoInstruction inst{record.hex};
+    if (const GekkoOPInfo* info = PPCTables::GetOpInfo(inst, record.address))
+    {
+      if (const std::optional<u32> target = GetMemoryTarget(ppc_state, inst, *info))
+      {
+        record.memory_target = *target;
+        record.flags |= Record::HAS_MEMORY_TARGET;
+      }
+    }
+    record.operands[0] = ppc_state.gpr[inst.RD];
+    record.operands[1] = ppc_state.gpr[inst.RA];
+    record.operands[2] = ppc_state.gpr[inst.RB];
+
+    power_pc.SingleStep();
+
+    record.result = ppc_state.gpr[inst.RD];
+    writer.Write(record);
+  }
+
+  power_pc.SetMode(old_mode);
+  return result;
+}
+
+TraceOutput Decode(const Record& record)
+{
+  TraceOutput output;
+  output.address = record.address;
+  output.instruction = Common::GekkoDisassembler::Disassemble(record.hex, record.address);
+  if (record.flags & Record::HAS_MEMORY_TARGET)
+    output.memory_target = record.memory_target;
+  return output;
+}
+}  // namespace CodeTraceFile
@@ -0,0 +1,132 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/IOFile.h"
+#include "Common/MappedFile.h"
+#include "Common/WorkQueueThread.h"
+
+namespace Core
+{
+class CPUThreadGuard;
+}
+
+struct TraceOutput;
+
+// Binary code traces. Rather than disassembling every instruction as it executes, a fixed-size
+// record of the raw instruction and the registers it uses is written to a file. Disassembly and
+// value tracking (see CodeTrace) happen later, on the recorded trace.
+namespace CodeTraceFile
+{
+struct Record
+{
+  enum Flags : u32
+  {
+    HAS_MEMORY_TARGET = (1 << 0),
+  };
+
+  u32 address;
+  u32 hex;
+  u32 memory_target;
+  u32 flags;
+  // The values of the registers in the rD (or rS), rA and rB fields before the instruction ran.
+  u32 operands[3];
+  // The value of the register in the rD field after the instruction ran.
+  u32 result;
+};
+static_assert(sizeof(Record) == 32);
+
+struct Header
+{
+  static constexpr u32 MAGIC = 0x43525444;  // "DTRC"
+  static constexpr u32 VERSION = 1;
+
+  u32 magic = MAGIC;
+  u32 version = VERSION;
+  u32 record_size = sizeof(Record);
+};
+static_assert(sizeof(Header) == 12);
+
+// Writes records to a file. Records are gathered into large buffers which are written on a
+// thread of their own, so recording doesn't wait on the disk.
+class Writer
+{
+public:
+  Writer() = default;
+  ~Writer();
+
+  Writer(const Writer&) = delete;
+  Writer& operator=(const Writer&) = delete;
+
+  bool Open(const std::string& path);
+  // Writes the remaining records and closes the file. Returns false if any write failed.
+  bool Close();
+
+  void Write(const Record& record)
+  {
+    m_buffer.push_back(record);
+    if (m_buffer.size() == BUFFER_RECORDS)
+      Flush();
+  }
+
+private:
+  static constexpr size_t BUFFER_RECORDS = 0x10000;
+
+  void Flush();
+
+  File::IOFile m_file;
+  std::vector<Record> m_buffer;
+  Common::WorkQueueThread<std::vector<Record>> m_write_thread;
+  std::atomic<bool> m_write_failed = false;
+};
+
+// Maps a trace file into memory so that its records can be read without copying them.
+class Reader
+{
+public:
+  bool Open(const std::string& path);
+  void Close();
+
+  std::span<const Record> GetRecords() const { return m_records; }
+
+private:
+  File::MappedFile m_file;
+  std::span<const Record> m_records;
+};
+
+// Traces longer than this are better recorded in several parts, since each instruction takes 32
+// bytes in the file.
+constexpr u64 MAX_RECORDED_INSTRUCTIONS = 100'000'000;
+
+struct RecordResult
+{
+  enum class StopReason
+  {
+    Finished,
+    BreakPoint,
+    Canceled,
+  };
+
+  u64 count = 0;
+  StopReason stop_reason = StopReason::Finished;
+};
+
+// Single steps the CPU in the interpreter and records every instruction that runs, stopping
+// after max_instructions or before an instruction with a breakpoint. Every PROGRESS_INTERVAL
+// instructions, progress is called with the number recorded so far, and recording stops if it
+// returns false. This has to run on the CPU thread.
+constexpr u64 PROGRESS_INTERVAL = 0x10000;
+RecordResult RecordInstructions(const Core::CPUThreadGuard& guard, Writer& writer,
+                                u64 max_instructions, const std::function<bool(u64)>& progress);
+
+// Disassembles a record into the form CodeTrace analyzes.
+TraceOutput Decode(const Record& record);
+}  // namespace CodeTraceFile
@@ -223,6 +223,22 @@ void DolphinAnalytics::ReportPerformanceInfo(PerformanceSample&& sample)
     builder.AddData("prims", num_prims);
     builder.AddData("draw-calls", num_draw_calls);
 
+    // How much of the emulated time of this game is spent in busy wait loops that get skipped.
+    // The counters go back when a state is loaded, so such intervals are left out.
+    u64 cycles = 0;
+    u64 idle_cycles = 0;
+    for (size_t i = 1; i < m_performance_samples.size(); ++i)
+    {
+      const PerformanceSample& previous = m_performance_samples[i - 1];
+      const PerformanceSample& sample = m_performance_samples[i];
+      if (sample.ticks < previous.ticks || sample.idle_ticks < previous.idle_ticks)
+        continue;
+      cycles += sample.ticks - previous.ticks;
+      idle_cycles += sample.idle_ticks - previous.idle_ticks;
+    }
+    builder.AddData("cycles", cycles);
+    builder.AddData("idle-cycles", idle_cycles);
+
     Send(builder);
 
     // Clear up and stop sampling until next time ShouldStartPerformanceSampling() says so.
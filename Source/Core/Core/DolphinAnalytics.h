@@ -144,6 +144,8 @@ public:
     double speed_ratio;  // See SystemTimers::GetEstimatedEmulationPerformance().
     int num_prims;
     int num_draw_calls;
+    u64 ticks;       // See CoreTiming::GetTicks().
+    u64 idle_ticks;  // Emulated cycles skipped by idle loop detection so far.
   };
   // Reports performance information. This method performs its own throttling / aggregation --
   // calling it does not guarantee when a report will actually be sent.
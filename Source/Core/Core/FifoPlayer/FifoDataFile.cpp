@@ -4,23 +4,31 @@
 #include "Core/FifoPlayer/FifoDataFile.h"
 
 #include <algorithm>
+#include <array>
+#include <cstdio>
 #include <cstring>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include <xxhash.h>
+#include <zstd.h>
+
+#include "Common/FileUtil.h"
 #include "Common/IOFile.h"
+#include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Core/Config/MainSettings.h"
 #include "Core/HW/Memmap.h"
 #include "Core/System.h"
 
 constexpr u32 FILE_ID = 0x0d01f1f0;
-constexpr u32 VERSION_NUMBER = 5;
-constexpr u32 MIN_LOADER_VERSION = 1;
-// This value is only used if the DFF file was created with overridden RAM sizes.
-// If the MIN_LOADER_VERSION ever exceeds this, it's alright to remove it.
-constexpr u32 MIN_LOADER_VERSION_FOR_RAM_OVERRIDE = 5;
+constexpr u32 VERSION_NUMBER = 6;
+// Version 6 replaced the uncompressed frame list by per-frame compressed chunks, and stores memory
+// update data with identical contents only once.
+constexpr u32 MIN_LOADER_VERSION = 6;
+constexpr u32 FIRST_CHUNKED_VERSION = 6;
+constexpr int CHUNK_COMPRESSION_LEVEL = 3;
 
 #pragma pack(push, 1)
 
@@ -46,7 +54,10 @@ struct FileHeader
   // will crash and burn with mismatched settings.  See PR #8722.
   u32 mem1_size;
   u32 mem2_size;
-  u8 reserved[32];
+  // Version 6+
+  u64 payloadListOffset;
+  u32 payloadCount;
+  u8 reserved[20];
 };
 static_assert(sizeof(FileHeader) == 128, "FileHeader should be 128 bytes");
 
@@ -62,6 +73,47 @@ struct FileFrameInfo
 };
 static_assert(sizeof(FileFrameInfo) == 64, "FileFrameInfo should be 64 bytes");
 
+// Starting with version 6, the frame list holds one of these per frame and each frame is stored as
+// a single zstd compressed chunk. A decompressed chunk consists of a FileFrameChunkHeader, the
+// FIFO data, the list of FileMemoryUpdates and finally the memory update data. The dataOffset of
+// each update is relative to the start of the decompressed chunk.
+struct FileFrameChunkInfo
+{
+  u64 chunkOffset;
+  u32 compressedSize;
+  u32 uncompressedSize;
+  u32 fifoDataSize;
+  u32 memoryUpdateSize;
+  u32 objectCount;
+  u8 reserved[4];
+};
+static_assert(sizeof(FileFrameChunkInfo) == 32, "FileFrameChunkInfo should be 32 bytes");
+
+struct FileFrameChunkHeader
+{
+  u32 fifoDataSize;
+  u32 fifoStart;
+  u32 fifoEnd;
+  u32 numMemoryUpdates;
+  // The CP registers at the start of the frame
+  std::array<u32, FifoDataFile::CP_MEM_SIZE> cpMem;
+};
+static_assert(sizeof(FileFrameChunkHeader) == 1040, "FileFrameChunkHeader should be 1040 bytes");
+
+// Starting with version 6, memory update data is stored in separately compressed payload chunks
+// which are listed after the frame list. Memory updates with MEMORY_UPDATE_FLAG_PAYLOAD set use
+// their dataOffset as an index into the payload list instead.
+struct FilePayloadInfo
+{
+  u64 chunkOffset;
+  u32 compressedSize;
+  u32 size;
+  u8 reserved[8];
+};
+static_assert(sizeof(FilePayloadInfo) == 24, "FilePayloadInfo should be 24 bytes");
+
+constexpr u8 MEMORY_UPDATE_FLAG_PAYLOAD = 1;
+
 struct FileMemoryUpdate
 {
   u32 fifoPosition;
@@ -69,7 +121,8 @@ struct FileMemoryUpdate
   u64 dataOffset;
   u32 dataSize;
   u8 type;
-  u8 reserved[3];
+  u8 flags;
+  u8 reserved[2];
 };
 static_assert(sizeof(FileMemoryUpdate) == 24, "FileMemoryUpdate should be 24 bytes");
 
@@ -99,24 +152,103 @@ bool FifoDataFile::GetIsWii() const
   return GetFlag(FLAG_IS_WII);
 }
 
+bool FifoDataFile::HasFrameAnalysisInfo() const
+{
+  return m_Version >= FIRST_CHUNKED_VERSION;
+}
+
 void FifoDataFile::AddFrame(const FifoFrameInfo& frameInfo)
 {
-  m_Frames.push_back(frameInfo);
+  StoredFrame stored;
+  stored.fifo_data_size = static_cast<u32>(frameInfo.fifoData.size());
+  stored.object_count = frameInfo.objectCount;
+  for (const MemoryUpdate& update : frameInfo.memoryUpdates)
+    stored.memory_update_size += static_cast<u32>(update.data->size());
+
+  std::lock_guard lk(m_frame_lock);
+
+  if (!m_chunk_file)
+    m_chunk_file = std::make_unique<File::IOFile>(std::tmpfile());
+
+  if (m_chunk_file->IsOpen())
+  {
+    std::vector<u32> payloads;
+    payloads.reserve(frameInfo.memoryUpdates.size());
+    for (const MemoryUpdate& update : frameInfo.memoryUpdates)
+      payloads.push_back(AddPayload(update.data));
+
+    const std::vector<u8> chunk = SerializeFrame(frameInfo, payloads);
+    std::vector<u8> compressed;
+    if (CompressChunk(chunk.data(), chunk.size(), &compressed))
+    {
+      m_chunk_file->Seek(0, File::SeekOrigin::End);
+      stored.chunk_offset = m_chunk_file->Tell();
+      stored.compressed_size = static_cast<u32>(compressed.size());
+      stored.uncompressed_size = static_cast<u32>(chunk.size());
+      if (m_chunk_file->WriteBytes(compressed.data(), compressed.size()))
+      {
+        m_Frames.push_back(std::move(stored));
+        return;
+      }
+      m_chunk_file->ClearError();
+    }
+  }
+
+  // Keep the frame in memory if the scratch file isn't usable
+  WARN_LOG_FMT(VIDEO, "Failed to write FIFO frame {} to the scratch file", m_Frames.size());
+  stored.frame = std::make_shared<FifoFrameInfo>(frameInfo);
+  m_Frames.push_back(std::move(stored));
+}
+
+std::shared_ptr<const FifoFrameInfo> FifoDataFile::GetFrame(u32 frame) const
+{
+  std::lock_guard lk(m_frame_lock);
+
+  const StoredFrame& stored = m_Frames[frame];
+  if (stored.frame)
+    return stored.frame;
+
+  const auto it = std::find_if(m_frame_cache.begin(), m_frame_cache.end(),
+                               [frame](const auto& entry) { return entry.first == frame; });
+  if (it != m_frame_cache.end())
+  {
+    m_frame_cache.splice(m_frame_cache.begin(), m_frame_cache, it);
+    return it->second;
+  }
+
+  std::shared_ptr<const FifoFrameInfo> loaded = LoadFrame(stored);
+  if (!loaded)
+  {
+    PanicAlertFmtT("Failed to read frame {0} of the DFF file.", frame);
+    return std::make_shared<FifoFrameInfo>();
+  }
+
+  m_frame_cache.emplace_front(frame, loaded);
+  if (m_frame_cache.size() > FRAME_CACHE_SIZE)
+    m_frame_cache.pop_back();
+
+  return loaded;
 }
 
 bool FifoDataFile::Save(const std::string& filename)
 {
+  std::lock_guard lk(m_frame_lock);
+
+  // Write to a temporary file first so that a failed save doesn't destroy an existing log
+  const std::string temp_filename = File::GetTempFilenameForAtomicWrite(filename);
   File::IOFile file;
-  if (!file.Open(filename, "wb"))
+  if (!file.Open(temp_filename, "wb"))
     return false;
 
+  const auto fail = [&file, &temp_filename] {
+    file.Close();
+    File::Delete(temp_filename);
+    return false;
+  };
+
   // Add space for header
   PadFile(sizeof(FileHeader), file);
 
-  // Add space for frame list
-  u64 frameListOffset = file.Tell();
-  PadFile(m_Frames.size() * sizeof(FileFrameInfo), file);
-
   u64 bpMemOffset = file.Tell();
   file.WriteArray(m_BPMem);
 
@@ -132,15 +264,66 @@ bool FifoDataFile::Save(const std::string& filename)
   u64 texMemOffset = file.Tell();
   file.WriteArray(m_TexMem);
 
+  // Write frame chunks, one at a time
+  std::vector<FileFrameChunkInfo> frameList(m_Frames.size());
+  std::vector<u8> compressed;
+  for (size_t i = 0; i < m_Frames.size(); ++i)
+  {
+    const StoredFrame& srcFrame = m_Frames[i];
+    FileFrameChunkInfo& dstFrame = frameList[i];
+    dstFrame = {};
+
+    if (srcFrame.frame)
+    {
+      const std::vector<u32> payloads(srcFrame.frame->memoryUpdates.size(), INLINE_PAYLOAD);
+      const std::vector<u8> chunk = SerializeFrame(*srcFrame.frame, payloads);
+      if (!CompressChunk(chunk.data(), chunk.size(), &compressed))
+        return fail();
+      dstFrame.uncompressedSize = static_cast<u32>(chunk.size());
+    }
+    else
+    {
+      if (!ReadChunk(srcFrame.chunk_offset, srcFrame.compressed_size, &compressed))
+        return fail();
+      dstFrame.uncompressedSize = srcFrame.uncompressed_size;
+    }
+
+    dstFrame.chunkOffset = file.Tell();
+    dstFrame.compressedSize = static_cast<u32>(compressed.size());
+    dstFrame.fifoDataSize = srcFrame.fifo_data_size;
+    dstFrame.memoryUpdateSize = srcFrame.memory_update_size;
+    dstFrame.objectCount = srcFrame.object_count;
+    file.WriteBytes(compressed.data(), compressed.size());
+  }
+
+  // Payload indices are kept as they are, so the frame chunks can be copied verbatim
+  std::vector<FilePayloadInfo> payloadList(m_payloads.size());
+  for (size_t i = 0; i < m_payloads.size(); ++i)
+  {
+    const StoredPayload& srcPayload = m_payloads[i];
+    if (!ReadChunk(srcPayload.chunk_offset, srcPayload.compressed_size, &compressed))
+      return fail();
+
+    FilePayloadInfo& dstPayload = payloadList[i];
+    dstPayload = {};
+    dstPayload.chunkOffset = file.Tell();
+    dstPayload.compressedSize = srcPayload.compressed_size;
+    dstPayload.size = srcPayload.size;
+    file.WriteBytes(compressed.data(), compressed.size());
+  }
+
+  // The lists go last so that the chunks can be written without knowing the frame count
+  u64 frameListOffset = file.Tell();
+  file.WriteArray(frameList.data(), frameList.size());
+
+  u64 payloadListOffset = file.Tell();
+  file.WriteArray(payloadList.data(), payloadList.size());
+
   // Write header
-  FileHeader header;
+  FileHeader header{};
   header.fileId = FILE_ID;
   header.file_version = VERSION_NUMBER;
-  // Maintain backwards compatability so long as the RAM sizes aren't overridden.
-  if (Config::Get(Config::MAIN_RAM_OVERRIDE_ENABLE))
-    header.min_loader_version = MIN_LOADER_VERSION_FOR_RAM_OVERRIDE;
-  else
-    header.min_loader_version = MIN_LOADER_VERSION;
+  header.min_loader_version = MIN_LOADER_VERSION;
 
   header.bpMemOffset = bpMemOffset;
   header.bpMemSize = BP_MEM_SIZE;
@@ -160,6 +343,9 @@ bool FifoDataFile::Save(const std::string& filename)
   header.frameListOffset = frameListOffset;
   header.frameCount = (u32)m_Frames.size();
 
+  header.payloadListOffset = payloadListOffset;
+  header.payloadCount = static_cast<u32>(m_payloads.size());
+
   header.flags = m_Flags;
 
   auto& system = Core::System::GetInstance();
@@ -170,36 +356,16 @@ bool FifoDataFile::Save(const std::string& filename)
   file.Seek(0, File::SeekOrigin::Begin);
   file.WriteBytes(&header, sizeof(FileHeader));
 
-  // Write frames list
-  for (unsigned int i = 0; i < m_Frames.size(); ++i)
-  {
-    const FifoFrameInfo& srcFrame = m_Frames[i];
-
-    // Write FIFO data
-    file.Seek(0, File::SeekOrigin::End);
-    u64 dataOffset = file.Tell();
-    file.WriteBytes(srcFrame.fifoData.data(), srcFrame.fifoData.size());
-
-    u64 memoryUpdatesOffset = WriteMemoryUpdates(srcFrame.memoryUpdates, file);
-
-    FileFrameInfo dstFrame;
-    dstFrame.fifoDataSize = static_cast<u32>(srcFrame.fifoData.size());
-    dstFrame.fifoDataOffset = dataOffset;
-    dstFrame.fifoStart = srcFrame.fifoStart;
-    dstFrame.fifoEnd = srcFrame.fifoEnd;
-    dstFrame.memoryUpdatesOffset = memoryUpdatesOffset;
-    dstFrame.numMemoryUpdates = static_cast<u32>(srcFrame.memoryUpdates.size());
-
-    // Write frame info
-    u64 frameOffset = frameListOffset + (i * sizeof(FileFrameInfo));
-    file.Seek(frameOffset, File::SeekOrigin::Begin);
-    file.WriteBytes(&dstFrame, sizeof(FileFrameInfo));
-  }
+  if (!file.IsGood())
+    return fail();
 
   if (!file.Close())
+  {
+    File::Delete(temp_filename);
     return false;
+  }
 
-  return true;
+  return File::Rename(temp_filename, filename);
 }
 
 std::unique_ptr<FifoDataFile> FifoDataFile::Load(const std::string& filename, bool flagsOnly)
@@ -316,6 +482,60 @@ std::unique_ptr<FifoDataFile> FifoDataFile::Load(const std::string& filename, bo
   dataFile->m_ram_size_real = header.mem1_size;
   dataFile->m_exram_size_real = header.mem2_size;
 
+  if (dataFile->m_Version >= FIRST_CHUNKED_VERSION)
+  {
+    // Only read the frame list here, the chunks are read on demand by GetFrame
+    std::vector<FileFrameChunkInfo> frameList(header.frameCount);
+    file.Seek(header.frameListOffset, File::SeekOrigin::Begin);
+    if (!file.ReadArray(frameList.data(), frameList.size()))
+      return panic_failed_to_read();
+
+    const u64 fileSize = file.GetSize();
+    dataFile->m_Frames.resize(header.frameCount);
+    for (u32 i = 0; i < header.frameCount; ++i)
+    {
+      const FileFrameChunkInfo& srcFrame = frameList[i];
+      if (srcFrame.chunkOffset > fileSize ||
+          srcFrame.compressedSize > fileSize - srcFrame.chunkOffset)
+      {
+        return panic_failed_to_read();
+      }
+
+      StoredFrame& dstFrame = dataFile->m_Frames[i];
+      dstFrame.chunk_offset = srcFrame.chunkOffset;
+      dstFrame.compressed_size = srcFrame.compressedSize;
+      dstFrame.uncompressed_size = srcFrame.uncompressedSize;
+      dstFrame.fifo_data_size = srcFrame.fifoDataSize;
+      dstFrame.memory_update_size = srcFrame.memoryUpdateSize;
+      dstFrame.object_count = srcFrame.objectCount;
+    }
+
+    std::vector<FilePayloadInfo> payloadList(header.payloadCount);
+    file.Seek(header.payloadListOffset, File::SeekOrigin::Begin);
+    if (!file.ReadArray(payloadList.data(), payloadList.size()))
+      return panic_failed_to_read();
+
+    dataFile->m_payloads.resize(header.payloadCount);
+    dataFile->m_payload_cache.resize(header.payloadCount);
+    for (u32 i = 0; i < header.payloadCount; ++i)
+    {
+      const FilePayloadInfo& srcPayload = payloadList[i];
+      if (srcPayload.chunkOffset > fileSize ||
+          srcPayload.compressedSize > fileSize - srcPayload.chunkOffset)
+      {
+        return panic_failed_to_read();
+      }
+
+      StoredPayload& dstPayload = dataFile->m_payloads[i];
+      dstPayload.chunk_offset = srcPayload.chunkOffset;
+      dstPayload.compressed_size = srcPayload.compressedSize;
+      dstPayload.size = srcPayload.size;
+    }
+
+    dataFile->m_chunk_file = std::make_unique<File::IOFile>(std::move(file));
+    return dataFile;
+  }
+
   // Read frames
   for (u32 i = 0; i < header.frameCount; ++i)
   {
@@ -339,7 +559,12 @@ std::unique_ptr<FifoDataFile> FifoDataFile::Load(const std::string& filename, bo
     if (!file.IsGood())
       return panic_failed_to_read();
 
-    dataFile->AddFrame(dstFrame);
+    StoredFrame stored;
+    stored.fifo_data_size = srcFrame.fifoDataSize;
+    for (const MemoryUpdate& update : dstFrame.memoryUpdates)
+      stored.memory_update_size += static_cast<u32>(update.data->size());
+    stored.frame = std::make_shared<FifoFrameInfo>(std::move(dstFrame));
+    dataFile->m_Frames.push_back(std::move(stored));
   }
 
   return dataFile;
@@ -364,35 +589,208 @@ bool FifoDataFile::GetFlag(u32 flag) const
   return !!(m_Flags & flag);
 }
 
-u64 FifoDataFile::WriteMemoryUpdates(const std::vector<MemoryUpdate>& memUpdates,
-                                     File::IOFile& file)
+std::vector<u8> FifoDataFile::SerializeFrame(const FifoFrameInfo& frame,
+                                             const std::vector<u32>& payloads)
 {
-  // Add space for memory update list
-  u64 updateListOffset = file.Tell();
-  PadFile(memUpdates.size() * sizeof(FileMemoryUpdate), file);
-
-  for (unsigned int i = 0; i < memUpdates.size(); ++i)
+  const size_t updateListOffset = sizeof(FileFrameChunkHeader) + frame.fifoData.size();
+  size_t size = updateListOffset + frame.memoryUpdates.size() * sizeof(FileMemoryUpdate);
+  for (size_t i = 0; i < frame.memoryUpdates.size(); ++i)
   {
-    const MemoryUpdate& srcUpdate = memUpdates[i];
+    if (payloads[i] == INLINE_PAYLOAD)
+      size += frame.memoryUpdates[i].data->size();
+  }
 
-    // Write memory
-    file.Seek(0, File::SeekOrigin::End);
-    u64 dataOffset = file.Tell();
-    file.WriteBytes(srcUpdate.data.data(), srcUpdate.data.size());
+  std::vector<u8> chunk(size);
+
+  FileFrameChunkHeader header{};
+  header.fifoDataSize = static_cast<u32>(frame.fifoData.size());
+  header.fifoStart = frame.fifoStart;
+  header.fifoEnd = frame.fifoEnd;
+  header.numMemoryUpdates = static_cast<u32>(frame.memoryUpdates.size());
+  std::copy_n(frame.cpMem.begin(), std::min(frame.cpMem.size(), header.cpMem.size()),
+              header.cpMem.begin());
+  std::memcpy(chunk.data(), &header, sizeof(header));
+  std::copy(frame.fifoData.begin(), frame.fifoData.end(),
+            chunk.begin() + sizeof(FileFrameChunkHeader));
+
+  size_t dataOffset = updateListOffset + frame.memoryUpdates.size() * sizeof(FileMemoryUpdate);
+  for (size_t i = 0; i < frame.memoryUpdates.size(); ++i)
+  {
+    const MemoryUpdate& srcUpdate = frame.memoryUpdates[i];
+    const std::vector<u8>& data = *srcUpdate.data;
 
-    FileMemoryUpdate dstUpdate;
+    FileMemoryUpdate dstUpdate{};
     dstUpdate.address = srcUpdate.address;
-    dstUpdate.dataOffset = dataOffset;
-    dstUpdate.dataSize = static_cast<u32>(srcUpdate.data.size());
+    dstUpdate.dataSize = static_cast<u32>(data.size());
     dstUpdate.fifoPosition = srcUpdate.fifoPosition;
     dstUpdate.type = static_cast<u8>(srcUpdate.type);
 
-    u64 updateOffset = updateListOffset + (i * sizeof(FileMemoryUpdate));
-    file.Seek(updateOffset, File::SeekOrigin::Begin);
-    file.WriteBytes(&dstUpdate, sizeof(FileMemoryUpdate));
+    if (payloads[i] != INLINE_PAYLOAD)
+    {
+      dstUpdate.flags = MEMORY_UPDATE_FLAG_PAYLOAD;
+      dstUpdate.dataOffset = payloads[i];
+    }
+    else
+    {
+      dstUpdate.dataOffset = dataOffset;
+      std::copy(data.begin(), data.end(), chunk.begin() + dataOffset);
+      dataOffset += data.size();
+    }
+
+    std::memcpy(&chunk[updateListOffset + i * sizeof(FileMemoryUpdate)], &dstUpdate,
+                sizeof(dstUpdate));
+  }
+
+  return chunk;
+}
+
+std::shared_ptr<FifoFrameInfo> FifoDataFile::DeserializeFrame(const std::vector<u8>& chunk) const
+{
+  if (chunk.size() < sizeof(FileFrameChunkHeader))
+    return nullptr;
+
+  FileFrameChunkHeader header;
+  std::memcpy(&header, chunk.data(), sizeof(header));
+
+  const u64 updateListOffset = sizeof(FileFrameChunkHeader) + u64{header.fifoDataSize};
+  if (updateListOffset + u64{header.numMemoryUpdates} * sizeof(FileMemoryUpdate) > chunk.size())
+    return nullptr;
+
+  auto frame = std::make_shared<FifoFrameInfo>();
+  frame->fifoStart = header.fifoStart;
+  frame->fifoEnd = header.fifoEnd;
+  frame->fifoData.assign(chunk.begin() + sizeof(FileFrameChunkHeader),
+                         chunk.begin() + updateListOffset);
+  frame->cpMem.assign(header.cpMem.begin(), header.cpMem.end());
+
+  frame->memoryUpdates.resize(header.numMemoryUpdates);
+  for (u32 i = 0; i < header.numMemoryUpdates; ++i)
+  {
+    FileMemoryUpdate srcUpdate;
+    std::memcpy(&srcUpdate, &chunk[updateListOffset + i * sizeof(FileMemoryUpdate)],
+                sizeof(srcUpdate));
+
+    MemoryUpdate& dstUpdate = frame->memoryUpdates[i];
+    dstUpdate.address = srcUpdate.address;
+    dstUpdate.fifoPosition = srcUpdate.fifoPosition;
+    dstUpdate.type = static_cast<MemoryUpdate::Type>(srcUpdate.type);
+
+    if (srcUpdate.flags & MEMORY_UPDATE_FLAG_PAYLOAD)
+    {
+      if (srcUpdate.dataOffset >= m_payloads.size())
+        return nullptr;
+
+      dstUpdate.data = LoadPayload(static_cast<u32>(srcUpdate.dataOffset));
+      if (!dstUpdate.data)
+        return nullptr;
+      continue;
+    }
+
+    if (srcUpdate.dataOffset > chunk.size() ||
+        srcUpdate.dataSize > chunk.size() - srcUpdate.dataOffset)
+    {
+      return nullptr;
+    }
+
+    dstUpdate.data = std::make_shared<std::vector<u8>>(
+        chunk.begin() + srcUpdate.dataOffset,
+        chunk.begin() + srcUpdate.dataOffset + srcUpdate.dataSize);
   }
 
-  return updateListOffset;
+  return frame;
+}
+
+bool FifoDataFile::CompressChunk(const u8* data, size_t size, std::vector<u8>* compressed)
+{
+  compressed->resize(ZSTD_compressBound(size));
+  const size_t result = ZSTD_compress(compressed->data(), compressed->size(), data, size,
+                                      CHUNK_COMPRESSION_LEVEL);
+  if (ZSTD_isError(result))
+    return false;
+
+  compressed->resize(result);
+  return true;
+}
+
+bool FifoDataFile::ReadChunk(u64 offset, u32 size, std::vector<u8>* compressed) const
+{
+  compressed->resize(size);
+  if (!m_chunk_file || !m_chunk_file->Seek(offset, File::SeekOrigin::Begin) ||
+      !m_chunk_file->ReadBytes(compressed->data(), compressed->size()))
+  {
+    if (m_chunk_file)
+      m_chunk_file->ClearError();
+    return false;
+  }
+  return true;
+}
+
+bool FifoDataFile::DecompressChunk(u64 offset, u32 compressed_size, std::vector<u8>* chunk) const
+{
+  std::vector<u8> compressed;
+  if (!ReadChunk(offset, compressed_size, &compressed))
+    return false;
+
+  const size_t result =
+      ZSTD_decompress(chunk->data(), chunk->size(), compressed.data(), compressed.size());
+  return !ZSTD_isError(result) && result == chunk->size();
+}
+
+std::shared_ptr<const FifoFrameInfo> FifoDataFile::LoadFrame(const StoredFrame& stored) const
+{
+  std::vector<u8> chunk(stored.uncompressed_size);
+  if (!DecompressChunk(stored.chunk_offset, stored.compressed_size, &chunk))
+    return nullptr;
+
+  std::shared_ptr<FifoFrameInfo> frame = DeserializeFrame(chunk);
+  if (frame)
+    frame->objectCount = stored.object_count;
+  return frame;
+}
+
+u32 FifoDataFile::AddPayload(const std::shared_ptr<const std::vector<u8>>& data)
+{
+  // Collisions of a 128-bit hash are unlikely enough that a match isn't read back from the scratch
+  // file to compare the contents.
+  const XXH128_hash_t hash = XXH3_128bits(data->data(), data->size());
+  const PayloadKey key{hash.low64, hash.high64, static_cast<u32>(data->size())};
+  if (const auto it = m_payload_lookup.find(key); it != m_payload_lookup.end())
+    return it->second;
+
+  std::vector<u8> compressed;
+  if (!CompressChunk(data->data(), data->size(), &compressed))
+    return INLINE_PAYLOAD;
+
+  StoredPayload payload;
+  m_chunk_file->Seek(0, File::SeekOrigin::End);
+  payload.chunk_offset = m_chunk_file->Tell();
+  payload.compressed_size = static_cast<u32>(compressed.size());
+  payload.size = static_cast<u32>(data->size());
+  if (!m_chunk_file->WriteBytes(compressed.data(), compressed.size()))
+  {
+    m_chunk_file->ClearError();
+    return INLINE_PAYLOAD;
+  }
+
+  const u32 index = static_cast<u32>(m_payloads.size());
+  m_payloads.push_back(payload);
+  m_payload_cache.push_back(data);
+  m_payload_lookup.emplace(key, index);
+  return index;
+}
+
+std::shared_ptr<const std::vector<u8>> FifoDataFile::LoadPayload(u32 index) const
+{
+  if (std::shared_ptr<const std::vector<u8>> cached = m_payload_cache[index].lock())
+    return cached;
+
+  const StoredPayload& payload = m_payloads[index];
+  auto data = std::make_shared<std::vector<u8>>(payload.size);
+  if (!DecompressChunk(payload.chunk_offset, payload.compressed_size, data.get()))
+    return nullptr;
+
+  m_payload_cache[index] = data;
+  return data;
 }
 
 void FifoDataFile::ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
@@ -410,10 +808,11 @@ void FifoDataFile::ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
     MemoryUpdate& dstUpdate = memUpdates[i];
     dstUpdate.address = srcUpdate.address;
     dstUpdate.fifoPosition = srcUpdate.fifoPosition;
-    dstUpdate.data.resize(srcUpdate.dataSize);
     dstUpdate.type = static_cast<MemoryUpdate::Type>(srcUpdate.type);
 
+    auto data = std::make_shared<std::vector<u8>>(srcUpdate.dataSize);
     file.Seek(srcUpdate.dataOffset, File::SeekOrigin::Begin);
-    file.ReadBytes(dstUpdate.data.data(), srcUpdate.dataSize);
+    file.ReadBytes(data->data(), srcUpdate.dataSize);
+    dstUpdate.data = std::move(data);
   }
 }
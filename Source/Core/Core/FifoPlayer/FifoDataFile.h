@@ -4,8 +4,12 @@
 #pragma once
 
 #include <array>
+#include <list>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -28,7 +32,8 @@ struct MemoryUpdate
 
   u32 fifoPosition = 0;
   u32 address = 0;
-  std::vector<u8> data;
+  // Updates with identical contents share their data, see FifoDataFile::AddPayload
+  std::shared_ptr<const std::vector<u8>> data;
   Type type{};
 };
 
@@ -41,6 +46,12 @@ struct FifoFrameInfo
 
   // Must be sorted by fifoPosition
   std::vector<MemoryUpdate> memoryUpdates;
+
+  // The CP registers at the start of the frame, and the number of objects the FIFO player finds in
+  // it, so that frames can be analyzed on demand rather than all in order. FifoRecorder fills these
+  // in. cpMem is empty for frames from files older than version 6.
+  std::vector<u32> cpMem;
+  u32 objectCount = 0;
 };
 
 class FifoDataFile
@@ -72,9 +83,19 @@ public:
   u32 GetRamSizeReal() { return m_ram_size_real; }
   u32 GetExRamSizeReal() { return m_exram_size_real; }
 
+  // Compresses the frame and appends it to a scratch file, so that long recordings don't have to
+  // be kept in memory. Memory update data which was already stored by an earlier frame is only
+  // referenced.
   void AddFrame(const FifoFrameInfo& frameInfo);
-  const FifoFrameInfo& GetFrame(u32 frame) const { return m_Frames[frame]; }
+  // Frames are decompressed on demand and only the most recently used ones are kept in memory.
+  // The returned frame stays valid for as long as the caller holds on to it.
+  std::shared_ptr<const FifoFrameInfo> GetFrame(u32 frame) const;
   u32 GetFrameCount() const { return static_cast<u32>(m_Frames.size()); }
+  u32 GetFrameFifoDataSize(u32 frame) const { return m_Frames[frame].fifo_data_size; }
+  u32 GetFrameMemoryUpdateSize(u32 frame) const { return m_Frames[frame].memory_update_size; }
+  u32 GetFrameObjectCount(u32 frame) const { return m_Frames[frame].object_count; }
+  // Whether frames know their CP registers and object count without being analyzed in order.
+  bool HasFrameAnalysisInfo() const;
   bool Save(const std::string& filename);
 
   static std::unique_ptr<FifoDataFile> Load(const std::string& filename, bool flagsOnly);
@@ -85,12 +106,59 @@ private:
     FLAG_IS_WII = 1
   };
 
+  // Number of decompressed frames which are kept around by GetFrame
+  static constexpr size_t FRAME_CACHE_SIZE = 16;
+  // Payload index of memory update data which is stored inside of the frame chunk
+  static constexpr u32 INLINE_PAYLOAD = 0xFFFFFFFF;
+
+  struct StoredFrame
+  {
+    // Frames from files older than version 6 are kept in memory in their entirety
+    std::shared_ptr<const FifoFrameInfo> frame;
+    // Otherwise, this is the location of the frame's compressed chunk in m_chunk_file
+    u64 chunk_offset = 0;
+    u32 compressed_size = 0;
+    u32 uncompressed_size = 0;
+
+    u32 fifo_data_size = 0;
+    u32 memory_update_size = 0;
+    u32 object_count = 0;
+  };
+
+  // Memory update data, stored once per unique content and referenced by index from the frames
+  struct StoredPayload
+  {
+    u64 chunk_offset = 0;
+    u32 compressed_size = 0;
+    u32 size = 0;
+  };
+
+  // Identifies the contents of a payload by their 128-bit hash and size
+  struct PayloadKey
+  {
+    u64 hash_low = 0;
+    u64 hash_high = 0;
+    u32 size = 0;
+
+    auto operator<=>(const PayloadKey&) const = default;
+  };
+
   void PadFile(size_t numBytes, File::IOFile& file);
 
   void SetFlag(u32 flag, bool set);
   bool GetFlag(u32 flag) const;
 
-  u64 WriteMemoryUpdates(const std::vector<MemoryUpdate>& memUpdates, File::IOFile& file);
+  static std::vector<u8> SerializeFrame(const FifoFrameInfo& frame,
+                                        const std::vector<u32>& payloads);
+  std::shared_ptr<FifoFrameInfo> DeserializeFrame(const std::vector<u8>& chunk) const;
+  static bool CompressChunk(const u8* data, size_t size, std::vector<u8>* compressed);
+  bool ReadChunk(u64 offset, u32 size, std::vector<u8>* compressed) const;
+  bool DecompressChunk(u64 offset, u32 compressed_size, std::vector<u8>* chunk) const;
+  std::shared_ptr<const FifoFrameInfo> LoadFrame(const StoredFrame& stored) const;
+
+  u32 AddPayload(const std::shared_ptr<const std::vector<u8>>& data);
+  std::shared_ptr<const std::vector<u8>> LoadPayload(u32 index) const;
+
   static void ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
                                 std::vector<MemoryUpdate>& memUpdates, File::IOFile& file);
 
@@ -105,5 +173,17 @@ private:
   u32 m_Flags = 0;
   u32 m_Version = 0;
 
-  std::vector<FifoFrameInfo> m_Frames;
+  std::vector<StoredFrame> m_Frames;
+  // The .dff file being played back, or a scratch file holding the frames of a recording
+  std::unique_ptr<File::IOFile> m_chunk_file;
+
+  std::vector<StoredPayload> m_payloads;
+  // Only used while recording
+  std::map<PayloadKey, u32> m_payload_lookup;
+
+  mutable std::mutex m_frame_lock;
+  // Most recently used frames first
+  mutable std::list<std::pair<u32, std::shared_ptr<const FifoFrameInfo>>> m_frame_cache;
+  // Lets frames share the payloads which are still in use by other frames
+  mutable std::vector<std::weak_ptr<const std::vector<u8>>> m_payload_cache;
 };
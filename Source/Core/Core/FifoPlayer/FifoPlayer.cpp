@@ -38,9 +38,7 @@ namespace
 class FifoPlaybackAnalyzer : public OpcodeDecoder::Callback
 {
 public:
-  static void AnalyzeFrames(FifoDataFile* file, std::vector<AnalyzedFrameInfo>& frame_info);
-
-  explicit FifoPlaybackAnalyzer(const u32* cpmem) : m_cpmem(cpmem) {}
+  explicit FifoPlaybackAnalyzer(const CPState& cpmem) : m_cpmem(cpmem) {}
 
   OPCODE_CALLBACK(void OnXF(u16 address, u8 count, const u8* data)) {}
   OPCODE_CALLBACK(void OnCP(u8 command, u32 value)) { GetCPState().LoadCPReg(command, value); }
@@ -73,62 +71,6 @@ public:
   CPState m_cpmem;
 };
 
-void FifoPlaybackAnalyzer::AnalyzeFrames(FifoDataFile* file,
-                                         std::vector<AnalyzedFrameInfo>& frame_info)
-{
-  FifoPlaybackAnalyzer analyzer(file->GetCPMem());
-  frame_info.clear();
-  frame_info.resize(file->GetFrameCount());
-
-  for (u32 frame_no = 0; frame_no < file->GetFrameCount(); frame_no++)
-  {
-    const FifoFrameInfo& frame = file->GetFrame(frame_no);
-    AnalyzedFrameInfo& analyzed = frame_info[frame_no];
-
-    u32 offset = 0;
-
-    u32 part_start = 0;
-    CPState cpmem;
-
-    while (offset < frame.fifoData.size())
-    {
-      const u32 cmd_size = OpcodeDecoder::RunCommand(&frame.fifoData[offset],
-                                                     u32(frame.fifoData.size()) - offset, analyzer);
-
-      if (analyzer.m_start_of_primitives)
-      {
-        // Start of primitive data for an object
-        analyzed.AddPart(FramePartType::Commands, part_start, offset, analyzer.m_cpmem);
-        part_start = offset;
-        // Copy cpmem now, because end_of_primitives isn't triggered until the first opcode after
-        // primitive data, and the first opcode might update cpmem
-        static_assert(std::is_trivially_copyable_v<CPState>);
-        std::memcpy(static_cast<void*>(&cpmem), static_cast<const void*>(&analyzer.m_cpmem),
-                    sizeof(CPState));
-      }
-      if (analyzer.m_end_of_primitives)
-      {
-        // End of primitive data for an object, and thus end of the object
-        analyzed.AddPart(FramePartType::PrimitiveData, part_start, offset, cpmem);
-        part_start = offset;
-      }
-
-      offset += cmd_size;
-
-      if (analyzer.m_efb_copy)
-      {
-        // We increase the offset beforehand, so that the trigger EFB copy command is included.
-        analyzed.AddPart(FramePartType::EFBCopy, part_start, offset, analyzer.m_cpmem);
-        part_start = offset;
-      }
-    }
-
-    // The frame should end with an EFB copy, so part_start should have been updated to the end.
-    ASSERT(part_start == frame.fifoData.size());
-    ASSERT(offset == frame.fifoData.size());
-  }
-}
-
 void FifoPlaybackAnalyzer::OnBP(u8 command, u32 value)
 {
   if (command == BPMEM_TRIGGER_EFB_COPY)
@@ -172,6 +114,58 @@ void FifoPlaybackAnalyzer::OnCommand(const u8* data, u32 size)
 
 bool IsPlayingBackFifologWithBrokenEFBCopies = false;
 
+AnalyzedFrameInfo FifoPlayer::AnalyzeFrame(const FifoFrameInfo& frame, CPState* cpmem)
+{
+  FifoPlaybackAnalyzer analyzer(*cpmem);
+  AnalyzedFrameInfo analyzed;
+
+  u32 offset = 0;
+
+  u32 part_start = 0;
+  CPState part_cpmem;
+
+  while (offset < frame.fifoData.size())
+  {
+    const u32 cmd_size = OpcodeDecoder::RunCommand(&frame.fifoData[offset],
+                                                   u32(frame.fifoData.size()) - offset, analyzer);
+
+    if (analyzer.m_start_of_primitives)
+    {
+      // Start of primitive data for an object
+      analyzed.AddPart(FramePartType::Commands, part_start, offset, analyzer.m_cpmem);
+      part_start = offset;
+      // Copy cpmem now, because end_of_primitives isn't triggered until the first opcode after
+      // primitive data, and the first opcode might update cpmem
+      static_assert(std::is_trivially_copyable_v<CPState>);
+      std::memcpy(static_cast<void*>(&part_cpmem), static_cast<const void*>(&analyzer.m_cpmem),
+                  sizeof(CPState));
+    }
+    if (analyzer.m_end_of_primitives)
+    {
+      // End of primitive data for an object, and thus end of the object
+      analyzed.AddPart(FramePartType::PrimitiveData, part_start, offset, part_cpmem);
+      part_start = offset;
+    }
+
+    offset += cmd_size;
+
+    if (analyzer.m_efb_copy)
+    {
+      // We increase the offset beforehand, so that the trigger EFB copy command is included.
+      analyzed.AddPart(FramePartType::EFBCopy, part_start, offset, analyzer.m_cpmem);
+      part_start = offset;
+    }
+  }
+
+  // The frame should end with an EFB copy, so part_start should have been updated to the end.
+  ASSERT(part_start == frame.fifoData.size());
+  ASSERT(offset == frame.fifoData.size());
+
+  std::memcpy(static_cast<void*>(cpmem), static_cast<const void*>(&analyzer.m_cpmem),
+              sizeof(CPState));
+  return analyzed;
+}
+
 FifoPlayer::FifoPlayer(Core::System& system) : m_system(system)
 {
   m_config_changed_callback_id = Config::AddConfigChangedCallback([this] { RefreshConfig(); });
@@ -191,7 +185,20 @@ bool FifoPlayer::Open(const std::string& filename)
 
   if (m_File)
   {
-    FifoPlaybackAnalyzer::AnalyzeFrames(m_File.get(), m_FrameInfo);
+    std::lock_guard lk(m_frame_info_lock);
+    m_FrameInfo.resize(m_File->GetFrameCount());
+
+    // Older files don't store the CP registers at the start of each frame, so their frames can only
+    // be analyzed in order. They are kept in memory, so this doesn't have to read the file.
+    if (!m_File->HasFrameAnalysisInfo())
+    {
+      CPState cpmem(m_File->GetCPMem());
+      for (u32 frame = 0; frame < m_File->GetFrameCount(); ++frame)
+      {
+        m_FrameInfo[frame] =
+            std::make_unique<AnalyzedFrameInfo>(AnalyzeFrame(*m_File->GetFrame(frame), &cpmem));
+      }
+    }
 
     m_FrameRangeEnd = m_File->GetFrameCount() - 1;
   }
@@ -204,6 +211,10 @@ bool FifoPlayer::Open(const std::string& filename)
 
 void FifoPlayer::Close()
 {
+  {
+    std::lock_guard lk(m_frame_info_lock);
+    m_FrameInfo.clear();
+  }
   m_File.reset();
 
   m_FrameRangeStart = 0;
@@ -231,6 +242,7 @@ public:
     m_parent->m_system.GetCPU().SetStepping(false);
 
     m_parent->m_CurrentFrame = m_parent->m_FrameRangeStart;
+    m_parent->m_LoopsPlayed = 0;
     m_parent->LoadMemory();
   }
 
@@ -279,7 +291,8 @@ CPU::State FifoPlayer::AdvanceFrame()
 {
   if (m_CurrentFrame > m_FrameRangeEnd)
   {
-    if (!m_Loop)
+    ++m_LoopsPlayed;
+    if (!m_Loop || (m_LoopCount != 0 && m_LoopsPlayed >= m_LoopCount))
       return CPU::State::PowerDown;
 
     // When looping, reload the contents of all the BP/CP/CF registers.
@@ -297,7 +310,7 @@ CPU::State FifoPlayer::AdvanceFrame()
   if (m_EarlyMemoryUpdates && m_CurrentFrame == m_FrameRangeStart)
     WriteAllMemoryUpdates();
 
-  WriteFrame(m_File->GetFrame(m_CurrentFrame), m_FrameInfo[m_CurrentFrame]);
+  WriteFrame(*m_File->GetFrame(m_CurrentFrame), GetAnalyzedFrameInfo(m_CurrentFrame));
 
   ++m_CurrentFrame;
   return CPU::State::Running;
@@ -338,26 +351,43 @@ bool FifoPlayer::IsRunningWithFakeVideoInterfaceUpdates() const
   return m_File->ShouldGenerateFakeVIUpdates();
 }
 
+const AnalyzedFrameInfo& FifoPlayer::GetAnalyzedFrameInfo(u32 frame) const
+{
+  std::lock_guard lk(m_frame_info_lock);
+
+  std::unique_ptr<const AnalyzedFrameInfo>& info = m_FrameInfo[frame];
+  if (!info)
+  {
+    const auto fifo_frame = m_File->GetFrame(frame);
+    // The frame is empty if it couldn't be read
+    CPState cpmem(fifo_frame->cpMem.size() == FifoDataFile::CP_MEM_SIZE ? fifo_frame->cpMem.data() :
+                                                                          m_File->GetCPMem());
+    info = std::make_unique<AnalyzedFrameInfo>(AnalyzeFrame(*fifo_frame, &cpmem));
+  }
+  return *info;
+}
+
 u32 FifoPlayer::GetMaxObjectCount() const
 {
   u32 result = 0;
-  for (auto& frame : m_FrameInfo)
+  if (m_File)
   {
-    const u32 count = frame.part_type_counts[FramePartType::PrimitiveData];
-    if (count > result)
-      result = count;
+    for (u32 frame = 0; frame < m_File->GetFrameCount(); ++frame)
+      result = std::max(result, GetFrameObjectCount(frame));
   }
   return result;
 }
 
 u32 FifoPlayer::GetFrameObjectCount(u32 frame) const
 {
-  if (frame < m_FrameInfo.size())
-  {
-    return m_FrameInfo[frame].part_type_counts[FramePartType::PrimitiveData];
-  }
+  if (!m_File || frame >= m_File->GetFrameCount())
+    return 0;
+
+  // The count is stored in the file, so that the frame doesn't have to be read and analyzed
+  if (m_File->HasFrameAnalysisInfo())
+    return m_File->GetFrameObjectCount(frame);
 
-  return 0;
+  return GetAnalyzedFrameInfo(frame).part_type_counts[FramePartType::PrimitiveData];
 }
 
 u32 FifoPlayer::GetCurrentFrameObjectCount() const
@@ -482,8 +512,8 @@ void FifoPlayer::WriteAllMemoryUpdates()
 
   for (u32 frameNum = 0; frameNum < m_File->GetFrameCount(); ++frameNum)
   {
-    const FifoFrameInfo& frame = m_File->GetFrame(frameNum);
-    for (auto& update : frame.memoryUpdates)
+    const auto frame = m_File->GetFrame(frameNum);
+    for (auto& update : frame->memoryUpdates)
     {
       WriteMemory(update);
     }
@@ -500,7 +530,7 @@ void FifoPlayer::WriteMemory(const MemoryUpdate& memUpdate)
   else
     mem = &memory.GetRAM()[memUpdate.address & memory.GetRamMask()];
 
-  std::copy(memUpdate.data.begin(), memUpdate.data.end(), mem);
+  std::copy(memUpdate.data->begin(), memUpdate.data->end(), mem);
 }
 
 void FifoPlayer::WriteFifo(const u8* data, u32 start, u32 end)
@@ -547,7 +577,8 @@ void FifoPlayer::SetupFifo()
   WriteCP(CommandProcessor::CTRL_REGISTER, 0);   // disable read, BP, interrupts
   WriteCP(CommandProcessor::CLEAR_REGISTER, 7);  // clear overflow, underflow, metrics
 
-  const FifoFrameInfo& frame = m_File->GetFrame(m_CurrentFrame);
+  const auto frame_ptr = m_File->GetFrame(m_CurrentFrame);
+  const FifoFrameInfo& frame = *frame_ptr;
 
   // Set fifo bounds
   WriteCP(CommandProcessor::FIFO_BASE_LO, frame.fifoStart);
@@ -5,6 +5,7 @@
 
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <vector>
@@ -119,7 +120,11 @@ public:
   u32 GetFrameObjectCount(u32 frame) const;
   u32 GetCurrentFrameObjectCount() const;
   u32 GetCurrentFrameNum() const { return m_CurrentFrame; }
-  const AnalyzedFrameInfo& GetAnalyzedFrameInfo(u32 frame) const { return m_FrameInfo[frame]; }
+  // Frames are analyzed the first time they are needed, since that has to read them from the file.
+  const AnalyzedFrameInfo& GetAnalyzedFrameInfo(u32 frame) const;
+  // Splits a frame into objects and EFB copies. cpmem holds the CP registers at the start of the
+  // frame and is updated to their state at its end.
+  static AnalyzedFrameInfo AnalyzeFrame(const FifoFrameInfo& frame, CPState* cpmem);
   // Frame range
   u32 GetFrameRangeStart() const { return m_FrameRangeStart; }
   void SetFrameRangeStart(u32 start);
@@ -127,6 +132,10 @@ public:
   u32 GetFrameRangeEnd() const { return m_FrameRangeEnd; }
   void SetFrameRangeEnd(u32 end);
 
+  // Stop after the frame range has been played this many times, even when looping is enabled.
+  // 0 means no limit.
+  void SetLoopCount(u32 count) { m_LoopCount = count; }
+
   // Object range
   u32 GetObjectRangeStart() const { return m_ObjectRangeStart; }
   void SetObjectRangeStart(u32 start) { m_ObjectRangeStart = start; }
@@ -184,6 +193,8 @@ private:
   Core::System& m_system;
 
   bool m_Loop = true;
+  u32 m_LoopCount = 0;
+  u32 m_LoopsPlayed = 0;
   // If enabled then all memory updates happen at once before the first frame
   bool m_EarlyMemoryUpdates = false;
 
@@ -204,5 +215,6 @@ private:
 
   std::unique_ptr<FifoDataFile> m_File;
 
-  std::vector<AnalyzedFrameInfo> m_FrameInfo;
+  mutable std::mutex m_frame_info_lock;
+  mutable std::vector<std::unique_ptr<const AnalyzedFrameInfo>> m_FrameInfo;
 };
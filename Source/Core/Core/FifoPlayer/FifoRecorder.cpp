@@ -10,6 +10,7 @@
 #include "Common/MsgHandler.h"
 #include "Common/Thread.h"
 
+#include "Core/FifoPlayer/FifoPlayer.h"
 #include "Core/HW/Memmap.h"
 #include "Core/System.h"
 
@@ -335,6 +336,12 @@ void FifoRecorder::WriteGPCommand(const u8* data, u32 size)
   {
     m_CurrentFrame.fifoData = m_FifoData;
 
+    // Analyze the frame like the FIFO player does, so that it can find the frame's objects without
+    // analyzing every frame before it
+    CPState cpmem(m_CurrentFrame.cpMem.data());
+    m_CurrentFrame.objectCount = FifoPlayer::AnalyzeFrame(m_CurrentFrame, &cpmem)
+                                     .part_type_counts[FramePartType::PrimitiveData];
+
     {
       std::lock_guard lk(m_mutex);
 
@@ -347,6 +354,7 @@ void FifoRecorder::WriteGPCommand(const u8* data, u32 size)
     }
 
     m_CurrentFrame.memoryUpdates.clear();
+    cpmem.FillCPMemoryArray(m_CurrentFrame.cpMem.data());
     m_FifoData.clear();
     m_FrameEnded = false;
   }
@@ -381,8 +389,7 @@ void FifoRecorder::UseMemory(u32 address, u32 size, MemoryUpdate::Type type, boo
     memUpdate.address = address;
     memUpdate.fifoPosition = (u32)(m_FifoData.size());
     memUpdate.type = type;
-    memUpdate.data.resize(size);
-    std::copy(newData, newData + size, memUpdate.data.begin());
+    memUpdate.data = std::make_shared<std::vector<u8>>(newData, newData + size);
 
     m_CurrentFrame.memoryUpdates.push_back(std::move(memUpdate));
   }
@@ -454,6 +461,7 @@ void FifoRecorder::SetVideoMemory(const u32* bpMem, const u32* cpMem, const u32*
   }
 
   m_record_analyzer = std::make_unique<FifoRecordAnalyzer>(this, cpMem);
+  m_CurrentFrame.cpMem.assign(cpMem, cpMem + FifoDataFile::CP_MEM_SIZE);
 }
 
 bool FifoRecorder::IsRecording() const
@@ -127,10 +127,13 @@ void SystemTimersManager::PerfTrackerCallback(Core::System& system, u64 userdata
   auto& core_timing = system.GetCoreTiming();
   g_perf_metrics.CountPerformanceMarker(system, cycles_late);
 
+  auto& system_timers = system.GetSystemTimers();
+  system_timers.m_ticks_snapshot.store(core_timing.GetTicks(), std::memory_order_relaxed);
+  system_timers.m_idle_ticks_snapshot.store(core_timing.GetIdleTicks(), std::memory_order_relaxed);
+
   // Call this performance tracker again in 1/100th of a second.
   // The tracker stores 256 values so this will let us summarize the last 2.56 seconds.
   // The performance metrics require this to be called at 100hz for the speed% is correct.
-  auto& system_timers = system.GetSystemTimers();
   core_timing.ScheduleEvent(system_timers.GetTicksPerSecond() / 100 - cycles_late,
                             system_timers.m_event_type_perf_tracker);
 }
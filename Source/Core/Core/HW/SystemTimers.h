@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "Common/CommonTypes.h"
 
 namespace Core
@@ -89,6 +91,12 @@ public:
   // - 2.0: the emulator is running at 200% speed (or 100% speed but sleeping half of the time).
   double GetEstimatedEmulationPerformance() const;
 
+  // The emulated cycles run so far, and those of them skipped by idle loop detection, as of the
+  // last performance tracker update. Unlike the CoreTiming counters, these can be read from any
+  // thread. Both go back on state loads.
+  u64 GetTicksSnapshot() const { return m_ticks_snapshot.load(std::memory_order_relaxed); }
+  u64 GetIdleTicksSnapshot() const { return m_idle_ticks_snapshot.load(std::memory_order_relaxed); }
+
 private:
   static void DSPCallback(Core::System& system, u64 userdata, s64 cycles_late);
   static void AudioDMACallback(Core::System& system, u64 userdata, s64 cycles_late);
@@ -117,6 +125,8 @@ private:
   CoreTiming::EventType* m_event_type_ipc_hle = nullptr;
   CoreTiming::EventType* m_event_type_gpu_sleeper = nullptr;
   CoreTiming::EventType* m_event_type_perf_tracker = nullptr;
+  std::atomic<u64> m_ticks_snapshot = 0;
+  std::atomic<u64> m_idle_ticks_snapshot = 0;
   // PatchEngine updates every 1/60th of a second by default
   CoreTiming::EventType* m_event_type_patch_engine = nullptr;
 };
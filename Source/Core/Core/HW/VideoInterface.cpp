@@ -889,6 +889,7 @@ void VideoInterfaceManager::Update(u64 ticks)
                           Config::Get(Config::MAIN_LOCK_CURSOR));
     auto& si = m_system.GetSerialInterface();
     si.UpdateDevices();
+    g_perf_metrics.CountInputPoll();
     m_half_line_of_next_si_poll += 2 * si.GetPollXLines();
   }
 
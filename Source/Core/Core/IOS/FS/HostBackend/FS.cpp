@@ -5,7 +5,9 @@
 
 #include <algorithm>
 #include <cmath>
+#include <filesystem>
 #include <optional>
+#include <set>
 #include <string_view>
 #include <type_traits>
 #include <unordered_map>
@@ -17,9 +19,11 @@
 #include "Common/ChunkFile.h"
 #include "Common/FileUtil.h"
 #include "Common/Logging/Log.h"
+#include "Common/MsgHandler.h"
 #include "Common/NandPaths.h"
 #include "Common/StringUtil.h"
 #include "Common/Swap.h"
+#include "Core/Config/MainSettings.h"
 #include "Core/IOS/ES/ES.h"
 #include "Core/IOS/IOS.h"
 #include "Core/Movie.h"
@@ -28,7 +32,8 @@
 
 namespace IOS::HLE::FS
 {
-constexpr u32 BUFFER_CHUNK_SIZE = 65536;
+// Upper bound for the file contents that are kept in memory between savestates.
+constexpr size_t SNAPSHOT_CACHE_SIZE = 64 * 1024 * 1024;
 
 HostFileSystem::HostFilename HostFileSystem::BuildFilename(const std::string& wii_path) const
 {
@@ -153,9 +158,34 @@ HostFileSystem::HostFileSystem(const std::string& root_path,
   File::CreateFullPath(m_root_path + '/');
   ResetFst();
   LoadFst();
+
+  m_write_back = Config::Get(Config::MAIN_NAND_WRITE_BACK);
+  if (m_write_back)
+  {
+    m_write_back_thread.Reset("IOS FS Write-Back",
+                              [this](std::string) { WriteBackPendingFiles(); });
+  }
 }
 
-HostFileSystem::~HostFileSystem() = default;
+HostFileSystem::~HostFileSystem()
+{
+  FlushWriteBack();
+
+  // IOS has already told the title that these files were written, so don't drop them silently.
+  std::vector<std::string> pending_writes;
+  while (!(pending_writes = GetPendingWrites()).empty())
+  {
+    const bool try_again =
+        PanicYesNoFmtT("{0} NAND file(s) could not be written, including \"{1}\". Saved data "
+                       "will be lost.\n\nPress \"Yes\" to make another attempt.",
+                       pending_writes.size(), pending_writes.front());
+    if (!try_again)
+      break;
+    FlushWriteBack();
+  }
+
+  m_write_back_thread.Shutdown();
+}
 
 std::string HostFileSystem::GetFstFilePath() const
 {
@@ -164,6 +194,7 @@ std::string HostFileSystem::GetFstFilePath() const
 
 void HostFileSystem::ResetFst()
 {
+  InvalidateFstIndex();
   m_root_entry = {};
   m_root_entry.name = "/";
   // Mode 0x16 (Directory | Owner_None | Group_Read | Other_Read) in the FS sysmodule
@@ -205,6 +236,7 @@ void HostFileSystem::LoadFst()
     ERROR_LOG_FMT(IOS_FS, "Failed to parse FST: at least one of the entries was invalid");
     return;
   }
+  InvalidateFstIndex();
   m_root_entry = *root_entry;
 }
 
@@ -244,14 +276,39 @@ HostFileSystem::FstEntry* HostFileSystem::GetFstEntryForPath(const std::string&
   if (!IsValidNonRootPath(path))
     return nullptr;
 
+  // The host file is checked even for indexed paths, since it may have been added, removed or
+  // replaced without going through this class.
   auto host_file = BuildFilename(path);
   const File::FileInfo host_file_info{host_file.host_path};
   if (!host_file_info.Exists())
     return nullptr;
 
+  if (const auto it = m_fst_index.find(path); it != m_fst_index.end())
+  {
+    if (it->second.is_redirect == host_file.is_redirect &&
+        it->second.entry->data.is_file == host_file_info.IsFile())
+    {
+      return it->second.entry;
+    }
+    // Let the entry be looked up and updated again below.
+    m_fst_index.erase(it);
+  }
+
   FstEntry* entry = host_file.is_redirect ? &m_redirect_fst : &m_root_entry;
   std::string complete_path = "";
-  for (const std::string& component : SplitString(std::string(path.substr(1)), '/'))
+  std::string remaining_path = path.substr(1);
+
+  // If the parent was already looked up, only the last component needs to be searched.
+  const auto split_path = SplitPathAndBasename(path);
+  const auto parent = m_fst_index.find(split_path.parent);
+  if (parent != m_fst_index.end() && parent->second.is_redirect == host_file.is_redirect)
+  {
+    entry = parent->second.entry;
+    complete_path = split_path.parent;
+    remaining_path = split_path.file_name;
+  }
+
+  for (const std::string& component : SplitString(remaining_path, '/'))
   {
     complete_path += '/' + component;
     const auto next =
@@ -267,6 +324,7 @@ HostFileSystem::FstEntry* HostFileSystem::GetFstEntryForPath(const std::string&
       // proper metadata is filled in later.
       INFO_LOG_FMT(IOS_FS, "Creating a default entry for {} ({})", complete_path,
                    host_file.is_redirect ? "redirect" : "NAND");
+      InvalidateFstIndex();
       entry = &entry->children.emplace_back();
       entry->name = component;
       entry->data.modes = {Mode::ReadWrite, Mode::ReadWrite, Mode::ReadWrite};
@@ -277,19 +335,122 @@ HostFileSystem::FstEntry* HostFileSystem::GetFstEntryForPath(const std::string&
   if (entry->data.is_file && !entry->children.empty())
   {
     WARN_LOG_FMT(IOS_FS, "{} is a file but also has children; clearing children", path);
+    InvalidateFstIndex();
     entry->children.clear();
   }
 
+  m_fst_index.emplace(path, IndexedFstEntry{entry, host_file.is_redirect});
   return entry;
 }
 
-void HostFileSystem::DoStateRead(PointerWrap& p, std::string start_directory_path)
+void HostFileSystem::InvalidateFstIndex()
+{
+  m_fst_index.clear();
+}
+
+static std::filesystem::file_time_type GetModificationTime(const std::string& path)
+{
+  std::error_code error;
+  const auto time = std::filesystem::last_write_time(StringToPath(path), error);
+  return error ? std::filesystem::file_time_type::min() : time;
+}
+
+HostFileSystem::SnapshotFile* HostFileSystem::FindSnapshotFile(const std::string& host_path)
+{
+  const auto it = m_snapshot_files.find(host_path);
+  if (it == m_snapshot_files.end() || File::GetSize(host_path) != it->second.size ||
+      GetModificationTime(host_path) != it->second.modification_time)
+  {
+    return nullptr;
+  }
+  return &it->second;
+}
+
+HostFileSystem::SnapshotFile& HostFileSystem::LoadSnapshotFile(const std::string& host_path)
+{
+  // The time is taken first, so that changes made while the file is read are noticed next time.
+  const auto modification_time = GetModificationTime(host_path);
+  File::IOFile handle(host_path, "rb");
+  auto data = std::make_shared<std::vector<u8>>(handle.GetSize());
+  if (!data->empty() && !handle.ReadBytes(data->data(), data->size()))
+  {
+    ERROR_LOG_FMT(IOS_FS, "Failed to read {} for the savestate", host_path);
+    std::fill(data->begin(), data->end(), 0);
+  }
+  const auto digest = Common::SHA1::CalculateDigest(*data);
+  SnapshotFile& snapshot = SetSnapshotFile(host_path, modification_time, digest, data);
+  if (!snapshot.data)
+    snapshot.data = std::move(data);
+  return snapshot;
+}
+
+HostFileSystem::SnapshotFile&
+HostFileSystem::SetSnapshotFile(const std::string& host_path,
+                                std::filesystem::file_time_type modification_time,
+                                const Common::SHA1::Digest& digest,
+                                std::shared_ptr<std::vector<u8>> data)
+{
+  SnapshotFile& snapshot = m_snapshot_files[host_path];
+  if (snapshot.cached)
+    m_snapshot_cache_size -= snapshot.data->size();
+
+  snapshot.size = static_cast<u32>(data->size());
+  snapshot.modification_time = modification_time;
+  snapshot.digest = digest;
+  snapshot.cached = m_snapshot_cache_size + data->size() <= SNAPSHOT_CACHE_SIZE;
+  if (snapshot.cached)
+  {
+    m_snapshot_cache_size += data->size();
+    snapshot.data = std::move(data);
+  }
+  else
+  {
+    snapshot.data.reset();
+  }
+  return snapshot;
+}
+
+void HostFileSystem::InvalidateSnapshot(const std::string& host_path)
+{
+  const auto erase = [this](auto begin, auto end) {
+    for (auto it = begin; it != end; ++it)
+    {
+      if (it->second.cached)
+        m_snapshot_cache_size -= it->second.data->size();
+    }
+    m_snapshot_files.erase(begin, end);
+  };
+
+  const auto it = m_snapshot_files.find(host_path);
+  if (it != m_snapshot_files.end())
+    erase(it, std::next(it));
+
+  // Everything below a directory sorts between "path/" and "path0".
+  erase(m_snapshot_files.lower_bound(host_path + '/'),
+        m_snapshot_files.lower_bound(host_path + '0'));
+}
+
+void HostFileSystem::ClearSnapshot()
+{
+  m_snapshot_files.clear();
+  m_snapshot_cache_size = 0;
+}
+
+void HostFileSystem::DoStateRead(PointerWrap& p, std::string start_directory_path,
+                                 RestoredContents& restored_contents)
 {
   std::string path = BuildFilename(start_directory_path).host_path;
-  File::DeleteDirRecursively(path);
-  File::CreateDir(path);
+  while (path.ends_with('/'))
+    path.pop_back();
+  if (!File::IsDirectory(path))
+  {
+    File::Delete(path);
+    File::CreateDir(path);
+  }
 
-  // now restore from the stream
+  // Only write the files that differ from what is on the host, then delete everything that is
+  // not part of the savestate.
+  std::set<std::string> restored_paths;
   while (true)
   {
     char type = 0;
@@ -303,34 +464,91 @@ void HostFileSystem::DoStateRead(PointerWrap& p, std::string start_directory_pat
     {
     case 'd':
     {
+      if (File::IsFile(name))
+      {
+        File::Delete(name);
+        InvalidateSnapshot(name);
+        DropPendingWrites(name);
+      }
       File::CreateDir(name);
+      restored_paths.insert(name);
       break;
     }
     case 'f':
     {
       u32 size = 0;
+      Common::SHA1::Digest digest{};
+      bool stored = false;
       p.Do(size);
+      p.DoArray(digest);
+      p.Do(stored);
 
-      File::IOFile handle(name, "wb");
-      char buf[BUFFER_CHUNK_SIZE];
-      u32 count = size;
-      while (count > BUFFER_CHUNK_SIZE)
+      std::shared_ptr<std::vector<u8>> data;
+      if (stored)
+      {
+        data = std::make_shared<std::vector<u8>>(size);
+        p.DoArray(data->data(), size);
+        restored_contents.emplace(digest, data);
+      }
+      else if (const auto it = restored_contents.find(digest); it != restored_contents.end())
       {
-        p.DoArray(buf);
-        handle.WriteArray(&buf[0], BUFFER_CHUNK_SIZE);
-        count -= BUFFER_CHUNK_SIZE;
+        data = it->second;
       }
-      p.DoArray(&buf[0], count);
-      handle.WriteArray(&buf[0], count);
+      else
+      {
+        ERROR_LOG_FMT(IOS_FS, "Contents of {} are missing from the savestate", name);
+        data = std::make_shared<std::vector<u8>>(size);
+      }
+
+      // A write that failed to be written back would otherwise replace the restored file later.
+      const bool was_pending = GetPendingWrite(name) != nullptr;
+      DropPendingWrites(name);
+
+      const SnapshotFile* snapshot = was_pending ? nullptr : FindSnapshotFile(name);
+      const bool unchanged = snapshot && snapshot->size == size && snapshot->digest == digest;
+      if (!unchanged)
+      {
+        if (File::IsDirectory(name))
+          File::DeleteDirRecursively(name);
+        InvalidateSnapshot(name);
+
+        File::IOFile handle(name, "wb");
+        handle.WriteBytes(data->data(), data->size());
+      }
+      SetSnapshotFile(name, GetModificationTime(name), digest, std::move(data));
+      restored_paths.insert(name);
       break;
     }
     }
   }
+
+  const auto remove_stale_entries = [&](const auto& self, const File::FSTEntry& parent) -> void {
+    for (const File::FSTEntry& entry : parent.children)
+    {
+      if (!restored_paths.contains(entry.physicalName))
+      {
+        if (entry.isDirectory)
+          File::DeleteDirRecursively(entry.physicalName);
+        else
+          File::Delete(entry.physicalName);
+        InvalidateSnapshot(entry.physicalName);
+        DropPendingWrites(entry.physicalName);
+      }
+      else if (entry.isDirectory)
+      {
+        self(self, entry);
+      }
+    }
+  };
+  remove_stale_entries(remove_stale_entries, File::ScanDirectoryTree(path, true));
 }
 
-void HostFileSystem::DoStateWriteOrMeasure(PointerWrap& p, std::string start_directory_path)
+void HostFileSystem::DoStateWriteOrMeasure(PointerWrap& p, std::string start_directory_path,
+                                           std::set<Common::SHA1::Digest>& stored_contents)
 {
   std::string path = BuildFilename(start_directory_path).host_path;
+  while (path.ends_with('/'))
+    path.pop_back();
   File::FSTEntry parent_entry = File::ScanDirectoryTree(path, true);
   std::deque<File::FSTEntry> todo;
   todo.insert(todo.end(), parent_entry.children.begin(), parent_entry.children.end());
@@ -349,20 +567,55 @@ void HostFileSystem::DoStateWriteOrMeasure(PointerWrap& p, std::string start_dir
     }
     else
     {
-      u32 size = (u32)entry.size;
-      p.Do(size);
+      // Files that failed to be written back are out of date on the host, so their pending
+      // contents are stored instead. They are not added to the snapshot.
+      SnapshotFile pending_snapshot;
+      SnapshotFile* snapshot = nullptr;
+      if (const auto pending = GetPendingWrite(entry.physicalName))
+      {
+        auto data = std::make_shared<std::vector<u8>>();
+        if (!ReadPendingContents(entry.physicalName, *pending, *data))
+        {
+          ERROR_LOG_FMT(IOS_FS, "Failed to read {} for the savestate", entry.physicalName);
+          std::fill(data->begin(), data->end(), 0);
+        }
+        pending_snapshot.size = static_cast<u32>(data->size());
+        pending_snapshot.digest = Common::SHA1::CalculateDigest(*data);
+        pending_snapshot.data = std::move(data);
+        snapshot = &pending_snapshot;
+      }
+      else
+      {
+        // The snapshot is taken during the measure pass and reused for the write pass.
+        snapshot = FindSnapshotFile(entry.physicalName);
+        if (!snapshot)
+          snapshot = &LoadSnapshotFile(entry.physicalName);
+      }
+
+      // Files with the same contents as an earlier file in this savestate only store the digest.
+      bool stored = !stored_contents.contains(snapshot->digest);
+      // Stored contents are hashed again from the buffer they are written from, in case they
+      // were dropped from the cache.
+      if (stored && !snapshot->data)
+      {
+        snapshot = &LoadSnapshotFile(entry.physicalName);
+        stored = !stored_contents.contains(snapshot->digest);
+      }
 
-      File::IOFile handle(entry.physicalName, "rb");
-      char buf[BUFFER_CHUNK_SIZE];
-      u32 count = size;
-      while (count > BUFFER_CHUNK_SIZE)
+      u32 size = snapshot->size;
+      Common::SHA1::Digest digest = snapshot->digest;
+      p.Do(size);
+      p.DoArray(digest);
+      p.Do(stored);
+      if (stored)
       {
-        handle.ReadArray(&buf[0], BUFFER_CHUNK_SIZE);
-        p.DoArray(buf);
-        count -= BUFFER_CHUNK_SIZE;
+        stored_contents.insert(digest);
+        p.DoArray(snapshot->data->data(), size);
       }
-      handle.ReadArray(&buf[0], count);
-      p.DoArray(&buf[0], count);
+
+      // Contents that don't fit in the cache are only needed until they have been written.
+      if (p.IsWriteMode() && !snapshot->cached)
+        snapshot->data.reset();
     }
     todo.pop_front();
   }
@@ -374,8 +627,15 @@ void HostFileSystem::DoStateWriteOrMeasure(PointerWrap& p, std::string start_dir
 void HostFileSystem::DoState(PointerWrap& p)
 {
   // Temporarily close the file, to prevent any issues with the savestating of files/folders.
+  // Writes which still fail to be written back are saved from memory.
+  FlushWriteBack();
   for (Handle& handle : m_handles)
     handle.host_file.reset();
+  m_open_files.clear();
+
+  // Every savestate stores all of the files it covers, so that it can be loaded without any other
+  // savestate. Only identical contents are stored once. The snapshots only avoid reading
+  // unchanged files when saving and writing them again when loading.
 
   // The format for the next part of the save state is follows:
   // 1. bool Movie::WasMovieActiveWhenStateSaved() &&
@@ -401,11 +661,12 @@ void HostFileSystem::DoState(PointerWrap& p)
 
   if (!p.IsReadMode())
   {
-    DoStateWriteOrMeasure(p, "/tmp");
+    std::set<Common::SHA1::Digest> stored_contents;
+    DoStateWriteOrMeasure(p, "/tmp", stored_contents);
     u8* previous_position = p.ReserveU32();
     if (original_save_state_made_during_movie_recording)
     {
-      DoStateWriteOrMeasure(p, "/");
+      DoStateWriteOrMeasure(p, "/", stored_contents);
       if (p.IsWriteMode())
       {
         u32 size_of_nand = p.GetOffsetFromPreviousPosition(previous_position) - sizeof(u32);
@@ -415,7 +676,9 @@ void HostFileSystem::DoState(PointerWrap& p)
   }
   else  // case where we're in read mode.
   {
-    DoStateRead(p, "/tmp");
+    RestoredContents restored_contents;
+    DoStateRead(p, "/tmp", restored_contents);
+    InvalidateFstIndex();
     if (!movie.IsMovieActive() || !original_save_state_made_during_movie_recording ||
         !Core::WiiRootIsTemporary() ||
         (original_save_state_made_during_movie_recording !=
@@ -427,7 +690,7 @@ void HostFileSystem::DoState(PointerWrap& p)
     {
       p.Do(temp_val);
       if (movie.IsMovieActive() && Core::WiiRootIsTemporary())
-        DoStateRead(p, "/");
+        DoStateRead(p, "/", restored_contents);
     }
   }
 
@@ -449,6 +712,9 @@ ResultCode HostFileSystem::Format(Uid uid)
   if (m_root_path.empty())
     return ResultCode::AccessDenied;
   const std::string root = BuildFilename("/").host_path;
+  FlushWriteBack();
+  ClearSnapshot();
+  m_open_files.clear();
   if (!File::DeleteDirRecursively(root) || !File::CreateDir(root))
     return ResultCode::UnknownError;
   ResetFst();
@@ -483,6 +749,7 @@ ResultCode HostFileSystem::CreateFileOrDirectory(Uid uid, Gid gid, const std::st
   if (File::Exists(host_path))
     return ResultCode::AlreadyExists;
 
+  InvalidateSnapshot(host_path);
   const bool ok = is_file ? File::CreateEmptyFile(host_path) : File::CreateDir(host_path);
   if (!ok)
   {
@@ -490,6 +757,7 @@ ResultCode HostFileSystem::CreateFileOrDirectory(Uid uid, Gid gid, const std::st
     return ResultCode::UnknownError;
   }
 
+  InvalidateFstIndex();
   FstEntry* child = GetFstEntryForPath(path);
   *child = {};
   child->name = split_path.file_name;
@@ -546,12 +814,23 @@ ResultCode HostFileSystem::Delete(Uid uid, Gid gid, const std::string& path)
   if (!File::Exists(host_path))
     return ResultCode::NotFound;
 
+  FlushWriteBack();
   if (File::IsFile(host_path) && !IsFileOpened(path))
+  {
+    CloseHostFiles(host_path);
     File::Delete(host_path);
+  }
   else if (File::IsDirectory(host_path) && !IsDirectoryInUse(path))
+  {
+    CloseHostFiles(host_path);
     File::DeleteDirRecursively(host_path);
+  }
   else
+  {
     return ResultCode::InUse;
+  }
+  InvalidateSnapshot(host_path);
+  InvalidateFstIndex();
 
   const auto it = std::find_if(parent->children.begin(), parent->children.end(),
                                GetNamePredicate(split_path.file_name));
@@ -596,10 +875,15 @@ ResultCode HostFileSystem::Rename(Uid uid, Gid gid, const std::string& old_path,
     return ResultCode::InUse;
   }
 
+  FlushWriteBack();
   const auto host_old_info = BuildFilename(old_path);
   const auto host_new_info = BuildFilename(new_path);
   const std::string& host_old_path = host_old_info.host_path;
   const std::string& host_new_path = host_new_info.host_path;
+  InvalidateSnapshot(host_old_path);
+  InvalidateSnapshot(host_new_path);
+  CloseHostFiles(host_old_path);
+  CloseHostFiles(host_new_path);
 
   // If there is already something of the same type at the new path, delete it.
   if (File::Exists(host_new_path))
@@ -639,6 +923,7 @@ ResultCode HostFileSystem::Rename(Uid uid, Gid gid, const std::string& old_path,
     }
   }
 
+  InvalidateFstIndex();
   FstEntry* new_entry = GetFstEntryForPath(new_path);
   new_entry->name = split_new_path.file_name;
 
@@ -652,6 +937,7 @@ ResultCode HostFileSystem::Rename(Uid uid, Gid gid, const std::string& old_path,
 
     old_parent->children.erase(it);
   }
+  InvalidateFstIndex();
 
   SaveFst();
 
@@ -737,7 +1023,7 @@ Result<Metadata> HostFileSystem::GetMetadata(Uid uid, Gid gid, const std::string
     return ResultCode::NotFound;
 
   Metadata metadata = entry->data;
-  metadata.size = File::GetSize(BuildFilename(path).host_path);
+  metadata.size = GetHostFileSize(BuildFilename(path).host_path);
   return metadata;
 }
 
@@ -756,7 +1042,7 @@ ResultCode HostFileSystem::SetMetadata(Uid caller_uid, const std::string& path,
   if (caller_uid != 0 && uid != entry->data.uid)
     return ResultCode::AccessDenied;
 
-  const bool is_empty = File::GetSize(BuildFilename(path).host_path) == 0;
+  const bool is_empty = GetHostFileSize(BuildFilename(path).host_path) == 0;
   if (entry->data.uid != uid && entry->data.is_file && !is_empty)
     return ResultCode::FileNotEmpty;
 
@@ -773,15 +1059,21 @@ ResultCode HostFileSystem::SetMetadata(Uid caller_uid, const std::string& path,
   return ResultCode::Success;
 }
 
-static u64 ComputeUsedClusters(const File::FSTEntry& parent_entry)
+// Files that haven't been written back yet are counted with the size they are going to have.
+static u64 ComputeUsedClusters(const File::FSTEntry& parent_entry,
+                               const std::map<std::string, u64>& uncommitted_sizes)
 {
   u64 clusters = 0;
   for (const File::FSTEntry& entry : parent_entry.children)
   {
     if (entry.isDirectory)
-      clusters += ComputeUsedClusters(entry);
-    else
-      clusters += Common::AlignUp(entry.size, CLUSTER_SIZE) / CLUSTER_SIZE;
+    {
+      clusters += ComputeUsedClusters(entry, uncommitted_sizes);
+      continue;
+    }
+    const auto uncommitted = uncommitted_sizes.find(entry.physicalName);
+    const u64 size = uncommitted != uncommitted_sizes.end() ? uncommitted->second : entry.size;
+    clusters += Common::AlignUp(size, CLUSTER_SIZE) / CLUSTER_SIZE;
   }
   return clusters;
 }
@@ -836,7 +1128,7 @@ HostFileSystem::GetExtendedDirectoryStats(const std::string& wii_path)
 
     // add one for the folder itself
     stats.used_inodes = 1 + parent_dir.size;
-    stats.used_clusters = ComputeUsedClusters(parent_dir);
+    stats.used_clusters = ComputeUsedClusters(parent_dir, GetUncommittedSizes());
   }
   else
   {
@@ -848,5 +1140,7 @@ HostFileSystem::GetExtendedDirectoryStats(const std::string& wii_path)
 void HostFileSystem::SetNandRedirects(std::vector<NandRedirect> nand_redirects)
 {
   m_nand_redirects = std::move(nand_redirects);
+  ClearSnapshot();
+  InvalidateFstIndex();
 }
 }  // namespace IOS::HLE::FS
@@ -4,13 +4,22 @@
 #pragma once
 
 #include <array>
+#include <filesystem>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include <rangeset/rangeset.h>
+
 #include "Common/CommonTypes.h"
+#include "Common/Crypto/SHA1.h"
 #include "Common/IOFile.h"
+#include "Common/WorkQueueThread.h"
 #include "Core/IOS/FS/FileSystem.h"
 
 namespace IOS::HLE::FS
@@ -60,8 +69,38 @@ public:
   void SetNandRedirects(std::vector<NandRedirect> nand_redirects) override;
 
 private:
-  void DoStateWriteOrMeasure(PointerWrap& p, std::string start_directory_path);
-  void DoStateRead(PointerWrap& p, std::string start_directory_path);
+  using RestoredContents = std::map<Common::SHA1::Digest, std::shared_ptr<std::vector<u8>>>;
+  void DoStateWriteOrMeasure(PointerWrap& p, std::string start_directory_path,
+                             std::set<Common::SHA1::Digest>& stored_contents);
+  void DoStateRead(PointerWrap& p, std::string start_directory_path,
+                   RestoredContents& restored_contents);
+
+  /// Contents of a host file as of the last time it was saved to or loaded from a savestate.
+  struct SnapshotFile
+  {
+    u32 size = 0;
+    /// Together with the size, this catches files that are changed outside of this class.
+    std::filesystem::file_time_type modification_time{};
+    Common::SHA1::Digest digest{};
+    /// Kept while the snapshot cache has room for it. Contents that don't fit are only kept from
+    /// the measure pass of a savestate to its write pass.
+    std::shared_ptr<std::vector<u8>> data;
+    /// Whether the data counts towards the snapshot cache.
+    bool cached = false;
+  };
+  /// Returns the snapshot for a host file, or nullptr if the file was modified since it was taken.
+  SnapshotFile* FindSnapshotFile(const std::string& host_path);
+  /// Reads and hashes a host file. The contents are kept at least until the next savestate has
+  /// been written, so that the stored contents always match the digest.
+  SnapshotFile& LoadSnapshotFile(const std::string& host_path);
+  SnapshotFile& SetSnapshotFile(const std::string& host_path,
+                                std::filesystem::file_time_type modification_time,
+                                const Common::SHA1::Digest& digest,
+                                std::shared_ptr<std::vector<u8>> data);
+  /// Forgets the snapshot for a file, or for everything in a directory.
+  /// Must be called whenever the emulated software modifies the host file system.
+  void InvalidateSnapshot(const std::string& host_path);
+  void ClearSnapshot();
 
   struct FstEntry
   {
@@ -76,12 +115,38 @@ private:
     std::vector<FstEntry> children;
   };
 
+  /// Host file that is shared by all handles for the same path.
+  struct HostFile
+  {
+    bool IsOpen() const { return contents || file.IsOpen(); }
+    u64 GetSize() const { return contents ? contents->size() : file.GetSize(); }
+
+    std::string host_path;
+    File::IOFile file;
+    /// With write-back, the contents of the file once it has been written to.
+    /// The host file is closed at that point, and the contents are committed in the background.
+    /// The contents are shared with pending commits, so they are copied before they are changed
+    /// while a commit is still being written back.
+    std::shared_ptr<std::vector<u8>> contents;
+    /// The parts of the host file which have neither been written nor loaded into contents yet.
+    /// They are only read when they are needed.
+    HyoutaUtilities::RangeSet<u64> missing;
+    bool dirty = false;
+  };
+
+  struct PendingWrite
+  {
+    std::shared_ptr<const std::vector<u8>> contents;
+    /// The parts which are taken from the current host file.
+    HyoutaUtilities::RangeSet<u64> missing;
+  };
+
   struct Handle
   {
     bool opened = false;
     Mode mode = Mode::None;
     std::string wii_path;
-    std::shared_ptr<File::IOFile> host_file;
+    std::shared_ptr<HostFile> host_file;
     u32 file_offset = 0;
   };
   Handle* AssignFreeHandle();
@@ -94,7 +159,36 @@ private:
     bool is_redirect;
   };
   HostFilename BuildFilename(const std::string& wii_path) const;
-  std::shared_ptr<File::IOFile> OpenHostFile(const std::string& host_path);
+  std::shared_ptr<HostFile> OpenHostFile(const std::string& host_path);
+  /// Closes the cached host files for a file, or for everything in a directory.
+  /// Handles that are still using them keep them open until they are closed.
+  void CloseHostFiles(const std::string& host_path);
+  /// Returns the size of a host file, including writes that have not been committed yet.
+  u64 GetHostFileSize(const std::string& host_path);
+  /// Returns the sizes of all files which have been written but not written back, keyed by host
+  /// path.
+  std::map<std::string, u64> GetUncommittedSizes();
+
+  /// Switches a host file over to write-back. None of the file is read at this point.
+  void StartWriteBack(HostFile& host_file);
+  /// Reads the parts of the file which haven't been loaded yet.
+  bool LoadMissingContents(HostFile& host_file);
+  /// Queues the contents of a host file to be written back.
+  void CommitHostFile(HostFile& host_file);
+  /// Commits all written files and waits for them to be written back. Files which failed to be
+  /// written back before are tried again.
+  void FlushWriteBack();
+  /// Returns the host paths of the files which haven't been written back yet.
+  std::vector<std::string> GetPendingWrites();
+  std::shared_ptr<const PendingWrite> GetPendingWrite(const std::string& host_path);
+  /// Drops the writes which are still pending for a file, or for everything in a directory.
+  void DropPendingWrites(const std::string& host_path);
+  /// Called on the write-back thread.
+  void WriteBackPendingFiles();
+  static bool WritePendingContents(const std::string& host_path, const PendingWrite& pending,
+                                   File::IOFile& out);
+  static bool ReadPendingContents(const std::string& host_path, const PendingWrite& pending,
+                                  std::vector<u8>& contents);
 
   ResultCode CreateFileOrDirectory(Uid uid, Gid gid, const std::string& path,
                                    FileAttribute attribute, Modes modes, bool is_file);
@@ -109,6 +203,9 @@ private:
   /// Automatically creates fallback entries for parents if they do not exist.
   /// Returns nullptr if the path is invalid or the file does not exist.
   FstEntry* GetFstEntryForPath(const std::string& path);
+  /// Must be called whenever entries are added to or removed from the FST,
+  /// since that can move the other entries in memory.
+  void InvalidateFstIndex();
 
   /// FST entry for the filesystem root.
   ///
@@ -120,11 +217,42 @@ private:
   /// filesystem root manually.
   FstEntry m_root_entry{};
   std::string m_root_path;
-  std::map<std::string, std::weak_ptr<File::IOFile>> m_open_files;
   std::array<Handle, 16> m_handles{};
 
+  struct IndexedFstEntry
+  {
+    FstEntry* entry;
+    bool is_redirect;
+  };
+  /// Paths that were found by GetFstEntryForPath. This only saves searching the FST; whether the
+  /// host file exists is still checked on every lookup.
+  std::unordered_map<std::string, IndexedFstEntry> m_fst_index;
+
+  struct CachedHostFile
+  {
+    std::shared_ptr<HostFile> file;
+    u64 last_used;
+  };
+  /// Host files are kept open for a while after their last handle is closed, and are reused if
+  /// the same path is opened again. A file is reopened if it was replaced on the host in the
+  /// meantime.
+  std::unordered_map<std::string, CachedHostFile> m_open_files;
+  u64 m_open_files_counter = 0;
+
   FstEntry m_redirect_fst{};
   std::vector<NandRedirect> m_nand_redirects;
+
+  /// Snapshots of the files that have not been modified since the last savestate, keyed by host
+  /// path. Savestates use them to avoid reading or rewriting unchanged files.
+  std::map<std::string, SnapshotFile> m_snapshot_files;
+  size_t m_snapshot_cache_size = 0;
+
+  bool m_write_back = false;
+  /// Latest contents of the files that still have to be written back, keyed by host path.
+  /// Writes which fail stay here until they succeed.
+  std::map<std::string, std::shared_ptr<const PendingWrite>> m_pending_writes;
+  std::mutex m_pending_writes_lock;
+  Common::WorkQueueThread<std::string> m_write_back_thread;
 };
 
 }  // namespace IOS::HLE::FS
@@ -6,6 +6,10 @@
 #include <algorithm>
 #include <memory>
 
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
 #include "Common/FileUtil.h"
 #include "Common/IOFile.h"
 #include "Common/Logging/Log.h"
@@ -13,8 +17,40 @@
 
 namespace IOS::HLE::FS
 {
+// Has to be larger than the number of handles, so that unused files can always be evicted.
+constexpr size_t MAX_CACHED_HOST_FILES = 32;
+
+static bool Overlaps(const HyoutaUtilities::RangeSet<u64>& ranges, u64 from, u64 to)
+{
+  for (auto it = ranges.begin(); it != ranges.end(); ++it)
+  {
+    if (it.from() < to && from < it.to())
+      return true;
+  }
+  return false;
+}
+
+// Returns whether the host path still refers to the file that was opened. Files that are replaced
+// on the host, for example by restoring a save from outside of Dolphin, get a new inode.
+static bool IsSameHostFile(File::IOFile& file, const std::string& host_path)
+{
+  if (!file.IsOpen())
+    return false;
+#ifdef _WIN32
+  // Files can't be deleted or replaced while IOFile has them open on Windows.
+  return true;
+#else
+  struct stat file_stat;
+  struct stat path_stat;
+  return fstat(fileno(file.GetHandle()), &file_stat) == 0 &&
+         stat(host_path.c_str(), &path_stat) == 0 && file_stat.st_dev == path_stat.st_dev &&
+         file_stat.st_ino == path_stat.st_ino;
+#endif
+}
+
 // This isn't theadsafe, but it's only called from the CPU thread.
-std::shared_ptr<File::IOFile> HostFileSystem::OpenHostFile(const std::string& host_path)
+std::shared_ptr<HostFileSystem::HostFile>
+HostFileSystem::OpenHostFile(const std::string& host_path)
 {
   // On the wii, all file operations are strongly ordered.
   // If a game opens the same file twice (or 8 times, looking at you PokePark Wii)
@@ -32,18 +68,40 @@ std::shared_ptr<File::IOFile> HostFileSystem::OpenHostFile(const std::string& ho
   //    - Wii System Menu (Can't access the system settings, gets stuck on blank screen)
   //    - The Beatles: Rock Band (saving doesn't work)
 
-  // Check if the file has already been opened.
+  // Check if the file has already been opened. A file that no handle is using any more is only
+  // reused if it is still the file at the host path.
   auto search = m_open_files.find(host_path);
   if (search != m_open_files.end())
   {
-    // Lock a shared pointer to use.
-    return search->second.lock();
+    const std::shared_ptr<HostFile>& cached = search->second.file;
+    if (cached.use_count() > 1 || IsSameHostFile(cached->file, host_path))
+    {
+      search->second.last_used = ++m_open_files_counter;
+      return cached;
+    }
+    m_open_files.erase(search);
+  }
+
+  auto host_file = std::make_shared<HostFile>();
+  host_file->host_path = host_path;
+
+  // Files that are still waiting to be written back have to be read from memory. The contents are
+  // shared until either of them changes.
+  if (m_write_back)
+  {
+    std::lock_guard lk(m_pending_writes_lock);
+    const auto pending = m_pending_writes.find(host_path);
+    if (pending != m_pending_writes.end())
+    {
+      host_file->contents = std::const_pointer_cast<std::vector<u8>>(pending->second->contents);
+      host_file->missing = pending->second->missing;
+    }
   }
 
   // All files are opened read/write. Actual access rights will be controlled per handle by the
   // read/write functions below
-  File::IOFile file;
-  while (!file.Open(host_path, "r+b"))
+  File::IOFile& file = host_file->file;
+  while (!host_file->contents && !file.Open(host_path, "r+b"))
   {
     const bool try_again =
         PanicYesNoFmt("File \"{}\" could not be opened!\n"
@@ -59,19 +117,300 @@ std::shared_ptr<File::IOFile> HostFileSystem::OpenHostFile(const std::string& ho
     }
   }
 
-  // This code will be called when all references to the shared pointer below have been removed.
-  auto deleter = [this, host_path](File::IOFile* ptr) {
-    delete ptr;                     // IOFile's deconstructor closes the file.
-    m_open_files.erase(host_path);  // erase the weak pointer from the list of open files.
-  };
+  // Make room by closing the least recently used file that no handle is using.
+  if (m_open_files.size() >= MAX_CACHED_HOST_FILES)
+  {
+    auto oldest = m_open_files.end();
+    for (auto it = m_open_files.begin(); it != m_open_files.end(); ++it)
+    {
+      if (it->second.file.use_count() == 1 &&
+          (oldest == m_open_files.end() || it->second.last_used < oldest->second.last_used))
+      {
+        oldest = it;
+      }
+    }
+    if (oldest != m_open_files.end())
+      m_open_files.erase(oldest);  // IOFile's deconstructor closes the file.
+  }
+
+  m_open_files.emplace(host_path, CachedHostFile{host_file, ++m_open_files_counter});
+  return host_file;
+}
 
-  // Use the custom deleter from above.
-  std::shared_ptr<File::IOFile> file_ptr(new File::IOFile(std::move(file)), deleter);
+u64 HostFileSystem::GetHostFileSize(const std::string& host_path)
+{
+  const auto cached = m_open_files.find(host_path);
+  if (cached != m_open_files.end() && cached->second.file->contents)
+    return cached->second.file->contents->size();
 
-  // Store a weak pointer to our newly opened file in the cache.
-  m_open_files[host_path] = std::weak_ptr<File::IOFile>(file_ptr);
+  if (m_write_back)
+  {
+    std::lock_guard lk(m_pending_writes_lock);
+    const auto pending = m_pending_writes.find(host_path);
+    if (pending != m_pending_writes.end())
+      return pending->second->contents->size();
+  }
 
-  return file_ptr;
+  return File::GetSize(host_path);
+}
+
+std::map<std::string, u64> HostFileSystem::GetUncommittedSizes()
+{
+  std::map<std::string, u64> sizes;
+  if (!m_write_back)
+    return sizes;
+
+  {
+    std::lock_guard lk(m_pending_writes_lock);
+    for (const auto& [host_path, pending] : m_pending_writes)
+      sizes.emplace(host_path, pending->contents->size());
+  }
+  // Open files may have been written to since their last commit.
+  for (const auto& [host_path, cached] : m_open_files)
+  {
+    if (cached.file->contents)
+      sizes.insert_or_assign(host_path, cached.file->contents->size());
+  }
+  return sizes;
+}
+
+void HostFileSystem::StartWriteBack(HostFile& host_file)
+{
+  const u64 size = host_file.file.GetSize();
+  host_file.contents = std::make_shared<std::vector<u8>>(size);
+  host_file.missing.clear();
+  host_file.missing.insert(0, size);
+
+  // Close the host file, since it is going to be replaced when the contents are committed.
+  host_file.file.Close();
+}
+
+bool HostFileSystem::LoadMissingContents(HostFile& host_file)
+{
+  if (host_file.missing.empty())
+    return true;
+
+  // The parts which haven't been written are the same in the host file and in any pending commit.
+  File::IOFile file(host_file.host_path, "rb");
+  if (host_file.contents.use_count() > 1)
+    host_file.contents = std::make_shared<std::vector<u8>>(*host_file.contents);
+  std::vector<u8>& contents = *host_file.contents;
+  for (auto it = host_file.missing.begin(); it != host_file.missing.end(); ++it)
+  {
+    if (!file.Seek(it.from(), File::SeekOrigin::Begin) ||
+        !file.ReadBytes(contents.data() + it.from(), it.to() - it.from()))
+    {
+      ERROR_LOG_FMT(IOS_FS, "Failed to read {} for write-back", host_file.host_path);
+      return false;
+    }
+  }
+  host_file.missing.clear();
+  return true;
+}
+
+void HostFileSystem::CommitHostFile(HostFile& host_file)
+{
+  // The contents aren't copied here. They are copied by the next write if this commit is still
+  // using them at that point.
+  auto pending = std::make_shared<const PendingWrite>(
+      PendingWrite{host_file.contents, host_file.missing});
+  host_file.dirty = false;
+  {
+    std::lock_guard lk(m_pending_writes_lock);
+    m_pending_writes.insert_or_assign(host_file.host_path, std::move(pending));
+  }
+  m_write_back_thread.Push(host_file.host_path);
+}
+
+void HostFileSystem::FlushWriteBack()
+{
+  if (!m_write_back)
+    return;
+
+  for (auto& [host_path, cached] : m_open_files)
+  {
+    if (cached.file->dirty)
+      CommitHostFile(*cached.file);
+  }
+  for (Handle& handle : m_handles)
+  {
+    if (handle.host_file && handle.host_file->dirty)
+      CommitHostFile(*handle.host_file);
+  }
+
+  // Try the writes which failed before again.
+  bool has_pending_writes;
+  {
+    std::lock_guard lk(m_pending_writes_lock);
+    has_pending_writes = !m_pending_writes.empty();
+  }
+  if (has_pending_writes)
+    m_write_back_thread.Push({});
+
+  m_write_back_thread.WaitForCompletion();
+}
+
+std::vector<std::string> HostFileSystem::GetPendingWrites()
+{
+  std::lock_guard lk(m_pending_writes_lock);
+  std::vector<std::string> paths;
+  for (const auto& [host_path, pending] : m_pending_writes)
+    paths.push_back(host_path);
+  return paths;
+}
+
+std::shared_ptr<const HostFileSystem::PendingWrite>
+HostFileSystem::GetPendingWrite(const std::string& host_path)
+{
+  std::lock_guard lk(m_pending_writes_lock);
+  const auto it = m_pending_writes.find(host_path);
+  return it != m_pending_writes.end() ? it->second : nullptr;
+}
+
+void HostFileSystem::DropPendingWrites(const std::string& host_path)
+{
+  std::lock_guard lk(m_pending_writes_lock);
+  m_pending_writes.erase(host_path);
+  // Everything below a directory sorts between "path/" and "path0".
+  m_pending_writes.erase(m_pending_writes.lower_bound(host_path + '/'),
+                         m_pending_writes.lower_bound(host_path + '0'));
+}
+
+void HostFileSystem::WriteBackPendingFiles()
+{
+  // Commits can be queued while a batch is being written, so keep going until none are left.
+  // Files which fail to be written stay pending, and are tried again when the next commit or
+  // barrier comes in.
+  bool failed = false;
+  while (!failed)
+  {
+    std::map<std::string, std::shared_ptr<const PendingWrite>> batch;
+    {
+      std::lock_guard lk(m_pending_writes_lock);
+      if (m_pending_writes.empty())
+        return;
+      batch = m_pending_writes;
+    }
+
+    // Every file is written to a temporary file which then replaces the original, so a crash
+    // leaves either the old or the new contents. All temporary files are written before any of
+    // them are synced, which lets the OS batch the writes.
+    struct TempFile
+    {
+      const std::string& host_path;
+      std::shared_ptr<const PendingWrite> pending;
+      std::string temp_path;
+      File::IOFile file;
+    };
+    std::vector<TempFile> temp_files;
+    for (const auto& [host_path, pending] : batch)
+    {
+      TempFile temp_file{host_path, pending, File::GetTempFilenameForAtomicWrite(host_path)};
+      if (!temp_file.file.Open(temp_file.temp_path, "wb") ||
+          !WritePendingContents(host_path, *pending, temp_file.file))
+      {
+        ERROR_LOG_FMT(IOS_FS, "Failed to write back {}", host_path);
+        temp_file.file.Close();
+        File::Delete(temp_file.temp_path);
+        failed = true;
+        continue;
+      }
+      temp_files.push_back(std::move(temp_file));
+    }
+
+    std::vector<const TempFile*> written;
+    for (TempFile& temp_file : temp_files)
+    {
+      const bool synced = temp_file.file.Sync();
+      temp_file.file.Close();
+      if (!synced)
+      {
+        ERROR_LOG_FMT(IOS_FS, "Failed to sync {}", temp_file.temp_path);
+        File::Delete(temp_file.temp_path);
+        failed = true;
+        continue;
+      }
+      written.push_back(&temp_file);
+    }
+
+    // RenameSync also syncs the directory, so that the rename itself survives a crash.
+    std::vector<const TempFile*> replaced;
+    for (const TempFile* temp_file : written)
+    {
+      if (!File::RenameSync(temp_file->temp_path, temp_file->host_path))
+      {
+        ERROR_LOG_FMT(IOS_FS, "Failed to replace {} during write-back", temp_file->host_path);
+        File::Delete(temp_file->temp_path);
+        failed = true;
+        continue;
+      }
+      replaced.push_back(temp_file);
+    }
+
+    std::lock_guard lk(m_pending_writes_lock);
+    for (const TempFile* temp_file : replaced)
+    {
+      const auto it = m_pending_writes.find(temp_file->host_path);
+      if (it != m_pending_writes.end() && it->second == temp_file->pending)
+        m_pending_writes.erase(it);
+    }
+  }
+}
+
+// Writes the contents of a pending commit, with the parts which haven't been loaded taken from
+// the current host file.
+bool HostFileSystem::WritePendingContents(const std::string& host_path,
+                                          const PendingWrite& pending, File::IOFile& out)
+{
+  const std::vector<u8>& contents = *pending.contents;
+  File::IOFile original;
+  if (!pending.missing.empty() && !original.Open(host_path, "rb"))
+    return false;
+
+  std::vector<u8> buffer;
+  u64 position = 0;
+  for (auto it = pending.missing.begin(); it != pending.missing.end(); ++it)
+  {
+    buffer.resize(it.to() - it.from());
+    if (!out.WriteBytes(contents.data() + position, it.from() - position) ||
+        !original.Seek(it.from(), File::SeekOrigin::Begin) ||
+        !original.ReadBytes(buffer.data(), buffer.size()) ||
+        !out.WriteBytes(buffer.data(), buffer.size()))
+    {
+      return false;
+    }
+    position = it.to();
+  }
+  return out.WriteBytes(contents.data() + position, contents.size() - position);
+}
+
+// Like WritePendingContents, but into memory.
+bool HostFileSystem::ReadPendingContents(const std::string& host_path,
+                                         const PendingWrite& pending, std::vector<u8>& contents)
+{
+  contents = *pending.contents;
+  File::IOFile original;
+  if (!pending.missing.empty() && !original.Open(host_path, "rb"))
+    return false;
+
+  for (auto it = pending.missing.begin(); it != pending.missing.end(); ++it)
+  {
+    if (!original.Seek(it.from(), File::SeekOrigin::Begin) ||
+        !original.ReadBytes(contents.data() + it.from(), it.to() - it.from()))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void HostFileSystem::CloseHostFiles(const std::string& host_path)
+{
+  std::erase_if(m_open_files, [&host_path](const auto& entry) {
+    const std::string& path = entry.first;
+    return path.starts_with(host_path) &&
+           (path.size() == host_path.size() || path[host_path.size()] == '/');
+  });
 }
 
 Result<FileHandle> HostFileSystem::OpenFile(Uid, Gid, const std::string& path, Mode mode)
@@ -112,9 +451,26 @@ ResultCode HostFileSystem::Close(Fd fd)
   if (!handle)
     return ResultCode::Invalid;
 
-  // Let go of our pointer to the file, it will automatically close if we are the last handle
-  // accessing it.
+  // The host file stays open in the cache, so flush it for anything else that reads it from
+  // the host.
+  if (handle->host_file && handle->host_file->dirty)
+    CommitHostFile(*handle->host_file);
+  else if (handle->host_file && (u8(handle->mode) & u8(Mode::Write)) != 0)
+    handle->host_file->file.Flush();
+
+  // Only the host file itself is kept open for reuse. Write-back contents stay pending until they
+  // are written back, and are picked up from there by the next open.
+  const std::shared_ptr<HostFile> host_file = std::move(handle->host_file);
   *handle = Handle{};
+  if (host_file && host_file->contents)
+  {
+    const auto cached = m_open_files.find(host_file->host_path);
+    if (cached != m_open_files.end() && cached->second.file == host_file &&
+        host_file.use_count() == 2)
+    {
+      m_open_files.erase(cached);
+    }
+  }
   return ResultCode::Success;
 }
 
@@ -132,12 +488,26 @@ Result<u32> HostFileSystem::ReadBytesFromFile(Fd fd, u8* ptr, u32 count)
   if (count + handle->file_offset > file_size)
     count = file_size - handle->file_offset;
 
-  // File might be opened twice, need to seek before we read
-  handle->host_file->Seek(handle->file_offset, File::SeekOrigin::Begin);
-  const u32 actually_read = static_cast<u32>(fread(ptr, 1, count, handle->host_file->GetHandle()));
+  u32 actually_read = count;
+  if (const auto& contents = handle->host_file->contents)
+  {
+    if (Overlaps(handle->host_file->missing, handle->file_offset, handle->file_offset + count) &&
+        !LoadMissingContents(*handle->host_file))
+    {
+      return ResultCode::AccessDenied;
+    }
+    std::copy_n(contents->begin() + handle->file_offset, count, ptr);
+  }
+  else
+  {
+    // File might be opened twice, need to seek before we read
+    File::IOFile& file = handle->host_file->file;
+    file.Seek(handle->file_offset, File::SeekOrigin::Begin);
+    actually_read = static_cast<u32>(fread(ptr, 1, count, file.GetHandle()));
 
-  if (actually_read != count && ferror(handle->host_file->GetHandle()))
-    return ResultCode::AccessDenied;
+    if (actually_read != count && ferror(file.GetHandle()))
+      return ResultCode::AccessDenied;
+  }
 
   // IOS returns the number of bytes read and adds that value to the seek position,
   // instead of adding the *requested* read length.
@@ -154,10 +524,32 @@ Result<u32> HostFileSystem::WriteBytesToFile(Fd fd, const u8* ptr, u32 count)
   if ((u8(handle->mode) & u8(Mode::Write)) == 0)
     return ResultCode::AccessDenied;
 
-  // File might be opened twice, need to seek before we read
-  handle->host_file->Seek(handle->file_offset, File::SeekOrigin::Begin);
-  if (!handle->host_file->WriteBytes(ptr, count))
-    return ResultCode::AccessDenied;
+  if (!m_snapshot_files.empty())
+    InvalidateSnapshot(BuildFilename(handle->wii_path).host_path);
+
+  HostFile& host_file = *handle->host_file;
+  if (m_write_back && !host_file.contents)
+    StartWriteBack(host_file);
+
+  if (host_file.contents)
+  {
+    // Acknowledge the write right away. The contents are written back when the file is closed.
+    if (host_file.contents.use_count() > 1)
+      host_file.contents = std::make_shared<std::vector<u8>>(*host_file.contents);
+    std::vector<u8>& contents = *host_file.contents;
+    if (contents.size() < handle->file_offset + count)
+      contents.resize(handle->file_offset + count);
+    std::copy_n(ptr, count, contents.begin() + handle->file_offset);
+    host_file.missing.erase(handle->file_offset, handle->file_offset + count);
+    host_file.dirty = true;
+  }
+  else
+  {
+    // File might be opened twice, need to seek before we read
+    host_file.file.Seek(handle->file_offset, File::SeekOrigin::Begin);
+    if (!host_file.file.WriteBytes(ptr, count))
+      return ResultCode::AccessDenied;
+  }
 
   handle->file_offset += count;
   return count;
@@ -12,6 +12,8 @@
 #include <mbedtls/config.h>
 #include <mbedtls/md.h>
 #include <mutex>
+#include <optional>
+#include <span>
 #include <sstream>
 #include <thread>
 #include <utility>
@@ -28,6 +30,7 @@
 #include "Common/FileUtil.h"
 #include "Common/Hash.h"
 #include "Common/IOFile.h"
+#include "Common/MappedFile.h"
 #include "Common/MsgHandler.h"
 #include "Common/NandPaths.h"
 #include "Common/StringUtil.h"
@@ -84,6 +87,9 @@ namespace Movie
 using namespace WiimoteCommon;
 using namespace WiimoteEmu;
 
+// How often a recording is flushed to disk.
+constexpr u64 INPUT_FLUSH_FRAMES = 60;
+
 static bool IsMovieHeader(const std::array<u8, 4>& magic)
 {
   return magic[0] == 'D' && magic[1] == 'T' && magic[2] == 'M' && magic[3] == 0x1A;
@@ -193,6 +199,15 @@ void MovieManager::FrameUpdate()
   {
     m_total_frames = m_current_frame;
     m_total_lag_count = m_current_lag_count;
+
+    // Keep the recording on disk up to date, so that it isn't lost if Dolphin crashes.
+    if (m_current_frame % INPUT_FLUSH_FRAMES == 0)
+      m_input.Flush(CreateHeader());
+  }
+  else if (IsPlayingInput() && m_checkpoint_interval != 0 &&
+           m_current_frame % m_checkpoint_interval == 0)
+  {
+    m_checkpoints.push_back({m_current_frame, HashEmulatedMemory(m_system)});
   }
 
   m_polled = false;
@@ -276,6 +291,21 @@ void MovieManager::SetReadOnly(bool bEnabled)
   m_read_only = bEnabled;
 }
 
+void MovieManager::SetCheckpointInterval(u64 frames)
+{
+  m_checkpoint_interval = frames;
+}
+
+const std::vector<Checkpoint>& MovieManager::GetCheckpoints() const
+{
+  return m_checkpoints;
+}
+
+void MovieManager::SetPlaybackEndedCallback(std::function<void(bool reached_end)> callback)
+{
+  m_playback_ended_callback = std::move(callback);
+}
+
 bool MovieManager::IsRecordingInput() const
 {
   return (m_play_mode == PlayMode::Recording);
@@ -559,7 +589,12 @@ bool MovieManager::BeginRecordingInput(const ControllerTypeArray& controllers,
 
     m_play_mode = PlayMode::Recording;
     m_author = Config::Get(Config::MAIN_MOVIE_MOVIE_AUTHOR);
-    m_temp_input.clear();
+    m_input.Clear();
+    for (const std::string& path : m_input.FindLeftoverWorkFiles())
+    {
+      Core::DisplayMessage(
+          fmt::format("{} may hold an unsaved recording from a previous session", path), 5000);
+    }
 
     m_current_byte = 0;
 
@@ -851,8 +886,12 @@ void MovieManager::RecordInput(const GCPadStatus* PadStatus, int controllerID)
 
   CheckPadStatus(PadStatus, controllerID);
 
-  m_temp_input.resize(m_current_byte + sizeof(ControllerState));
-  memcpy(&m_temp_input[m_current_byte], &m_pad_state, sizeof(ControllerState));
+  if (!m_input.Write(m_current_byte, &m_pad_state, sizeof(ControllerState)))
+  {
+    PanicAlertFmtT("Failed to record input, movie recording stopping...");
+    EndPlayInput(false);
+    return;
+  }
   m_current_byte += sizeof(ControllerState);
 }
 
@@ -877,10 +916,13 @@ void MovieManager::RecordWiimote(int wiimote, const u8* data, u8 size)
     return;
 
   InputUpdate();
-  m_temp_input.resize(m_current_byte + size + 1);
-  m_temp_input[m_current_byte++] = size;
-  memcpy(&m_temp_input[m_current_byte], data, size);
-  m_current_byte += size;
+  if (!m_input.Write(m_current_byte, &size, 1) || !m_input.Write(m_current_byte + 1, data, size))
+  {
+    PanicAlertFmtT("Failed to record input, movie recording stopping...");
+    EndPlayInput(false);
+    return;
+  }
+  m_current_byte += 1 + size;
 }
 
 // NOTE: EmuThread / Host Thread
@@ -938,6 +980,15 @@ bool MovieManager::PlayInput(const std::string& movie_path,
     PanicAlertFmtT("Invalid recording file");
     return false;
   }
+  recording_file.Close();
+
+  // The input is read straight from the file rather than loaded into memory.
+  if (!m_input.Map(movie_path))
+  {
+    PanicAlertFmtT("Failed to read {0}", movie_path);
+    return false;
+  }
+  m_current_byte = 0;
 
   ReadHeader();
 
@@ -951,6 +1002,7 @@ bool MovieManager::PlayInput(const std::string& movie_path,
   m_current_frame = 0;
   m_current_lag_count = 0;
   m_current_input_count = 0;
+  m_checkpoints.clear();
 
   m_play_mode = PlayMode::Playing;
 
@@ -959,11 +1011,6 @@ bool MovieManager::PlayInput(const std::string& movie_path,
 
   Core::UpdateWantDeterminism(m_system);
 
-  m_temp_input.resize(recording_file.GetSize() - 256);
-  recording_file.ReadBytes(m_temp_input.data(), m_temp_input.size());
-  m_current_byte = 0;
-  recording_file.Close();
-
   // Load savestate (and skip to frame data)
   if (m_temp_header.bFromSaveState && savestate_path)
   {
@@ -1050,42 +1097,47 @@ void MovieManager::LoadInput(const std::string& movie_path)
     afterEnd = true;
   }
 
-  if (!m_read_only || m_temp_input.empty())
+  if (!m_read_only || m_input.IsEmpty())
   {
     m_total_frames = m_temp_header.frameCount;
     m_total_lag_count = m_temp_header.lagCount;
     m_total_input_count = m_temp_header.inputCount;
     m_total_tick_count = m_tick_count_at_last_input = m_temp_header.tickCount;
 
-    m_temp_input.resize(static_cast<size_t>(totalSavedBytes));
-    t_record.ReadBytes(m_temp_input.data(), m_temp_input.size());
+    t_record.Flush();
+    if (!m_input.Load(movie_path))
+    {
+      PanicAlertFmtT("Failed to read {0}", movie_path);
+      EndPlayInput(false);
+      return;
+    }
   }
   else if (m_current_byte > 0)
   {
     if (m_current_byte > totalSavedBytes)
     {
     }
-    else if (m_current_byte > m_temp_input.size())
+    else if (m_current_byte > m_input.GetSize())
     {
       afterEnd = true;
       PanicAlertFmtT(
           "Warning: You loaded a save that's after the end of the current movie. (byte {0} "
           "> {1}) (input {2} > {3}). You should load another save before continuing, or load "
           "this state with read-only mode off.",
-          m_current_byte + 256, m_temp_input.size() + 256, m_current_input_count,
+          m_current_byte + 256, m_input.GetSize() + 256, m_current_input_count,
           m_total_input_count);
     }
-    else if (m_current_byte > 0 && !m_temp_input.empty())
+    else if (m_current_byte > 0 && !m_input.IsEmpty())
     {
       // verify identical from movie start to the save's current frame
-      std::vector<u8> movInput(m_current_byte);
-      t_record.ReadArray(movInput.data(), movInput.size());
-
-      const auto result = std::mismatch(movInput.begin(), movInput.end(), m_temp_input.begin());
+      const File::MappedFile saved_movie(movie_path);
+      std::span<const u8> movInput;
+      if (saved_movie.IsOpen())
+        movInput = saved_movie.GetSpan().subspan(sizeof(DTMHeader), m_current_byte);
 
-      if (result.first != movInput.end())
+      if (const std::optional<u64> mismatch = m_input.FindMismatch(movInput))
       {
-        const ptrdiff_t mismatch_index = std::distance(movInput.begin(), result.first);
+        const ptrdiff_t mismatch_index = static_cast<ptrdiff_t>(*mismatch);
 
         // this is a "you did something wrong" alert for the user's benefit.
         // we'll try to say what's going on in excruciating detail, otherwise the user might not
@@ -1100,14 +1152,14 @@ void MovieManager::LoadInput(const std::string& movie_path)
                          "read-only mode off. Otherwise you'll probably get a desync.",
                          byte_offset, byte_offset);
 
-          std::copy(movInput.begin(), movInput.end(), m_temp_input.begin());
+          if (!m_input.Patch(0, movInput))
+            PanicAlertFmtT("Failed to update the movie input.");
         }
         else
         {
           const ptrdiff_t frame = mismatch_index / sizeof(ControllerState);
           ControllerState curPadState;
-          memcpy(&curPadState, &m_temp_input[frame * sizeof(ControllerState)],
-                 sizeof(ControllerState));
+          m_input.Read(frame * sizeof(ControllerState), &curPadState, sizeof(ControllerState));
           ControllerState movPadState;
           memcpy(&movPadState, &movInput[frame * sizeof(ControllerState)], sizeof(ControllerState));
           PanicAlertFmtT(
@@ -1174,11 +1226,11 @@ void MovieManager::LoadInput(const std::string& movie_path)
 // NOTE: CPU Thread
 void MovieManager::CheckInputEnd()
 {
-  if (m_current_byte >= m_temp_input.size() ||
+  if (m_current_byte >= m_input.GetSize() ||
       (m_system.GetCoreTiming().GetTicks() > m_total_tick_count &&
        !IsRecordingInputFromSaveState()))
   {
-    EndPlayInput(!m_read_only);
+    EndPlayInput(!m_read_only, true);
   }
 }
 
@@ -1187,18 +1239,16 @@ void MovieManager::PlayController(GCPadStatus* PadStatus, int controllerID)
 {
   // Correct playback is entirely dependent on the emulator polling the controllers
   // in the same order done during recording
-  if (!IsPlayingInput() || !IsUsingPad(controllerID) || m_temp_input.empty())
+  if (!IsPlayingInput() || !IsUsingPad(controllerID) || m_input.IsEmpty())
     return;
 
-  if (m_current_byte + sizeof(ControllerState) > m_temp_input.size())
+  if (!m_input.Read(m_current_byte, &m_pad_state, sizeof(ControllerState)))
   {
     PanicAlertFmtT("Premature movie end in PlayController. {0} + {1} > {2}", m_current_byte,
-                   sizeof(ControllerState), m_temp_input.size());
+                   sizeof(ControllerState), m_input.GetSize());
     EndPlayInput(!m_read_only);
     return;
   }
-
-  memcpy(&m_pad_state, &m_temp_input[m_current_byte], sizeof(ControllerState));
   m_current_byte += sizeof(ControllerState);
 
   PadStatus->isConnected = m_pad_state.is_connected;
@@ -1278,19 +1328,19 @@ void MovieManager::PlayController(GCPadStatus* PadStatus, int controllerID)
 bool MovieManager::PlayWiimote(int wiimote, WiimoteCommon::DataReportBuilder& rpt,
                                ExtensionNumber ext, const EncryptionKey& key)
 {
-  if (!IsPlayingInput() || !IsUsingWiimote(wiimote) || m_temp_input.empty())
+  if (!IsPlayingInput() || !IsUsingWiimote(wiimote) || m_input.IsEmpty())
     return false;
 
-  if (m_current_byte > m_temp_input.size())
+  u8 sizeInMovie;
+  if (!m_input.Read(m_current_byte, &sizeInMovie, 1))
   {
     PanicAlertFmtT("Premature movie end in PlayWiimote. {0} > {1}", m_current_byte,
-                   m_temp_input.size());
+                   m_input.GetSize());
     EndPlayInput(!m_read_only);
     return false;
   }
 
   const u8 size = rpt.GetDataSize();
-  const u8 sizeInMovie = m_temp_input[m_current_byte];
 
   if (size != sizeInMovie)
   {
@@ -1307,15 +1357,13 @@ bool MovieManager::PlayWiimote(int wiimote, WiimoteCommon::DataReportBuilder& rp
 
   m_current_byte++;
 
-  if (m_current_byte + size > m_temp_input.size())
+  if (!m_input.Read(m_current_byte, rpt.GetDataPtr(), size))
   {
     PanicAlertFmtT("Premature movie end in PlayWiimote. {0} + {1} > {2}", m_current_byte, size,
-                   m_temp_input.size());
+                   m_input.GetSize());
     EndPlayInput(!m_read_only);
     return false;
   }
-
-  memcpy(rpt.GetDataPtr(), &m_temp_input[m_current_byte], size);
   m_current_byte += size;
 
   m_current_input_count++;
@@ -1325,8 +1373,9 @@ bool MovieManager::PlayWiimote(int wiimote, WiimoteCommon::DataReportBuilder& rp
 }
 
 // NOTE: Host / EmuThread / CPU Thread
-void MovieManager::EndPlayInput(bool cont)
+void MovieManager::EndPlayInput(bool cont, bool reached_end)
 {
+  const bool was_playing = IsPlayingInput();
   if (cont)
   {
     // If !IsMovieActive(), changing m_play_mode requires calling UpdateWantDeterminism
@@ -1356,13 +1405,13 @@ void MovieManager::EndPlayInput(bool cont)
 
     Core::QueueHostJob([](Core::System& system) { Core::UpdateWantDeterminism(system); });
   }
+
+  if (was_playing && m_playback_ended_callback)
+    m_playback_ended_callback(reached_end);
 }
 
-// NOTE: Save State + Host Thread
-void MovieManager::SaveRecording(const std::string& filename)
+DTMHeader MovieManager::CreateHeader() const
 {
-  File::IOFile save_record(filename, "wb");
-  // Create the real header now and write it
   DTMHeader header;
   memset(&header, 0, sizeof(DTMHeader));
 
@@ -1409,9 +1458,13 @@ void MovieManager::SaveRecording(const std::string& filename)
   header.uniqueID = 0;
   // header.audioEmulator;
 
-  save_record.WriteArray(&header, 1);
+  return header;
+}
 
-  bool success = save_record.WriteBytes(m_temp_input.data(), m_temp_input.size());
+// NOTE: Save State + Host Thread
+void MovieManager::SaveRecording(const std::string& filename)
+{
+  bool success = m_input.SaveAs(filename, CreateHeader());
 
   if (success && m_recording_from_save_state)
   {
@@ -1551,6 +1604,6 @@ void MovieManager::GetMD5()
 void MovieManager::Shutdown()
 {
   m_current_input_count = m_total_input_count = m_total_frames = m_tick_count_at_last_input = 0;
-  m_temp_input.clear();
+  m_input.Clear();
 }
 }  // namespace Movie
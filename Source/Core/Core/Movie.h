@@ -5,6 +5,7 @@
 
 #include <array>
 #include <cstring>
+#include <functional>
 #include <mutex>
 #include <optional>
 #include <string>
@@ -12,6 +13,8 @@
 #include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Core/MovieCheckpoints.h"
+#include "Core/MovieInputStorage.h"
 
 struct BootParameters;
 
@@ -202,6 +205,14 @@ public:
 
   void SetReadOnly(bool bEnabled);
 
+  // Hashes emulated memory every this many frames of playback. 0 disables checkpoints.
+  void SetCheckpointInterval(u64 frames);
+  // The checkpoints of the current or last playback. Only call while the CPU thread isn't running.
+  const std::vector<Checkpoint>& GetCheckpoints() const;
+  // Called on the thread that ends playback, which is usually the CPU thread. reached_end is false
+  // if playback was aborted before the end of the movie, e.g. because it is corrupted.
+  void SetPlaybackEndedCallback(std::function<void(bool reached_end)> callback);
+
   bool BeginRecordingInput(const ControllerTypeArray& controllers,
                            const WiimoteEnabledArray& wiimotes);
   void RecordInput(const GCPadStatus* PadStatus, int controllerID);
@@ -213,7 +224,7 @@ public:
   void PlayController(GCPadStatus* PadStatus, int controllerID);
   bool PlayWiimote(int wiimote, WiimoteCommon::DataReportBuilder& rpt,
                    WiimoteEmu::ExtensionNumber ext, const WiimoteEmu::EncryptionKey& key);
-  void EndPlayInput(bool cont);
+  void EndPlayInput(bool cont, bool reached_end = false);
   void SaveRecording(const std::string& filename);
   void DoState(PointerWrap& p);
   void Shutdown();
@@ -228,6 +239,7 @@ public:
 private:
   void GetSettings();
   void CheckInputEnd();
+  DTMHeader CreateHeader() const;
 
   void CheckMD5();
   void GetMD5();
@@ -240,7 +252,7 @@ private:
   std::array<bool, 4> m_wiimotes{};
   ControllerState m_pad_state{};
   DTMHeader m_temp_header{};
-  std::vector<u8> m_temp_input;
+  InputStorage m_input;
   u64 m_current_byte = 0;
   u64 m_current_frame = 0;
   u64 m_total_frames = 0;  // VI
@@ -265,6 +277,10 @@ private:
   u32 m_dsp_irom_hash = 0;
   u32 m_dsp_coef_hash = 0;
 
+  u64 m_checkpoint_interval = 0;
+  std::vector<Checkpoint> m_checkpoints;
+  std::function<void(bool reached_end)> m_playback_ended_callback;
+
   bool m_recording_from_save_state = false;
   bool m_polled = false;
 
@@ -0,0 +1,99 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "Core/MovieCheckpoints.h"
+
+#include <algorithm>
+
+#include <fmt/format.h>
+#include <picojson.h>
+#include <xxhash.h>
+
+#include "Common/JsonUtil.h"
+#include "Common/Logging/Log.h"
+#include "Common/StringUtil.h"
+#include "Core/HW/Memmap.h"
+#include "Core/System.h"
+
+namespace Movie
+{
+u64 HashEmulatedMemory(Core::System& system)
+{
+  auto& memory = system.GetMemory();
+  u64 hash = XXH3_64bits(memory.GetRAM(), memory.GetRamSizeReal());
+  if (memory.GetEXRAM())
+    hash = XXH3_64bits_withSeed(memory.GetEXRAM(), memory.GetExRamSizeReal(), hash);
+  return hash;
+}
+
+std::string GetCheckpointsPath(const std::string& movie_path)
+{
+  return movie_path + ".checkpoints.json";
+}
+
+bool SaveCheckpoints(const std::string& path, std::span<const Checkpoint> checkpoints)
+{
+  picojson::array checkpoints_json;
+  checkpoints_json.reserve(checkpoints.size());
+  for (const Checkpoint& checkpoint : checkpoints)
+  {
+    picojson::object checkpoint_json;
+    checkpoint_json.emplace("frame", picojson::value(static_cast<double>(checkpoint.frame)));
+    // Doubles can't hold every 64-bit hash.
+    checkpoint_json.emplace("hash", picojson::value(fmt::format("{:016x}", checkpoint.hash)));
+    checkpoints_json.emplace_back(std::move(checkpoint_json));
+  }
+
+  picojson::object root;
+  root.emplace("checkpoints", picojson::value(std::move(checkpoints_json)));
+  return JsonToFile(path, picojson::value(std::move(root)), true);
+}
+
+std::optional<std::vector<Checkpoint>> LoadCheckpoints(const std::string& path)
+{
+  picojson::value root;
+  std::string error;
+  if (!JsonFromFile(path, &root, &error))
+  {
+    WARN_LOG_FMT(CORE, "Failed to load movie checkpoints from {}: {}", path, error);
+    return std::nullopt;
+  }
+
+  if (!root.is<picojson::object>() || !root.get("checkpoints").is<picojson::array>())
+    return std::nullopt;
+
+  std::vector<Checkpoint> checkpoints;
+  for (const picojson::value& value : root.get("checkpoints").get<picojson::array>())
+  {
+    if (!value.is<picojson::object>())
+      return std::nullopt;
+
+    const picojson::object& object = value.get<picojson::object>();
+    const std::optional<u64> frame = ReadNumericFromJson<u64>(object, "frame");
+    const std::optional<std::string> hash_string = ReadStringFromJson(object, "hash");
+    u64 hash;
+    if (!frame || !hash_string || !TryParse(*hash_string, &hash, 16))
+      return std::nullopt;
+
+    checkpoints.push_back({*frame, hash});
+  }
+  return checkpoints;
+}
+
+std::optional<Checkpoint> FindMismatchedCheckpoint(std::span<const Checkpoint> expected,
+                                                   std::span<const Checkpoint> actual,
+                                                   u64 last_frame)
+{
+  // Both lists are in frame order.
+  auto it = actual.begin();
+  for (const Checkpoint& checkpoint : expected)
+  {
+    if (checkpoint.frame > last_frame)
+      break;
+    it = std::ranges::lower_bound(it, actual.end(), checkpoint.frame, {}, &Checkpoint::frame);
+    if (it == actual.end() || *it != checkpoint)
+      return checkpoint;
+  }
+  return std::nullopt;
+}
+}  // namespace Movie
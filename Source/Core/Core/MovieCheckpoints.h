@@ -0,0 +1,45 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace Core
+{
+class System;
+}
+
+namespace Movie
+{
+// A hash of emulated memory at the end of a frame of movie playback. Replaying a movie on a known
+// good build and saving its checkpoints makes it possible to tell whether later builds still
+// replay it the same way, and from which frame on they don't.
+struct Checkpoint
+{
+  u64 frame = 0;
+  u64 hash = 0;
+
+  bool operator==(const Checkpoint&) const = default;
+};
+
+// Called on the CPU thread.
+u64 HashEmulatedMemory(Core::System& system);
+
+// The checkpoints of a movie are stored next to it, like the savestate it starts from.
+std::string GetCheckpointsPath(const std::string& movie_path);
+bool SaveCheckpoints(const std::string& path, std::span<const Checkpoint> checkpoints);
+std::optional<std::vector<Checkpoint>> LoadCheckpoints(const std::string& path);
+
+// Returns the first expected checkpoint up to last_frame, the last frame that was replayed, which
+// was either reached with a different hash or has no actual checkpoint at all. Actual checkpoints
+// that weren't expected are ignored.
+std::optional<Checkpoint> FindMismatchedCheckpoint(std::span<const Checkpoint> expected,
+                                                   std::span<const Checkpoint> actual,
+                                                   u64 last_frame);
+}  // namespace Movie
@@ -0,0 +1,368 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "Core/MovieInputStorage.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "Common/CommonPaths.h"
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+#include "Core/Movie.h"
+
+namespace Movie
+{
+namespace
+{
+constexpr u64 HEADER_SIZE = sizeof(DTMHeader);
+constexpr size_t FLUSH_SIZE = 64 * 1024;
+constexpr size_t READ_CACHE_SIZE = 64 * 1024;
+constexpr size_t COPY_CHUNK_SIZE = 1024 * 1024;
+constexpr u32 MAX_WORK_FILES = 64;
+
+std::string GetWorkFilePath(u32 index)
+{
+  return File::GetUserPath(D_STATESAVES_IDX) + fmt::format("recording.{}.dtm", index);
+}
+}  // namespace
+
+InputStorage::InputStorage(std::string work_file_path) : m_work_file_path(std::move(work_file_path))
+{
+}
+
+InputStorage::~InputStorage()
+{
+  Clear();
+  // A generated work file is only kept if Dolphin doesn't get to exit normally.
+  if (m_delete_work_file)
+    File::Delete(m_work_file_path);
+}
+
+bool InputStorage::Map(const std::string& movie_path)
+{
+  Clear();
+
+  if (!m_mapping.Open(movie_path) || m_mapping.GetSize() < HEADER_SIZE)
+  {
+    m_mapping.Close();
+    return false;
+  }
+
+  m_mapped_path = movie_path;
+  return true;
+}
+
+bool InputStorage::Load(const std::string& movie_path)
+{
+  Clear();
+
+  File::IOFile movie(movie_path, "rb");
+  std::array<u8, HEADER_SIZE> header;
+  // The header is written over the placeholder that OpenWorkFile leaves.
+  if (!movie.ReadArray(&header) || !OpenWorkFile() ||
+      !m_work_file.Seek(0, File::SeekOrigin::Begin) || !m_work_file.WriteArray(header))
+  {
+    return false;
+  }
+
+  std::vector<u8> buffer(COPY_CHUNK_SIZE);
+  for (u64 remaining = movie.GetSize() - HEADER_SIZE; remaining != 0;)
+  {
+    const size_t size = static_cast<size_t>(std::min<u64>(remaining, buffer.size()));
+    if (!movie.ReadBytes(buffer.data(), size) || !m_work_file.WriteBytes(buffer.data(), size))
+    {
+      ERROR_LOG_FMT(CORE, "Failed to copy the input of {}", movie_path);
+      Clear();
+      return false;
+    }
+    m_flushed_size += size;
+    remaining -= size;
+  }
+
+  return true;
+}
+
+void InputStorage::Clear()
+{
+  m_mapping.Close();
+  m_mapped_path.clear();
+  m_work_file.Close();
+  m_flushed_size = 0;
+  m_pending.clear();
+  m_read_cache.clear();
+}
+
+u64 InputStorage::GetSize() const
+{
+  if (m_mapping.IsOpen())
+    return m_mapping.GetSize() - HEADER_SIZE;
+  return m_flushed_size + m_pending.size();
+}
+
+bool InputStorage::Read(u64 offset, void* data, size_t size)
+{
+  if (offset + size > GetSize())
+    return false;
+
+  if (m_mapping.IsOpen())
+  {
+    std::memcpy(data, m_mapping.GetData() + HEADER_SIZE + offset, size);
+    return true;
+  }
+
+  u8* out = static_cast<u8*>(data);
+  if (offset < m_flushed_size)
+  {
+    const size_t flushed = static_cast<size_t>(std::min<u64>(size, m_flushed_size - offset));
+    if (!ReadFromWorkFile(offset, out, flushed))
+      return false;
+    out += flushed;
+    offset += flushed;
+    size -= flushed;
+  }
+  std::copy_n(m_pending.begin() + (offset - m_flushed_size), size, out);
+  return true;
+}
+
+bool InputStorage::Write(u64 offset, const void* data, size_t size)
+{
+  // Input can't be recorded past the end, as that would leave a gap.
+  if (offset > GetSize() || (m_mapping.IsOpen() && !MoveToWorkFile()))
+    return false;
+
+  if (offset < m_flushed_size)
+  {
+    // Recording after loading an earlier savestate discards the input that followed it.
+    m_work_file.Flush();
+    m_work_file.Resize(HEADER_SIZE + offset);
+    m_flushed_size = offset;
+    m_pending.clear();
+    m_read_cache.clear();
+  }
+
+  m_pending.resize(offset - m_flushed_size);
+  const u8* in = static_cast<const u8*>(data);
+  m_pending.insert(m_pending.end(), in, in + size);
+
+  if (m_pending.size() >= FLUSH_SIZE)
+    FlushPendingInput();
+  return true;
+}
+
+bool InputStorage::Patch(u64 offset, std::span<const u8> data)
+{
+  if (offset > GetSize() || (m_mapping.IsOpen() && !MoveToWorkFile()))
+    return false;
+
+  data = data.first(static_cast<size_t>(std::min<u64>(data.size(), GetSize() - offset)));
+  if (offset < m_flushed_size)
+  {
+    const size_t flushed = static_cast<size_t>(std::min<u64>(data.size(), m_flushed_size - offset));
+    m_work_file.Seek(HEADER_SIZE + offset, File::SeekOrigin::Begin);
+    m_work_file.WriteBytes(data.data(), flushed);
+    m_read_cache.clear();
+    data = data.subspan(flushed);
+    offset += flushed;
+  }
+  std::ranges::copy(data, m_pending.begin() + (offset - m_flushed_size));
+  return true;
+}
+
+std::optional<u64> InputStorage::FindMismatch(std::span<const u8> input)
+{
+  if (m_mapping.IsOpen())
+  {
+    const std::span<const u8> own = m_mapping.GetSpan().subspan(HEADER_SIZE);
+    const auto result = std::ranges::mismatch(input, own);
+    if (result.in1 == input.end())
+      return std::nullopt;
+    return static_cast<u64>(result.in1 - input.begin());
+  }
+
+  std::vector<u8> buffer(std::min(input.size(), COPY_CHUNK_SIZE));
+  for (u64 offset = 0; offset < input.size(); offset += buffer.size())
+  {
+    const size_t size = static_cast<size_t>(std::min<u64>(buffer.size(), input.size() - offset));
+    if (!Read(offset, buffer.data(), size))
+      return std::min<u64>(offset, GetSize());
+
+    const auto chunk = input.subspan(offset, size);
+    const auto result = std::mismatch(chunk.begin(), chunk.end(), buffer.begin());
+    if (result.first != chunk.end())
+      return offset + (result.first - chunk.begin());
+  }
+  return std::nullopt;
+}
+
+void InputStorage::Flush(const DTMHeader& header)
+{
+  if (m_mapping.IsOpen() || (!m_work_file.IsOpen() && !OpenWorkFile()))
+    return;
+
+  FlushPendingInput();
+  m_work_file.Seek(0, File::SeekOrigin::Begin);
+  m_work_file.WriteArray(&header, 1);
+  m_work_file.Flush();
+}
+
+bool InputStorage::SaveAs(const std::string& movie_path, const DTMHeader& header)
+{
+  // The mapped file can't be replaced on all systems, so it has to be copied away first.
+  if (m_mapping.IsOpen() && movie_path == m_mapped_path && !MoveToWorkFile())
+    return false;
+
+  // Write to a new file, as truncating a file that is mapped would break the mapping.
+  const std::string temp_path = File::GetTempFilenameForAtomicWrite(movie_path);
+  {
+    File::IOFile movie(temp_path, "wb");
+    if (!movie.WriteArray(&header, 1))
+      return false;
+
+    if (m_mapping.IsOpen())
+    {
+      if (!movie.WriteBytes(m_mapping.GetData() + HEADER_SIZE, GetSize()))
+        return false;
+    }
+    else
+    {
+      if (m_flushed_size != 0)
+      {
+        m_work_file.Seek(HEADER_SIZE, File::SeekOrigin::Begin);
+        std::vector<u8> buffer(COPY_CHUNK_SIZE);
+        for (u64 remaining = m_flushed_size; remaining != 0;)
+        {
+          const size_t size = static_cast<size_t>(std::min<u64>(remaining, buffer.size()));
+          if (!m_work_file.ReadBytes(buffer.data(), size) ||
+              !movie.WriteBytes(buffer.data(), size))
+          {
+            return false;
+          }
+          remaining -= size;
+        }
+      }
+
+      // Input that hasn't reached the work file yet, which may not even exist.
+      if (!movie.WriteBytes(m_pending.data(), m_pending.size()))
+        return false;
+    }
+
+    if (!movie.Close())
+      return false;
+  }
+
+  return File::Rename(temp_path, movie_path);
+}
+
+std::vector<std::string> InputStorage::FindLeftoverWorkFiles() const
+{
+  std::vector<std::string> paths;
+  for (u32 i = 0; i < MAX_WORK_FILES; ++i)
+  {
+    std::string path = GetWorkFilePath(i);
+    if (path != m_work_file_path && File::Exists(path))
+      paths.push_back(std::move(path));
+  }
+  return paths;
+}
+
+bool InputStorage::OpenWorkFile()
+{
+  // The header is written on the first flush.
+  const std::array<u8, HEADER_SIZE> header{};
+
+  // Several instances of Dolphin may be recording at once, so each of them claims the first work
+  // file that doesn't exist yet. Files that are left over from a crash stay claimed until the user
+  // deletes them, so that their input can be recovered.
+  if (m_work_file_path.empty())
+  {
+    for (u32 i = 0; i < MAX_WORK_FILES; ++i)
+    {
+      const std::string path = GetWorkFilePath(i);
+      if (m_work_file.Open(path, "w+bx"))
+      {
+        m_work_file_path = path;
+        m_delete_work_file = true;
+        break;
+      }
+    }
+  }
+  else
+  {
+    m_work_file.Open(m_work_file_path, "w+b");
+  }
+
+  if (m_work_file_path.empty())
+  {
+    ERROR_LOG_FMT(CORE, "Failed to create a work file in {}", File::GetUserPath(D_STATESAVES_IDX));
+    return false;
+  }
+  if (!m_work_file.IsOpen() || !m_work_file.WriteArray(header))
+  {
+    ERROR_LOG_FMT(CORE, "Failed to create {}", m_work_file_path);
+    m_work_file.Close();
+    return false;
+  }
+  return true;
+}
+
+bool InputStorage::MoveToWorkFile()
+{
+  // The mapping is only given up once its input is safe in the work file.
+  if (!OpenWorkFile() || !m_work_file.Seek(0, File::SeekOrigin::Begin) ||
+      !m_work_file.WriteBytes(m_mapping.GetData(), m_mapping.GetSize()))
+  {
+    ERROR_LOG_FMT(CORE, "Failed to copy the input of {}", m_mapped_path);
+    m_work_file.Close();
+    return false;
+  }
+
+  // The mapped movie comes with its own header, which replaces the placeholder.
+  m_flushed_size = m_mapping.GetSize() - HEADER_SIZE;
+  m_mapping.Close();
+  m_mapped_path.clear();
+  return true;
+}
+
+void InputStorage::FlushPendingInput()
+{
+  if (m_pending.empty() || (!m_work_file.IsOpen() && !OpenWorkFile()))
+    return;
+
+  m_work_file.Seek(HEADER_SIZE + m_flushed_size, File::SeekOrigin::Begin);
+  m_work_file.WriteBytes(m_pending.data(), m_pending.size());
+  m_flushed_size += m_pending.size();
+  m_pending.clear();
+}
+
+bool InputStorage::ReadFromWorkFile(u64 offset, u8* data, size_t size)
+{
+  while (size != 0)
+  {
+    if (offset < m_read_cache_offset || offset >= m_read_cache_offset + m_read_cache.size())
+    {
+      const u64 cache_size = std::min<u64>(READ_CACHE_SIZE, m_flushed_size - offset);
+      m_read_cache.resize(static_cast<size_t>(cache_size));
+      m_read_cache_offset = offset;
+      if (!m_work_file.Seek(HEADER_SIZE + offset, File::SeekOrigin::Begin) ||
+          !m_work_file.ReadBytes(m_read_cache.data(), m_read_cache.size()))
+      {
+        m_read_cache.clear();
+        return false;
+      }
+    }
+
+    const size_t cache_offset = static_cast<size_t>(offset - m_read_cache_offset);
+    const size_t count = std::min(size, m_read_cache.size() - cache_offset);
+    std::copy_n(m_read_cache.begin() + cache_offset, count, data);
+    data += count;
+    offset += count;
+    size -= count;
+  }
+  return true;
+}
+}  // namespace Movie
@@ -0,0 +1,86 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/IOFile.h"
+#include "Common/MappedFile.h"
+
+namespace Movie
+{
+struct DTMHeader;
+
+// The input of a movie, kept in files rather than in memory so that long recordings neither use a
+// lot of memory nor get lost when Dolphin crashes.
+//
+// A movie that is only played back is read straight from a memory mapping of its DTM file. As soon
+// as input gets recorded, it is moved to a work file, which is a valid DTM after every Flush.
+//
+// Nothing in Dolphin truncates a movie while it's mapped, as SaveAs writes a new file and renames it
+// over the old one. Another program that truncates it anyway makes reading the input past the new
+// end raise SIGBUS on POSIX systems, which is not caught. Windows refuses to truncate a mapped file.
+class InputStorage
+{
+public:
+  // By default, the work file is the first recording.<n>.dtm in the savestate directory that
+  // doesn't exist yet, and it is deleted along with the InputStorage.
+  explicit InputStorage(std::string work_file_path = {});
+  ~InputStorage();
+
+  InputStorage(const InputStorage&) = delete;
+  InputStorage& operator=(const InputStorage&) = delete;
+
+  bool Map(const std::string& movie_path);
+  // Copies the input of a DTM file into the work file.
+  bool Load(const std::string& movie_path);
+  void Clear();
+
+  u64 GetSize() const;
+  bool IsEmpty() const { return GetSize() == 0; }
+
+  bool Read(u64 offset, void* data, size_t size);
+  // Replaces all input from offset on. Fails without changing anything if offset is past the end,
+  // or if the mapped input can't be moved to the work file.
+  bool Write(u64 offset, const void* data, size_t size);
+  // Overwrites input without discarding the input that follows it.
+  bool Patch(u64 offset, std::span<const u8> data);
+  // Returns the first offset at which the input differs from the given input.
+  std::optional<u64> FindMismatch(std::span<const u8> input);
+
+  // Writes the header and all pending input to the work file.
+  void Flush(const DTMHeader& header);
+  bool SaveAs(const std::string& movie_path, const DTMHeader& header);
+
+  // Default work files other than this one's. They either belong to another instance of Dolphin
+  // or hold the input of a recording that was never saved, and can be played back as movies.
+  std::vector<std::string> FindLeftoverWorkFiles() const;
+
+private:
+  bool OpenWorkFile();
+  bool MoveToWorkFile();
+  void FlushPendingInput();
+  bool ReadFromWorkFile(u64 offset, u8* data, size_t size);
+
+  std::string m_work_file_path;
+  bool m_delete_work_file = false;
+
+  File::MappedFile m_mapping;
+  std::string m_mapped_path;
+
+  File::IOFile m_work_file;
+  // Input that has been written to the work file.
+  u64 m_flushed_size = 0;
+  // Input that follows the flushed input, written in batches.
+  std::vector<u8> m_pending;
+
+  std::vector<u8> m_read_cache;
+  u64 m_read_cache_offset = 0;
+};
+}  // namespace Movie
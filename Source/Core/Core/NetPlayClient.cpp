@@ -10,6 +10,7 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <span>
 #include <thread>
 #include <tuple>
@@ -449,6 +450,10 @@ void NetPlayClient::OnData(sf::Packet& packet)
     OnDesyncDetected(packet);
     break;
 
+  case MessageID::DesyncBisect:
+    OnDesyncBisect(packet);
+    break;
+
   case MessageID::SyncSaveData:
     OnSyncSaveData(packet);
     break;
@@ -545,23 +550,53 @@ void NetPlayClient::OnChunkedDataStart(sf::Packet& packet)
   std::string title;
   packet >> title;
   const u64 data_size = Common::PacketReadU64(packet);
+  Common::SHA1::Digest digest;
+  for (u8& byte : digest)
+    packet >> byte;
+  Common::SHA1::Digest base_digest;
+  for (u8& byte : base_digest)
+    packet >> byte;
 
   INFO_LOG_FMT(NETPLAY, "Starting data chunk {}.", cid);
 
-  m_chunked_data_receive_queue.emplace(cid, sf::Packet{});
+  ChunkedDataStatus status = ChunkedDataStatus::Missing;
+  const auto history = m_chunked_data_history.find(title);
+  if (history != m_chunked_data_history.end())
+  {
+    if (history->second.digest == digest)
+      status = ChunkedDataStatus::HaveData;
+    else if (history->second.digest == base_digest)
+      status = ChunkedDataStatus::HaveBase;
+  }
+
+  sf::Packet negotiate_packet;
+  negotiate_packet << MessageID::ChunkedDataNegotiate;
+  negotiate_packet << cid << status;
+  Send(negotiate_packet, CHUNKED_DATA_CHANNEL);
 
   std::vector<int> players;
   players.push_back(m_local_player->pid);
   m_dialog->ShowChunkedProgressDialog(title, data_size, players);
+
+  if (status == ChunkedDataStatus::HaveData)
+  {
+    INFO_LOG_FMT(NETPLAY, "Data chunk {} is unchanged, using the previous data.", cid);
+    FinishChunkedData(cid, title, digest, history->second.data);
+    return;
+  }
+
+  m_chunked_data_receive_queue.emplace(cid, ChunkedData{title, data_size, digest, {}});
 }
 
 void NetPlayClient::OnChunkedDataEnd(sf::Packet& packet)
 {
   u32 cid;
   packet >> cid;
+  bool is_delta;
+  packet >> is_delta;
 
-  const auto data_packet_iter = m_chunked_data_receive_queue.find(cid);
-  if (data_packet_iter == m_chunked_data_receive_queue.end())
+  const auto data_iter = m_chunked_data_receive_queue.find(cid);
+  if (data_iter == m_chunked_data_receive_queue.end())
   {
     INFO_LOG_FMT(NETPLAY, "Invalid data chunk ID {}.", cid);
     return;
@@ -569,15 +604,67 @@ void NetPlayClient::OnChunkedDataEnd(sf::Packet& packet)
 
   INFO_LOG_FMT(NETPLAY, "Ending data chunk {}.", cid);
 
-  auto& data_packet = data_packet_iter->second;
+  ChunkedData chunked_data = std::move(data_iter->second);
+  m_chunked_data_receive_queue.erase(data_iter);
+
+  if (is_delta)
+  {
+    const auto history = m_chunked_data_history.find(chunked_data.title);
+    std::optional<std::vector<u8>> data;
+    if (history != m_chunked_data_history.end())
+      data = DecompressDelta(chunked_data.data, history->second.data, chunked_data.size);
+    if (!data)
+    {
+      ERROR_LOG_FMT(NETPLAY, "Failed to decode delta of data chunk {}.", cid);
+      FailChunkedData(cid);
+      return;
+    }
+    chunked_data.data = std::move(*data);
+  }
+
+  // Corrupt data must neither be used nor become the base of the next delta.
+  if (Common::SHA1::CalculateDigest(chunked_data.data) != chunked_data.digest)
+  {
+    ERROR_LOG_FMT(NETPLAY, "Data chunk {} doesn't match the server's digest.", cid);
+    FailChunkedData(cid);
+    return;
+  }
+
+  FinishChunkedData(cid, chunked_data.title, chunked_data.digest, std::move(chunked_data.data));
+}
+
+void NetPlayClient::FailChunkedData(u32 cid)
+{
+  m_dialog->HideChunkedProgressDialog();
+  m_dialog->AppendChat(Common::GetStringT("Error receiving data."));
+
+  sf::Packet failed_packet;
+  failed_packet << MessageID::ChunkedDataFailed;
+  failed_packet << cid;
+  Send(failed_packet, CHUNKED_DATA_CHANNEL);
+}
+
+void NetPlayClient::FinishChunkedData(u32 cid, const std::string& title,
+                                      const Common::SHA1::Digest& digest, std::vector<u8> data)
+{
+  sf::Packet data_packet;
+  data_packet.append(data.data(), data.size());
   OnData(data_packet);
-  m_chunked_data_receive_queue.erase(data_packet_iter);
+  m_dialog->SetChunkedProgress(m_local_player->pid, data.size());
   m_dialog->HideChunkedProgressDialog();
 
+  sf::Packet progress_packet;
+  progress_packet << MessageID::ChunkedDataProgress;
+  progress_packet << cid;
+  progress_packet << sf::Uint64{data.size()};
+  Send(progress_packet, CHUNKED_DATA_CHANNEL);
+
   sf::Packet complete_packet;
   complete_packet << MessageID::ChunkedDataComplete;
   complete_packet << cid;
   Send(complete_packet, CHUNKED_DATA_CHANNEL);
+
+  m_chunked_data_history[title] = {digest, std::move(data)};
 }
 
 void NetPlayClient::OnChunkedDataPayload(sf::Packet& packet)
@@ -585,29 +672,26 @@ void NetPlayClient::OnChunkedDataPayload(sf::Packet& packet)
   u32 cid;
   packet >> cid;
 
-  const auto data_packet_iter = m_chunked_data_receive_queue.find(cid);
-  if (data_packet_iter == m_chunked_data_receive_queue.end())
+  const auto data_iter = m_chunked_data_receive_queue.find(cid);
+  if (data_iter == m_chunked_data_receive_queue.end())
   {
     INFO_LOG_FMT(NETPLAY, "Invalid data chunk ID {}.", cid);
     return;
   }
 
-  auto& data_packet = data_packet_iter->second;
-  while (!packet.endOfPacket())
-  {
-    u8 byte;
-    packet >> byte;
-    data_packet << byte;
-  }
+  auto& data = data_iter->second.data;
+  const size_t offset = sizeof(MessageID) + sizeof(cid);
+  const u8* payload = static_cast<const u8*>(packet.getData()) + offset;
+  data.insert(data.end(), payload, payload + packet.getDataSize() - offset);
 
-  INFO_LOG_FMT(NETPLAY, "Received {} bytes of data chunk {}.", data_packet.getDataSize(), cid);
+  INFO_LOG_FMT(NETPLAY, "Received {} bytes of data chunk {}.", data.size(), cid);
 
-  m_dialog->SetChunkedProgress(m_local_player->pid, data_packet.getDataSize());
+  m_dialog->SetChunkedProgress(m_local_player->pid, data.size());
 
   sf::Packet progress_packet;
   progress_packet << MessageID::ChunkedDataProgress;
   progress_packet << cid;
-  progress_packet << sf::Uint64{data_packet.getDataSize()};
+  progress_packet << sf::Uint64{data.size()};
   Send(progress_packet, CHUNKED_DATA_CHANNEL);
 }
 
@@ -936,6 +1020,13 @@ void NetPlayClient::OnStartGame(sf::Packet& packet)
     m_net_settings.is_hosting = m_local_player->IsHost();
   }
 
+  if (m_net_settings.cpu_thread)
+  {
+    INFO_LOG_FMT(NETPLAY, "Dual core is enabled, so desync detection skips the GPU registers");
+    m_dialog->AppendChat(Common::GetStringT(
+        "Dual core is enabled, so desync detection can't check the GPU registers."));
+  }
+
   m_dialog->OnMsgStartGame();
 }
 
@@ -984,8 +1075,14 @@ void NetPlayClient::OnDesyncDetected(sf::Packet& packet)
 {
   int pid_to_blame;
   u32 frame;
+  DesyncComponent component;
+  bool has_address;
+  u32 address;
   packet >> pid_to_blame;
   packet >> frame;
+  packet >> component;
+  packet >> has_address;
+  packet >> address;
 
   std::string player = "??";
   std::lock_guard lkp(m_crit.players);
@@ -995,9 +1092,33 @@ void NetPlayClient::OnDesyncDetected(sf::Packet& packet)
       player = it->second.name;
   }
 
-  INFO_LOG_FMT(NETPLAY, "Player {} ({}) desynced!", player, pid_to_blame);
+  INFO_LOG_FMT(NETPLAY, "Player {} ({}) desynced at frame {}! Component {}, address {:08x}", player,
+               pid_to_blame, frame, static_cast<u8>(component), has_address ? address : 0);
+
+  m_dialog->OnDesync(frame, player, component,
+                     has_address ? std::make_optional(address) : std::nullopt);
+}
+
+void NetPlayClient::OnDesyncBisect(sf::Packet& packet)
+{
+  u32 frame;
+  u32 block;
+  packet >> frame;
+  packet >> block;
+
+  const std::vector<StateHashPage> pages = m_state_hasher.GetPageHashes(frame, block);
 
-  m_dialog->OnDesync(frame, player);
+  sf::Packet response;
+  response << MessageID::DesyncPageHashes;
+  response << frame;
+  response << block;
+  response << static_cast<u32>(pages.size());
+  for (const StateHashPage& page : pages)
+  {
+    response << page.address;
+    response << sf::Uint64{page.hash};
+  }
+  Send(response);
 }
 
 void NetPlayClient::OnSyncSaveData(sf::Packet& packet)
@@ -1751,7 +1872,8 @@ bool NetPlayClient::StartGame(const std::string& path)
     return false;
   }
 
-  m_timebase_frame = 0;
+  m_state_hash_frame = 0;
+  m_state_hasher.Reset();
   m_current_golfer = 1;
   m_wait_on_input = false;
 
@@ -2519,23 +2641,21 @@ void NetPlayClient::SendGameStatus()
   Send(packet);
 }
 
-void NetPlayClient::SendTimeBase()
+void NetPlayClient::SendStateHash()
 {
   std::lock_guard lk(crit_netplay_client);
 
-  if (netplay_client->m_timebase_frame % 60 == 0)
-  {
-    const sf::Uint64 timebase = Core::System::GetInstance().GetSystemTimers().GetFakeTimeBase();
+  auto& system = Core::System::GetInstance();
+  const StateHashReport report = netplay_client->m_state_hasher.HashFrame(
+      system, netplay_client->m_state_hash_frame, system.GetSystemTimers().GetFakeTimeBase());
 
-    sf::Packet packet;
-    packet << MessageID::TimeBase;
-    packet << timebase;
-    packet << netplay_client->m_timebase_frame;
+  sf::Packet packet;
+  packet << MessageID::StateHash;
+  WriteStateHashReport(packet, report);
 
-    netplay_client->SendAsync(std::move(packet));
-  }
+  netplay_client->SendAsync(std::move(packet));
 
-  netplay_client->m_timebase_frame++;
+  netplay_client->m_state_hash_frame++;
 }
 
 bool NetPlayClient::DoAllPlayersHaveGame()
@@ -9,6 +9,7 @@
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <span>
 #include <string>
 #include <thread>
@@ -17,10 +18,12 @@
 #include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/Crypto/SHA1.h"
 #include "Common/Event.h"
 #include "Common/SPSCQueue.h"
 #include "Common/TraversalClient.h"
 #include "Core/NetPlayProto.h"
+#include "Core/NetPlayStateHash.h"
 #include "Core/SyncIdentifier.h"
 #include "InputCommon/GCPadStatus.h"
 
@@ -65,7 +68,8 @@ public:
   virtual void OnPlayerDisconnect(const std::string& player) = 0;
   virtual void OnPadBufferChanged(u32 buffer) = 0;
   virtual void OnHostInputAuthorityChanged(bool enabled) = 0;
-  virtual void OnDesync(u32 frame, const std::string& player) = 0;
+  virtual void OnDesync(u32 frame, const std::string& player, DesyncComponent component,
+                        std::optional<u32> address) = 0;
   virtual void OnConnectionLost() = 0;
   virtual void OnConnectionError(const std::string& message) = 0;
   virtual void OnTraversalError(Common::TraversalClient::FailureReason error) = 0;
@@ -165,7 +169,7 @@ public:
   bool IsLocalPlayer(PlayerId pid) const;
   const PlayerId& GetLocalPlayerId() const;
 
-  static void SendTimeBase();
+  static void SendStateHash();
   bool DoAllPlayersHaveGame();
 
   const PadMappingArray& GetPadMapping() const;
@@ -282,6 +286,9 @@ private:
   void OnChunkedDataEnd(sf::Packet& packet);
   void OnChunkedDataPayload(sf::Packet& packet);
   void OnChunkedDataAbort(sf::Packet& packet);
+  void FinishChunkedData(u32 cid, const std::string& title, const Common::SHA1::Digest& digest,
+                         std::vector<u8> data);
+  void FailChunkedData(u32 cid);
   void OnPadMapping(sf::Packet& packet);
   void OnWiimoteMapping(sf::Packet& packet);
   void OnGBAConfig(sf::Packet& packet);
@@ -300,6 +307,7 @@ private:
   void OnPing(sf::Packet& packet);
   void OnPlayerPingData(sf::Packet& packet);
   void OnDesyncDetected(sf::Packet& packet);
+  void OnDesyncBisect(sf::Packet& packet);
   void OnSyncSaveData(sf::Packet& packet);
   void OnSyncSaveDataNotify(sf::Packet& packet);
   void OnSyncSaveDataRaw(sf::Packet& packet);
@@ -342,10 +350,25 @@ private:
   u16 m_sync_ar_codes_count = 0;
   u16 m_sync_ar_codes_success_count = 0;
   bool m_sync_ar_codes_complete = false;
-  std::unordered_map<u32, sf::Packet> m_chunked_data_receive_queue;
+  struct ChunkedData
+  {
+    std::string title;
+    u64 size;
+    Common::SHA1::Digest digest;
+    std::vector<u8> data;
+  };
+  std::unordered_map<u32, ChunkedData> m_chunked_data_receive_queue;
+  struct ChunkedDataHistoryEntry
+  {
+    Common::SHA1::Digest digest;
+    std::vector<u8> data;
+  };
+  // Last data received for each title, which the server can send deltas against.
+  std::map<std::string, ChunkedDataHistoryEntry> m_chunked_data_history;
 
   u64 m_initial_rtc = 0;
-  u32 m_timebase_frame = 0;
+  u32 m_state_hash_frame = 0;
+  StateHasher m_state_hasher;
 
   std::unique_ptr<IOS::HLE::FS::FileSystem> m_wii_sync_fs;
   std::vector<u64> m_wii_sync_titles;
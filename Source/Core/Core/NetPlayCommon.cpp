@@ -4,9 +4,11 @@
 #include "Core/NetPlayCommon.h"
 
 #include <algorithm>
+#include <bit>
+#include <memory>
 
 #include <fmt/format.h>
-#include <lzo/lzo1x.h>
+#include <zstd.h>
 
 #include "Common/FileUtil.h"
 #include "Common/IOFile.h"
@@ -15,8 +17,70 @@
 
 namespace NetPlay
 {
-constexpr u32 LZO_IN_LEN = 1024 * 64;
-constexpr u32 LZO_OUT_LEN = LZO_IN_LEN + (LZO_IN_LEN / 16) + 64 + 3;
+constexpr u32 BLOCK_SIZE = 1024 * 64;
+// Deltas need a window that covers both the base and the new data.
+constexpr int MIN_DELTA_WINDOW_LOG = 10;
+constexpr int MAX_DELTA_WINDOW_LOG = 30;
+
+namespace
+{
+struct ZstdCCtxDeleter
+{
+  void operator()(ZSTD_CCtx* cctx) const { ZSTD_freeCCtx(cctx); }
+};
+struct ZstdDCtxDeleter
+{
+  void operator()(ZSTD_DCtx* dctx) const { ZSTD_freeDCtx(dctx); }
+};
+using ZstdCCtx = std::unique_ptr<ZSTD_CCtx, ZstdCCtxDeleter>;
+using ZstdDCtx = std::unique_ptr<ZSTD_DCtx, ZstdDCtxDeleter>;
+}  // namespace
+
+// Every block is compressed on its own, so unchanged blocks of a file compress to the same bytes.
+// This is what lets deltas between two payloads stay small.
+static bool CompressBlockIntoPacket(ZSTD_CCtx* cctx, const u8* data, size_t size,
+                                    std::vector<u8>& out_buffer, sf::Packet& packet)
+{
+  const size_t out_len = ZSTD_compressCCtx(cctx, out_buffer.data(), out_buffer.size(), data, size,
+                                           ZSTD_CLEVEL_DEFAULT);
+  if (ZSTD_isError(out_len))
+  {
+    PanicAlertFmtT("Internal Zstandard Error - compression failed");
+    return false;
+  }
+
+  packet << static_cast<u32>(out_len);
+  packet.append(out_buffer.data(), out_len);
+  return true;
+}
+
+// Returns the number of decompressed bytes, or nothing if the end of the data was reached.
+static std::optional<size_t> DecompressBlockFromPacket(sf::Packet& packet,
+                                                       std::vector<u8>& in_buffer, u8* out,
+                                                       size_t out_capacity, bool* error)
+{
+  u32 cur_len = 0;
+  packet >> cur_len;
+  if (!cur_len)
+    return std::nullopt;  // We reached the end of the data stream
+
+  if (cur_len > in_buffer.size())
+  {
+    *error = true;
+    return std::nullopt;
+  }
+
+  for (size_t j = 0; j < cur_len; j++)
+    packet >> in_buffer[j];
+
+  const size_t new_len = ZSTD_decompress(out, out_capacity, in_buffer.data(), cur_len);
+  if (ZSTD_isError(new_len))
+  {
+    *error = true;
+    return std::nullopt;
+  }
+  return new_len;
+}
 
 bool CompressFileIntoPacket(const std::string& file_path, sf::Packet& packet)
 {
@@ -33,52 +97,21 @@ bool CompressFileIntoPacket(const std::string& file_path, sf::Packet& packet)
   if (size == 0)
     return true;
 
-  std::vector<u8> in_buffer(LZO_IN_LEN);
-  std::vector<u8> out_buffer(LZO_OUT_LEN);
-  std::vector<u8> wrkmem(LZO1X_1_MEM_COMPRESS);
+  ZstdCCtx cctx(ZSTD_createCCtx());
+  std::vector<u8> in_buffer(BLOCK_SIZE);
+  std::vector<u8> out_buffer(ZSTD_compressBound(BLOCK_SIZE));
 
-  lzo_uint i = 0;
-  while (true)
+  for (u64 i = 0; i < size; i += BLOCK_SIZE)
   {
-    lzo_uint32 cur_len = 0;  // number of bytes to read
-    lzo_uint out_len = 0;    // number of bytes to write
-
-    if ((i + LZO_IN_LEN) >= size)
-    {
-      cur_len = static_cast<lzo_uint32>(size - i);
-    }
-    else
-    {
-      cur_len = LZO_IN_LEN;
-    }
-
-    if (cur_len <= 0)
-      break;  // EOF
-
+    const size_t cur_len = static_cast<size_t>(std::min<u64>(BLOCK_SIZE, size - i));
     if (!file.ReadBytes(in_buffer.data(), cur_len))
     {
       PanicAlertFmtT("Error reading file: {0}", file_path.c_str());
       return false;
     }
 
-    if (lzo1x_1_compress(in_buffer.data(), cur_len, out_buffer.data(), &out_len, wrkmem.data()) !=
-        LZO_E_OK)
-    {
-      PanicAlertFmtT("Internal LZO Error - compression failed");
+    if (!CompressBlockIntoPacket(cctx.get(), in_buffer.data(), cur_len, out_buffer, packet))
       return false;
-    }
-
-    // The size of the data to write is 'out_len'
-    packet << static_cast<u32>(out_len);
-    for (size_t j = 0; j < out_len; j++)
-    {
-      packet << out_buffer[j];
-    }
-
-    if (cur_len != LZO_IN_LEN)
-      break;
-
-    i += cur_len;
   }
 
   // Mark end of data
@@ -124,45 +157,14 @@ bool CompressBufferIntoPacket(const std::vector<u8>& in_buffer, sf::Packet& pack
   if (size == 0)
     return true;
 
-  std::vector<u8> out_buffer(LZO_OUT_LEN);
-  std::vector<u8> wrkmem(LZO1X_1_MEM_COMPRESS);
+  ZstdCCtx cctx(ZSTD_createCCtx());
+  std::vector<u8> out_buffer(ZSTD_compressBound(BLOCK_SIZE));
 
-  lzo_uint i = 0;
-  while (true)
+  for (size_t i = 0; i < in_buffer.size(); i += BLOCK_SIZE)
   {
-    lzo_uint32 cur_len = 0;  // number of bytes to read
-    lzo_uint out_len = 0;    // number of bytes to write
-
-    if ((i + LZO_IN_LEN) >= size)
-    {
-      cur_len = static_cast<lzo_uint32>(size - i);
-    }
-    else
-    {
-      cur_len = LZO_IN_LEN;
-    }
-
-    if (cur_len <= 0)
-      break;  // end of buffer
-
-    if (lzo1x_1_compress(&in_buffer[i], cur_len, out_buffer.data(), &out_len, wrkmem.data()) !=
-        LZO_E_OK)
-    {
-      PanicAlertFmtT("Internal LZO Error - compression failed");
+    const size_t cur_len = std::min<size_t>(BLOCK_SIZE, in_buffer.size() - i);
+    if (!CompressBlockIntoPacket(cctx.get(), &in_buffer[i], cur_len, out_buffer, packet))
       return false;
-    }
-
-    // The size of the data to write is 'out_len'
-    packet << static_cast<u32>(out_len);
-    for (size_t j = 0; j < out_len; j++)
-    {
-      packet << out_buffer[j];
-    }
-
-    if (cur_len != LZO_IN_LEN)
-      break;
-
-    i += cur_len;
   }
 
   // Mark end of data
@@ -185,37 +187,26 @@ bool DecompressPacketIntoFile(sf::Packet& packet, const std::string& file_path)
     return false;
   }
 
-  std::vector<u8> in_buffer(LZO_OUT_LEN);
-  std::vector<u8> out_buffer(LZO_IN_LEN);
+  std::vector<u8> in_buffer(ZSTD_compressBound(BLOCK_SIZE));
+  std::vector<u8> out_buffer(BLOCK_SIZE);
 
-  while (true)
+  bool error = false;
+  while (const auto new_len =
+             DecompressBlockFromPacket(packet, in_buffer, out_buffer.data(), BLOCK_SIZE, &error))
   {
-    u32 cur_len = 0;       // number of bytes to read
-    lzo_uint new_len = 0;  // number of bytes to write
-
-    packet >> cur_len;
-    if (!cur_len)
-      break;  // We reached the end of the data stream
-
-    for (size_t j = 0; j < cur_len; j++)
-    {
-      packet >> in_buffer[j];
-    }
-
-    if (lzo1x_decompress(in_buffer.data(), cur_len, out_buffer.data(), &new_len, nullptr) !=
-        LZO_E_OK)
-    {
-      PanicAlertFmtT("Internal LZO Error - decompression failed");
-      return false;
-    }
-
-    if (!file.WriteBytes(out_buffer.data(), new_len))
+    if (!file.WriteBytes(out_buffer.data(), *new_len))
     {
       PanicAlertFmtT("Error writing file: {0}", file_path);
       return false;
     }
   }
 
+  if (error)
+  {
+    PanicAlertFmtT("Internal Zstandard Error - decompression failed");
+    return false;
+  }
+
   return true;
 }
 
@@ -269,32 +260,88 @@ std::optional<std::vector<u8>> DecompressPacketIntoBuffer(sf::Packet& packet)
   if (size == 0)
     return out_buffer;
 
-  std::vector<u8> in_buffer(LZO_OUT_LEN);
+  std::vector<u8> in_buffer(ZSTD_compressBound(BLOCK_SIZE));
 
-  lzo_uint i = 0;
-  while (true)
+  size_t i = 0;
+  bool error = false;
+  while (const auto new_len = DecompressBlockFromPacket(packet, in_buffer, out_buffer.data() + i,
+                                                        out_buffer.size() - i, &error))
+  {
+    i += *new_len;
+  }
+
+  if (error)
   {
-    u32 cur_len = 0;       // number of bytes to read
-    lzo_uint new_len = 0;  // number of bytes to write
+    PanicAlertFmtT("Internal Zstandard Error - decompression failed");
+    return {};
+  }
 
-    packet >> cur_len;
-    if (!cur_len)
-      break;  // We reached the end of the data stream
+  return out_buffer;
+}
 
-    for (size_t j = 0; j < cur_len; j++)
-    {
-      packet >> in_buffer[j];
-    }
+static int GetDeltaWindowLog(size_t base_size, size_t size)
+{
+  return std::max<int>(MIN_DELTA_WINDOW_LOG, std::bit_width(base_size + size));
+}
 
-    if (lzo1x_decompress(in_buffer.data(), cur_len, &out_buffer[i], &new_len, nullptr) != LZO_E_OK)
-    {
-      PanicAlertFmtT("Internal LZO Error - decompression failed");
-      return {};
-    }
+bool CanCompressDelta(size_t base_size, size_t size)
+{
+  return GetDeltaWindowLog(base_size, size) <= MAX_DELTA_WINDOW_LOG;
+}
+
+std::optional<std::vector<u8>> CompressDelta(std::span<const u8> data, std::span<const u8> base)
+{
+  if (!CanCompressDelta(base.size(), data.size()))
+    return std::nullopt;
+
+  ZstdCCtx cctx(ZSTD_createCCtx());
+  ZSTD_CCtx_setParameter(cctx.get(), ZSTD_c_windowLog, GetDeltaWindowLog(base.size(), data.size()));
+  ZSTD_CCtx_setParameter(cctx.get(), ZSTD_c_enableLongDistanceMatching, 1);
+  // Decompressing with the wrong base doesn't fail by itself, it just gives the wrong data.
+  ZSTD_CCtx_setParameter(cctx.get(), ZSTD_c_checksumFlag, 1);
+  if (ZSTD_isError(ZSTD_CCtx_refPrefix(cctx.get(), base.data(), base.size())))
+    return std::nullopt;
+
+  std::vector<u8> delta(ZSTD_compressBound(data.size()));
+  const size_t delta_size =
+      ZSTD_compress2(cctx.get(), delta.data(), delta.size(), data.data(), data.size());
+  if (ZSTD_isError(delta_size))
+    return std::nullopt;
+
+  delta.resize(delta_size);
+  return delta;
+}
+
+std::optional<std::vector<u8>> DecompressDelta(std::span<const u8> delta,
+                                               std::span<const u8> base, size_t size)
+{
+  if (!CanCompressDelta(base.size(), size))
+    return std::nullopt;
 
-    i += new_len;
+  ZstdDCtx dctx(ZSTD_createDCtx());
+  ZSTD_DCtx_setParameter(dctx.get(), ZSTD_d_windowLogMax, GetDeltaWindowLog(base.size(), size));
+  if (ZSTD_isError(ZSTD_DCtx_refPrefix(dctx.get(), base.data(), base.size())))
+    return std::nullopt;
+
+  std::vector<u8> data(size);
+  ZSTD_inBuffer in{delta.data(), delta.size(), 0};
+  ZSTD_outBuffer out{data.data(), data.size(), 0};
+  while (true)
+  {
+    const size_t in_pos = in.pos;
+    const size_t out_pos = out.pos;
+    const size_t result = ZSTD_decompressStream(dctx.get(), &out, &in);
+    if (ZSTD_isError(result))
+      return std::nullopt;
+    if (result == 0)
+      break;
+    // The delta was truncated, or it decompresses to more data than expected.
+    if (in.pos == in_pos && out.pos == out_pos)
+      return std::nullopt;
   }
 
-  return out_buffer;
+  if (out.pos != size)
+    return std::nullopt;
+  return data;
 }
 }  // namespace NetPlay
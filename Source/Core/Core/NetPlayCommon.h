@@ -8,6 +8,7 @@
 #include <array>
 #include <chrono>
 #include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -26,4 +27,10 @@ bool CompressBufferIntoPacket(const std::vector<u8>& in_buffer, sf::Packet& pack
 bool DecompressPacketIntoFile(sf::Packet& packet, const std::string& file_path);
 bool DecompressPacketIntoFolder(sf::Packet& packet, const std::string& folder_path);
 std::optional<std::vector<u8>> DecompressPacketIntoBuffer(sf::Packet& packet);
+
+// Deltas are zstd frames that use the base as a prefix, so they only need to encode what changed.
+bool CanCompressDelta(size_t base_size, size_t size);
+std::optional<std::vector<u8>> CompressDelta(std::span<const u8> data, std::span<const u8> base);
+std::optional<std::vector<u8>> DecompressDelta(std::span<const u8> delta,
+                                               std::span<const u8> base, size_t size);
 }  // namespace NetPlay
@@ -144,6 +144,8 @@ enum class MessageID : u8
   ChunkedDataProgress = 0x43,
   ChunkedDataComplete = 0x44,
   ChunkedDataAbort = 0x45,
+  ChunkedDataNegotiate = 0x46,
+  ChunkedDataFailed = 0x47,
 
   PadData = 0x60,
   PadMapping = 0x61,
@@ -169,8 +171,10 @@ enum class MessageID : u8
   HostInputAuthority = 0xA6,
   PowerButton = 0xA7,
 
-  TimeBase = 0xB0,
+  StateHash = 0xB0,
   DesyncDetected = 0xB1,
+  DesyncBisect = 0xB2,
+  DesyncPageHashes = 0xB3,
 
   ComputeGameDigest = 0xC0,
   GameDigestProgress = 0xC1,
@@ -209,6 +213,23 @@ enum class SyncSaveDataID : u8
   GBAData = 6
 };
 
+// What a client already has when it is about to receive chunked data.
+enum class ChunkedDataStatus : u8
+{
+  Missing = 0,
+  HaveData = 1,
+  HaveBase = 2,
+};
+
+// The part of the emulated state in which a desync was first detected.
+enum class DesyncComponent : u8
+{
+  TimeBase = 0,
+  CPU = 1,
+  GPU = 2,
+  RAM = 3,
+};
+
 enum class SyncCodeID : u8
 {
   Notify = 0,
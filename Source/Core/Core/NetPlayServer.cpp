@@ -10,6 +10,7 @@
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <span>
 #include <string>
 #include <thread>
 #include <type_traits>
@@ -551,6 +552,13 @@ unsigned int NetPlayServer::OnDisconnect(const Client& player)
   auto it = m_players.find(player.pid);
   if (it != m_players.end())
     m_players.erase(it);
+  // Frames which only this player hadn't reported yet are dropped once the others move on.
+  m_last_state_hash_frames.erase(pid);
+  for (auto& [frame, reports] : m_state_hashes_by_frame)
+    std::erase_if(reports, [pid](const auto& pair) { return pair.first == pid; });
+  PruneStateHashes();
+  // The chunked data thread may be waiting for this player to negotiate.
+  m_chunked_data_complete_event.Set();
 
   // alert other players of disconnect
   SendToClients(spac);
@@ -783,6 +791,23 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
   }
   break;
 
+  case MessageID::ChunkedDataNegotiate:
+  {
+    u32 cid;
+    packet >> cid;
+    ChunkedDataStatus status;
+    packet >> status;
+
+    std::lock_guard lk(m_chunked_data_status_lock);
+    const auto it = m_chunked_data_status.find(cid);
+    if (it != m_chunked_data_status.end())
+    {
+      it->second[player.pid] = status;
+      m_chunked_data_complete_event.Set();
+    }
+  }
+  break;
+
   case MessageID::ChunkedDataComplete:
   {
     u32 cid;
@@ -796,6 +821,22 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
   }
   break;
 
+  case MessageID::ChunkedDataFailed:
+  {
+    u32 cid;
+    packet >> cid;
+
+    if (m_chunked_data_complete_count.contains(cid))
+    {
+      ERROR_LOG_FMT(NETPLAY, "Player {} failed to receive data chunk {}.", player.pid, cid);
+      m_dialog->AppendChat(Common::FmtFormatT("{0} failed to receive data.", player.name));
+      m_dialog->OnGameStartAborted();
+      ChunkedDataAbort();
+      m_start_pending = false;
+    }
+  }
+  break;
+
   case MessageID::PadData:
   {
     // if this is pad data from the last game still being received, ignore it
@@ -1044,48 +1085,28 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
   }
   break;
 
-  case MessageID::TimeBase:
+  case MessageID::StateHash:
+    OnStateHash(ReadStateHashReport(packet), player.pid);
+    break;
+
+  case MessageID::DesyncPageHashes:
   {
-    u64 timebase = Common::PacketReadU64(packet);
     u32 frame;
+    u32 block;
+    u32 count;
     packet >> frame;
+    packet >> block;
+    packet >> count;
 
-    if (m_desync_detected)
-      break;
-
-    std::vector<std::pair<PlayerId, u64>>& timebases = m_timebase_by_frame[frame];
-    timebases.emplace_back(player.pid, timebase);
-    if (timebases.size() >= m_players.size())
+    std::vector<StateHashPage> pages;
+    for (u32 i = 0; i < count && !packet.endOfPacket(); ++i)
     {
-      // we have all records for this frame
-
-      if (!std::all_of(timebases.begin(), timebases.end(), [&](std::pair<PlayerId, u64> pair) {
-            return pair.second == timebases[0].second;
-          }))
-      {
-        int pid_to_blame = 0;
-        for (auto pair : timebases)
-        {
-          if (std::all_of(timebases.begin(), timebases.end(), [&](std::pair<PlayerId, u64> other) {
-                return other.first == pair.first || other.second != pair.second;
-              }))
-          {
-            // we are the only outlier
-            pid_to_blame = pair.first;
-            break;
-          }
-        }
-
-        sf::Packet spac;
-        spac << MessageID::DesyncDetected;
-        spac << pid_to_blame;
-        spac << frame;
-        SendToClients(spac);
-
-        m_desync_detected = true;
-      }
-      m_timebase_by_frame.erase(frame);
+      StateHashPage& page = pages.emplace_back();
+      packet >> page.address;
+      page.hash = Common::PacketReadU64(packet);
     }
+
+    OnDesyncPageHashes(frame, block, std::move(pages), player.pid);
   }
   break;
 
@@ -1557,8 +1578,10 @@ bool NetPlayServer::StartGame()
 {
   INFO_LOG_FMT(NETPLAY, "Starting game.");
 
-  m_timebase_by_frame.clear();
+  m_state_hashes_by_frame.clear();
+  m_last_state_hash_frames.clear();
   m_desync_detected = false;
+  m_desync_bisect.reset();
   std::lock_guard lkg(m_crit.game);
   // only used as an identifier, not time value, so truncation is fine
   m_current_game = static_cast<u32>(Common::Timer::NowMs());
@@ -2373,36 +2396,102 @@ void NetPlayServer::ChunkedDataThreadFunc()
         break;
       auto& e = m_chunked_data_queue.Front();
       const u32 id = m_next_chunked_data_id++;
+      const std::span<const u8> data(static_cast<const u8*>(e.packet.getData()),
+                                     e.packet.getDataSize());
+      const Common::SHA1::Digest digest = Common::SHA1::CalculateDigest(data.data(), data.size());
+
+      // Clients that still have the last data sent under this title only need a delta.
+      const auto base = m_chunked_data_history.find(e.title);
+      Common::SHA1::Digest base_digest{};
+      if (base != m_chunked_data_history.end() &&
+          CanCompressDelta(base->second.data.size(), data.size()))
+      {
+        base_digest = base->second.digest;
+      }
 
       m_chunked_data_complete_count[id] = 0;
-      size_t player_count;
       {
-        std::vector<int> players;
-        if (e.target_mode == TargetMode::Only)
-        {
-          players.push_back(e.target_pid);
-        }
-        else
+        std::lock_guard lk(m_chunked_data_status_lock);
+        m_chunked_data_status[id] = {};
+      }
+      std::vector<int> players;
+      if (e.target_mode == TargetMode::Only)
+      {
+        players.push_back(e.target_pid);
+      }
+      else
+      {
+        for (auto& pl : m_players)
         {
-          for (auto& pl : m_players)
-          {
-            if (pl.second.pid != e.target_pid)
-              players.push_back(pl.second.pid);
-          }
+          if (pl.second.pid != e.target_pid)
+            players.push_back(pl.second.pid);
         }
-        player_count = players.size();
-
+      }
+      const size_t player_count = players.size();
+      {
         INFO_LOG_FMT(NETPLAY, "Informing players {} of data chunk {} start.",
                      fmt::join(players, ", "), id);
 
         sf::Packet pac;
         pac << MessageID::ChunkedDataStart;
-        pac << id << e.title << sf::Uint64{e.packet.getDataSize()};
+        pac << id << e.title << sf::Uint64{data.size()};
+        for (const u8 byte : digest)
+          pac << byte;
+        for (const u8 byte : base_digest)
+          pac << byte;
 
         ChunkedDataSend(std::move(pac), e.target_pid, e.target_mode);
 
         if (e.target_mode == TargetMode::AllExcept && e.target_pid == 1)
-          m_dialog->ShowChunkedProgressDialog(e.title, e.packet.getDataSize(), players);
+          m_dialog->ShowChunkedProgressDialog(e.title, data.size(), players);
+      }
+
+      // Wait until every client has told us what it already has. Players that left don't answer.
+      std::map<PlayerId, ChunkedDataStatus> statuses;
+      while (m_do_loop && !m_abort_chunked_data)
+      {
+        {
+          std::lock_guard lk(m_chunked_data_status_lock);
+          statuses = m_chunked_data_status[id];
+        }
+        if (std::ranges::all_of(players, [&](int pid) {
+              return statuses.contains(pid) || !m_players.contains(pid);
+            }))
+        {
+          break;
+        }
+        m_chunked_data_complete_event.Wait();
+      }
+
+      // Every client gets its own stream, and the streams are sent interleaved so that a client
+      // which only needs a small delta doesn't wait for the others.
+      struct Stream
+      {
+        PlayerId pid;
+        std::span<const u8> data;
+        bool is_delta;
+        size_t index = 0;
+      };
+      std::optional<std::vector<u8>> delta;
+      std::vector<Stream> streams;
+      for (const auto& [pid, status] : statuses)
+      {
+        if (status == ChunkedDataStatus::HaveData)
+          continue;
+
+        if (status == ChunkedDataStatus::HaveBase && base != m_chunked_data_history.end())
+        {
+          if (!delta)
+            delta = CompressDelta(data, base->second.data);
+          if (delta)
+          {
+            INFO_LOG_FMT(NETPLAY, "Sending data chunk {} to player {} as a {} byte delta.", id,
+                         pid, delta->size());
+            streams.push_back({pid, *delta, true});
+            continue;
+          }
+        }
+        streams.push_back({pid, data, false});
       }
 
       const bool enable_limit = Config::Get(Config::NETPLAY_ENABLE_CHUNKED_UPLOAD_LIMIT);
@@ -2410,57 +2499,65 @@ void NetPlayServer::ChunkedDataThreadFunc()
           (std::max(Config::Get(Config::NETPLAY_CHUNKED_UPLOAD_LIMIT), 1u) / 8.0f) * 1024.0f;
       const std::chrono::duration<double> send_interval(CHUNKED_DATA_UNIT_SIZE / bytes_per_second);
       bool skip_wait = false;
-      size_t index = 0;
-      do
+      while (!streams.empty() && !m_abort_chunked_data)
       {
         if (!m_do_loop)
           return;
-        if (m_abort_chunked_data)
-        {
-          INFO_LOG_FMT(NETPLAY, "Informing players of data chunk {} abort.", id);
 
-          sf::Packet pac;
-          pac << MessageID::ChunkedDataAbort;
-          pac << id;
-          ChunkedDataSend(std::move(pac), e.target_pid, e.target_mode);
-          break;
-        }
-        if (e.target_mode == TargetMode::Only)
+        auto start = std::chrono::steady_clock::now();
+
+        for (auto it = streams.begin(); it != streams.end();)
         {
-          if (!m_players.contains(e.target_pid))
+          if (!m_players.contains(it->pid))
           {
-            skip_wait = true;
-            break;
+            skip_wait |= e.target_mode == TargetMode::Only;
+            it = streams.erase(it);
+            continue;
           }
-        }
 
-        auto start = std::chrono::steady_clock::now();
+          if (it->index < it->data.size())
+          {
+            sf::Packet pac;
+            pac << MessageID::ChunkedDataPayload;
+            pac << id;
+            const size_t len = std::min(CHUNKED_DATA_UNIT_SIZE, it->data.size() - it->index);
+            pac.append(it->data.data() + it->index, len);
 
-        sf::Packet pac;
-        pac << MessageID::ChunkedDataPayload;
-        pac << id;
-        size_t len = std::min(CHUNKED_DATA_UNIT_SIZE, e.packet.getDataSize() - index);
-        pac.append(static_cast<const u8*>(e.packet.getData()) + index, len);
+            INFO_LOG_FMT(NETPLAY, "Sending data chunk of {} to player {} ({} bytes at {}/{}).",
+                         id, it->pid, len, it->index, it->data.size());
 
-        INFO_LOG_FMT(NETPLAY, "Sending data chunk of {} ({} bytes at {}/{}).", id, len, index,
-                     e.packet.getDataSize());
+            SendAsync(std::move(pac), it->pid, CHUNKED_DATA_CHANNEL);
+            it->index += len;
+          }
 
-        ChunkedDataSend(std::move(pac), e.target_pid, e.target_mode);
-        index += CHUNKED_DATA_UNIT_SIZE;
+          if (it->index < it->data.size())
+          {
+            ++it;
+            continue;
+          }
+
+          INFO_LOG_FMT(NETPLAY, "Informing player {} of data chunk {} end.", it->pid, id);
+
+          sf::Packet pac;
+          pac << MessageID::ChunkedDataEnd;
+          pac << id << it->is_delta;
+          SendAsync(std::move(pac), it->pid, CHUNKED_DATA_CHANNEL);
+          it = streams.erase(it);
+        }
 
         if (enable_limit)
         {
-          std::chrono::duration<double> delta = std::chrono::steady_clock::now() - start;
-          std::this_thread::sleep_for(send_interval - delta);
+          std::chrono::duration<double> delta_time = std::chrono::steady_clock::now() - start;
+          std::this_thread::sleep_for(send_interval - delta_time);
         }
-      } while (index < e.packet.getDataSize());
+      }
 
-      if (!m_abort_chunked_data)
+      if (m_abort_chunked_data)
       {
-        INFO_LOG_FMT(NETPLAY, "Informing players of data chunk {} end.", id);
+        INFO_LOG_FMT(NETPLAY, "Informing players of data chunk {} abort.", id);
 
         sf::Packet pac;
-        pac << MessageID::ChunkedDataEnd;
+        pac << MessageID::ChunkedDataAbort;
         pac << id;
         ChunkedDataSend(std::move(pac), e.target_pid, e.target_mode);
       }
@@ -2469,8 +2566,15 @@ void NetPlayServer::ChunkedDataThreadFunc()
              !m_abort_chunked_data && !skip_wait)
         m_chunked_data_complete_event.Wait();
       m_chunked_data_complete_count.erase(id);
+      {
+        std::lock_guard lk(m_chunked_data_status_lock);
+        m_chunked_data_status.erase(id);
+      }
       m_dialog->HideChunkedProgressDialog();
 
+      if (!m_abort_chunked_data)
+        m_chunked_data_history[e.title] = {digest, {data.begin(), data.end()}};
+
       m_chunked_data_queue.Pop();
     }
   }
@@ -2492,6 +2596,143 @@ void NetPlayServer::ChunkedDataSend(sf::Packet&& packet, const PlayerId pid,
   }
 }
 
+void NetPlayServer::OnStateHash(const StateHashReport& report, const PlayerId pid)
+{
+  if (m_desync_detected)
+    return;
+
+  m_last_state_hash_frames[pid] = report.frame;
+  PruneStateHashes();
+
+  std::vector<std::pair<PlayerId, StateHashReport>>& reports =
+      m_state_hashes_by_frame[report.frame];
+  reports.emplace_back(pid, report);
+  if (reports.size() < m_players.size())
+    return;
+
+  // we have all records for this frame
+  const u32 frame = report.frame;
+  // Reports that only differ in whether they include the GPU registers still match.
+  const auto matches = [](const StateHashReport& a, const StateHashReport& b) {
+    return !FindStateHashMismatch(a, b);
+  };
+  if (std::all_of(reports.begin(), reports.end(),
+                  [&](const auto& pair) { return matches(pair.second, reports[0].second); }))
+  {
+    m_state_hashes_by_frame.erase(frame);
+    return;
+  }
+
+  int pid_to_blame = 0;
+  const StateHashReport* outlier = &reports[0].second;
+  for (const auto& pair : reports)
+  {
+    if (std::all_of(reports.begin(), reports.end(), [&](const auto& other) {
+          return other.first == pair.first || !matches(other.second, pair.second);
+        }))
+    {
+      // we are the only outlier
+      pid_to_blame = pair.first;
+      outlier = &pair.second;
+      break;
+    }
+  }
+
+  const auto other = std::find_if(reports.begin(), reports.end(), [&](const auto& pair) {
+    return !matches(pair.second, *outlier);
+  });
+  const StateHashMismatch mismatch = *FindStateHashMismatch(*outlier, other->second);
+  m_desync_detected = true;
+
+  if (mismatch.component != DesyncComponent::RAM)
+  {
+    SendDesyncDetected(pid_to_blame, frame, mismatch.component, std::nullopt);
+  }
+  else
+  {
+    // Ask everyone for the page hashes of the first block that differs to find the exact page.
+    m_desync_bisect = DesyncBisect{frame, mismatch.ram_block, pid_to_blame, reports.size(), {}};
+
+    sf::Packet spac;
+    spac << MessageID::DesyncBisect;
+    spac << frame;
+    spac << mismatch.ram_block;
+    SendToClients(spac);
+  }
+
+  m_state_hashes_by_frame.clear();
+}
+
+void NetPlayServer::PruneStateHashes()
+{
+  // Reports arrive in order, so a frame which some player has already moved past can't be
+  // completed anymore. This happens when a player leaves before reporting it.
+  std::optional<u32> oldest_frame;
+  for (const auto& [pid, player] : m_players)
+  {
+    const auto it = m_last_state_hash_frames.find(pid);
+    if (it == m_last_state_hash_frames.end())
+      return;
+    oldest_frame = std::min(oldest_frame.value_or(it->second), it->second);
+  }
+  if (!oldest_frame)
+    return;
+
+  std::erase_if(m_state_hashes_by_frame,
+                [&](const auto& pair) { return pair.first < *oldest_frame; });
+}
+
+void NetPlayServer::OnDesyncPageHashes(u32 frame, u32 block, std::vector<StateHashPage> pages,
+                                       const PlayerId pid)
+{
+  if (!m_desync_bisect || m_desync_bisect->frame != frame || m_desync_bisect->block != block)
+    return;
+
+  auto& all_pages = m_desync_bisect->pages;
+  all_pages.emplace_back(pid, std::move(pages));
+  if (all_pages.size() < std::min(m_desync_bisect->player_count, m_players.size()))
+    return;
+
+  // Compare against the player to blame if there is one, as everyone else agrees with each other.
+  auto reference = std::find_if(all_pages.begin(), all_pages.end(), [&](const auto& pair) {
+    return pair.first == m_desync_bisect->pid_to_blame;
+  });
+  if (reference == all_pages.end())
+    reference = all_pages.begin();
+
+  // Players that no longer have the frame send nothing, which leaves the exact address unknown.
+  std::optional<u32> address;
+  std::optional<size_t> first_page;
+  for (const auto& pair : all_pages)
+  {
+    if (pair.second.empty() || reference->second.empty())
+      continue;
+    const std::optional<size_t> page = FindMismatchedPage(reference->second, pair.second);
+    if (page && (!first_page || *page < *first_page))
+    {
+      first_page = page;
+      const auto& list = *page < reference->second.size() ? reference->second : pair.second;
+      address = list[*page].address;
+    }
+  }
+
+  SendDesyncDetected(m_desync_bisect->pid_to_blame, frame, DesyncComponent::RAM, address);
+  m_desync_bisect.reset();
+}
+
+void NetPlayServer::SendDesyncDetected(int pid_to_blame, u32 frame, DesyncComponent component,
+                                       std::optional<u32> address)
+{
+  sf::Packet spac;
+  spac << MessageID::DesyncDetected;
+  spac << pid_to_blame;
+  spac << frame;
+  spac << component;
+  spac << address.has_value();
+  spac << address.value_or(0);
+  SendToClients(spac);
+}
+
 void NetPlayServer::ChunkedDataAbort()
 {
   m_abort_chunked_data = true;
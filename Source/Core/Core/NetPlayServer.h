@@ -16,12 +16,14 @@
 #include <unordered_set>
 #include <utility>
 
+#include "Common/Crypto/SHA1.h"
 #include "Common/Event.h"
 #include "Common/QoSSession.h"
 #include "Common/SPSCQueue.h"
 #include "Common/Timer.h"
 #include "Common/TraversalClient.h"
 #include "Core/NetPlayProto.h"
+#include "Core/NetPlayStateHash.h"
 #include "Core/SyncIdentifier.h"
 #include "InputCommon/GCPadStatus.h"
 #include "UICommon/NetPlayIndex.h"
@@ -153,6 +155,12 @@ private:
   void ChunkedDataSend(sf::Packet&& packet, PlayerId pid, const TargetMode target_mode);
   void ChunkedDataAbort();
 
+  void OnStateHash(const StateHashReport& report, PlayerId pid);
+  void PruneStateHashes();
+  void OnDesyncPageHashes(u32 frame, u32 block, std::vector<StateHashPage> pages, PlayerId pid);
+  void SendDesyncDetected(int pid_to_blame, u32 frame, DesyncComponent component,
+                          std::optional<u32> address);
+
   void SetupIndex();
   bool PlayerHasControllerMapped(PlayerId pid) const;
 
@@ -185,8 +193,22 @@ private:
 
   std::map<PlayerId, Client> m_players;
 
-  std::unordered_map<u32, std::vector<std::pair<PlayerId, u64>>> m_timebase_by_frame;
+  std::unordered_map<u32, std::vector<std::pair<PlayerId, StateHashReport>>>
+      m_state_hashes_by_frame;
+  // The last frame each player sent a state hash for. Frames before the oldest of these won't get
+  // any more reports.
+  std::map<PlayerId, u32> m_last_state_hash_frames;
   bool m_desync_detected = false;
+  // Collects the page hashes of the first diverging RAM block to find the diverging address.
+  struct DesyncBisect
+  {
+    u32 frame;
+    u32 block;
+    int pid_to_blame;
+    size_t player_count;
+    std::vector<std::pair<PlayerId, std::vector<StateHashPage>>> pages;
+  };
+  std::optional<DesyncBisect> m_desync_bisect;
 
   struct
   {
@@ -209,6 +231,16 @@ private:
   u32 m_next_chunked_data_id = 0;
   std::unordered_map<u32, unsigned int> m_chunked_data_complete_count;
   bool m_abort_chunked_data = false;
+  std::mutex m_chunked_data_status_lock;
+  std::unordered_map<u32, std::map<PlayerId, ChunkedDataStatus>> m_chunked_data_status;
+
+  struct ChunkedDataHistoryEntry
+  {
+    Common::SHA1::Digest digest;
+    std::vector<u8> data;
+  };
+  // Last data that was sent for each title, which clients can use as the base for a delta.
+  std::map<std::string, ChunkedDataHistoryEntry> m_chunked_data_history;
 
   ENetHost* m_server = nullptr;
   Common::TraversalClient* m_traversal_client = nullptr;
@@ -0,0 +1,208 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "Core/NetPlayStateHash.h"
+
+#include <algorithm>
+
+#include <xxhash.h>
+
+#include "Common/Align.h"
+#include "Common/SFMLHelper.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/System.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/XFMemory.h"
+
+namespace NetPlay
+{
+namespace
+{
+struct RamRegion
+{
+  const u8* data;
+  u32 size;
+  u32 physical_address;
+};
+
+u32 GetPageCount(u32 size)
+{
+  return Common::AlignUp(size, STATE_HASH_PAGE_SIZE) / STATE_HASH_PAGE_SIZE;
+}
+
+u64 HashCPUState(const PowerPC::PowerPCState& ppc_state)
+{
+  // Only architectural state, as the rest depends on the host and the CPU core in use.
+  std::array<u64, 1 + 32 + 64 + 6 + 16 + 12> values;
+  size_t i = 0;
+  values[i++] = ppc_state.pc;
+  for (const u32 gpr : ppc_state.gpr)
+    values[i++] = gpr;
+  for (const PowerPC::PairedSingle& ps : ppc_state.ps)
+  {
+    values[i++] = ps.PS0AsU64();
+    values[i++] = ps.PS1AsU64();
+  }
+  values[i++] = ppc_state.cr.Get();
+  values[i++] = ppc_state.msr.Hex;
+  values[i++] = ppc_state.fpscr.Hex;
+  values[i++] = ppc_state.xer_ca;
+  values[i++] = ppc_state.xer_so_ov;
+  values[i++] = ppc_state.xer_stringctrl;
+  for (const u32 sr : ppc_state.sr)
+    values[i++] = sr;
+  for (const u32 spr : {SPR_LR, SPR_CTR, SPR_SRR0, SPR_SRR1})
+    values[i++] = ppc_state.spr[spr];
+  for (u32 gqr = 0; gqr < 8; ++gqr)
+    values[i++] = ppc_state.spr[SPR_GQR0 + gqr];
+
+  return XXH3_64bits(values.data(), i * sizeof(u64));
+}
+
+std::optional<u64> HashGPUState(const Core::System& system)
+{
+  // In dual core mode the registers belong to the GPU thread and can't be read consistently.
+  if (system.IsDualCoreMode())
+    return std::nullopt;
+
+  return XXH3_64bits_withSeed(&xfmem, sizeof(xfmem), XXH3_64bits(&bpmem, sizeof(bpmem)));
+}
+}  // namespace
+
+void WriteStateHashReport(sf::Packet& packet, const StateHashReport& report)
+{
+  packet << report.frame;
+  packet << sf::Uint64{report.timebase};
+  packet << sf::Uint64{report.cpu_hash};
+  packet << report.gpu_hash.has_value();
+  if (report.gpu_hash)
+    packet << sf::Uint64{*report.gpu_hash};
+  for (const u64 hash : report.ram_block_hashes)
+    packet << sf::Uint64{hash};
+}
+
+StateHashReport ReadStateHashReport(sf::Packet& packet)
+{
+  StateHashReport report;
+  packet >> report.frame;
+  report.timebase = Common::PacketReadU64(packet);
+  report.cpu_hash = Common::PacketReadU64(packet);
+  bool has_gpu_hash;
+  packet >> has_gpu_hash;
+  if (has_gpu_hash)
+    report.gpu_hash = Common::PacketReadU64(packet);
+  for (u64& hash : report.ram_block_hashes)
+    hash = Common::PacketReadU64(packet);
+  return report;
+}
+
+std::optional<StateHashMismatch> FindStateHashMismatch(const StateHashReport& a,
+                                                       const StateHashReport& b)
+{
+  if (a.timebase != b.timebase)
+    return StateHashMismatch{DesyncComponent::TimeBase};
+  if (a.cpu_hash != b.cpu_hash)
+    return StateHashMismatch{DesyncComponent::CPU};
+  if (a.gpu_hash && b.gpu_hash && *a.gpu_hash != *b.gpu_hash)
+    return StateHashMismatch{DesyncComponent::GPU};
+
+  const auto [it_a, it_b] = std::ranges::mismatch(a.ram_block_hashes, b.ram_block_hashes);
+  if (it_a != a.ram_block_hashes.end())
+  {
+    return StateHashMismatch{DesyncComponent::RAM,
+                             static_cast<u32>(it_a - a.ram_block_hashes.begin())};
+  }
+
+  return std::nullopt;
+}
+
+std::optional<size_t> FindMismatchedPage(std::span<const StateHashPage> a,
+                                         std::span<const StateHashPage> b)
+{
+  const auto [it_a, it_b] = std::ranges::mismatch(a, b);
+  if (it_a == a.end() && it_b == b.end())
+    return std::nullopt;
+  return static_cast<size_t>(it_a - a.begin());
+}
+
+StateHashReport StateHasher::HashFrame(Core::System& system, u32 frame, u64 timebase)
+{
+  StateHashReport report;
+  report.frame = frame;
+  report.timebase = timebase;
+  report.cpu_hash = HashCPUState(system.GetPPCState());
+  report.gpu_hash = HashGPUState(system);
+
+  auto& memory = system.GetMemory();
+  std::array<RamRegion, 2> regions{{{memory.GetRAM(), memory.GetRamSizeReal(), 0x00000000}}};
+  if (memory.GetEXRAM())
+    regions[1] = {memory.GetEXRAM(), memory.GetExRamSizeReal(), 0x10000000};
+
+  u32 total_pages = 0;
+  for (const RamRegion& region : regions)
+    total_pages += GetPageCount(region.size);
+
+  // Every frame hashes the next slice of RAM, which is the same slice for all players.
+  const u32 pages_per_block = std::max<u32>(
+      Common::AlignUp(total_pages, STATE_HASH_SLICE_FRAMES * STATE_HASH_RAM_BLOCKS) /
+          (STATE_HASH_SLICE_FRAMES * STATE_HASH_RAM_BLOCKS),
+      1);
+  const u32 pages_per_slice = pages_per_block * STATE_HASH_RAM_BLOCKS;
+  const u32 first_page = (frame % STATE_HASH_SLICE_FRAMES) * pages_per_slice;
+  const u32 last_page = std::min(first_page + pages_per_slice, total_pages);
+
+  std::lock_guard lk(m_history_lock);
+  HistoryEntry& entry = m_history[frame % STATE_HASH_HISTORY_FRAMES];
+  entry.frame = frame;
+  entry.pages_per_block = pages_per_block;
+  entry.pages.clear();
+
+  u32 region_first_page = 0;
+  for (const RamRegion& region : regions)
+  {
+    const u32 region_pages = GetPageCount(region.size);
+    const u32 begin = std::max(first_page, region_first_page);
+    const u32 end = std::min(last_page, region_first_page + region_pages);
+    for (u32 page = begin; page < end; ++page)
+    {
+      const u32 offset = (page - region_first_page) * STATE_HASH_PAGE_SIZE;
+      const u32 size = std::min(STATE_HASH_PAGE_SIZE, region.size - offset);
+      entry.pages.push_back(
+          {region.physical_address + offset, XXH3_64bits(region.data + offset, size)});
+    }
+    region_first_page += region_pages;
+  }
+
+  for (u32 block = 0; block < STATE_HASH_RAM_BLOCKS; ++block)
+  {
+    const size_t begin = std::min<size_t>(block * pages_per_block, entry.pages.size());
+    const size_t end = std::min<size_t>(begin + pages_per_block, entry.pages.size());
+    u64 block_hash = 0;
+    for (size_t page = begin; page < end; ++page)
+      block_hash = XXH3_64bits_withSeed(&entry.pages[page].hash, sizeof(u64), block_hash);
+    report.ram_block_hashes[block] = block_hash;
+  }
+
+  return report;
+}
+
+std::vector<StateHashPage> StateHasher::GetPageHashes(u32 frame, u32 block) const
+{
+  std::lock_guard lk(m_history_lock);
+  const HistoryEntry& entry = m_history[frame % STATE_HASH_HISTORY_FRAMES];
+  if (entry.frame != frame || block >= STATE_HASH_RAM_BLOCKS)
+    return {};
+
+  const size_t begin = std::min<size_t>(block * entry.pages_per_block, entry.pages.size());
+  const size_t end = std::min<size_t>(begin + entry.pages_per_block, entry.pages.size());
+  return {entry.pages.begin() + begin, entry.pages.begin() + end};
+}
+
+void StateHasher::Reset()
+{
+  std::lock_guard lk(m_history_lock);
+  for (HistoryEntry& entry : m_history)
+    entry.frame.reset();
+}
+}  // namespace NetPlay
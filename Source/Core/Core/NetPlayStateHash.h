@@ -0,0 +1,94 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <SFML/Network/Packet.hpp>
+
+#include <array>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Core/NetPlayProto.h"
+
+namespace Core
+{
+class System;
+}
+
+namespace NetPlay
+{
+constexpr u32 STATE_HASH_PAGE_SIZE = 0x1000;
+// Each frame only hashes a slice of RAM, so that all of it is covered once every this many frames.
+constexpr u32 STATE_HASH_SLICE_FRAMES = 60;
+// The RAM slice of a frame is reported as this many block hashes.
+constexpr u32 STATE_HASH_RAM_BLOCKS = 16;
+// How many frames of page hashes are kept to narrow a RAM desync down to a single page.
+constexpr u32 STATE_HASH_HISTORY_FRAMES = 256;
+
+// Hashes of the emulated state at the end of a frame, which the server compares between players.
+struct StateHashReport
+{
+  u32 frame = 0;
+  u64 timebase = 0;
+  u64 cpu_hash = 0;
+  // Missing in dual core mode, where the GPU registers belong to the GPU thread.
+  std::optional<u64> gpu_hash;
+  std::array<u64, STATE_HASH_RAM_BLOCKS> ram_block_hashes{};
+
+  bool operator==(const StateHashReport&) const = default;
+};
+
+struct StateHashPage
+{
+  u32 address = 0;
+  u64 hash = 0;
+
+  bool operator==(const StateHashPage&) const = default;
+};
+
+struct StateHashMismatch
+{
+  DesyncComponent component;
+  u32 ram_block = 0;
+};
+
+void WriteStateHashReport(sf::Packet& packet, const StateHashReport& report);
+StateHashReport ReadStateHashReport(sf::Packet& packet);
+
+// Returns the first part of the state that differs between the two reports. GPU registers are only
+// compared if both reports include them.
+std::optional<StateHashMismatch> FindStateHashMismatch(const StateHashReport& a,
+                                                       const StateHashReport& b);
+
+// Returns the index of the first page that differs between the two lists. If one list is a prefix
+// of the other, this is the size of the shorter one.
+std::optional<size_t> FindMismatchedPage(std::span<const StateHashPage> a,
+                                         std::span<const StateHashPage> b);
+
+class StateHasher
+{
+public:
+  // Called on the CPU thread at the end of every frame.
+  StateHashReport HashFrame(Core::System& system, u32 frame, u64 timebase);
+
+  // Page hashes of one RAM block of a recent frame. Empty if the frame is no longer known.
+  std::vector<StateHashPage> GetPageHashes(u32 frame, u32 block) const;
+
+  void Reset();
+
+private:
+  struct HistoryEntry
+  {
+    std::optional<u32> frame;
+    u32 pages_per_block = 0;
+    std::vector<StateHashPage> pages;
+  };
+
+  mutable std::mutex m_history_lock;
+  std::array<HistoryEntry, STATE_HASH_HISTORY_FRAMES> m_history;
+};
+}  // namespace NetPlay
@@ -8,6 +8,7 @@
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
+#include "Core/Debugger/BranchWatch.h"
 #include "Core/HLE/HLE.h"
 #include "Core/HW/CPU.h"
 #include "Core/PowerPC/Gekko.h"
@@ -143,6 +144,70 @@ s32 CachedInterpreter::InterpretAndCheckExceptions(
   return sizeof(AnyCallback) + sizeof(operands);
 }
 
+s32 CachedInterpreter::InterpretPair(PowerPC::PowerPCState& ppc_state,
+                                     const InterpretPairOperands& operands)
+{
+  const auto& [interpreter, func_a, func_b, inst_a, inst_b] = operands;
+  func_a(interpreter, inst_a);
+  func_b(interpreter, inst_b);
+  return sizeof(AnyCallback) + sizeof(operands);
+}
+
+CachedInterpreter::CompareAndBranchOperands
+CachedInterpreter::DecodeCompareAndBranch(Core::BranchWatch& branch_watch,
+                                          UGeckoInstruction compare, UGeckoInstruction branch,
+                                          u32 branch_pc)
+{
+  const bool is_signed = compare.OPCD == 11;
+  return {branch_watch,
+          branch,
+          branch_pc,
+          branch_pc + u32(SignExt16(s16(branch.BD << 2))),
+          is_signed ? u32(s32(compare.SIMM_16)) : u32(compare.UIMM),
+          static_cast<u8>(compare.RA),
+          static_cast<u8>(compare.CRFD),
+          static_cast<u8>(branch.BI),
+          static_cast<u8>((branch.BO & BO_BRANCH_IF_TRUE) != 0)};
+}
+
+template <bool is_signed>
+s32 CachedInterpreter::CompareAndBranch(PowerPC::PowerPCState& ppc_state,
+                                        const CompareAndBranchOperands& operands)
+{
+  const auto& [branch_watch, branch_inst, branch_pc, destination, immediate, ra, crf, bi,
+               branch_if_true] = operands;
+
+  // Equivalent to Interpreter::cmpi/cmpli
+  using T = std::conditional_t<is_signed, s32, u32>;
+  const T a = static_cast<T>(ppc_state.gpr[ra]);
+  const T b = static_cast<T>(immediate);
+  u32 cr_field = a < b ? PowerPC::CR_LT : a > b ? PowerPC::CR_GT : PowerPC::CR_EQ;
+  if (ppc_state.GetXER_SO())
+    cr_field |= PowerPC::CR_SO;
+  ppc_state.cr.SetField(crf, cr_field);
+
+  // Equivalent to Interpreter::bcx with BO_DONT_DECREMENT_FLAG set and LK/AA unset
+  ppc_state.pc = branch_pc;
+  if (ppc_state.cr.GetBit(bi) == branch_if_true)
+  {
+    ppc_state.npc = destination;
+    if (branch_watch.GetRecordingActive())
+      branch_watch.HitTrue(branch_pc, destination, branch_inst, ppc_state.msr.IR);
+  }
+  else
+  {
+    ppc_state.npc = branch_pc + 4;
+    if (branch_watch.GetRecordingActive())
+      branch_watch.HitFalse(branch_pc, branch_pc + 4, branch_inst, ppc_state.msr.IR);
+  }
+  return sizeof(AnyCallback) + sizeof(operands);
+}
+
+template s32 CachedInterpreter::CompareAndBranch<true>(PowerPC::PowerPCState& ppc_state,
+                                                       const CompareAndBranchOperands& operands);
+template s32 CachedInterpreter::CompareAndBranch<false>(PowerPC::PowerPCState& ppc_state,
+                                                        const CompareAndBranchOperands& operands);
+
 s32 CachedInterpreter::HLEFunction(PowerPC::PowerPCState& ppc_state,
                                    const HLEFunctionOperands& operands)
 {
@@ -228,6 +293,59 @@ void CachedInterpreter::WriteEndBlock()
   }
 }
 
+static bool IsCompareImmediate(const PPCAnalyst::CodeOp& op)
+{
+  return op.inst.OPCD == 10 || op.inst.OPCD == 11;  // cmpli, cmpi
+}
+
+static bool IsConditionOnlyBranch(const PPCAnalyst::CodeOp& op)
+{
+  return op.inst.OPCD == 16 && (op.inst.BO & BO_DONT_DECREMENT_FLAG) != 0 &&
+         (op.inst.BO & BO_DONT_CHECK_CONDITION) == 0 && !op.inst.LK && !op.inst.AA;
+}
+
+bool CachedInterpreter::CanFuseInstructions(const PPCAnalyst::CodeOp& op,
+                                            const PPCAnalyst::CodeOp& next_op)
+{
+  // Breakpoints, HLE hooks, idle loop detection and exception checks all need a callback of their
+  // own between the two instructions.
+  if (IsDebuggingEnabled() || op.canEndBlock || op.branchIsIdleLoop || next_op.skip ||
+      next_op.branchIsIdleLoop)
+  {
+    return false;
+  }
+  if (HLE::TryReplaceFunction(m_ppc_symbol_db, next_op.address, PowerPC::CoreMode::JIT))
+    return false;
+  if (!js.firstFPInstructionFound && (next_op.opinfo->flags & FL_USE_FPU) != 0)
+    return false;
+  if ((jo.memcheck && (next_op.opinfo->flags & FL_LOADSTORE) != 0) ||
+      (!next_op.canEndBlock && ShouldHandleFPExceptionForInstruction(&next_op)))
+  {
+    return false;
+  }
+
+  if (IsCompareImmediate(op) && IsConditionOnlyBranch(next_op))
+    return true;
+
+  return !next_op.canEndBlock;
+}
+
+void CachedInterpreter::WriteFusedInstructions(const PPCAnalyst::CodeOp& op,
+                                               const PPCAnalyst::CodeOp& next_op)
+{
+  if (IsCompareImmediate(op) && IsConditionOnlyBranch(next_op))
+  {
+    const CompareAndBranchOperands operands = DecodeCompareAndBranch(
+        m_system.GetPowerPC().GetBranchWatch(), op.inst, next_op.inst, next_op.address);
+    Write(op.inst.OPCD == 11 ? CompareAndBranch<true> : CompareAndBranch<false>, operands);
+    return;
+  }
+
+  auto& interpreter = m_system.GetInterpreter();
+  Write(InterpretPair, {interpreter, Interpreter::GetInterpreterOp(op.inst),
+                        Interpreter::GetInterpreterOp(next_op.inst), op.inst, next_op.inst});
+}
+
 bool CachedInterpreter::SetEmitterStateToFreeCodeRegion()
 {
   const auto free = m_free_ranges.by_size_begin();
@@ -333,8 +451,7 @@ bool CachedInterpreter::DoJit(u32 em_address, JitBlock* b, u32 nextPC)
   if (IsProfilingEnabled())
     Write(StartProfiledBlock, {js.curBlock->profile_data.get()});
 
-  for (u32 i = 0; i < code_block.m_num_instructions; i++)
-  {
+  const auto begin_instruction = [this](u32 i) -> PPCAnalyst::CodeOp& {
     PPCAnalyst::CodeOp& op = m_code_buffer[i];
     js.op = &op;
 
@@ -345,6 +462,12 @@ bool CachedInterpreter::DoJit(u32 em_address, JitBlock* b, u32 nextPC)
       ++js.numLoadStoreInst;
     if (op.opinfo->flags & FL_USE_FPU)
       ++js.numFloatingPointInst;
+    return op;
+  };
+
+  for (u32 i = 0; i < code_block.m_num_instructions; i++)
+  {
+    PPCAnalyst::CodeOp& op = begin_instruction(i);
 
     if (HandleFunctionHooking(js.compilerPC))
       break;
@@ -374,6 +497,17 @@ bool CachedInterpreter::DoJit(u32 em_address, JitBlock* b, u32 nextPC)
                                InterpretAndCheckExceptions<false>,
               operands);
       }
+      else if (i + 1 < code_block.m_num_instructions &&
+               CanFuseInstructions(op, m_code_buffer[i + 1]))
+      {
+        WriteFusedInstructions(op, m_code_buffer[i + 1]);
+
+        // The next instruction has been emitted as part of this callback.
+        const PPCAnalyst::CodeOp& next_op = begin_instruction(++i);
+        if (next_op.canEndBlock)
+          WriteEndBlock();
+        continue;
+      }
       else
       {
         const InterpretOperands operands = {interpreter, Interpreter::GetInterpreterOp(op.inst),
@@ -13,6 +13,10 @@
 #include "Core/PowerPC/JitCommon/JitBase.h"
 #include "Core/PowerPC/PPCAnalyst.h"
 
+namespace Core
+{
+class BranchWatch;
+}
 namespace CoreTiming
 {
 class CoreTimingManager;
@@ -50,12 +54,29 @@ public:
   const char* GetName() const override { return "Cached Interpreter"; }
   const CommonAsmRoutinesBase* GetAsmRoutines() override { return nullptr; }
 
+protected:
+  // The compare and branch superinstruction, which the tests check against the Interpreter.
+  struct CompareAndBranchOperands;
+
+  static CompareAndBranchOperands DecodeCompareAndBranch(Core::BranchWatch& branch_watch,
+                                                         UGeckoInstruction compare,
+                                                         UGeckoInstruction branch, u32 branch_pc);
+
+  template <bool is_signed>
+  static s32 CompareAndBranch(PowerPC::PowerPCState& ppc_state,
+                              const CompareAndBranchOperands& operands);
+
 private:
   void ExecuteOneBlock();
 
   bool HandleFunctionHooking(u32 address);
   void WriteEndBlock();
 
+  // Superinstructions: some pairs of adjacent instructions are emitted as a single callback to
+  // save a dispatch per instruction.
+  bool CanFuseInstructions(const PPCAnalyst::CodeOp& op, const PPCAnalyst::CodeOp& next_op);
+  void WriteFusedInstructions(const PPCAnalyst::CodeOp& op, const PPCAnalyst::CodeOp& next_op);
+
   // Finds a free memory region and sets the code emitter to point at that region.
   // Returns false if no free memory region can be found.
   bool SetEmitterStateToFreeCodeRegion();
@@ -68,6 +89,7 @@ private:
   struct EndBlockOperands;
   struct InterpretOperands;
   struct InterpretAndCheckExceptionsOperands;
+  struct InterpretPairOperands;
   struct HLEFunctionOperands;
   struct WriteBrokenBlockNPCOperands;
   struct CheckHaltOperands;
@@ -82,6 +104,7 @@ private:
   template <bool write_pc>
   static s32 InterpretAndCheckExceptions(PowerPC::PowerPCState& ppc_state,
                                          const InterpretAndCheckExceptionsOperands& operands);
+  static s32 InterpretPair(PowerPC::PowerPCState& ppc_state, const InterpretPairOperands& operands);
   static s32 HLEFunction(PowerPC::PowerPCState& ppc_state, const HLEFunctionOperands& operands);
   static s32 WriteBrokenBlockNPC(PowerPC::PowerPCState& ppc_state,
                                  const WriteBrokenBlockNPCOperands& operands);
@@ -127,6 +150,30 @@ struct CachedInterpreter::InterpretAndCheckExceptionsOperands : InterpretOperand
   u32 downcount;
 };
 
+struct CachedInterpreter::InterpretPairOperands
+{
+  Interpreter& interpreter;
+  void (*func_a)(Interpreter&, UGeckoInstruction);  // Interpreter::Instruction
+  void (*func_b)(Interpreter&, UGeckoInstruction);  // Interpreter::Instruction
+  UGeckoInstruction inst_a;
+  UGeckoInstruction inst_b;
+};
+
+// cmpi/cmpli followed by a bc which only tests the condition register.
+struct CachedInterpreter::CompareAndBranchOperands
+{
+  Core::BranchWatch& branch_watch;
+  UGeckoInstruction branch_inst;
+  u32 branch_pc;
+  u32 destination;
+  u32 immediate;
+  u8 ra;
+  u8 crf;
+  u8 bi;
+  u8 branch_if_true;
+  u32 : 32;
+};
+
 struct CachedInterpreter::HLEFunctionOperands
 {
   Core::System& system;
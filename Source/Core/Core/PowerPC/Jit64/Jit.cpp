@@ -3,6 +3,7 @@
 
 #include "Core/PowerPC/Jit64/Jit.h"
 
+#include <algorithm>
 #include <map>
 #include <sstream>
 #include <string>
@@ -305,6 +306,7 @@ void Jit64::ClearCache()
   m_const_pool.Clear();
   ClearCodeSpace();
   Clear();
+  ClearHotBranches();
   RefreshConfig();
   asm_routines.Regenerate();
   ResetFreeMemoryRanges();
@@ -1190,6 +1192,9 @@ bool Jit64::DoJit(u32 em_address, JitBlock* b, u32 nextPC)
 
   b->codeSize = static_cast<u32>(GetCodePtr() - b->normalEntry);
   b->originalSize = code_block.m_num_instructions;
+  b->traced_branches = static_cast<u32>(std::count_if(
+      m_code_buffer.begin(), m_code_buffer.begin() + code_block.m_num_instructions,
+      [](const PPCAnalyst::CodeOp& op) { return op.branchIsHot; }));
 
 #ifdef JIT_LOG_GENERATED_CODE
   LogGeneratedX86(code_block.m_num_instructions, m_code_buffer, start, b);
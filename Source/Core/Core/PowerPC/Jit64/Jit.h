@@ -98,6 +98,7 @@ public:
   void WriteExternalExceptionExit();
   void WriteRfiExitDestInRSCRATCH();
   void WriteIdleExit(u32 destination);
+  void WriteBranchProfileCounter(u32 branch_address, bool taken, u64 check_interval);
   template <bool condition>
   void WriteBranchWatch(u32 origin, u32 destination, UGeckoInstruction inst, Gen::X64Reg reg_a,
                         Gen::X64Reg reg_b, BitSet32 caller_save);
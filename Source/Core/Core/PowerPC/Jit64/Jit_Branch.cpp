@@ -11,6 +11,7 @@
 #include "Core/PowerPC/Gekko.h"
 #include "Core/PowerPC/Jit64/RegCache/JitRegCache.h"
 #include "Core/PowerPC/Jit64Common/Jit64PowerPCState.h"
+#include "Core/PowerPC/JitInterface.h"
 #include "Core/PowerPC/PPCAnalyst.h"
 #include "Core/PowerPC/PowerPC.h"
 #include "Core/System.h"
@@ -181,6 +182,24 @@ void Jit64::bx(UGeckoInstruction inst)
   }
 }
 
+void Jit64::WriteBranchProfileCounter(u32 branch_address, bool taken, u64 check_interval)
+{
+  BranchProfile& profile = m_branch_profiles[branch_address];
+  MOV(64, R(RSCRATCH), ImmPtr(taken ? &profile.taken : &profile.not_taken));
+  ADD(64, MatR(RSCRATCH), Imm8(1));
+  if (check_interval == 0)
+    return;
+
+  // Registers must have been flushed by the caller.
+  TEST(32, MatR(RSCRATCH), Imm32(static_cast<u32>(check_interval - 1)));
+  FixupBranch no_check = J_CC(CC_NZ);
+  ABI_PushRegistersAndAdjustStack({}, 0);
+  ABI_CallFunctionPC(JitInterface::UpdateHotBranchFromJIT, &m_system.GetJitInterface(),
+                     branch_address);
+  ABI_PopRegistersAndAdjustStack({}, 0);
+  SetJumpTarget(no_check);
+}
+
 // TODO - optimize to hell and beyond
 // TODO - make nice easy to optimize special cases for the most common
 // variants of this instruction.
@@ -189,6 +208,26 @@ void Jit64::bcx(UGeckoInstruction inst)
   INSTRUCTION_START
   JITDISABLE(bJITBranchOff);
 
+  if (js.op->branchIsHot)
+  {
+    // The taken path has been traced into this block, so only leave it when not taking the branch.
+    FixupBranch taken = JumpIfCRFieldBit(inst.BI >> 2, 3 - (inst.BI & 3),
+                                         (inst.BO_2 & BO_BRANCH_IF_TRUE) != 0);
+    {
+      RCForkGuard gpr_guard = gpr.Fork();
+      RCForkGuard fpr_guard = fpr.Fork();
+      gpr.Flush();
+      fpr.Flush();
+      WriteBranchProfileCounter(js.compilerPC, false, SIDE_EXIT_CHECK_INTERVAL);
+      WriteExit(js.compilerPC + 4);
+    }
+    SetJumpTarget(taken);
+    WriteBranchProfileCounter(js.compilerPC, true, 0);
+    return;
+  }
+
+  const bool profile_branch = jo.superblocks && PPCAnalyst::IsTraceableBranch(inst);
+
   // USES_CR
 
   FixupBranch pCTRDontBranch;
@@ -243,6 +282,8 @@ void Jit64::bcx(UGeckoInstruction inst)
       // ABI_PARAM1 is safe to use after a GPR flush for an optimization in this function.
       WriteBranchWatch<true>(js.compilerPC, js.op->branchTo, inst, ABI_PARAM1, RSCRATCH, {});
     }
+    if (profile_branch)
+      WriteBranchProfileCounter(js.compilerPC, true, HOT_BRANCH_CHECK_INTERVAL);
     if (js.op->branchIsIdleLoop)
     {
       WriteIdleExit(js.op->branchTo);
@@ -258,6 +299,9 @@ void Jit64::bcx(UGeckoInstruction inst)
   if ((inst.BO & BO_DONT_DECREMENT_FLAG) == 0)
     SetJumpTarget(pCTRDontBranch);
 
+  if (profile_branch)
+    WriteBranchProfileCounter(js.compilerPC, false, 0);
+
   if (!analyzer.HasOption(PPCAnalyst::PPCAnalyzer::OPTION_CONDITIONAL_CONTINUE))
   {
     gpr.Flush();
@@ -376,6 +376,10 @@ bool Jit64::CheckMergedBranch(u32 crf) const
   if (!CanMergeNextInstructions(1))
     return false;
 
+  // Traced branches only leave the block when they aren't taken, see bcx.
+  if (js.op[1].branchIsHot)
+    return false;
+
   const UGeckoInstruction& next = js.op[1].inst;
   return (((next.OPCD == 16 /* bcx */) ||
            ((next.OPCD == 19) && (next.SUBOP10 == 528) /* bcctrx */) ||
@@ -457,6 +461,7 @@ void Jit64::DoMergedBranchCondition()
   int test_bit = 3 - (next.BI & 3);
   bool condition = !!(next.BO & BO_BRANCH_IF_TRUE);
   const u32 nextPC = js.op[1].address;
+  const bool profile_branch = jo.superblocks && PPCAnalyst::IsTraceableBranch(next);
 
   ASSERT(gpr.IsAllUnlocked());
 
@@ -488,11 +493,16 @@ void Jit64::DoMergedBranchCondition()
     gpr.Flush();
     fpr.Flush();
 
+    if (profile_branch)
+      WriteBranchProfileCounter(nextPC, true, HOT_BRANCH_CHECK_INTERVAL);
     DoMergedBranch();
   }
 
   SetJumpTarget(pDontBranch);
 
+  if (profile_branch)
+    WriteBranchProfileCounter(nextPC, false, 0);
+
   if (!analyzer.HasOption(PPCAnalyst::PPCAnalyzer::OPTION_CONDITIONAL_CONTINUE))
   {
     gpr.Flush();
@@ -57,7 +57,7 @@
 // After resetting the stack to the top, we call _resetstkoflw() to restore
 // the guard page at the 256kb mark.
 
-const std::array<std::pair<bool JitBase::*, const Config::Info<bool>*>, 23> JitBase::JIT_SETTINGS{{
+const std::array<std::pair<bool JitBase::*, const Config::Info<bool>*>, 24> JitBase::JIT_SETTINGS{{
     {&JitBase::bJITOff, &Config::MAIN_DEBUG_JIT_OFF},
     {&JitBase::bJITLoadStoreOff, &Config::MAIN_DEBUG_JIT_LOAD_STORE_OFF},
     {&JitBase::bJITLoadStorelXzOff, &Config::MAIN_DEBUG_JIT_LOAD_STORE_LXZ_OFF},
@@ -74,6 +74,7 @@ const std::array<std::pair<bool JitBase::*, const Config::Info<bool>*>, 23> JitB
     {&JitBase::m_enable_profiling, &Config::MAIN_DEBUG_JIT_ENABLE_PROFILING},
     {&JitBase::m_enable_debugging, &Config::MAIN_ENABLE_DEBUGGING},
     {&JitBase::m_enable_branch_following, &Config::MAIN_JIT_FOLLOW_BRANCH},
+    {&JitBase::m_enable_superblocks, &Config::MAIN_JIT_SUPERBLOCKS},
     {&JitBase::m_enable_float_exceptions, &Config::MAIN_FLOAT_EXCEPTIONS},
     {&JitBase::m_enable_div_by_zero_exceptions, &Config::MAIN_DIVIDE_BY_ZERO_EXCEPTIONS},
     {&JitBase::m_low_dcbz_hack, &Config::MAIN_LOW_DCBZ_HACK},
@@ -138,6 +139,9 @@ void JitBase::RefreshConfig()
   jo.fastmem = m_fastmem_enabled && jo.fastmem_arena && (m_ppc_state.msr.DR || !any_watchpoints) &&
                EMM::IsExceptionHandlerSupported();
   jo.memcheck = m_system.IsMMUMode() || m_system.IsPauseOnPanicMode() || any_watchpoints;
+  // Which branches get traced depends on when the cache was last cleared.
+  jo.superblocks = m_enable_superblocks && m_enable_branch_following && !m_enable_debugging &&
+                   !Core::WantsDeterminism();
   jo.fp_exceptions = m_enable_float_exceptions;
   jo.div_by_zero_exceptions = m_enable_div_by_zero_exceptions;
 }
@@ -260,6 +264,45 @@ void JitBase::CleanUpAfterStackFault()
   }
 }
 
+void JitBase::ClearHotBranches()
+{
+  m_branch_profiles.clear();
+  m_cold_branches.clear();
+  analyzer.ClearHotBranches();
+}
+
+bool JitBase::UpdateHotBranch(u32 address)
+{
+  const auto it = m_branch_profiles.find(address);
+  if (it == m_branch_profiles.end())
+    return false;
+
+  const BranchProfile& profile = it->second;
+  const bool is_hot = profile.not_taken * HOT_BRANCH_RATIO <= profile.taken;
+
+  if (analyzer.IsHotBranch(address))
+  {
+    if (is_hot)
+      return false;
+
+    // The side exit is used too often. Go back to a regular branch for good, so that the block
+    // doesn't keep getting recompiled.
+    analyzer.RemoveHotBranch(address);
+    m_cold_branches.insert(address);
+    DEBUG_LOG_FMT(DYNA_REC, "Untracing branch at {:08x} (taken {}, not taken {})", address,
+                  profile.taken, profile.not_taken);
+    return true;
+  }
+
+  if (!is_hot || m_cold_branches.contains(address))
+    return false;
+
+  analyzer.AddHotBranch(address);
+  DEBUG_LOG_FMT(DYNA_REC, "Tracing hot branch at {:08x} (taken {}, not taken {})", address,
+                profile.taken, profile.not_taken);
+  return true;
+}
+
 bool JitBase::CanMergeNextInstructions(int count) const
 {
   if (m_system.GetCPU().IsStepping() || js.instructionsLeft < count)
@@ -6,6 +6,7 @@
 #include <array>
 #include <cstddef>
 #include <map>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 
@@ -86,6 +87,7 @@ protected:
     bool memcheck;
     bool fp_exceptions;
     bool div_by_zero_exceptions;
+    bool superblocks;
   };
   struct JitState
   {
@@ -150,6 +152,7 @@ protected:
   bool m_enable_profiling = false;
   bool m_enable_debugging = false;
   bool m_enable_branch_following = false;
+  bool m_enable_superblocks = false;
   bool m_enable_float_exceptions = false;
   bool m_enable_div_by_zero_exceptions = false;
   bool m_low_dcbz_hack = false;
@@ -162,7 +165,28 @@ protected:
   bool m_cleanup_after_stackfault = false;
   u8* m_stack_guard = nullptr;
 
-  static const std::array<std::pair<bool JitBase::*, const Config::Info<bool>*>, 23> JIT_SETTINGS;
+  static const std::array<std::pair<bool JitBase::*, const Config::Info<bool>*>, 24> JIT_SETTINGS;
+
+  // Execution counters of a conditional branch, used to find hot paths for superblocks.
+  struct BranchProfile
+  {
+    u64 taken = 0;
+    u64 not_taken = 0;
+  };
+
+  // How often (in executions of the counted path) generated code asks UpdateHotBranch to
+  // reconsider a branch. Both must be powers of two.
+  static constexpr u64 HOT_BRANCH_CHECK_INTERVAL = 0x1000;
+  static constexpr u64 SIDE_EXIT_CHECK_INTERVAL = 0x100;
+  // A branch is hot when it is taken at least this many times for every time it is not taken.
+  static constexpr u64 HOT_BRANCH_RATIO = 16;
+
+  // Generated code points into this map, so entries may only be dropped along with all code.
+  std::unordered_map<u32, BranchProfile> m_branch_profiles;
+  // Branches which were traced once and then left through their side exit too often.
+  std::unordered_set<u32> m_cold_branches;
+
+  void ClearHotBranches();
 
   bool DoesConfigNeedRefresh();
   void RefreshConfig();
@@ -199,6 +223,10 @@ public:
   virtual bool HandleFault(uintptr_t access_address, SContext* ctx) = 0;
   bool HandleStackFault();
 
+  // Called by generated code when the counters of a branch pass a check interval. Returns true if
+  // the blocks containing the branch must be recompiled.
+  bool UpdateHotBranch(u32 address);
+
   static constexpr std::size_t code_buffer_size = 32000;
 
   // This should probably be removed from public:
@@ -105,6 +105,9 @@ struct JitBlock : public JitBlockData
   // This set stores all physical addresses of all occupied instructions.
   std::set<u32> physical_addresses;
 
+  // The number of hot conditional branches whose taken path was traced into this block.
+  u32 traced_branches = 0;
+
   std::unique_ptr<ProfileData> profile_data;
 };
 
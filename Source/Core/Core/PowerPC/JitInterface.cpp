@@ -118,8 +118,9 @@ static std::string_view GetDescription(const CPUEmuFeatureFlags flags)
 void JitInterface::JitBlockLogDump(const Core::CPUThreadGuard& guard, std::FILE* file) const
 {
   std::fputs(
-      "ppcFeatureFlags\tppcAddress\tppcSize\thostNearSize\thostFarSize\trunCount\tcyclesSpent"
-      "\tcyclesAverage\tcyclesPercent\ttimeSpent(ns)\ttimeAverage(ns)\ttimePercent\tsymbol\n",
+      "ppcFeatureFlags\tppcAddress\tppcSize\thostNearSize\thostFarSize\ttracedBranches\trunCount"
+      "\tcyclesSpent\tcyclesAverage\tcyclesPercent\ttimeSpent(ns)\ttimeAverage(ns)\ttimePercent"
+      "\tsymbol\n",
       file);
 
   if (!m_jit)
@@ -157,10 +158,11 @@ void JitInterface::JitBlockLogDump(const Core::CPUThreadGuard& guard, std::FILE*
       const std::size_t host_far_code_size = block.far_end - block.far_begin;
 
       fmt::println(
-          file, "{}\t{:08x}\t{}\t{}\t{}\t{}\t{}\t{:.6f}\t{:.6f}\t{}\t{:.6f}\t{:.6f}\t\"{}\"",
+          file, "{}\t{:08x}\t{}\t{}\t{}\t{}\t{}\t{}\t{:.6f}\t{:.6f}\t{}\t{:.6f}\t{:.6f}\t\"{}\"",
           GetDescription(block.feature_flags), block.effectiveAddress,
           block.originalSize * sizeof(UGeckoInstruction), host_near_code_size, host_far_code_size,
-          data->run_count, data->cycles_spent, cycles_average, cycles_percent,
+          block.traced_branches, data->run_count, data->cycles_spent, cycles_average,
+          cycles_percent,
           std::chrono::duration_cast<std::chrono::nanoseconds>(data->time_spent).count(),
           time_average, time_percent, symbol ? std::string_view{symbol->name} : "");
     });
@@ -174,10 +176,11 @@ void JitInterface::JitBlockLogDump(const Core::CPUThreadGuard& guard, std::FILE*
       const std::size_t host_near_code_size = block.near_end - block.near_begin;
       const std::size_t host_far_code_size = block.far_end - block.far_begin;
 
-      fmt::println(file, "{}\t{:08x}\t{}\t{}\t{}\t-\t-\t-\t-\t-\t-\t-\t\"{}\"",
+      fmt::println(file, "{}\t{:08x}\t{}\t{}\t{}\t{}\t-\t-\t-\t-\t-\t-\t-\t\"{}\"",
                    GetDescription(block.feature_flags), block.effectiveAddress,
                    block.originalSize * sizeof(UGeckoInstruction), host_near_code_size,
-                   host_far_code_size, symbol ? std::string_view{symbol->name} : "");
+                   host_far_code_size, block.traced_branches,
+                   symbol ? std::string_view{symbol->name} : "");
     });
   }
 }
@@ -342,6 +345,20 @@ void JitInterface::CompileExceptionCheckFromJIT(JitInterface& jit_interface, Exc
   jit_interface.CompileExceptionCheck(type);
 }
 
+void JitInterface::UpdateHotBranch(u32 address)
+{
+  if (!m_jit || !m_jit->UpdateHotBranch(address))
+    return;
+
+  // Invalidate every block containing the branch so that the new path is used from now on.
+  m_jit->GetBlockCache()->InvalidateICache(address, 4, true);
+}
+
+void JitInterface::UpdateHotBranchFromJIT(JitInterface& jit_interface, u32 address)
+{
+  jit_interface.UpdateHotBranch(address);
+}
+
 void JitInterface::Shutdown()
 {
   if (m_jit)
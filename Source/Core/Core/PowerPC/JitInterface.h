@@ -87,6 +87,10 @@ public:
   void CompileExceptionCheck(ExceptionType type);
   static void CompileExceptionCheckFromJIT(JitInterface& jit_interface, ExceptionType type);
 
+  // Superblock formation: reconsider whether the conditional branch at address should be traced
+  void UpdateHotBranch(u32 address);
+  static void UpdateHotBranchFromJIT(JitInterface& jit_interface, u32 address);
+
   /// used for the page fault unit test, don't use outside of tests!
   void SetJit(std::unique_ptr<JitBase> jit);
 
@@ -144,6 +144,103 @@ static void EFB_Write(u32 data, u32 addr)
   }
 }
 
+u8* MMU::GetHostPagePointer(u32 physical_page) const
+{
+  // Only memory that ReadFromHardware and WriteToHardware handle with a plain memcpy can be
+  // accessed through the software TLB.
+  if (m_memory.GetL1Cache() && (physical_page >> 28) == 0xE &&
+      (physical_page < (0xE0000000 + m_memory.GetL1CacheSize())))
+  {
+    return &m_memory.GetL1Cache()[physical_page & 0x0FFFFFFF];
+  }
+
+  if (m_memory.GetRAM() && (physical_page & 0xF8000000) == 0x00000000)
+    return &m_memory.GetRAM()[physical_page & m_memory.GetRamMask()];
+
+  if (m_memory.GetEXRAM() && (physical_page >> 28) == 0x1 &&
+      (physical_page & 0x0FFFFFFF) < m_memory.GetExRamSizeReal())
+  {
+    return &m_memory.GetEXRAM()[physical_page & 0x0FFFFFFF];
+  }
+
+  if (m_memory.GetFakeVMEM() && ((physical_page & 0xFE000000) == 0x7E000000))
+    return &m_memory.GetFakeVMEM()[physical_page & m_memory.GetFakeVMemMask()];
+
+  return nullptr;
+}
+
+const MMU::SoftwareTLBEntry* MMU::LookupSoftwareTLB(size_t tlb_index, u32 address, u8 permission)
+{
+  const u32 tag = address >> HW_PAGE_INDEX_SHIFT;
+  const SoftwareTLBEntry& entry = m_software_tlb[tlb_index][tag & SOFTWARE_TLB_MASK];
+  if (entry.tag != tag || entry.sr != m_ppc_state.sr[address >> 28] ||
+      (entry.permissions & permission) == 0)
+  {
+    return nullptr;
+  }
+
+  // Keep the replacement order of the emulated TLB the same as for a regular lookup.
+  if (entry.tlb_way != SoftwareTLBEntry::FROM_BAT)
+    m_ppc_state.tlb[tlb_index][tag & HW_PAGE_INDEX_MASK].recent = entry.tlb_way;
+
+  return &entry;
+}
+
+void MMU::FillSoftwareTLB(size_t tlb_index, u32 address, const TranslateAddressResult& result)
+{
+  const u32 tag = address >> HW_PAGE_INDEX_SHIFT;
+  const bool is_data = tlb_index == PowerPC::DATA_TLB_INDEX;
+
+  u8 tlb_way = SoftwareTLBEntry::FROM_BAT;
+  u8 permissions = is_data ? SOFTWARE_TLB_READ | SOFTWARE_TLB_WRITE : SOFTWARE_TLB_EXECUTE;
+  if (result.result == TranslateAddressResultEnum::PAGE_TABLE_TRANSLATED)
+  {
+    const u32 vsid = UReg_SR{m_ppc_state.sr[address >> 28]}.VSID;
+    const TLBEntry& tlbe = m_ppc_state.tlb[tlb_index][tag & HW_PAGE_INDEX_MASK];
+    if (tlbe.tag[0] == tag && tlbe.vsid[0] == vsid)
+      tlb_way = 0;
+    else if (tlbe.tag[1] == tag && tlbe.vsid[1] == vsid)
+      tlb_way = 1;
+    else
+      return;
+
+    // Stores have to take the slow path until the page's C bit has been set.
+    if (is_data && UPTE_Hi{tlbe.pte[tlb_way]}.C == 0)
+      permissions &= ~SOFTWARE_TLB_WRITE;
+  }
+
+  const u32 physical_page = result.address & ~HW_PAGE_MASK;
+  u8* host_page = nullptr;
+  if (is_data)
+  {
+    // Uncached and write-through memory and the data cache need the full slow path.
+    if (result.wi || m_ppc_state.m_enable_dcache)
+      return;
+
+    host_page = GetHostPagePointer(physical_page);
+    if (!host_page)
+      return;
+  }
+
+  m_software_tlb[tlb_index][tag & SOFTWARE_TLB_MASK] = SoftwareTLBEntry{
+      tag, m_ppc_state.sr[address >> 28], physical_page, host_page, permissions, tlb_way};
+}
+
+void MMU::InvalidateSoftwareTLBSet(size_t tlb_index, u32 set)
+{
+  for (u32 i = set; i < SOFTWARE_TLB_SIZE; i += HW_PAGE_INDEX_MASK + 1)
+    m_software_tlb[tlb_index][i].tag = SoftwareTLBEntry::INVALID_TAG;
+}
+
+void MMU::InvalidateSoftwareTLB()
+{
+  for (SoftwareTLB& software_tlb : m_software_tlb)
+  {
+    for (SoftwareTLBEntry& entry : software_tlb)
+      entry.tag = SoftwareTLBEntry::INVALID_TAG;
+  }
+}
+
 template <XCheckTLBFlag flag, typename T, bool never_translate>
 T MMU::ReadFromHardware(u32 em_address)
 {
@@ -174,6 +271,17 @@ T MMU::ReadFromHardware(u32 em_address)
   if (!never_translate &&
       (IsOpcodeFlag(flag) ? m_ppc_state.msr.IR.Value() : m_ppc_state.msr.DR.Value()))
   {
+    if constexpr (flag == XCheckTLBFlag::Read)
+    {
+      if (const SoftwareTLBEntry* entry =
+              LookupSoftwareTLB(PowerPC::DATA_TLB_INDEX, em_address, SOFTWARE_TLB_READ))
+      {
+        T value;
+        std::memcpy(&value, &entry->host_page[em_address & HW_PAGE_MASK], sizeof(T));
+        return bswap(value);
+      }
+    }
+
     auto translated_addr = TranslateAddress<flag>(em_address);
     if (!translated_addr.Success())
     {
@@ -181,6 +289,8 @@ T MMU::ReadFromHardware(u32 em_address)
         GenerateDSIException(em_address, false);
       return 0;
     }
+    if constexpr (flag == XCheckTLBFlag::Read)
+      FillSoftwareTLB(PowerPC::DATA_TLB_INDEX, em_address, translated_addr);
     em_address = translated_addr.address;
     wi = translated_addr.wi;
   }
@@ -292,6 +402,17 @@ void MMU::WriteToHardware(u32 em_address, const u32 data, const u32 size)
 
   if (!never_translate && m_ppc_state.msr.DR)
   {
+    if constexpr (flag == XCheckTLBFlag::Write)
+    {
+      if (const SoftwareTLBEntry* entry =
+              LookupSoftwareTLB(PowerPC::DATA_TLB_INDEX, em_address, SOFTWARE_TLB_WRITE))
+      {
+        const u32 swapped_data = Common::swap32(std::rotr(data, size * 8));
+        std::memcpy(&entry->host_page[em_address & HW_PAGE_MASK], &swapped_data, size);
+        return;
+      }
+    }
+
     auto translated_addr = TranslateAddress<flag>(em_address);
     if (!translated_addr.Success())
     {
@@ -299,6 +420,8 @@ void MMU::WriteToHardware(u32 em_address, const u32 data, const u32 size)
         GenerateDSIException(em_address, true);
       return;
     }
+    if constexpr (flag == XCheckTLBFlag::Write)
+      FillSoftwareTLB(PowerPC::DATA_TLB_INDEX, em_address, translated_addr);
     em_address = translated_addr.address;
     wi = translated_addr.wi;
   }
@@ -477,13 +600,19 @@ TryReadInstResult MMU::TryReadInstruction(u32 address)
   bool from_bat = true;
   if (m_ppc_state.msr.IR)
   {
-    auto tlb_addr = TranslateAddress<XCheckTLBFlag::Opcode>(address);
-    if (!tlb_addr.Success())
+    if (const SoftwareTLBEntry* entry =
+            LookupSoftwareTLB(PowerPC::INST_TLB_INDEX, address, SOFTWARE_TLB_EXECUTE))
     {
-      return TryReadInstResult{false, false, 0, 0};
+      address = entry->physical_page | (address & HW_PAGE_MASK);
+      from_bat = entry->tlb_way == SoftwareTLBEntry::FROM_BAT;
     }
     else
     {
+      auto tlb_addr = TranslateAddress<XCheckTLBFlag::Opcode>(address);
+      if (!tlb_addr.Success())
+        return TryReadInstResult{false, false, 0, 0};
+
+      FillSoftwareTLB(PowerPC::INST_TLB_INDEX, address, tlb_addr);
       address = tlb_addr.address;
       from_bat = tlb_addr.result == TranslateAddressResultEnum::BAT_TRANSLATED;
     }
@@ -1413,6 +1542,8 @@ void MMU::InvalidateTLBEntry(u32 address)
 
   m_ppc_state.tlb[PowerPC::DATA_TLB_INDEX][entry_index].Invalidate();
   m_ppc_state.tlb[PowerPC::INST_TLB_INDEX][entry_index].Invalidate();
+  InvalidateSoftwareTLBSet(PowerPC::DATA_TLB_INDEX, entry_index);
+  InvalidateSoftwareTLBSet(PowerPC::INST_TLB_INDEX, entry_index);
 }
 
 // Page Address Translation
@@ -1502,9 +1633,16 @@ MMU::TranslateAddressResult MMU::TranslatePageAddress(const EffectiveAddress add
         }
 
         // We already updated the TLB entry if this was caused by a C bit.
-        if (res != TLBLookupResult::UpdateC)
+        if (res != TLBLookupResult::UpdateC && !IsNoExceptionFlag(flag))
+        {
           UpdateTLBEntry(m_ppc_state, flag, pte2, address.Hex, VSID);
 
+          // The replaced TLB entry may still be cached in the software TLB.
+          InvalidateSoftwareTLBSet(IsOpcodeFlag(flag) ? PowerPC::INST_TLB_INDEX :
+                                                        PowerPC::DATA_TLB_INDEX,
+                                   address.page_index & HW_PAGE_INDEX_MASK);
+        }
+
         *wi = (pte2.WIMG & 0b1100) != 0;
 
         return TranslateAddressResult{TranslateAddressResultEnum::PAGE_TABLE_TRANSLATED,
@@ -1627,6 +1765,7 @@ void MMU::UpdateFakeMMUBat(BatTable& bat_table, u32 start_addr)
 
 void MMU::DBATUpdated()
 {
+  InvalidateSoftwareTLB();
   m_dbat_table = {};
   UpdateBATs(m_dbat_table, SPR_DBAT0U);
   bool extended_bats = m_system.IsWii() && HID4(m_ppc_state).SBE;
@@ -1649,6 +1788,7 @@ void MMU::DBATUpdated()
 
 void MMU::IBATUpdated()
 {
+  InvalidateSoftwareTLB();
   m_ibat_table = {};
   UpdateBATs(m_ibat_table, SPR_IBAT0U);
   bool extended_bats = m_system.IsWii() && HID4(m_ppc_state).SBE;
@@ -72,6 +72,15 @@ constexpr size_t HW_PAGE_MASK = HW_PAGE_SIZE - 1;
 constexpr u32 HW_PAGE_INDEX_SHIFT = 12;
 constexpr u32 HW_PAGE_INDEX_MASK = 0x3f;
 
+// The software TLB caches translations of effective pages to host pointers so that loads and
+// stores done by the interpreters (and by the slow paths of the JITs) can skip the BAT lookup and
+// the emulated TLB entirely. It is direct-mapped and strictly a subset of what the BATs and the
+// emulated TLB currently contain, so it never changes what the game observes.
+constexpr u32 SOFTWARE_TLB_SIZE = 1024;
+constexpr u32 SOFTWARE_TLB_MASK = SOFTWARE_TLB_SIZE - 1;
+static_assert(SOFTWARE_TLB_SIZE % (HW_PAGE_INDEX_MASK + 1) == 0,
+              "Each emulated TLB set must map to a whole number of software TLB entries");
+
 // Return value of MMU::TryReadInstruction().
 struct TryReadInstResult
 {
@@ -241,6 +250,7 @@ public:
   void InvalidateTLBEntry(u32 address);
   void DBATUpdated();
   void IBATUpdated();
+  void InvalidateSoftwareTLB();
 
   // Result changes based on the BAT registers and MSR.DR.  Returns whether
   // it's safe to optimize a read or write to this address to an unguarded
@@ -278,6 +288,32 @@ private:
     bool Success() const { return result <= TranslateAddressResultEnum::PAGE_TABLE_TRANSLATED; }
   };
 
+  enum SoftwareTLBPermission : u8
+  {
+    SOFTWARE_TLB_READ = 0x1,
+    SOFTWARE_TLB_WRITE = 0x2,
+    SOFTWARE_TLB_EXECUTE = 0x4,
+  };
+
+  struct SoftwareTLBEntry
+  {
+    static constexpr u32 INVALID_TAG = 0xffffffff;
+    static constexpr u8 FROM_BAT = 0xff;
+
+    // Effective page number (address >> HW_PAGE_INDEX_SHIFT)
+    u32 tag = INVALID_TAG;
+    // Segment register the translation was made with. Checked on every hit, as some JITs write
+    // the segment registers without going through the MMU.
+    u32 sr = 0;
+    u32 physical_page = 0;
+    // Host pointer to the start of the page, or nullptr if it can't be accessed directly
+    u8* host_page = nullptr;
+    u8 permissions = 0;
+    // The way of the emulated TLB set holding this translation, or FROM_BAT
+    u8 tlb_way = FROM_BAT;
+  };
+  using SoftwareTLB = std::array<SoftwareTLBEntry, SOFTWARE_TLB_SIZE>;
+
   union EffectiveAddress
   {
     BitField<0, 12, u32> offset;
@@ -297,6 +333,11 @@ private:
   template <const XCheckTLBFlag flag>
   TranslateAddressResult TranslatePageAddress(const EffectiveAddress address, bool* wi);
 
+  const SoftwareTLBEntry* LookupSoftwareTLB(size_t tlb_index, u32 address, u8 permission);
+  void FillSoftwareTLB(size_t tlb_index, u32 address, const TranslateAddressResult& result);
+  void InvalidateSoftwareTLBSet(size_t tlb_index, u32 set);
+  u8* GetHostPagePointer(u32 physical_page) const;
+
   void GenerateDSIException(u32 effective_address, bool write);
   void GenerateISIException(u32 effective_address);
 
@@ -326,6 +367,9 @@ private:
 
   BatTable m_ibat_table;
   BatTable m_dbat_table;
+
+  // Indexed by PowerPC::DATA_TLB_INDEX and PowerPC::INST_TLB_INDEX
+  std::array<SoftwareTLB, 2> m_software_tlb;
 };
 
 void ClearDCacheLineFromJit(MMU& mmu, u32 address);
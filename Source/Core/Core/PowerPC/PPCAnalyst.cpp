@@ -43,6 +43,8 @@ namespace PPCAnalyst
 {
 // 0 does not perform block merging
 constexpr u32 BRANCH_FOLLOWING_THRESHOLD = 2;
+// Maximum number of hot conditional branches traced into a single block.
+constexpr u32 HOT_BRANCH_FOLLOWING_THRESHOLD = 4;
 
 constexpr u32 INVALID_BRANCH_TARGET = 0xFFFFFFFF;
 
@@ -225,6 +227,13 @@ static bool InstructionCanEndBlock(const CodeOp& op)
           GetSPRIndex(op.inst) == SPR_MMCR1);
 }
 
+bool IsTraceableBranch(UGeckoInstruction inst)
+{
+  // Only bcx which tests a CR bit, without touching CTR or LR
+  return inst.OPCD == 16 && !inst.LK && (inst.BO & BO_DONT_DECREMENT_FLAG) &&
+         (inst.BO & BO_DONT_CHECK_CONDITION) == 0;
+}
+
 bool PPCAnalyzer::CanSwapAdjacentOps(const CodeOp& a, const CodeOp& b) const
 {
   const GekkoOPInfo* a_info = a.opinfo;
@@ -407,15 +416,14 @@ void FindFunctions(const Core::CPUThreadGuard& guard, u32 startAddr, u32 endAddr
   int numLeafs = 0, numNice = 0, numUnNice = 0;
   int numTimer = 0, numRFI = 0, numStraightLeaf = 0;
   int leafSize = 0, niceSize = 0, unniceSize = 0;
-  for (auto& func : func_db->AccessSymbols())
+  for (Common::Symbol& f : func_db->AccessSymbols())
   {
-    if (func.second.address == 4)
+    if (f.address == 4)
     {
       WARN_LOG_FMT(SYMBOLS, "Weird function");
       continue;
     }
-    AnalyzeFunction2(func_db, &(func.second));
-    Common::Symbol& f = func.second;
+    AnalyzeFunction2(func_db, &f);
     if (f.name.substr(0, 3) == "zzz")
     {
       if (f.flags & Common::FFLAG_LEAF)
@@ -737,30 +745,56 @@ void PPCAnalyzer::SetInstructionStats(CodeBlock* block, CodeOp* code,
   }
 }
 
+// Memory barriers are commonly used between the loads of a loop polling a hardware register, and
+// don't have any effect which could make the next iteration behave differently.
+static bool IsMemoryBarrier(UGeckoInstruction inst)
+{
+  return inst.OPCD == 31 && (inst.SUBOP10 == 598 /* sync */ || inst.SUBOP10 == 854 /* eieio */);
+}
+
 bool PPCAnalyzer::IsBusyWaitLoop(CodeBlock* block, CodeOp* code, size_t instructions) const
 {
-  // Very basic algorithm to detect busy wait loops:
-  //   * It loops to itself and does not contain any other branches.
-  //   * It does not write to memory.
-  //   * It only reads from registers it wrote to earlier in the loop, or it
-  //     does not write to these registers.
-  //
-  // Would benefit a lot from basic inlining support - a lot of the most
-  // used busy loops are DSP register interactions, which are bl/cmp/bne
-  // (with the bl target a pure function that follows the above rules). We
-  // don't detect these at the moment.
+  // A loop is a busy wait loop if running it again can only behave differently after something
+  // outside of the CPU (an interrupt, DMA, hardware registers, the other threads' memory writes
+  // being delivered by such events...) has changed, so that it's safe to skip ahead to the next
+  // scheduled event:
+  //   * It loops to itself. Any other branch must either leave the loop, or be a call that was
+  //     inlined through branch following together with its return.
+  //   * It does not write to memory and contains no other instruction with side effects.
+  //   * Every register, CR field and the carry flag is either only read, or written before it is
+  //     read in the loop. This rules out counters and other loop carried state.
   std::bitset<32> write_disallowed_regs;
   std::bitset<32> written_regs;
+  BitSet8 write_disallowed_cr;
+  BitSet8 written_cr;
+  bool write_disallowed_ca = false;
+  bool written_ca = false;
+
   for (size_t i = 0; i <= instructions; ++i)
   {
-    if (code[i].opinfo->type == OpType::Branch)
+    const CodeOp& op = code[i];
+    if (op.opinfo->type == OpType::Branch)
     {
-      if (code[i].branchUsesCtr)
+      if (op.branchUsesCtr)
         return false;
-      if (code[i].branchTo == block->m_address && i == instructions)
+      if (op.inst.LK)
+      {
+        // Only allow calls which have been inlined, since LR gets the same value every time.
+        if (i == instructions || code[i + 1].address != op.branchTo)
+          return false;
+
+        auto& system = Core::System::GetInstance();
+        if (HLE::TryReplaceFunction(system.GetPPCSymbolDB(), op.branchTo,
+                                    system.GetPowerPC().GetMode()))
+        {
+          return false;
+        }
+      }
+      if (op.branchTo == block->m_address && i == instructions)
         return true;
     }
-    else if (code[i].opinfo->type != OpType::Integer && code[i].opinfo->type != OpType::Load)
+    else if (op.opinfo->type != OpType::Integer && op.opinfo->type != OpType::Load &&
+             !IsMemoryBarrier(op.inst))
     {
       // In the future, some subsets of other instruction types might get
       // supported. Right now, only try loops that have this very
@@ -769,7 +803,7 @@ bool PPCAnalyzer::IsBusyWaitLoop(CodeBlock* block, CodeOp* code, size_t instruct
     }
     else
     {
-      for (int reg : code[i].regsIn)
+      for (int reg : op.regsIn)
       {
         if (reg == -1)
           continue;
@@ -777,7 +811,7 @@ bool PPCAnalyzer::IsBusyWaitLoop(CodeBlock* block, CodeOp* code, size_t instruct
           continue;
         write_disallowed_regs[reg] = true;
       }
-      for (int reg : code[i].regsOut)
+      for (int reg : op.regsOut)
       {
         if (reg == -1)
           continue;
@@ -785,7 +819,26 @@ bool PPCAnalyzer::IsBusyWaitLoop(CodeBlock* block, CodeOp* code, size_t instruct
           return false;
         written_regs[reg] = true;
       }
+
+      if (op.opinfo->flags & FL_READ_CA)
+        write_disallowed_ca |= !written_ca;
+      if (op.opinfo->flags & FL_SET_CA)
+      {
+        if (write_disallowed_ca)
+          return false;
+        written_ca = true;
+      }
     }
+
+    // Branches that don't check a condition, like the blr of an inlined call, are marked as reading
+    // the CR field that BI points to anyway.
+    BitSet8 cr_in = op.crIn;
+    if (op.opinfo->type == OpType::Branch && (op.inst.BO & BO_DONT_CHECK_CONDITION))
+      cr_in = BitSet8{};
+    write_disallowed_cr |= cr_in & ~written_cr;
+    if (op.crOut & write_disallowed_cr)
+      return false;
+    written_cr |= op.crOut;
   }
   return false;
 }
@@ -826,6 +879,7 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer,
   bool found_call = false;
   size_t caller = 0;
   u32 numFollows = 0;
+  u32 numHotFollows = 0;
   u32 num_inst = 0;
 
   const bool enable_follow = m_enable_branch_following;
@@ -857,6 +911,7 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer,
     SetInstructionStats(block, &code[i], opinfo);
 
     bool follow = false;
+    bool follow_hot = false;
 
     bool conditional_continue = false;
 
@@ -921,6 +976,17 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer,
       {
         // bcx with conditional branch
         conditional_continue = true;
+
+        // Trace the taken path of branches which profiling found to be nearly always taken,
+        // unless that would unroll a loop.
+        const u32 target = code[i].branchTo;
+        if (enable_follow && block_size > 1 && IsTraceableBranch(inst) &&
+            numHotFollows < HOT_BRANCH_FOLLOWING_THRESHOLD && IsHotBranch(code[i].address) &&
+            std::none_of(code, code + i + 1,
+                         [target](const CodeOp& op) { return op.address == target; }))
+        {
+          follow_hot = true;
+        }
       }
       else if (inst.OPCD == 19 && inst.SUBOP10 == 16 &&
                ((inst.BO & BO_DONT_DECREMENT_FLAG) == 0 ||
@@ -945,7 +1011,15 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer,
     code[i].branchIsIdleLoop =
         code[i].branchTo == block->m_address && IsBusyWaitLoop(block, code, i);
 
-    if (follow && numFollows < BRANCH_FOLLOWING_THRESHOLD)
+    if (follow_hot)
+    {
+      // Follow the hot conditional branch. The JIT leaves the block when it isn't taken.
+      numHotFollows++;
+      code[i].branchIsHot = true;
+      address = code[i].branchTo;
+      found_call = false;
+    }
+    else if (follow && numFollows < BRANCH_FOLLOWING_THRESHOLD)
     {
       // Follow the unconditional branch.
       numFollows++;
@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <set>
+#include <unordered_set>
 #include <vector>
 
 #include "Common/BitSet.h"
@@ -40,6 +41,8 @@ struct CodeOp  // 16B
   BitSet8 crOut;
   bool branchUsesCtr = false;
   bool branchIsIdleLoop = false;
+  // conditional branch whose taken path follows it in the block (superblock formation)
+  bool branchIsHot = false;
   BitSet8 wantsCR;
   bool wantsFPRF = false;
   bool wantsCA = false;
@@ -183,6 +186,19 @@ public:
   void SetDivByZeroExceptionsEnabled(bool enabled) { m_enable_div_by_zero_exceptions = enabled; }
   u32 Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, std::size_t block_size) const;
 
+  // Conditional branches which are known to be nearly always taken. When branch following is
+  // enabled, their taken path is traced into the block and the JIT emits a side exit instead.
+  void AddHotBranch(u32 address) { m_hot_branches.insert(address); }
+  void RemoveHotBranch(u32 address) { m_hot_branches.erase(address); }
+  bool IsHotBranch(u32 address) const { return m_hot_branches.contains(address); }
+  void ClearHotBranches() { m_hot_branches.clear(); }
+
+  // Fills in what Analyze knows about a single instruction from code->inst and code->address.
+  void SetInstructionStats(CodeBlock* block, CodeOp* code, const GekkoOPInfo* opinfo) const;
+  // Whether code[0] to code[instructions], which ends with a branch back to the start of the
+  // block, is a busy wait loop that can be skipped until the next scheduled event.
+  bool IsBusyWaitLoop(CodeBlock* block, CodeOp* code, size_t instructions) const;
+
 private:
   enum class ReorderType
   {
@@ -195,8 +211,6 @@ private:
   void ReorderInstructionsCore(u32 instructions, CodeOp* code, bool reverse,
                                ReorderType type) const;
   void ReorderInstructions(u32 instructions, CodeOp* code) const;
-  void SetInstructionStats(CodeBlock* block, CodeOp* code, const GekkoOPInfo* opinfo) const;
-  bool IsBusyWaitLoop(CodeBlock* block, CodeOp* code, size_t instructions) const;
 
   // Options
   u32 m_options = 0;
@@ -205,8 +219,13 @@ private:
   bool m_enable_branch_following = false;
   bool m_enable_float_exceptions = false;
   bool m_enable_div_by_zero_exceptions = false;
+
+  std::unordered_set<u32> m_hot_branches;
 };
 
+// Whether a conditional branch is simple enough to have its taken path traced into a block.
+bool IsTraceableBranch(UGeckoInstruction inst);
+
 void FindFunctions(const Core::CPUThreadGuard& guard, u32 startAddr, u32 endAddr,
                    PPCSymbolDB* func_db);
 bool AnalyzeFunction(const Core::CPUThreadGuard& guard, u32 startAddr, Common::Symbol& func,
@@ -43,6 +43,7 @@ Common::Symbol* PPCSymbolDB::AddFunction(const Core::CPUThreadGuard& guard, u32
 
   const auto insert = m_functions.emplace(start_addr, std::move(symbol));
   Common::Symbol* ptr = &insert.first->second;
+  AddToAddressIndex(ptr);
   ptr->type = Common::Symbol::Type::Function;
   m_checksum_to_function[ptr->hash].insert(ptr);
   return ptr;
@@ -67,6 +68,7 @@ void PPCSymbolDB::AddKnownSymbol(const Core::CPUThreadGuard& guard, u32 startAdd
     auto& new_symbol = m_functions.emplace(startAddr, name).first->second;
     new_symbol.type = type;
     new_symbol.address = startAddr;
+    AddToAddressIndex(&new_symbol);
 
     if (new_symbol.type == Common::Symbol::Type::Function)
     {
@@ -87,27 +89,6 @@ void PPCSymbolDB::AddKnownSymbol(const Core::CPUThreadGuard& guard, u32 startAdd
   }
 }
 
-Common::Symbol* PPCSymbolDB::GetSymbolFromAddr(u32 addr)
-{
-  auto it = m_functions.lower_bound(addr);
-
-  if (it != m_functions.end())
-  {
-    // If the address is exactly the start address of a symbol, we're done.
-    if (it->second.address == addr)
-      return &it->second;
-  }
-  if (it != m_functions.begin())
-  {
-    // Otherwise, check whether the address is within the bounds of a symbol.
-    --it;
-    if (addr >= it->second.address && addr < it->second.address + it->second.size)
-      return &it->second;
-  }
-
-  return nullptr;
-}
-
 std::string_view PPCSymbolDB::GetDescription(u32 addr)
 {
   if (const Common::Symbol* const symbol = GetSymbolFromAddr(addr))
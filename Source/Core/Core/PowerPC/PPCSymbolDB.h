@@ -26,8 +26,6 @@ public:
                       const std::string& name,
                       Common::Symbol::Type type = Common::Symbol::Type::Function);
 
-  Common::Symbol* GetSymbolFromAddr(u32 addr) override;
-
   std::string_view GetDescription(u32 addr);
 
   void FillInCallers();
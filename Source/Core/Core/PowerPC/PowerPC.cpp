@@ -253,6 +253,10 @@ void PowerPCManager::RefreshConfig()
     INFO_LOG_FMT(POWERPC, "Flushing data cache");
     m_ppc_state.dCache.FlushAll(m_system.GetMemory());
   }
+
+  // Accesses that hit in the software TLB bypass the data cache.
+  if (old_enable_dcache != m_ppc_state.m_enable_dcache)
+    m_system.GetMMU().InvalidateSoftwareTLB();
 }
 
 void PowerPCManager::Init(CPUCore cpu_core)
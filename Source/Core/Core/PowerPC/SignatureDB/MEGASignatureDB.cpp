@@ -3,13 +3,17 @@
 
 #include "Core/PowerPC/SignatureDB/MEGASignatureDB.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdlib>
 #include <fstream>
 #include <limits>
+#include <span>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "Common/FileUtil.h"
 #include "Common/Logging/Log.h"
@@ -101,18 +105,12 @@ bool GetRefs(MEGASignature* sig, std::istringstream* iss)
   return true;
 }
 
-bool Compare(const Core::CPUThreadGuard& guard, u32 address, u32 size, const MEGASignature& sig)
+bool Compare(std::span<const u32> code, const MEGASignature& sig)
 {
-  if (size != sig.code.size() * sizeof(u32))
-    return false;
-
   for (size_t i = 0; i < sig.code.size(); ++i)
   {
-    if (sig.code[i] != 0 && PowerPC::MMU::HostRead_U32(
-                                guard, static_cast<u32>(address + i * sizeof(u32))) != sig.code[i])
-    {
+    if (sig.code[i] != 0 && code[i] != sig.code[i])
       return false;
-    }
   }
   return true;
 }
@@ -160,19 +158,32 @@ bool MEGASignatureDB::Save(const std::string& file_path) const
 
 void MEGASignatureDB::Apply(const Core::CPUThreadGuard& guard, PPCSymbolDB* symbol_db) const
 {
-  for (auto& it : symbol_db->AccessSymbols())
+  // A signature can only match functions of its own size.
+  std::unordered_map<u32, std::vector<const MEGASignature*>> signatures_by_size;
+  for (const MEGASignature& sig : m_signatures)
+    signatures_by_size[static_cast<u32>(sig.code.size() * sizeof(u32))].push_back(&sig);
+
+  // Only functions with the size of a signature are read and compared. That leaves few enough
+  // comparisons to run them all on this thread.
+  std::vector<u32> code;
+  for (Common::Symbol& symbol : symbol_db->AccessSymbols())
   {
-    auto& symbol = it.second;
-    for (const auto& sig : m_signatures)
-    {
-      if (Compare(guard, symbol.address, symbol.size, sig))
-      {
-        symbol.name = sig.name;
-        INFO_LOG_FMT(SYMBOLS, "Found {} at {:08x} (size: {:08x})!", sig.name, symbol.address,
-                     symbol.size);
-        break;
-      }
-    }
+    const auto sigs = signatures_by_size.find(symbol.size);
+    if (sigs == signatures_by_size.end())
+      continue;
+
+    code.resize(symbol.size / sizeof(u32));
+    for (size_t i = 0; i < code.size(); ++i)
+      code[i] = PowerPC::MMU::HostRead_U32(guard, static_cast<u32>(symbol.address + i * 4));
+
+    const auto match = std::ranges::find_if(
+        sigs->second, [&code](const MEGASignature* sig) { return Compare(code, *sig); });
+    if (match == sigs->second.end())
+      continue;
+
+    symbol.name = (*match)->name;
+    INFO_LOG_FMT(SYMBOLS, "Found {} at {:08x} (size: {:08x})!", symbol.name, symbol.address,
+                 symbol.size);
   }
   symbol_db->Index();
 }
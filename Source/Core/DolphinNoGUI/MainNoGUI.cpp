@@ -4,28 +4,46 @@
 #include "DolphinNoGUI/Platform.h"
 
 #include <OptionParser.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <cstdio>
 #include <cstring>
 #include <signal.h>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <variant>
 #include <vector>
 
+#include <fmt/format.h>
+#include <picojson.h>
+
 #ifndef _WIN32
 #include <unistd.h>
 #else
 #include <Windows.h>
 #endif
 
+#include "Common/Config/Config.h"
+#include "Common/JsonUtil.h"
 #include "Common/ScopeGuard.h"
 #include "Common/StringUtil.h"
 #include "Core/Boot/Boot.h"
 #include "Core/BootManager.h"
+#include "Core/Config/GraphicsSettings.h"
+#include "Core/Config/MainSettings.h"
 #include "Core/Core.h"
 #include "Core/DolphinAnalytics.h"
+#include "Core/FifoPlayer/FifoPlayer.h"
 #include "Core/Host.h"
+#include "Core/Movie.h"
 #include "Core/System.h"
 
+#include "DolphinNoGUI/MovieReplay.h"
+
 #include "UICommon/CommandLineParse.h"
 #ifdef USE_DISCORD_PRESENCE
 #include "UICommon/DiscordPresence.h"
@@ -35,6 +53,7 @@
 #include "InputCommon/GCAdapter.h"
 
 #include "VideoCommon/VideoBackendBase.h"
+#include "VideoCommon/VideoThreadTimings.h"
 
 static std::unique_ptr<Platform> s_platform;
 
@@ -185,6 +204,109 @@ static std::unique_ptr<Platform> GetPlatform(const optparse::Values& options)
   return nullptr;
 }
 
+static bool WriteReport(const std::string& output_path, const picojson::value& report)
+{
+  if (output_path.empty())
+  {
+    std::puts(report.serialize(true).c_str());
+    return true;
+  }
+  return JsonToFile(output_path, report, true);
+}
+
+static picojson::value CreateFifoBenchmarkReport(const std::string& dff_path, int loops)
+{
+  using Category = VideoThreadTimings::Category;
+  const auto to_ns = [](VideoThreadTimings::Clock::duration duration) {
+    return picojson::value(static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()));
+  };
+
+  const std::vector<VideoThreadTimings::Frame> frames = g_video_thread_timings.Stop();
+
+  std::array<VideoThreadTimings::Clock::duration, VideoThreadTimings::NUM_CATEGORIES> total{};
+  picojson::array frames_json;
+  frames_json.reserve(frames.size());
+  for (const VideoThreadTimings::Frame& frame : frames)
+  {
+    picojson::object frame_json;
+    for (size_t i = 0; i < VideoThreadTimings::NUM_CATEGORIES; ++i)
+    {
+      const std::string name(VideoThreadTimings::GetCategoryName(static_cast<Category>(i)));
+      frame_json.emplace(name, to_ns(frame.time_spent[i]));
+      total[i] += frame.time_spent[i];
+    }
+    frames_json.emplace_back(std::move(frame_json));
+  }
+
+  picojson::object total_json;
+  for (size_t i = 0; i < VideoThreadTimings::NUM_CATEGORIES; ++i)
+  {
+    const std::string name(VideoThreadTimings::GetCategoryName(static_cast<Category>(i)));
+    total_json.emplace(name, to_ns(total[i]));
+  }
+
+  picojson::object root;
+  root.emplace("file", picojson::value(dff_path));
+  root.emplace("video_backend", picojson::value(Config::Get(Config::MAIN_GFX_BACKEND)));
+  root.emplace("loops", picojson::value(static_cast<double>(loops)));
+  root.emplace("frame_count", picojson::value(static_cast<double>(frames.size())));
+  root.emplace("unit", picojson::value("ns"));
+  root.emplace("total", picojson::value(std::move(total_json)));
+  root.emplace("frames", picojson::value(std::move(frames_json)));
+  return picojson::value(std::move(root));
+}
+
+static int RunReplayList(const optparse::Values& options)
+{
+  const std::string list_path = static_cast<const char*>(options.get("replay_list"));
+  const std::optional<std::vector<MovieReplay::Job>> jobs = MovieReplay::LoadJobList(list_path);
+  if (!jobs)
+  {
+    fprintf(stderr, "The replay list must be a JSON array of {\"game\", \"movie\"} objects.\n");
+    return 1;
+  }
+
+  // Every replay gets a fresh user directory, so settings have to be passed on explicitly.
+  std::vector<std::string> child_args{"--checkpoint_interval",
+                                      static_cast<const char*>(options.get("checkpoint_interval"))};
+  if (options.get("record_checkpoints"))
+    child_args.emplace_back("--record_checkpoints");
+  for (const char* option : {"video_backend", "audio_emulation"})
+  {
+    const std::string value = static_cast<const char*>(options.get(option));
+    if (!value.empty())
+      child_args.insert(child_args.end(), {fmt::format("--{}", option), value});
+  }
+  if (options.is_set_by_user("config"))
+  {
+    for (const std::string& config : options.all("config"))
+      child_args.insert(child_args.end(), {"--config", config});
+  }
+
+  unsigned int max_processes = std::thread::hardware_concurrency();
+  if (options.is_set("replay_jobs"))
+    max_processes = options.get("replay_jobs");
+
+  picojson::array reports = MovieReplay::RunJobs(*jobs, child_args, max_processes);
+  const auto failed = std::ranges::count_if(reports, [](const picojson::value& report) {
+    return !MovieReplay::IsSuccess(report.get<picojson::object>());
+  });
+
+  picojson::object root;
+  root.emplace("passed", picojson::value(static_cast<double>(reports.size() - failed)));
+  root.emplace("failed", picojson::value(static_cast<double>(failed)));
+  root.emplace("movies", picojson::value(std::move(reports)));
+
+  const std::string output_path = static_cast<const char*>(options.get("replay_output"));
+  if (!WriteReport(output_path, picojson::value(std::move(root))))
+  {
+    fprintf(stderr, "Could not write the replay report\n");
+    return 1;
+  }
+  return failed == 0 ? 0 : 1;
+}
+
 #ifdef _WIN32
 #define main app_main
 #endif
@@ -216,10 +338,47 @@ int main(int argc, char* argv[])
             "macos"
 #endif
       });
+  parser->add_option("--fifo_benchmark")
+      .action("store")
+      .metavar("<loops>")
+      .help("Play back the given FIFO log this many times as fast as possible, then report the "
+            "time the video thread spent on each frame as JSON");
+  parser->add_option("--benchmark_output")
+      .action("store")
+      .metavar("<file>")
+      .help("Write the FIFO benchmark report to this file instead of the standard output");
+  parser->add_option("--replay")
+      .action("store_true")
+      .help("Play back the movie as fast as possible, stop at its end and report as JSON whether "
+            "emulated memory matched the checkpoints saved next to the movie");
+  parser->add_option("--replay_list")
+      .action("store")
+      .metavar("<file>")
+      .help("Replay every movie of a JSON array of {\"game\", \"movie\"} objects, each in a "
+            "process and user directory of its own, and report the results as JSON");
+  parser->add_option("--replay_jobs")
+      .action("store")
+      .metavar("<count>")
+      .help("Replay this many movies of the replay list at once (default: one per CPU thread)");
+  parser->add_option("--record_checkpoints")
+      .action("store_true")
+      .help("Save the checkpoints of the replayed movies instead of checking them");
+  parser->add_option("--checkpoint_interval")
+      .action("store")
+      .metavar("<frames>")
+      .set_default(60)
+      .help("Hash emulated memory every this many frames of a replay [default: %default]");
+  parser->add_option("--replay_output")
+      .action("store")
+      .metavar("<file>")
+      .help("Write the replay report to this file instead of the standard output");
 
   optparse::Values& options = CommandLineParse::ParseArguments(parser.get(), argc, argv);
   std::vector<std::string> args = parser->args();
 
+  if (options.is_set("replay_list"))
+    return RunReplayList(options);
+
   std::optional<std::string> save_state_path;
   if (options.is_set("save_state"))
   {
@@ -266,7 +425,10 @@ int main(int argc, char* argv[])
   if (options.is_set("user"))
     user_directory = static_cast<const char*>(options.get("user"));
 
-  s_platform = GetPlatform(options);
+  // Replays are meant to run unattended, so they don't open a window unless asked to.
+  const bool replay = options.get("replay");
+  s_platform = replay && !options.is_set("platform") ? Platform::CreateHeadlessPlatform() :
+                                                       GetPlatform(options);
   if (!s_platform || !s_platform->Init())
   {
     fprintf(stderr, "No platform found, or failed to initialize.\n");
@@ -308,6 +470,73 @@ int main(int argc, char* argv[])
   sigaction(SIGTERM, &sa, nullptr);
 #endif
 
+  const bool fifo_benchmark = options.is_set("fifo_benchmark");
+  int fifo_benchmark_loops = 0;
+  std::string fifo_benchmark_file;
+  if (fifo_benchmark)
+  {
+    const auto* dff = boot ? std::get_if<BootParameters::DFF>(&boot->parameters) : nullptr;
+    fifo_benchmark_loops = options.get("fifo_benchmark");
+    if (!dff || fifo_benchmark_loops <= 0)
+    {
+      fprintf(stderr, "The FIFO benchmark needs a FIFO log and a positive number of loops.\n");
+      return 1;
+    }
+    fifo_benchmark_file = dff->dff_path;
+
+    // Run unthrottled, and without rendering anything unless another backend was requested.
+    Config::SetCurrent(Config::MAIN_EMULATION_SPEED, 0.0f);
+    Config::SetCurrent(Config::GFX_VSYNC, false);
+    Config::SetCurrent(Config::MAIN_FIFOPLAYER_LOOP_REPLAY, true);
+    if (std::string_view(options.get("video_backend")).empty())
+      Config::SetCurrent(Config::MAIN_GFX_BACKEND, "Null");
+
+    Core::System::GetInstance().GetFifoPlayer().SetLoopCount(fifo_benchmark_loops);
+    g_video_thread_timings.Start();
+  }
+
+  auto& movie = Core::System::GetInstance().GetMovie();
+  const std::string movie_path =
+      options.is_set("movie") ? static_cast<const char*>(options.get("movie")) : "";
+  std::atomic<bool> reached_movie_end = false;
+  if (replay)
+  {
+    const int checkpoint_interval = options.get("checkpoint_interval");
+    if (movie_path.empty() || !game_specified || checkpoint_interval <= 0)
+    {
+      fprintf(stderr, "A replay needs a game, a movie and a positive checkpoint interval.\n");
+      return 1;
+    }
+
+    Config::SetCurrent(Config::MAIN_EMULATION_SPEED, 0.0f);
+    Config::SetCurrent(Config::GFX_VSYNC, false);
+    Config::SetCurrent(Config::MAIN_USE_PANIC_HANDLERS, false);
+    if (std::string_view(options.get("video_backend")).empty())
+      Config::SetCurrent(Config::MAIN_GFX_BACKEND, "Null");
+
+    movie.SetReadOnly(true);
+    movie.SetCheckpointInterval(checkpoint_interval);
+    movie.SetPlaybackEndedCallback([&reached_movie_end](bool reached_end) {
+      reached_movie_end = reached_end;
+      s_platform->Stop();
+    });
+  }
+
+  if (!movie_path.empty())
+  {
+    std::optional<std::string> movie_save_state_path;
+    if (!boot || !movie.PlayInput(movie_path, &movie_save_state_path))
+    {
+      fprintf(stderr, "Could not play the specified movie\n");
+      return 1;
+    }
+    if (movie_save_state_path)
+    {
+      boot->boot_session_data.SetSavestateData(std::move(movie_save_state_path),
+                                               DeleteSavestateAfterBoot::No);
+    }
+  }
+
   DolphinAnalytics::Instance().ReportDolphinStart("nogui");
 
   if (!BootManager::BootCore(Core::System::GetInstance(), std::move(boot), wsi))
@@ -320,12 +549,40 @@ int main(int argc, char* argv[])
   Discord::UpdateDiscordPresence();
 #endif
 
+  const auto start_time = std::chrono::steady_clock::now();
   s_platform->MainLoop();
+  const std::chrono::duration<double> run_time = std::chrono::steady_clock::now() - start_time;
   Core::Stop(Core::System::GetInstance());
 
   Core::Shutdown(Core::System::GetInstance());
+  movie.SetPlaybackEndedCallback({});
   s_platform.reset();
 
+  if (replay)
+  {
+    const picojson::object report =
+        MovieReplay::CheckReplay(movie_path, reached_movie_end,
+                                 options.get("record_checkpoints"), run_time.count());
+    const std::string output_path = static_cast<const char*>(options.get("replay_output"));
+    if (!WriteReport(output_path, picojson::value(report)))
+    {
+      fprintf(stderr, "Could not write the replay report\n");
+      return 1;
+    }
+    return MovieReplay::IsSuccess(report) ? 0 : 1;
+  }
+
+  if (fifo_benchmark)
+  {
+    const std::string output_path = static_cast<const char*>(options.get("benchmark_output"));
+    if (!WriteReport(output_path,
+                     CreateFifoBenchmarkReport(fifo_benchmark_file, fifo_benchmark_loops)))
+    {
+      fprintf(stderr, "Could not write the FIFO benchmark report\n");
+      return 1;
+    }
+  }
+
   return 0;
 }
 
@@ -0,0 +1,261 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "DolphinNoGUI/MovieReplay.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+#include <fmt/format.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char** environ;
+#endif
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/JsonUtil.h"
+#include "Common/StringUtil.h"
+#include "Core/Movie.h"
+#include "Core/MovieCheckpoints.h"
+#include "Core/System.h"
+
+namespace MovieReplay
+{
+namespace
+{
+#ifdef _WIN32
+// Quotes an argument so that CommandLineToArgvW turns it back into the same string.
+std::wstring QuoteArgument(const std::string& argument)
+{
+  std::wstring quoted = L"\"";
+  size_t backslashes = 0;
+  for (const wchar_t c : UTF8ToWString(argument))
+  {
+    if (c == L'\\')
+    {
+      ++backslashes;
+      continue;
+    }
+    // Backslashes only need to be escaped when a quote follows them.
+    quoted.append(c == L'"' ? backslashes * 2 + 1 : backslashes, L'\\');
+    quoted.push_back(c);
+    backslashes = 0;
+  }
+  quoted.append(backslashes * 2, L'\\');
+  quoted.push_back(L'"');
+  return quoted;
+}
+#endif
+
+// Runs a process to completion. Returns its exit code, or nothing if it couldn't be started or
+// didn't exit normally.
+std::optional<int> RunProcess(const std::vector<std::string>& args)
+{
+#ifdef _WIN32
+  std::wstring command_line;
+  for (const std::string& arg : args)
+  {
+    if (!command_line.empty())
+      command_line.push_back(L' ');
+    command_line += QuoteArgument(arg);
+  }
+
+  STARTUPINFOW sinfo{.cb = sizeof(sinfo)};
+  PROCESS_INFORMATION pinfo;
+  if (!CreateProcessW(UTF8ToWString(args.front()).c_str(), command_line.data(), nullptr, nullptr,
+                      FALSE, 0, nullptr, nullptr, &sinfo, &pinfo))
+  {
+    return std::nullopt;
+  }
+  CloseHandle(pinfo.hThread);
+
+  WaitForSingleObject(pinfo.hProcess, INFINITE);
+  DWORD exit_code;
+  const bool got_exit_code = GetExitCodeProcess(pinfo.hProcess, &exit_code);
+  CloseHandle(pinfo.hProcess);
+  if (!got_exit_code)
+    return std::nullopt;
+  return static_cast<int>(exit_code);
+#else
+  std::vector<char*> argv;
+  argv.reserve(args.size() + 1);
+  for (const std::string& arg : args)
+    argv.push_back(const_cast<char*>(arg.c_str()));
+  argv.push_back(nullptr);
+
+  pid_t pid;
+  if (posix_spawn(&pid, argv[0], nullptr, nullptr, argv.data(), environ) != 0)
+    return std::nullopt;
+
+  int status;
+  while (waitpid(pid, &status, 0) < 0)
+  {
+    if (errno != EINTR)
+      return std::nullopt;
+  }
+  if (!WIFEXITED(status))
+    return std::nullopt;
+  return WEXITSTATUS(status);
+#endif
+}
+
+picojson::object RunJob(const Job& job, const std::vector<std::string>& child_args)
+{
+  picojson::object report;
+
+  // A user directory of its own keeps the memory cards, the NAND and the work files of each
+  // replay apart, and makes the replay independent of the settings of whoever runs it.
+  const std::string user_directory = File::CreateTempDir();
+  if (user_directory.empty())
+  {
+    report.emplace("status", picojson::value("failed"));
+    report.emplace("error", picojson::value("Could not create a user directory"));
+  }
+  else
+  {
+    const std::string report_path = user_directory + "/replay.json";
+    std::vector<std::string> args{File::GetExePath(), "--user",        user_directory,
+                                  "--exec",           job.game_path,   "--movie",
+                                  job.movie_path,     "--replay",      "--replay_output",
+                                  report_path};
+    args.insert(args.end(), child_args.begin(), child_args.end());
+
+    const std::optional<int> exit_code = RunProcess(args);
+    picojson::value child_report;
+    std::string error;
+    if (JsonFromFile(report_path, &child_report, &error) && child_report.is<picojson::object>())
+    {
+      report = child_report.get<picojson::object>();
+    }
+    else
+    {
+      report.emplace("status", picojson::value("failed"));
+      report.emplace("error", picojson::value(
+                                  exit_code ? fmt::format("The replay exited with code {}",
+                                                          *exit_code) :
+                                              std::string("The replay crashed")));
+    }
+
+    File::DeleteDirRecursively(user_directory);
+  }
+
+  report.insert_or_assign("game", picojson::value(job.game_path));
+  report.insert_or_assign("movie", picojson::value(job.movie_path));
+  return report;
+}
+}  // namespace
+
+std::optional<std::vector<Job>> LoadJobList(const std::string& path)
+{
+  picojson::value root;
+  std::string error;
+  if (!JsonFromFile(path, &root, &error))
+  {
+    std::fprintf(stderr, "Could not read %s: %s\n", path.c_str(), error.c_str());
+    return std::nullopt;
+  }
+  if (!root.is<picojson::array>())
+    return std::nullopt;
+
+  std::vector<Job> jobs;
+  for (const picojson::value& value : root.get<picojson::array>())
+  {
+    if (!value.is<picojson::object>())
+      return std::nullopt;
+
+    const picojson::object& object = value.get<picojson::object>();
+    std::optional<std::string> game_path = ReadStringFromJson(object, "game");
+    std::optional<std::string> movie_path = ReadStringFromJson(object, "movie");
+    if (!game_path || !movie_path)
+      return std::nullopt;
+
+    jobs.push_back({std::move(*game_path), std::move(*movie_path)});
+  }
+  return jobs;
+}
+
+picojson::object CheckReplay(const std::string& movie_path, bool reached_end, bool record,
+                             double seconds)
+{
+  const Movie::MovieManager& movie = Core::System::GetInstance().GetMovie();
+  const std::vector<Movie::Checkpoint>& checkpoints = movie.GetCheckpoints();
+
+  picojson::object report;
+  report.emplace("movie", picojson::value(movie_path));
+  report.emplace("frames", picojson::value(static_cast<double>(movie.GetCurrentFrame())));
+  report.emplace("checkpoints", picojson::value(static_cast<double>(checkpoints.size())));
+  report.emplace("seconds", picojson::value(seconds));
+
+  const std::string checkpoints_path = Movie::GetCheckpointsPath(movie_path);
+  std::string status;
+  if (!reached_end)
+  {
+    status = "incomplete";
+  }
+  else if (record)
+  {
+    status = Movie::SaveCheckpoints(checkpoints_path, checkpoints) ? "recorded" : "failed";
+  }
+  else if (const auto expected = Movie::LoadCheckpoints(checkpoints_path); !expected)
+  {
+    status = "no_checkpoints";
+  }
+  else if (const auto mismatch = Movie::FindMismatchedCheckpoint(*expected, checkpoints,
+                                                                 movie.GetCurrentFrame()))
+  {
+    status = "desynced";
+    report.emplace("first_mismatch_frame", picojson::value(static_cast<double>(mismatch->frame)));
+  }
+  else
+  {
+    status = "passed";
+  }
+  report.emplace("status", picojson::value(status));
+  return report;
+}
+
+picojson::array RunJobs(const std::vector<Job>& jobs, const std::vector<std::string>& child_args,
+                        unsigned int max_processes)
+{
+  std::vector<picojson::object> reports(jobs.size());
+  std::atomic<size_t> next_job = 0;
+  std::atomic<size_t> finished_jobs = 0;
+
+  std::vector<std::thread> threads(std::min<size_t>(std::max(max_processes, 1u), jobs.size()));
+  for (std::thread& thread : threads)
+  {
+    thread = std::thread([&] {
+      for (size_t i = next_job++; i < jobs.size(); i = next_job++)
+      {
+        reports[i] = RunJob(jobs[i], child_args);
+        const std::string status = reports[i]["status"].to_str();
+        std::fprintf(stderr, "[%zu/%zu] %s: %s\n", ++finished_jobs, jobs.size(),
+                     jobs[i].movie_path.c_str(), status.c_str());
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  picojson::array result;
+  result.reserve(reports.size());
+  for (picojson::object& report : reports)
+    result.emplace_back(std::move(report));
+  return result;
+}
+
+bool IsSuccess(const picojson::object& report)
+{
+  const std::optional<std::string> status = ReadStringFromJson(report, "status");
+  return status == "passed" || status == "recorded";
+}
+}  // namespace MovieReplay
@@ -0,0 +1,37 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <picojson.h>
+
+// Replays movies as regression tests: every movie is played back as fast as possible, and the
+// memory hashes at its checkpoints are compared to those saved by an earlier replay.
+namespace MovieReplay
+{
+struct Job
+{
+  std::string game_path;
+  std::string movie_path;
+};
+
+// Reads a JSON array of {"game": <path>, "movie": <path>} objects.
+std::optional<std::vector<Job>> LoadJobList(const std::string& path);
+
+// Reports on the movie that was just played back in this process. If record is set, the
+// checkpoints of the playback are saved as the expected ones rather than checked.
+picojson::object CheckReplay(const std::string& movie_path, bool reached_end, bool record,
+                             double seconds);
+
+// Replays every job in a Dolphin process of its own, with its own user directory, running up to
+// max_processes of them at once. child_args are passed to every process. Returns the reports in
+// the order of the jobs.
+picojson::array RunJobs(const std::vector<Job>& jobs, const std::vector<std::string>& child_args,
+                        unsigned int max_processes);
+
+bool IsSuccess(const picojson::object& report);
+}  // namespace MovieReplay
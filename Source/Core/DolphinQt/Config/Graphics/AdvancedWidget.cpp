@@ -67,6 +67,8 @@ void AdvancedWidget::CreateWidgets()
   m_perf_samp_window->SetTitle(tr("Performance Sample Window (ms)"));
   m_log_render_time =
       new ConfigBool(tr("Log Render Time to File"), Config::GFX_LOG_RENDER_TIME_TO_FILE);
+  m_show_latency = new ConfigBool(tr("Show Latency Breakdown"), Config::GFX_SHOW_LATENCY);
+  m_log_latency = new ConfigBool(tr("Log Latency to File"), Config::GFX_LOG_LATENCY_TO_FILE);
 
   performance_layout->addWidget(m_show_fps, 0, 0);
   performance_layout->addWidget(m_show_ftimes, 0, 1);
@@ -78,6 +80,8 @@ void AdvancedWidget::CreateWidgets()
   performance_layout->addWidget(m_perf_samp_window, 3, 1);
   performance_layout->addWidget(m_log_render_time, 4, 0);
   performance_layout->addWidget(m_show_speed_colors, 4, 1);
+  performance_layout->addWidget(m_show_latency, 5, 0);
+  performance_layout->addWidget(m_log_latency, 5, 1);
 
   // Debugging
   auto* debugging_box = new QGroupBox(tr("Debugging"));
@@ -196,7 +200,11 @@ void AdvancedWidget::CreateWidgets()
       new ConfigBool(tr("Manual Texture Sampling"), Config::GFX_HACK_FAST_TEXTURE_SAMPLING, true);
 
   experimental_layout->addWidget(m_defer_efb_access_invalidation, 0, 0);
+  m_display_list_cache =
+      new ConfigBool(tr("Cache Display Lists"), Config::GFX_DISPLAY_LIST_CACHE);
+
   experimental_layout->addWidget(m_manual_texture_sampling, 0, 1);
+  experimental_layout->addWidget(m_display_list_cache, 1, 0);
 
   main_layout->addWidget(performance_box);
   main_layout->addWidget(debugging_box);
@@ -296,6 +304,14 @@ void AdvancedWidget::AddDescriptions()
       "Logs the render time of every frame to User/Logs/render_time.txt.<br><br>Use this "
       "feature to measure Dolphin's performance.<br><br><dolphin_emphasis>If "
       "unsure, leave this unchecked.</dolphin_emphasis>");
+  static const char TR_SHOW_LATENCY_DESCRIPTION[] = QT_TR_NOOP(
+      "Shows how long frames take on average from the last input poll until they are on "
+      "screen, broken down into emulation, waiting for the video thread, fetching the XFB and "
+      "presenting.<br><br><dolphin_emphasis>If unsure, leave this unchecked.</dolphin_emphasis>");
+  static const char TR_LOG_LATENCY_DESCRIPTION[] = QT_TR_NOOP(
+      "Logs when every frame passed each stage on its way to the screen to "
+      "User/Logs/frame_latency.csv, and as a Chrome trace to User/Logs/frame_latency.json."
+      "<br><br><dolphin_emphasis>If unsure, leave this unchecked.</dolphin_emphasis>");
   static const char TR_WIREFRAME_DESCRIPTION[] =
       QT_TR_NOOP("Renders the scene as a wireframe.<br><br><dolphin_emphasis>If unsure, leave "
                  "this unchecked.</dolphin_emphasis>");
@@ -401,6 +417,11 @@ void AdvancedWidget::AddDescriptions()
       QT_TR_NOOP("Cull vertices on the CPU to reduce the number of draw calls required.  "
                  "May affect performance and draw statistics.<br><br>"
                  "<dolphin_emphasis>If unsure, leave this unchecked.</dolphin_emphasis>");
+  static const char TR_DISPLAY_LIST_CACHE_DESCRIPTION[] =
+      QT_TR_NOOP("Remembers the decoded commands of display lists and replays them when a game "
+                 "calls a display list with unchanged contents again. May improve performance "
+                 "in games which make heavy use of display lists.<br><br>"
+                 "<dolphin_emphasis>If unsure, leave this unchecked.</dolphin_emphasis>");
   static const char TR_DEFER_EFB_ACCESS_INVALIDATION_DESCRIPTION[] = QT_TR_NOOP(
       "Defers invalidation of the EFB access cache until a GPU synchronization command "
       "is executed. If disabled, the cache will be invalidated with every draw call. "
@@ -439,6 +460,8 @@ void AdvancedWidget::AddDescriptions()
   m_show_speed->SetDescription(tr(TR_SHOW_SPEED_DESCRIPTION));
   m_log_render_time->SetDescription(tr(TR_LOG_RENDERTIME_DESCRIPTION));
   m_show_speed_colors->SetDescription(tr(TR_SHOW_SPEED_COLORS_DESCRIPTION));
+  m_show_latency->SetDescription(tr(TR_SHOW_LATENCY_DESCRIPTION));
+  m_log_latency->SetDescription(tr(TR_LOG_LATENCY_DESCRIPTION));
 
   m_enable_wireframe->SetDescription(tr(TR_WIREFRAME_DESCRIPTION));
   m_show_statistics->SetDescription(tr(TR_SHOW_STATS_DESCRIPTION));
@@ -480,4 +503,5 @@ void AdvancedWidget::AddDescriptions()
 #endif
   m_defer_efb_access_invalidation->SetDescription(tr(TR_DEFER_EFB_ACCESS_INVALIDATION_DESCRIPTION));
   m_manual_texture_sampling->SetDescription(tr(TR_MANUAL_TEXTURE_SAMPLING_DESCRIPTION));
+  m_display_list_cache->SetDescription(tr(TR_DISPLAY_LIST_CACHE_DESCRIPTION));
 }
@@ -45,6 +45,8 @@ private:
   ConfigBool* m_show_speed_colors;
   ConfigInteger* m_perf_samp_window;
   ConfigBool* m_log_render_time;
+  ConfigBool* m_show_latency;
+  ConfigBool* m_log_latency;
 
   // Utility
   ConfigBool* m_prefetch_custom_textures;
@@ -76,4 +78,5 @@ private:
   // Experimental
   ConfigBool* m_defer_efb_access_invalidation;
   ConfigBool* m_manual_texture_sampling;
+  ConfigBool* m_display_list_cache;
 };
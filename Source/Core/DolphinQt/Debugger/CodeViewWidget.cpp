@@ -5,6 +5,8 @@
 
 #include <algorithm>
 #include <cmath>
+#include <future>
+#include <span>
 
 #include <fmt/format.h>
 #include <fmt/ranges.h>
@@ -26,10 +28,12 @@
 #include <QWheelEvent>
 
 #include "Common/Assert.h"
+#include "Common/FileUtil.h"
 #include "Common/GekkoDisassembler.h"
 #include "Common/StringUtil.h"
 #include "Core/Core.h"
 #include "Core/Debugger/CodeTrace.h"
+#include "Core/Debugger/CodeTraceFile.h"
 #include "Core/Debugger/PPCDebugInterface.h"
 #include "Core/PowerPC/MMU.h"
 #include "Core/PowerPC/PPCAnalyst.h"
@@ -39,7 +43,10 @@
 #include "DolphinQt/Debugger/AssembleInstructionDialog.h"
 #include "DolphinQt/Debugger/PatchInstructionDialog.h"
 #include "DolphinQt/Host.h"
+#include "DolphinQt/QtUtils/DolphinFileDialog.h"
 #include "DolphinQt/QtUtils/FromStdString.h"
+#include "DolphinQt/QtUtils/ModalMessageBox.h"
+#include "DolphinQt/QtUtils/ParallelProgressDialog.h"
 #include "DolphinQt/QtUtils/SetWindowDecorations.h"
 #include "DolphinQt/Resources.h"
 #include "DolphinQt/Settings.h"
@@ -140,6 +147,10 @@ constexpr int CODE_VIEW_COLUMN_DESCRIPTION = 4;
 constexpr int CODE_VIEW_COLUMN_BRANCH_ARROWS = 5;
 constexpr int CODE_VIEW_COLUMNCOUNT = 6;
 
+// Recorded traces are analyzed in parts of this many instructions, to show progress in between.
+constexpr size_t CODE_TRACE_ANALYSIS_PART_SIZE = 0x10000;
+constexpr int CODE_TRACE_ANALYSIS_PROGRESS_STEPS = 1000;
+
 CodeViewWidget::CodeViewWidget()
     : m_system(Core::System::GetInstance()), m_ppc_symbol_db(m_system.GetPPCSymbolDB())
 {
@@ -645,6 +656,23 @@ void CodeViewWidget::OnContextMenu()
                             [this] { AutoStep(CodeTrace::AutoStop::Changed); });
 
   run_until_menu->setEnabled(!target.isEmpty());
+
+  auto* record_trace_action =
+      menu->addAction(tr("Record Code &Trace..."), this, &CodeViewWidget::OnRecordCodeTrace);
+  record_trace_action->setEnabled(paused);
+
+  // The value written by the first instruction of the trace is followed.
+  auto* analyze_trace_menu = menu->addMenu(tr("Analyze Code Trace"));
+  // i18n: One of the options shown below "Analyze Code Trace"
+  analyze_trace_menu->addAction(tr("Until the value is hit..."), this,
+                                [this] { AnalyzeCodeTrace(CodeTrace::AutoStop::Always); });
+  // i18n: One of the options shown below "Analyze Code Trace"
+  analyze_trace_menu->addAction(tr("Until the value is used..."), this,
+                                [this] { AnalyzeCodeTrace(CodeTrace::AutoStop::Used); });
+  // i18n: One of the options shown below "Analyze Code Trace"
+  analyze_trace_menu->addAction(tr("Until the value is changed..."), this,
+                                [this] { AnalyzeCodeTrace(CodeTrace::AutoStop::Changed); });
+
   follow_branch_action->setEnabled(follow_branch_enabled);
 
   for (auto* action :
@@ -669,6 +697,36 @@ void CodeViewWidget::OnContextMenu()
   Update();
 }
 
+QString CodeViewWidget::GetAutoStepResultsText(const AutoStepResults& results)
+{
+  // Mem_tracked needs to track each byte individually, so a tracked word-sized value would have
+  // four entries. The displayed memory list needs to be shortened so it's not a huge list of
+  // bytes. Assumes adjacent bytes represent a word or half-word and removes the redundant bytes.
+  std::set<u32> mem_out;
+  auto iter = results.mem_tracked.begin();
+
+  while (iter != results.mem_tracked.end())
+  {
+    const u32 address = *iter;
+    mem_out.insert(address);
+
+    for (u32 i = 1; i <= 3; i++)
+    {
+      if (results.mem_tracked.contains(address + i))
+        iter++;
+      else
+        break;
+    }
+
+    iter++;
+  }
+
+  return tr("Instructions executed:   %1\nValue contained in:\nRegisters:   %2\nMemory:   %3")
+      .arg(QString::number(results.count))
+      .arg(QString::fromStdString(fmt::format("{}", fmt::join(results.reg_tracked, ", "))))
+      .arg(QString::fromStdString(fmt::format("{:#x}", fmt::join(mem_out, ", "))));
+}
+
 void CodeViewWidget::AutoStep(CodeTrace::AutoStop option)
 {
   // Autosteps and follows value in the target (left-most) register. The Used and Changed options
@@ -716,35 +774,194 @@ void CodeViewWidget::AutoStep(CodeTrace::AutoStop option)
       msgbox.setText(tr("Value tracked to current instruction."));
     }
 
-    // Mem_tracked needs to track each byte individually, so a tracked word-sized value would have
-    // four entries. The displayed memory list needs to be shortened so it's not a huge list of
-    // bytes. Assumes adjacent bytes represent a word or half-word and removes the redundant bytes.
-    std::set<u32> mem_out;
-    auto iter = results.mem_tracked.begin();
+    msgbox.setInformativeText(GetAutoStepResultsText(results));
+    SetQWidgetWindowDecorations(&msgbox);
+    msgbox.exec();
 
-    while (iter != results.mem_tracked.end())
-    {
-      const u32 address = *iter;
-      mem_out.insert(address);
+  } while (msgbox.clickedButton() == (QAbstractButton*)run_button);
+}
+
+void CodeViewWidget::OnRecordCodeTrace()
+{
+  // Single steps from the current instruction and saves what ran to a file, without analyzing it.
+  // This is fast enough for traces of millions of instructions.
+  bool good;
+  const int count = QInputDialog::getInt(
+      this, tr("Record Code Trace"), tr("Number of instructions to record:"), 1000000, 1,
+      static_cast<int>(CodeTraceFile::MAX_RECORDED_INSTRUCTIONS), 1, &good,
+      Qt::WindowCloseButtonHint);
+  if (!good)
+    return;
+
+  const QString path = DolphinFileDialog::getSaveFileName(
+      this, tr("Save Code Trace"), QString::fromStdString(File::GetUserPath(D_DUMPDEBUG_IDX)),
+      tr("Code trace (*.dtrc);;All Files (*)"));
+  if (path.isEmpty())
+    return;
 
-      for (u32 i = 1; i <= 3; i++)
+  CodeTraceFile::Writer writer;
+  if (!writer.Open(path.toStdString()))
+  {
+    ModalMessageBox::critical(this, tr("Error"), tr("Failed to open \"%1\".").arg(path));
+    return;
+  }
+
+  ParallelProgressDialog progress(tr("Recording code trace..."), tr("Cancel"), 0, count, this);
+  progress.GetRaw()->setWindowTitle(tr("Record Code Trace"));
+  progress.GetRaw()->setMinimumDuration(500);
+  progress.GetRaw()->setWindowModality(Qt::WindowModal);
+
+  // The CPU thread does the stepping, which keeps the GUI responsive and lets recording be
+  // canceled.
+  std::promise<CodeTraceFile::RecordResult> promise;
+  std::future<CodeTraceFile::RecordResult> future = promise.get_future();
+  Core::RunOnCPUThread(
+      m_system,
+      [this, &writer, &progress, &promise, count] {
+        const Core::CPUThreadGuard guard(m_system);
+        promise.set_value(CodeTraceFile::RecordInstructions(
+            guard, writer, static_cast<u64>(count), [&progress](u64 recorded) {
+              progress.SetValue(static_cast<int>(recorded));
+              return !progress.WasCanceled();
+            }));
+        progress.Reset();
+      },
+      false);
+
+  SetQWidgetWindowDecorations(progress.GetRaw());
+  progress.GetRaw()->exec();
+
+  const CodeTraceFile::RecordResult result = future.get();
+  emit Host::GetInstance()->UpdateDisasmDialog();
+
+  if (!writer.Close())
+  {
+    ModalMessageBox::critical(this, tr("Error"), tr("Failed to write \"%1\".").arg(path));
+    return;
+  }
+
+  QString text =
+      tr("Recorded %1 instructions to \"%2\".").arg(QString::number(result.count)).arg(path);
+  if (result.stop_reason == CodeTraceFile::RecordResult::StopReason::BreakPoint)
+    text += QStringLiteral("\n") + tr("Recording stopped at a breakpoint.");
+  else if (result.stop_reason == CodeTraceFile::RecordResult::StopReason::Canceled)
+    text += QStringLiteral("\n") + tr("Recording was canceled.");
+  ModalMessageBox::information(this, tr("Record Code Trace"), text);
+}
+
+void CodeViewWidget::AnalyzeCodeTrace(CodeTrace::AutoStop option)
+{
+  // Follows the value written by the first instruction of a recorded trace, the way AutoStep
+  // follows the value written by the current instruction.
+  const QString path = DolphinFileDialog::getOpenFileName(
+      this, tr("Open Code Trace"), QString::fromStdString(File::GetUserPath(D_DUMPDEBUG_IDX)),
+      tr("Code trace (*.dtrc);;All Files (*)"));
+  if (path.isEmpty())
+    return;
+
+  CodeTraceFile::Reader reader;
+  if (!reader.Open(path.toStdString()))
+  {
+    ModalMessageBox::critical(this, tr("Error"),
+                              tr("Failed to open \"%1\" as a code trace.").arg(path));
+    return;
+  }
+  const std::span<const CodeTraceFile::Record> records = reader.GetRecords();
+
+  CodeTrace code_trace;
+  // The index of the instruction the analysis has stopped at.
+  size_t position = 0;
+
+  QMessageBox msgbox(QMessageBox::NoIcon, tr("Analyze Code Trace"), {}, QMessageBox::Cancel);
+  QPushButton* run_button = msgbox.addButton(tr("Keep Running"), QMessageBox::AcceptRole);
+
+  do
+  {
+    ParallelProgressDialog progress(tr("Analyzing code trace..."), tr("Cancel"), 0,
+                                    CODE_TRACE_ANALYSIS_PROGRESS_STEPS, this);
+    progress.GetRaw()->setWindowTitle(tr("Analyze Code Trace"));
+    progress.GetRaw()->setMinimumDuration(500);
+    progress.GetRaw()->setWindowModality(Qt::WindowModal);
+
+    auto future = std::async(std::launch::async, [&]() -> AutoStepResults {
+      // Each part starts with the instruction the previous one stopped at, which isn't analyzed
+      // again.
+      AutoStepResults results;
+      bool continue_previous = position != 0;
+      while (position + 1 < records.size() && !progress.WasCanceled())
       {
-        if (results.mem_tracked.contains(address + i))
-          iter++;
-        else
+        const auto part =
+            records.subspan(position, std::min(records.size() - position,
+                                               CODE_TRACE_ANALYSIS_PART_SIZE + 1));
+        const AutoStepResults part_results =
+            code_trace.AutoStepping(part, continue_previous, option);
+        if (part_results.count == 0)
           break;
+
+        continue_previous = true;
+        position += part_results.count;
+        const u32 count = results.count + part_results.count;
+        results = part_results;
+        results.count = count;
+        if (!results.timed_out)
+          break;
+
+        progress.SetValue(
+            static_cast<int>(position * CODE_TRACE_ANALYSIS_PROGRESS_STEPS / records.size()));
       }
+      progress.Reset();
+      return results;
+    });
 
-      iter++;
+    SetQWidgetWindowDecorations(progress.GetRaw());
+    progress.GetRaw()->exec();
+    const AutoStepResults results = future.get();
+
+    if (progress.WasCanceled())
+      return;
+
+    if (results.count == 0)
+    {
+      if (position == 0)
+      {
+        ModalMessageBox::warning(
+            this, tr("Analyze Code Trace"),
+            tr("The first instruction of the trace doesn't write a value which can be followed."));
+      }
+      else
+      {
+        ModalMessageBox::information(this, tr("Analyze Code Trace"),
+                                     tr("Reached the end of the trace."));
+      }
+      return;
     }
 
-    const QString msgtext =
-        tr("Instructions executed:   %1\nValue contained in:\nRegisters:   %2\nMemory:   %3")
-            .arg(QString::number(results.count))
-            .arg(QString::fromStdString(fmt::format("{}", fmt::join(results.reg_tracked, ", "))))
-            .arg(QString::fromStdString(fmt::format("{:#x}", fmt::join(mem_out, ", "))));
+    const u32 address = records[position].address;
+    SetAddress(address, SetAddressUpdate::WithDetailedUpdate);
+
+    if (results.reg_tracked.empty() && results.mem_tracked.empty())
+    {
+      ModalMessageBox::warning(this, tr("Overwritten"),
+                               tr("Target value was overwritten by instruction %1 of the trace "
+                                  "at %2.\nInstructions executed:   %3")
+                                   .arg(QString::number(position))
+                                   .arg(address, 8, 16, QLatin1Char('0'))
+                                   .arg(QString::number(results.count)));
+      return;
+    }
+
+    if (results.timed_out)
+    {
+      ModalMessageBox::information(
+          this, tr("Analyze Code Trace"),
+          tr("Reached the end of the trace.\n%1").arg(GetAutoStepResultsText(results)));
+      return;
+    }
 
-    msgbox.setInformativeText(msgtext);
+    msgbox.setText(tr("Value tracked to instruction %1 of the trace at %2.")
+                       .arg(QString::number(position))
+                       .arg(address, 8, 16, QLatin1Char('0')));
+    msgbox.setInformativeText(GetAutoStepResultsText(results));
     SetQWidgetWindowDecorations(&msgbox);
     msgbox.exec();
 
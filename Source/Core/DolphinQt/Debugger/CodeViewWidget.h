@@ -77,7 +77,11 @@ private:
 
   void OnContextMenu();
 
+  // The status report shared by stepping and recorded traces.
+  static QString GetAutoStepResultsText(const AutoStepResults& results);
   void AutoStep(CodeTrace::AutoStop option = CodeTrace::AutoStop::Always);
+  void OnRecordCodeTrace();
+  void AnalyzeCodeTrace(CodeTrace::AutoStop option);
   void OnDebugFontChanged(const QFont& font);
   void OnFollowBranch();
   void OnCopyAddress();
@@ -115,6 +115,7 @@ void FIFOAnalyzer::CreateWidgets()
 void FIFOAnalyzer::ConnectWidgets()
 {
   connect(m_tree_widget, &QTreeWidget::itemSelectionChanged, this, &FIFOAnalyzer::UpdateDetails);
+  connect(m_tree_widget, &QTreeWidget::itemExpanded, this, &FIFOAnalyzer::AddFrameObjects);
   connect(m_detail_list, &QListWidget::itemSelectionChanged, this,
           &FIFOAnalyzer::UpdateDescription);
 
@@ -152,48 +153,62 @@ void FIFOAnalyzer::UpdateTree()
   for (u32 frame = 0; frame < frame_count; frame++)
   {
     auto* frame_item = new QTreeWidgetItem({tr("Frame %1").arg(frame)});
+    frame_item->setData(0, FRAME_ROLE, frame);
+    // The objects are only added once the frame is expanded, since the frame has to be read and
+    // analyzed to find them.
+    frame_item->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
 
     recording_item->addChild(frame_item);
+  }
+}
 
-    const AnalyzedFrameInfo& frame_info = m_fifo_player.GetAnalyzedFrameInfo(frame);
-    ASSERT(frame_info.parts.size() != 0);
+void FIFOAnalyzer::AddFrameObjects(QTreeWidgetItem* frame_item)
+{
+  if (frame_item->childCount() != 0 || frame_item->data(0, FRAME_ROLE).isNull() ||
+      !frame_item->data(0, PART_START_ROLE).isNull())
+  {
+    return;
+  }
 
-    Common::EnumMap<u32, FramePartType::EFBCopy> part_counts;
-    u32 part_start = 0;
+  const u32 frame = frame_item->data(0, FRAME_ROLE).toUInt();
+  const AnalyzedFrameInfo& frame_info = m_fifo_player.GetAnalyzedFrameInfo(frame);
+  ASSERT(frame_info.parts.size() != 0);
 
-    for (u32 part_nr = 0; part_nr < frame_info.parts.size(); part_nr++)
-    {
-      const auto& part = frame_info.parts[part_nr];
+  Common::EnumMap<u32, FramePartType::EFBCopy> part_counts;
+  u32 part_start = 0;
 
-      const u32 part_type_nr = part_counts[part.m_type];
-      part_counts[part.m_type]++;
+  for (u32 part_nr = 0; part_nr < frame_info.parts.size(); part_nr++)
+  {
+    const auto& part = frame_info.parts[part_nr];
 
-      QTreeWidgetItem* object_item = nullptr;
-      if (part.m_type == FramePartType::PrimitiveData)
-        object_item = new QTreeWidgetItem({tr("Object %1").arg(part_type_nr)});
-      else if (part.m_type == FramePartType::EFBCopy)
-        object_item = new QTreeWidgetItem({tr("EFB copy %1").arg(part_type_nr)});
-      // We don't create dedicated labels for FramePartType::Command;
-      // those are grouped with the primitive
+    const u32 part_type_nr = part_counts[part.m_type];
+    part_counts[part.m_type]++;
 
-      if (object_item != nullptr)
-      {
-        frame_item->addChild(object_item);
+    QTreeWidgetItem* object_item = nullptr;
+    if (part.m_type == FramePartType::PrimitiveData)
+      object_item = new QTreeWidgetItem({tr("Object %1").arg(part_type_nr)});
+    else if (part.m_type == FramePartType::EFBCopy)
+      object_item = new QTreeWidgetItem({tr("EFB copy %1").arg(part_type_nr)});
+    // We don't create dedicated labels for FramePartType::Command;
+    // those are grouped with the primitive
 
-        object_item->setData(0, FRAME_ROLE, frame);
-        object_item->setData(0, PART_START_ROLE, part_start);
-        object_item->setData(0, PART_END_ROLE, part_nr);
+    if (object_item != nullptr)
+    {
+      frame_item->addChild(object_item);
 
-        part_start = part_nr + 1;
-      }
-    }
+      object_item->setData(0, FRAME_ROLE, frame);
+      object_item->setData(0, PART_START_ROLE, part_start);
+      object_item->setData(0, PART_END_ROLE, part_nr);
 
-    // We shouldn't end on a Command (it should end with an EFB copy)
-    ASSERT(part_start == frame_info.parts.size());
-    // The counts we computed should match the frame's counts
-    ASSERT(std::equal(frame_info.part_type_counts.begin(), frame_info.part_type_counts.end(),
-                      part_counts.begin()));
+      part_start = part_nr + 1;
+    }
   }
+
+  // We shouldn't end on a Command (it should end with an EFB copy)
+  ASSERT(part_start == frame_info.parts.size());
+  // The counts we computed should match the frame's counts
+  ASSERT(std::equal(frame_info.part_type_counts.begin(), frame_info.part_type_counts.end(),
+                    part_counts.begin()));
 }
 
 namespace
@@ -349,7 +364,8 @@ void FIFOAnalyzer::UpdateDetails()
   const u32 end_part_nr = items[0]->data(0, PART_END_ROLE).toUInt();
 
   const AnalyzedFrameInfo& frame_info = m_fifo_player.GetAnalyzedFrameInfo(frame_nr);
-  const auto& fifo_frame = m_fifo_player.GetFile()->GetFrame(frame_nr);
+  const auto fifo_frame_ptr = m_fifo_player.GetFile()->GetFrame(frame_nr);
+  const FifoFrameInfo& fifo_frame = *fifo_frame_ptr;
 
   const u32 object_start = frame_info.parts[start_part_nr].m_start;
   const u32 object_end = frame_info.parts[end_part_nr].m_end;
@@ -432,7 +448,8 @@ void FIFOAnalyzer::BeginSearch()
   const u32 end_part_nr = items[0]->data(0, PART_END_ROLE).toUInt();
 
   const AnalyzedFrameInfo& frame_info = m_fifo_player.GetAnalyzedFrameInfo(frame_nr);
-  const FifoFrameInfo& fifo_frame = m_fifo_player.GetFile()->GetFrame(frame_nr);
+  const auto fifo_frame_ptr = m_fifo_player.GetFile()->GetFrame(frame_nr);
+  const FifoFrameInfo& fifo_frame = *fifo_frame_ptr;
 
   const u32 object_start = frame_info.parts[start_part_nr].m_start;
   const u32 object_end = frame_info.parts[end_part_nr].m_end;
@@ -764,7 +781,8 @@ void FIFOAnalyzer::UpdateDescription()
   const u32 entry_nr = m_detail_list->currentRow();
 
   const AnalyzedFrameInfo& frame_info = m_fifo_player.GetAnalyzedFrameInfo(frame_nr);
-  const FifoFrameInfo& fifo_frame = m_fifo_player.GetFile()->GetFrame(frame_nr);
+  const auto fifo_frame_ptr = m_fifo_player.GetFile()->GetFrame(frame_nr);
+  const FifoFrameInfo& fifo_frame = *fifo_frame_ptr;
 
   const u32 object_start = frame_info.parts[start_part_nr].m_start;
   const u32 object_end = frame_info.parts[end_part_nr].m_end;
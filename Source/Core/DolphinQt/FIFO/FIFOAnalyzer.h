@@ -19,6 +19,7 @@ class QPushButton;
 class QSplitter;
 class QTextBrowser;
 class QTreeWidget;
+class QTreeWidgetItem;
 
 class FIFOAnalyzer final : public QWidget
 {
@@ -41,6 +42,7 @@ private:
   void ShowSearchResult(size_t index);
 
   void UpdateTree();
+  void AddFrameObjects(QTreeWidgetItem* frame_item);
   void UpdateDetails();
   void UpdateDescription();
 
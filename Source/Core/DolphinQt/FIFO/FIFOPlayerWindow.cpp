@@ -306,9 +306,8 @@ void FIFOPlayerWindow::UpdateInfo()
 
     for (u32 i = 0; i < file->GetFrameCount(); ++i)
     {
-      fifo_bytes += file->GetFrame(i).fifoData.size();
-      for (const auto& mem_update : file->GetFrame(i).memoryUpdates)
-        mem_bytes += mem_update.data.size();
+      fifo_bytes += file->GetFrameFifoDataSize(i);
+      mem_bytes += file->GetFrameMemoryUpdateSize(i);
     }
 
     m_info_label->setText(tr("%1 FIFO bytes\n%2 memory bytes\n%3 frames")
@@ -967,10 +967,28 @@ void NetPlayDialog::OnHostInputAuthorityChanged(bool enabled)
   });
 }
 
-void NetPlayDialog::OnDesync(u32 frame, const std::string& player)
+void NetPlayDialog::OnDesync(u32 frame, const std::string& player,
+                             NetPlay::DesyncComponent component, std::optional<u32> address)
 {
-  DisplayMessage(tr("Possible desync detected: %1 might have desynced at frame %2")
-                     .arg(QString::fromStdString(player), QString::number(frame)),
+  QString location;
+  switch (component)
+  {
+  case NetPlay::DesyncComponent::TimeBase:
+    location = tr("time base");
+    break;
+  case NetPlay::DesyncComponent::CPU:
+    location = tr("CPU registers");
+    break;
+  case NetPlay::DesyncComponent::GPU:
+    location = tr("GPU registers");
+    break;
+  case NetPlay::DesyncComponent::RAM:
+    location = address ? tr("RAM at %1").arg(*address, 8, 16, QLatin1Char('0')) : tr("RAM");
+    break;
+  }
+
+  DisplayMessage(tr("Possible desync detected: %1 might have desynced at frame %2 (%3)")
+                     .arg(QString::fromStdString(player), QString::number(frame), location),
                  "red", OSD::Duration::VERY_LONG);
 }
 
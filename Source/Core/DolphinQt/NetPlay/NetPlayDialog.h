@@ -64,7 +64,8 @@ public:
   void OnPlayerDisconnect(const std::string& player) override;
   void OnPadBufferChanged(u32 buffer) override;
   void OnHostInputAuthorityChanged(bool enabled) override;
-  void OnDesync(u32 frame, const std::string& player) override;
+  void OnDesync(u32 frame, const std::string& player, NetPlay::DesyncComponent component,
+                std::optional<u32> address) override;
   void OnConnectionLost() override;
   void OnConnectionError(const std::string& message) override;
   void OnTraversalError(Common::TraversalClient::FailureReason error) override;
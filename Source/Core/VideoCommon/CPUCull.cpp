@@ -3,13 +3,20 @@
 
 #include "VideoCommon/CPUCull.h"
 
+#include <algorithm>
+#include <array>
+#include <limits>
+
+#include "Common/Align.h"
 #include "Common/Assert.h"
 #include "Common/CPUDetect.h"
 #include "Common/MathUtil.h"
 #include "Common/MemoryUtil.h"
+#include "Common/Timer.h"
 #include "Core/System.h"
 
 #include "VideoCommon/CPMemory.h"
+#include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VertexShaderManager.h"
 #include "VideoCommon/VideoConfig.h"
@@ -164,9 +171,120 @@ bool CPUCull::AreAllVerticesCulled(VertexLoaderBase* loader, OpcodeDecoder::Prim
   if (xfmem.viewport.ht > 0)  // See videosoftware Clipper.cpp:IsBackface
     cullmode = cullmode_invert[cullmode];
   const TransformFunction transform = m_transform_table[posHas3Elems][perVertexPosMtx];
-  transform(m_transform_buffer.get(), src, stride, count);
+
+  INCSTAT(g_stats.this_frame.num_cpu_cull_checks);
+  if (!perVertexPosMtx && count >= BOUNDS_CHECK_THRESHOLD &&
+      IsBoundingBoxCulled(transform, src, stride, count, posHas3Elems))
+  {
+    INCSTAT(g_stats.this_frame.num_cpu_cull_bounds_rejects);
+    INCSTAT(g_stats.this_frame.num_cpu_culled_draws);
+    ADDSTAT(g_stats.this_frame.num_cpu_culled_vertices, count);
+    return true;
+  }
+
+  TransformVertices(transform, src, stride, count);
   const CullFunction cull = m_cull_table[primitive][cullmode];
-  return cull(m_transform_buffer.get(), count);
+  if (!cull(m_transform_buffer.get(), count))
+    return false;
+
+  INCSTAT(g_stats.this_frame.num_cpu_culled_draws);
+  ADDSTAT(g_stats.this_frame.num_cpu_culled_vertices, count);
+  return true;
+}
+
+void CPUCull::TransformVertices(TransformFunction transform, const u8* src, u32 stride, u32 count)
+{
+  if (count < PARALLEL_TRANSFORM_THRESHOLD)
+  {
+    transform(m_transform_buffer.get(), src, stride, count);
+    return;
+  }
+
+  if (!m_workers_started)
+  {
+    m_workers_started = true;
+    // The CPU and video threads are busy already.
+    const int num_workers = std::clamp(cpu_info.num_cores - 2, 0, MAX_WORKERS);
+    for (int i = 0; i < num_workers; i++)
+    {
+      m_workers.push_back(std::make_unique<Common::WorkQueueThread<TransformJob>>(
+          "CPUCull Worker", [](const TransformJob& job) {
+            job.transform(job.output, job.src, job.stride, job.count);
+          }));
+    }
+  }
+
+  // Large batches are timed whether or not there are workers, so the statistics show the time per
+  // vertex on machines with and without them.
+  const u64 start_time = Common::Timer::NowUs();
+  INCSTAT(g_stats.this_frame.num_cpu_cull_large_transforms);
+  ADDSTAT(g_stats.this_frame.num_cpu_cull_large_transform_vertices, count);
+
+  // The vectorized transforms store two vertices at a time, so every part has to start at an even
+  // vertex to keep the output aligned. The video thread transforms the last part itself.
+  const u32 num_parts = static_cast<u32>(m_workers.size()) + 1;
+  const u32 part_size = Common::AlignUp((count + num_parts - 1) / num_parts, 2);
+  u32 start = 0;
+  size_t num_jobs = 0;
+  for (; num_jobs < m_workers.size() && start + part_size < count; num_jobs++)
+  {
+    m_workers[num_jobs]->Push(
+        {transform, m_transform_buffer.get() + start, src + start * stride, stride, part_size});
+    start += part_size;
+  }
+  transform(m_transform_buffer.get() + start, src + start * stride, stride, count - start);
+
+  for (size_t i = 0; i < num_jobs; i++)
+    m_workers[i]->WaitForCompletion();
+
+  ADDSTAT(g_stats.this_frame.cpu_cull_large_transform_us,
+          static_cast<int>(Common::Timer::NowUs() - start_time));
+}
+
+bool CPUCull::IsBoundingBoxCulled(TransformFunction transform, const u8* src, u32 stride,
+                                  u32 count, bool pos_has_3_elems)
+{
+  // Every triangle is culled if all of its vertices are outside of the same side of the view
+  // volume. Those sides are planes in clip space, so if the corners of the bounding box are all
+  // outside of one of them, so is every vertex inside it.
+  constexpr float inf = std::numeric_limits<float>::infinity();
+  std::array<float, 3> min = {inf, inf, inf};
+  std::array<float, 3> max = {-inf, -inf, -inf};
+  const u32 num_elems = pos_has_3_elems ? 3 : 2;
+  bool has_nan = false;
+  for (u32 i = 0; i < count; i++)
+  {
+    const float* position = reinterpret_cast<const float*>(src + i * stride);
+    for (u32 j = 0; j < num_elems; j++)
+    {
+      has_nan |= position[j] != position[j];
+      min[j] = std::min(min[j], position[j]);
+      max[j] = std::max(max[j], position[j]);
+    }
+  }
+  // A vertex with a NaN coordinate is never culled.
+  if (has_nan)
+    return false;
+  if (!pos_has_3_elems)
+    min[2] = max[2] = 0.0f;
+
+  std::array<std::array<float, 4>, 8> corners;
+  for (u32 i = 0; i < corners.size(); i++)
+  {
+    corners[i] = {(i & 1) ? max[0] : min[0], (i & 2) ? max[1] : min[1],
+                  (i & 4) ? max[2] : min[2], 1.0f};
+  }
+  alignas(32) std::array<TransformedVertex, 8> transformed;
+  transform(transformed.data(), corners.data(), sizeof(corners[0]),
+            static_cast<int>(corners.size()));
+
+  const auto all_outside = [&transformed](auto&& outside) {
+    return std::ranges::all_of(transformed, outside);
+  };
+  return all_outside([](const TransformedVertex& v) { return v.x < -v.w; }) ||
+         all_outside([](const TransformedVertex& v) { return v.y < -v.w; }) ||
+         all_outside([](const TransformedVertex& v) { return v.x > v.w; }) ||
+         all_outside([](const TransformedVertex& v) { return v.y > v.w; });
 }
 
 template <typename T>
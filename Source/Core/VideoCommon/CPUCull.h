@@ -3,6 +3,10 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
+#include "Common/WorkQueueThread.h"
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/OpcodeDecoding.h"
@@ -23,16 +27,40 @@ public:
   using TransformFunction = void (*)(void*, const void*, u32, int);
   using CullFunction = bool (*)(const CPUCull::TransformedVertex*, int);
 
+  // Batches with at least this many vertices are transformed by the worker threads as well.
+  static constexpr u32 PARALLEL_TRANSFORM_THRESHOLD = 8192;
+  // Batches with at least this many vertices first check whether their bounding box is culled.
+  static constexpr u32 BOUNDS_CHECK_THRESHOLD = 256;
+  static constexpr int MAX_WORKERS = 3;
+
 private:
+
+  struct TransformJob
+  {
+    TransformFunction transform;
+    TransformedVertex* output;
+    const u8* src;
+    u32 stride;
+    u32 count;
+  };
+
   template <typename T>
   struct BufferDeleter
   {
     void operator()(T* ptr);
   };
+
+  void TransformVertices(TransformFunction transform, const u8* src, u32 stride, u32 count);
+  bool IsBoundingBoxCulled(TransformFunction transform, const u8* src, u32 stride, u32 count,
+                           bool pos_has_3_elems);
+
   std::unique_ptr<TransformedVertex[], BufferDeleter<TransformedVertex>> m_transform_buffer{};
   u32 m_transform_buffer_size = 0;
   std::array<std::array<TransformFunction, 2>, 2> m_transform_table{};
   Common::EnumMap<Common::EnumMap<CullFunction, CullMode::All>,
                   OpcodeDecoder::Primitive::GX_DRAW_TRIANGLE_FAN>
       m_cull_table{};
+  // Started the first time a batch is large enough to need them
+  std::vector<std::unique_ptr<Common::WorkQueueThread<TransformJob>>> m_workers;
+  bool m_workers_started = false;
 };
@@ -559,9 +559,11 @@ ATTR_TARGET DOLPHIN_FORCE_INLINE static bool CullTriangle(const CPUCull::Transfo
   if (Mode == CullMode::All)
     return true;
 
+#ifndef NO_SIMD
   Vector va = reinterpret_cast<const Vector&>(a);
   Vector vb = reinterpret_cast<const Vector&>(b);
   Vector vc = reinterpret_cast<const Vector&>(c);
+#endif
 
   // See videosoftware Clipper.cpp
 
@@ -0,0 +1,57 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "VideoCommon/DisplayListCache.h"
+
+#include <utility>
+
+#include "Common/HookableEvent.h"
+#include "VideoCommon/VideoEvents.h"
+
+namespace OpcodeDecoder
+{
+DisplayListCache g_display_list_cache;
+
+static Common::EventHook s_after_frame_event = AfterFrameEvent::Register(
+    [](Core::System&) { g_display_list_cache.EndFrame(); }, "DisplayListCache::EndFrame");
+
+const DisplayListCache::DisplayList* DisplayListCache::Find(u32 address, u32 size)
+{
+  const auto it = m_display_lists.find(address);
+  if (it == m_display_lists.end() || it->second.size != size)
+    return nullptr;
+
+  it->second.last_used_frame = m_frame_count;
+  return &it->second;
+}
+
+void DisplayListCache::Insert(u32 address, DisplayList display_list)
+{
+  if (m_display_lists.size() >= MAX_DISPLAY_LISTS && !m_display_lists.contains(address))
+    return;
+
+  display_list.last_used_frame = m_frame_count;
+  m_display_lists.insert_or_assign(address, std::move(display_list));
+}
+
+void DisplayListCache::Erase(u32 address)
+{
+  m_display_lists.erase(address);
+}
+
+void DisplayListCache::EndFrame()
+{
+  ++m_frame_count;
+  if (m_frame_count % MAX_UNUSED_FRAMES != 0)
+    return;
+
+  std::erase_if(m_display_lists, [this](const auto& entry) {
+    return m_frame_count - entry.second.last_used_frame >= MAX_UNUSED_FRAMES;
+  });
+}
+
+void DisplayListCache::Clear()
+{
+  m_display_lists.clear();
+}
+}  // namespace OpcodeDecoder
@@ -0,0 +1,336 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+// Games commonly call the same display lists every frame. Instead of decoding them byte by byte
+// each time, the first call records the decoded commands (with the register writes already
+// byte swapped) and later calls to the same address and size replay them.
+//
+// The game may have changed the display list since it was recorded. XF and vertex data are read
+// from memory while replaying anyway, so only the bytes which determine the commands themselves
+// (the opcodes, register writes and counts) are compared with the recording, one command at a time.
+// Hashing the whole display list instead would cost more than decoding it, since most of its bytes
+// are usually vertex data which the decoder skips over.
+//
+// The size of a primitive command depends on the vertex format at the time it is executed, so a
+// recorded display list is only valid as long as the vertex sizes match. This is checked for every
+// primitive while replaying. If either check fails, the rest of the display list is interpreted
+// normally.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/OpcodeDecoding.h"
+
+namespace OpcodeDecoder
+{
+class DisplayListCache
+{
+public:
+  enum class CommandType : u8
+  {
+    Nop,
+    XF,
+    CP,
+    BP,
+    IndexedLoad,
+    Primitive,
+  };
+
+  // The bytes of a command which aren't XF or vertex data
+  static constexpr size_t MAX_HEADER_SIZE = 6;
+
+  struct Command
+  {
+    // Bytes of the command at the time it was recorded, except for NOPs
+    std::array<u8, MAX_HEADER_SIZE> header;
+    // Offset of the command in the display list
+    u32 offset;
+    // CP/BP value, raw indexed load value or vertex size
+    u32 value;
+    // XF address or vertex count
+    u16 address;
+    CommandType type;
+    // CP/BP register, XF count, indexed load opcode or primitive opcode
+    u8 arg;
+  };
+
+  struct DisplayList
+  {
+    u32 size = 0;
+    // Number of bytes which were consumed by the decoder
+    u32 decoded_size = 0;
+    u32 last_used_frame = 0;
+    std::vector<Command> commands;
+  };
+
+  // Returns nullptr if no display list of this size has been recorded at this address.
+  const DisplayList* Find(u32 address, u32 size);
+  void Insert(u32 address, DisplayList display_list);
+  void Erase(u32 address);
+
+  void EndFrame();
+  void Clear();
+
+  // Interprets the display list while recording its commands. Returns false if the display list
+  // contains commands which can't be replayed.
+  template <typename T>
+  static bool Record(const u8* data, u32 size, T& callback, DisplayList* display_list);
+
+  // Replays a recorded display list from the current contents of data. Returns false if the
+  // commands in data differ from the recording, which should then be dropped. The display list is
+  // executed completely either way.
+  template <typename T>
+  static bool Replay(const DisplayList& display_list, const u8* data, T& callback);
+
+private:
+  static constexpr size_t GetHeaderSize(CommandType type)
+  {
+    switch (type)
+    {
+    case CommandType::XF:
+    case CommandType::BP:
+    case CommandType::IndexedLoad:
+      return 5;
+    case CommandType::CP:
+      return 6;
+    case CommandType::Primitive:
+      return 3;
+    default:
+      return 0;
+    }
+  }
+
+  // With a constant size, the comparison is inlined as one or two loads.
+  template <CommandType type>
+  static bool IsHeaderUnchanged(const Command& command, const u8* data)
+  {
+    return std::memcmp(data, command.header.data(), GetHeaderSize(type)) == 0;
+  }
+
+  // Interprets the rest of the display list, starting at the given command.
+  template <typename T>
+  static void RunFrom(const DisplayList& display_list, const Command& command, const u8* data,
+                      T& callback)
+  {
+    Run(data + command.offset, display_list.size - command.offset, callback);
+  }
+
+  template <typename T>
+  class RecordingCallback;
+
+  // Display lists which haven't been used for this many frames are dropped
+  static constexpr u32 MAX_UNUSED_FRAMES = 600;
+  static constexpr size_t MAX_DISPLAY_LISTS = 8192;
+
+  std::unordered_map<u32, DisplayList> m_display_lists;
+  u32 m_frame_count = 0;
+};
+
+template <typename T>
+class DisplayListCache::RecordingCallback final : public Callback
+{
+public:
+  RecordingCallback(const u8* start, T& callback, DisplayList* display_list)
+      : m_start(start), m_callback(callback), m_display_list(display_list)
+  {
+  }
+
+  OPCODE_CALLBACK(void OnXF(u16 address, u8 count, const u8* data))
+  {
+    SetPending(CommandType::XF, 0, address, count);
+    m_callback.OnXF(address, count, data);
+  }
+  OPCODE_CALLBACK(void OnCP(u8 command, u32 value))
+  {
+    SetPending(CommandType::CP, value, 0, command);
+    m_callback.OnCP(command, value);
+  }
+  OPCODE_CALLBACK(void OnBP(u8 command, u32 value))
+  {
+    SetPending(CommandType::BP, value, 0, command);
+    m_callback.OnBP(command, value);
+  }
+  OPCODE_CALLBACK(void OnIndexedLoad(CPArray array, u32 index, u16 address, u8 size))
+  {
+    // The raw value is taken from the command itself in OnCommand
+    SetPending(CommandType::IndexedLoad, 0, 0, 0);
+    m_callback.OnIndexedLoad(array, index, address, size);
+  }
+  OPCODE_CALLBACK(void OnPrimitiveCommand(OpcodeDecoder::Primitive primitive, u8 vat,
+                                          u32 vertex_size, u16 num_vertices, const u8* vertex_data))
+  {
+    SetPending(CommandType::Primitive, vertex_size, num_vertices, 0);
+    m_callback.OnPrimitiveCommand(primitive, vat, vertex_size, num_vertices, vertex_data);
+  }
+  OPCODE_CALLBACK(void OnDisplayList(u32 address, u32 size))
+  {
+    m_cacheable = false;
+    m_callback.OnDisplayList(address, size);
+  }
+  OPCODE_CALLBACK(void OnNop(u32 count))
+  {
+    SetPending(CommandType::Nop, 0, 0, 0);
+    m_callback.OnNop(count);
+  }
+  OPCODE_CALLBACK(void OnUnknown(u8 opcode, const u8* data))
+  {
+    m_cacheable = false;
+    m_callback.OnUnknown(opcode, data);
+  }
+
+  OPCODE_CALLBACK(void OnCommand(const u8* data, u32 size))
+  {
+    if (m_has_pending)
+    {
+      m_pending.offset = static_cast<u32>(data - m_start);
+      std::memcpy(m_pending.header.data(), data, GetHeaderSize(m_pending.type));
+      if (m_pending.type == CommandType::IndexedLoad)
+      {
+        m_pending.arg = data[0];
+        m_pending.value = Common::swap32(&data[1]);
+      }
+      else if (m_pending.type == CommandType::Primitive)
+      {
+        m_pending.arg = data[0];
+      }
+      m_display_list->commands.push_back(m_pending);
+      m_has_pending = false;
+    }
+    m_callback.OnCommand(data, size);
+  }
+
+  OPCODE_CALLBACK(CPState& GetCPState()) { return m_callback.GetCPState(); }
+
+  OPCODE_CALLBACK(u32 GetVertexSize(u8 vat)) { return m_callback.GetVertexSize(vat); }
+
+  bool IsCacheable() const { return m_cacheable; }
+
+private:
+  void SetPending(CommandType type, u32 value, u16 address, u8 arg)
+  {
+    m_pending = {{}, 0, value, address, type, arg};
+    m_has_pending = true;
+  }
+
+  const u8* const m_start;
+  T& m_callback;
+  DisplayList* const m_display_list;
+  Command m_pending{};
+  bool m_has_pending = false;
+  bool m_cacheable = true;
+};
+
+template <typename T>
+bool DisplayListCache::Record(const u8* data, u32 size, T& callback, DisplayList* display_list)
+{
+  RecordingCallback<T> recorder(data, callback, display_list);
+  display_list->size = size;
+  display_list->decoded_size = Run(data, size, recorder);
+  return recorder.IsCacheable();
+}
+
+template <typename T>
+bool DisplayListCache::Replay(const DisplayList& display_list, const u8* data, T& callback)
+{
+  const size_t count = display_list.commands.size();
+  for (size_t i = 0; i < count; ++i)
+  {
+    const Command& command = display_list.commands[i];
+    const u32 end =
+        i + 1 < count ? display_list.commands[i + 1].offset : display_list.decoded_size;
+    const u8* const command_data = data + command.offset;
+    const u32 command_size = end - command.offset;
+
+    // Each command is compared with the recording before it is replayed. If it differs, the game
+    // has changed the display list, and the decoder takes over from that command.
+    switch (command.type)
+    {
+    case CommandType::Nop:
+      if (!std::all_of(command_data, command_data + command_size,
+                       [](u8 byte) { return static_cast<Opcode>(byte) == Opcode::GX_NOP; }))
+      {
+        RunFrom(display_list, command, data, callback);
+        return false;
+      }
+      callback.OnNop(command_size);
+      break;
+    case CommandType::XF:
+      if (!IsHeaderUnchanged<CommandType::XF>(command, command_data))
+      {
+        RunFrom(display_list, command, data, callback);
+        return false;
+      }
+      callback.OnXF(command.address, command.arg, &command_data[5]);
+      break;
+    case CommandType::CP:
+      if (!IsHeaderUnchanged<CommandType::CP>(command, command_data))
+      {
+        RunFrom(display_list, command, data, callback);
+        return false;
+      }
+      callback.OnCP(command.arg, command.value);
+      break;
+    case CommandType::BP:
+      if (!IsHeaderUnchanged<CommandType::BP>(command, command_data))
+      {
+        RunFrom(display_list, command, data, callback);
+        return false;
+      }
+      callback.OnBP(command.arg, command.value);
+      break;
+    case CommandType::IndexedLoad:
+    {
+      if (!IsHeaderUnchanged<CommandType::IndexedLoad>(command, command_data))
+      {
+        RunFrom(display_list, command, data, callback);
+        return false;
+      }
+      const u32 value = command.value;
+      const auto ref_array = static_cast<CPArray>((command.arg / 8) + 8);
+      callback.OnIndexedLoad(ref_array, value >> 16, value & 0xFFF, ((value >> 12) & 0xF) + 1);
+      break;
+    }
+    case CommandType::Primitive:
+    {
+      if (!IsHeaderUnchanged<CommandType::Primitive>(command, command_data))
+      {
+        RunFrom(display_list, command, data, callback);
+        return false;
+      }
+      const u8 vat = command.arg & GX_VAT_MASK;
+      if (callback.GetVertexSize(vat) != command.value)
+      {
+        // The vertex format changed since the display list was recorded, so the command
+        // boundaries from here on can't be trusted.
+        RunFrom(display_list, command, data, callback);
+        return true;
+      }
+      const auto primitive =
+          static_cast<Primitive>((command.arg & GX_PRIMITIVE_MASK) >> GX_PRIMITIVE_SHIFT);
+      callback.OnPrimitiveCommand(primitive, vat, command.value, command.address,
+                                  &command_data[3]);
+      break;
+    }
+    }
+
+    callback.OnCommand(command_data, command_size);
+  }
+
+  // The decoder stopped at an incomplete command when the display list was recorded. Whether it is
+  // still incomplete can depend on the vertex format, so this is left to the decoder.
+  if (display_list.decoded_size < display_list.size)
+  {
+    Run(data + display_list.decoded_size, display_list.size - display_list.decoded_size,
+        callback);
+  }
+  return true;
+}
+
+extern DisplayListCache g_display_list_cache;
+}  // namespace OpcodeDecoder
@@ -3,8 +3,10 @@
 
 #include "VideoCommon/Fifo.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cstring>
+#include <thread>
 
 #include "Common/Assert.h"
 #include "Common/BlockingLoop.h"
@@ -13,6 +15,7 @@
 #include "Common/FPURoundMode.h"
 #include "Common/MemoryUtil.h"
 #include "Common/MsgHandler.h"
+#include "Common/Thread.h"
 
 #include "Core/Config/MainSettings.h"
 #include "Core/ConfigManager.h"
@@ -36,6 +39,75 @@ namespace Fifo
 {
 static constexpr int GPU_TIME_SLOT_SIZE = 1000;
 
+DecodedCommandQueue::DecodedCommandQueue() = default;
+
+DecodedCommandQueue::~DecodedCommandQueue() = default;
+
+void DecodedCommandQueue::Init(bool enabled)
+{
+  m_commands.clear();
+  m_commands.shrink_to_fit();
+  m_commands.resize(enabled ? SIZE : 0);
+  Reset();
+}
+
+void DecodedCommandQueue::Reset()
+{
+  m_write = 0;
+  m_end.store(0);
+  m_read.store(0);
+}
+
+bool DecodedCommandQueue::IsFull() const
+{
+  return m_write - m_read.load(std::memory_order_acquire) == SIZE;
+}
+
+void DecodedCommandQueue::Push(const OpcodeDecoder::DecodedCommand& command)
+{
+  m_commands[m_write++ % SIZE] = command;
+}
+
+void DecodedCommandQueue::Publish()
+{
+  m_end.store(m_write, std::memory_order_release);
+}
+
+bool DecodedCommandQueue::IsDrained() const
+{
+  return m_read.load(std::memory_order_acquire) == m_write;
+}
+
+std::span<const OpcodeDecoder::DecodedCommand> DecodedCommandQueue::GetNextRun() const
+{
+  const size_t read = m_read.load(std::memory_order_relaxed);
+  const size_t offset = read % SIZE;
+  const size_t available = std::min({m_end.load(std::memory_order_acquire) - read, SIZE - offset,
+                                     MAX_COMMANDS_PER_RUN});
+
+  size_t count = 0;
+  while (count < available)
+  {
+    const OpcodeDecoder::DecodedCommand::Type type = m_commands[offset + count++].type;
+    if (type == OpcodeDecoder::DecodedCommand::Type::FifoProgress ||
+        type == OpcodeDecoder::DecodedCommand::Type::Idle)
+    {
+      break;
+    }
+  }
+  return {m_commands.data() + offset, count};
+}
+
+void DecodedCommandQueue::Pop(size_t count)
+{
+  m_read.fetch_add(count, std::memory_order_release);
+}
+
+bool DecodedCommandQueue::IsEmpty() const
+{
+  return m_read.load(std::memory_order_acquire) == m_end.load(std::memory_order_acquire);
+}
+
 FifoManager::FifoManager(Core::System& system) : m_system{system}
 {
 }
@@ -48,20 +120,39 @@ void FifoManager::RefreshConfig()
   m_config_sync_gpu_max_distance = Config::Get(Config::MAIN_SYNC_GPU_MAX_DISTANCE);
   m_config_sync_gpu_min_distance = Config::Get(Config::MAIN_SYNC_GPU_MIN_DISTANCE);
   m_config_sync_gpu_overclock = Config::Get(Config::MAIN_SYNC_GPU_OVERCLOCK);
+  m_config_decode_thread = Config::Get(Config::MAIN_GPU_DECODE_THREAD);
 }
 
 void FifoManager::DoState(PointerWrap& p)
 {
   p.DoArray(m_video_buffer, FIFO_SIZE);
+  // The video thread may have stopped at an interrupt before running everything the decode thread
+  // has read. The CP registers only cover what it has executed, so the rest is left out, and is
+  // read from the FIFO again after loading.
   u8* write_ptr = m_video_buffer_write_ptr;
+  if (UseDecodeThread())
+    write_ptr = m_video_buffer_executed_write_ptr;
   p.DoPointer(write_ptr, m_video_buffer);
-  m_video_buffer_write_ptr = write_ptr;
-  p.DoPointer(m_video_buffer_read_ptr, m_video_buffer);
+  if (p.IsReadMode())
+    m_video_buffer_write_ptr = write_ptr;
+  if (UseDecodeThread())
+    p.DoPointer(m_video_buffer_executed_ptr, m_video_buffer);
+  else
+    p.DoPointer(m_video_buffer_read_ptr, m_video_buffer);
   if (p.IsReadMode() && m_use_deterministic_gpu_thread)
   {
     // We're good and paused, right?
     m_video_buffer_seen_ptr = m_video_buffer_pp_read_ptr = m_video_buffer_read_ptr;
   }
+  if (p.IsReadMode() && UseDecodeThread())
+  {
+    m_video_buffer_read_ptr = m_video_buffer_executed_ptr;
+    m_video_buffer_executed_write_ptr = write_ptr;
+    m_decoded_commands.Reset();
+    m_decoded_commands_idle = 0;
+    m_decode_pending_bytes.store(0);
+    m_fifo_aux_write_ptr = m_fifo_aux_read_ptr = m_fifo_aux_data;
+  }
 
   p.Do(m_sync_ticks);
   p.Do(m_syncing_suspended);
@@ -77,6 +168,8 @@ void FifoManager::PauseAndLock(bool do_lock, bool unpause_on_unlock)
     if (!m_system.IsDualCoreMode() || m_use_deterministic_gpu_thread)
       return;
 
+    if (UseDecodeThread())
+      m_decode_loop.WaitYield(std::chrono::milliseconds(100), Host_YieldToUI);
     m_gpu_mainloop.WaitYield(std::chrono::milliseconds(100), Host_YieldToUI);
   }
   else
@@ -95,8 +188,16 @@ void FifoManager::Init()
   // Padded so that SIMD overreads in the vertex loader are safe
   m_video_buffer = static_cast<u8*>(Common::AllocateMemoryPages(FIFO_SIZE + 4));
   ResetVideoBuffer();
+
+  m_use_decode_thread = m_config_decode_thread && m_system.IsDualCoreMode();
+  m_decoded_commands.Init(m_use_decode_thread);
+  m_decoded_commands_idle = 0;
+  m_decode_pending_bytes.store(0);
+
   if (m_system.IsDualCoreMode())
     m_gpu_mainloop.Prepare();
+  if (m_use_decode_thread)
+    m_decode_loop.Prepare();
   m_sync_ticks.store(0);
 }
 
@@ -111,8 +212,12 @@ void FifoManager::Shutdown()
   m_video_buffer_pp_read_ptr = nullptr;
   m_video_buffer_read_ptr = nullptr;
   m_video_buffer_seen_ptr = nullptr;
+  m_video_buffer_executed_ptr = nullptr;
+  m_video_buffer_executed_write_ptr = nullptr;
   m_fifo_aux_write_ptr = nullptr;
   m_fifo_aux_read_ptr = nullptr;
+  m_decoded_commands.Init(false);
+  m_use_decode_thread = false;
 
   if (m_config_callback_id)
   {
@@ -135,15 +240,22 @@ void FifoManager::ExitGpuLoop()
   // Terminate GPU thread loop
   m_emu_running_state.Set();
   m_gpu_mainloop.Stop(Common::BlockingLoop::StopMode::NonBlock);
+  m_decode_loop.Stop(Common::BlockingLoop::StopMode::NonBlock);
 }
 
 void FifoManager::EmulatorState(bool running)
 {
   m_emu_running_state.Set(running);
   if (running)
+  {
     m_gpu_mainloop.Wakeup();
+    m_decode_loop.Wakeup();
+  }
   else
+  {
     m_gpu_mainloop.AllowSleep();
+    m_decode_loop.AllowSleep();
+  }
 }
 
 void FifoManager::SyncGPU(SyncGPUReason reason, bool may_move_read_ptr)
@@ -184,26 +296,38 @@ void FifoManager::SyncGPU(SyncGPUReason reason, bool may_move_read_ptr)
   }
 }
 
-void FifoManager::PushFifoAuxBuffer(const void* ptr, size_t size)
+void* FifoManager::PushFifoAuxBuffer(const void* ptr, size_t size)
 {
   if (size > (size_t)(m_fifo_aux_data + FIFO_SIZE - m_fifo_aux_write_ptr))
   {
-    SyncGPU(SyncGPUReason::AuxSpace, /* may_move_read_ptr */ false);
-    if (!m_gpu_mainloop.IsRunning())
+    if (UseDecodeThread())
     {
-      // GPU is shutting down
-      return;
+      if (!DrainDecodedCommands())
+        return nullptr;
+      m_fifo_aux_write_ptr = m_fifo_aux_data;
+      m_fifo_aux_read_ptr = m_fifo_aux_data;
+    }
+    else
+    {
+      SyncGPU(SyncGPUReason::AuxSpace, /* may_move_read_ptr */ false);
+      if (!m_gpu_mainloop.IsRunning())
+      {
+        // GPU is shutting down
+        return nullptr;
+      }
     }
     if (size > (size_t)(m_fifo_aux_data + FIFO_SIZE - m_fifo_aux_write_ptr))
     {
       // That will sync us up to the last 32 bytes, so this short region
       // of FIFO would have to point to a 2MB display list or something.
       PanicAlertFmt("Absurdly large aux buffer");
-      return;
+      return nullptr;
     }
   }
+  void* const copy = m_fifo_aux_write_ptr;
   memcpy(m_fifo_aux_write_ptr, ptr, size);
   m_fifo_aux_write_ptr += size;
+  return copy;
 }
 
 void* FifoManager::PopFifoAuxBuffer(size_t size)
@@ -213,12 +337,120 @@ void* FifoManager::PopFifoAuxBuffer(size_t size)
   return ret;
 }
 
+void FifoManager::PushDecodedCommand(const OpcodeDecoder::DecodedCommand& command)
+{
+  if (m_decoded_commands.IsFull() && !DrainDecodedCommands())
+    return;
+
+  m_decoded_commands.Push(command);
+
+  // Don't let the video thread wait for the end of a large display list.
+  if (m_decoded_commands.GetPushedCount() % DecodedCommandQueue::MAX_COMMANDS_PER_RUN == 0)
+    PublishDecodedCommands();
+}
+
+void FifoManager::PublishDecodedCommands()
+{
+  m_decoded_commands.Publish();
+  m_gpu_mainloop.Wakeup();
+}
+
+// Waits until the video thread has run all decoded commands, so that the memory they point to may
+// be reused. Returns false if the video thread has stopped.
+bool FifoManager::DrainDecodedCommands()
+{
+  // The video thread normally stops while a GPU interrupt waits for the CPU, which may in turn be
+  // waiting for this thread.
+  m_draining_decoded_commands.store(true);
+  PublishDecodedCommands();
+  m_gpu_mainloop.Wait();
+  m_draining_decoded_commands.store(false);
+  return m_decoded_commands.IsDrained();
+}
+
+// The video thread's side of the decode thread.
+void FifoManager::RunDecodedCommands()
+{
+  auto& command_processor = m_system.GetCommandProcessor();
+  while (!command_processor.IsInterruptWaiting() || m_draining_decoded_commands.load())
+  {
+    const std::span<const OpcodeDecoder::DecodedCommand> run = m_decoded_commands.GetNextRun();
+    if (run.empty())
+      break;
+
+    OpcodeDecoder::RunDecodedCommands(run);
+    const OpcodeDecoder::DecodedCommand& last = run.back();
+    if (last.type == OpcodeDecoder::DecodedCommand::Type::FifoProgress)
+    {
+      OnFifoProgress(last);
+    }
+    else if (last.type == OpcodeDecoder::DecodedCommand::Type::Idle)
+    {
+      g_vertex_manager->Flush();
+      g_framebuffer_manager->RefreshPeekCache();
+      if (m_decode_pending_bytes.load() == 0)
+        SkipSyncTicksIfIdle();
+    }
+
+    m_decoded_commands.Pop(run.size());
+
+    AsyncRequests::GetInstance()->PullEvents();
+  }
+}
+
+// Moves the FIFO state the CPU sees past a chunk, once the video thread has executed it.
+void FifoManager::OnFifoProgress(const OpcodeDecoder::DecodedCommand& command)
+{
+  auto& command_processor = m_system.GetCommandProcessor();
+  auto& fifo = command_processor.GetFifo();
+
+  m_video_buffer_executed_ptr = const_cast<u8*>(command.data);
+  m_video_buffer_executed_write_ptr = m_video_buffer_executed_ptr + command.partial_size;
+  fifo.CPReadPointer.store(command.value, std::memory_order_relaxed);
+  fifo.CPReadWriteDistance.fetch_sub(GPFifo::GATHER_PIPE_SIZE, std::memory_order_seq_cst);
+  m_decode_pending_bytes.fetch_sub(GPFifo::GATHER_PIPE_SIZE);
+  if (command.partial_size == 0)
+  {
+    fifo.SafeCPReadPointer.store(fifo.CPReadPointer.load(std::memory_order_relaxed),
+                                 std::memory_order_relaxed);
+  }
+
+  command_processor.SetCPStatusFromGPU();
+
+  // The decode thread may have stopped because the distance it sees was briefly too short.
+  if (fifo.CPReadWriteDistance.load(std::memory_order_relaxed) > m_decode_pending_bytes.load())
+    m_decode_loop.Wakeup();
+
+  if (m_config_sync_gpu)
+  {
+    const int cycles = static_cast<int>(command.size / m_config_sync_gpu_overclock);
+    const int old = m_sync_ticks.fetch_sub(cycles);
+    if (old >= m_config_sync_gpu_max_distance && old - cycles < m_config_sync_gpu_max_distance)
+      m_sync_wakeup_event.Set();
+  }
+}
+
+// Skips the remaining GPU time once the FIFO is empty.
+void FifoManager::SkipSyncTicksIfIdle()
+{
+  if (m_sync_ticks.load() > 0)
+  {
+    const int old = m_sync_ticks.exchange(0);
+    if (old >= m_config_sync_gpu_max_distance)
+      m_sync_wakeup_event.Set();
+  }
+}
+
 // Description: RunGpuLoop() sends data through this function.
 void FifoManager::ReadDataFromFifo(u32 read_ptr)
 {
   if (GPFifo::GATHER_PIPE_SIZE >
       static_cast<size_t>(m_video_buffer + FIFO_SIZE - m_video_buffer_write_ptr))
   {
+    // The decoded commands point into the data which is about to be moved.
+    if (UseDecodeThread() && !DrainDecodedCommands())
+      return;
+
     const size_t existing_len = m_video_buffer_write_ptr - m_video_buffer_read_ptr;
     if (GPFifo::GATHER_PIPE_SIZE > static_cast<size_t>(FIFO_SIZE - existing_len))
     {
@@ -229,6 +461,8 @@ void FifoManager::ReadDataFromFifo(u32 read_ptr)
     memmove(m_video_buffer, m_video_buffer_read_ptr, existing_len);
     m_video_buffer_write_ptr = m_video_buffer + existing_len;
     m_video_buffer_read_ptr = m_video_buffer;
+    m_video_buffer_executed_ptr = m_video_buffer;
+    m_video_buffer_executed_write_ptr = m_video_buffer_write_ptr;
   }
   // Copy new video instructions to m_video_buffer for future use in rendering the new picture
   auto& memory = m_system.GetMemory();
@@ -279,6 +513,8 @@ void FifoManager::ResetVideoBuffer()
   m_video_buffer_write_ptr = m_video_buffer;
   m_video_buffer_seen_ptr = m_video_buffer;
   m_video_buffer_pp_read_ptr = m_video_buffer;
+  m_video_buffer_executed_ptr = m_video_buffer;
+  m_video_buffer_executed_write_ptr = m_video_buffer;
   m_fifo_aux_write_ptr = m_fifo_aux_data;
   m_fifo_aux_read_ptr = m_fifo_aux_data;
 }
@@ -290,11 +526,22 @@ void FifoManager::RunGpuLoop()
   AsyncRequests::GetInstance()->SetEnable(true);
   AsyncRequests::GetInstance()->SetPassthrough(false);
 
+  std::thread decode_thread;
+  if (m_use_decode_thread)
+    decode_thread = std::thread(&FifoManager::RunDecodeLoop, this);
+
   m_gpu_mainloop.Run(
       [this] {
         // Run events from the CPU thread.
         AsyncRequests::GetInstance()->PullEvents();
 
+        // The decoded commands are run even while paused, since pausing waits for them.
+        if (UseDecodeThread())
+        {
+          RunDecodedCommands();
+          return;
+        }
+
         // Do nothing while paused
         if (!m_emu_running_state.IsSet())
           return;
@@ -314,99 +561,182 @@ void FifoManager::RunGpuLoop()
         }
         else
         {
-          auto& command_processor = m_system.GetCommandProcessor();
-          auto& fifo = command_processor.GetFifo();
-          command_processor.SetCPStatusFromGPU();
-
-          // check if we are able to run this buffer
-          while (!command_processor.IsInterruptWaiting() &&
-                 fifo.bFF_GPReadEnable.load(std::memory_order_relaxed) &&
-                 fifo.CPReadWriteDistance.load(std::memory_order_relaxed) &&
-                 !AtBreakpoint(m_system))
-          {
-            if (m_config_sync_gpu && m_sync_ticks.load() < m_config_sync_gpu_min_distance)
-              break;
-
-            u32 cyclesExecuted = 0;
-            u32 readPtr = fifo.CPReadPointer.load(std::memory_order_relaxed);
-            ReadDataFromFifo(readPtr);
-
-            if (readPtr == fifo.CPEnd.load(std::memory_order_relaxed))
-              readPtr = fifo.CPBase.load(std::memory_order_relaxed);
-            else
-              readPtr += GPFifo::GATHER_PIPE_SIZE;
-
-            const s32 distance =
-                static_cast<s32>(fifo.CPReadWriteDistance.load(std::memory_order_relaxed)) -
-                GPFifo::GATHER_PIPE_SIZE;
-            ASSERT_MSG(COMMANDPROCESSOR, distance >= 0,
-                       "Negative fifo.CPReadWriteDistance = {} in FIFO Loop !\nThat can produce "
-                       "instability in the game. Please report it.",
-                       distance);
-
-            u8* write_ptr = m_video_buffer_write_ptr;
-            m_video_buffer_read_ptr = OpcodeDecoder::RunFifo(
-                DataReader(m_video_buffer_read_ptr, write_ptr), &cyclesExecuted);
-
-            fifo.CPReadPointer.store(readPtr, std::memory_order_relaxed);
-            fifo.CPReadWriteDistance.fetch_sub(GPFifo::GATHER_PIPE_SIZE, std::memory_order_seq_cst);
-            if ((write_ptr - m_video_buffer_read_ptr) == 0)
-            {
-              fifo.SafeCPReadPointer.store(fifo.CPReadPointer.load(std::memory_order_relaxed),
-                                           std::memory_order_relaxed);
-            }
-
-            command_processor.SetCPStatusFromGPU();
-
-            if (m_config_sync_gpu)
-            {
-              cyclesExecuted = (int)(cyclesExecuted / m_config_sync_gpu_overclock);
-              int old = m_sync_ticks.fetch_sub(cyclesExecuted);
-              if (old >= m_config_sync_gpu_max_distance &&
-                  old - (int)cyclesExecuted < m_config_sync_gpu_max_distance)
-              {
-                m_sync_wakeup_event.Set();
-              }
-            }
-
-            // This call is pretty important in DualCore mode and must be called in the FIFO Loop.
-            // If we don't, s_swapRequested or s_efbAccessRequested won't be set to false
-            // leading the CPU thread to wait in Video_OutputXFB or Video_AccessEFB thus slowing
-            // things down.
-            AsyncRequests::GetInstance()->PullEvents();
-          }
-
-          // fast skip remaining GPU time if fifo is empty
-          if (m_sync_ticks.load() > 0)
-          {
-            int old = m_sync_ticks.exchange(0);
-            if (old >= m_config_sync_gpu_max_distance)
-              m_sync_wakeup_event.Set();
-          }
-
-          // The fifo is empty and it's unlikely we will get any more work in the near future.
-          // Make sure VertexManager finishes drawing any primitives it has stored in it's buffer.
-          g_vertex_manager->Flush();
-          g_framebuffer_manager->RefreshPeekCache();
+          ProcessFifo();
         }
       },
       100);
 
+  if (decode_thread.joinable())
+  {
+    m_decode_loop.Stop();
+    decode_thread.join();
+  }
+
   AsyncRequests::GetInstance()->SetEnable(false);
   AsyncRequests::GetInstance()->SetPassthrough(true);
 }
 
+void FifoManager::RunDecodeLoop()
+{
+  Common::SetCurrentThreadName("Video decode thread");
+
+  m_decode_loop.Run(
+      [this] {
+        // Do nothing while paused, or while the deterministic GPU thread is used instead
+        if (!m_emu_running_state.IsSet() || !UseDecodeThread())
+          return;
+
+        ProcessFifo();
+      },
+      100);
+}
+
+// Reads the FIFO until it is empty. This runs on the decode thread if it is used, and on the video
+// thread otherwise.
+void FifoManager::ProcessFifo()
+{
+  const bool decode_thread = UseDecodeThread();
+  auto& command_processor = m_system.GetCommandProcessor();
+  auto& fifo = command_processor.GetFifo();
+
+  // The decode thread reads ahead of the CP registers, which only move once the video thread has
+  // executed a chunk. They may only have been changed by the CPU if the video thread has caught up.
+  if (decode_thread)
+  {
+    if (m_decode_pending_bytes.load() == 0)
+      m_decode_read_pointer = fifo.CPReadPointer.load(std::memory_order_relaxed);
+  }
+  else
+  {
+    command_processor.SetCPStatusFromGPU();
+  }
+
+  const auto get_read_pointer = [&] {
+    return decode_thread ? m_decode_read_pointer :
+                           fifo.CPReadPointer.load(std::memory_order_relaxed);
+  };
+  const auto has_data = [&] {
+    const u32 pending = decode_thread ? m_decode_pending_bytes.load() : 0;
+    return fifo.CPReadWriteDistance.load(std::memory_order_relaxed) > pending;
+  };
+  const auto at_breakpoint = [&] {
+    return fifo.bFF_BPEnable.load(std::memory_order_relaxed) &&
+           get_read_pointer() == fifo.CPBreakpoint.load(std::memory_order_relaxed);
+  };
+
+  // check if we are able to run this buffer
+  while (!command_processor.IsInterruptWaiting() &&
+         fifo.bFF_GPReadEnable.load(std::memory_order_relaxed) && has_data() && !at_breakpoint())
+  {
+    if (m_config_sync_gpu && m_sync_ticks.load() < m_config_sync_gpu_min_distance)
+      break;
+
+    u32 cyclesExecuted = 0;
+    u32 readPtr = get_read_pointer();
+    ReadDataFromFifo(readPtr);
+
+    if (readPtr == fifo.CPEnd.load(std::memory_order_relaxed))
+      readPtr = fifo.CPBase.load(std::memory_order_relaxed);
+    else
+      readPtr += GPFifo::GATHER_PIPE_SIZE;
+
+    u8* write_ptr = m_video_buffer_write_ptr;
+    if (decode_thread)
+    {
+      m_video_buffer_read_ptr = OpcodeDecoder::DecodeFifo(
+          DataReader(m_video_buffer_read_ptr, write_ptr), &cyclesExecuted);
+      m_decode_read_pointer = readPtr;
+      m_decode_pending_bytes.fetch_add(GPFifo::GATHER_PIPE_SIZE);
+
+      const u32 partial_size = static_cast<u32>(write_ptr - m_video_buffer_read_ptr);
+      PushDecodedCommand({m_video_buffer_read_ptr, cyclesExecuted, readPtr, 0,
+                          OpcodeDecoder::DecodedCommand::Type::FifoProgress, 0, partial_size});
+      PublishDecodedCommands();
+      continue;
+    }
+
+    const s32 distance =
+        static_cast<s32>(fifo.CPReadWriteDistance.load(std::memory_order_relaxed)) -
+        GPFifo::GATHER_PIPE_SIZE;
+    ASSERT_MSG(COMMANDPROCESSOR, distance >= 0,
+               "Negative fifo.CPReadWriteDistance = {} in FIFO Loop !\nThat can produce "
+               "instability in the game. Please report it.",
+               distance);
+
+    m_video_buffer_read_ptr = OpcodeDecoder::RunFifo(
+        DataReader(m_video_buffer_read_ptr, write_ptr), &cyclesExecuted);
+
+    fifo.CPReadPointer.store(readPtr, std::memory_order_relaxed);
+    fifo.CPReadWriteDistance.fetch_sub(GPFifo::GATHER_PIPE_SIZE, std::memory_order_seq_cst);
+    if ((write_ptr - m_video_buffer_read_ptr) == 0)
+    {
+      fifo.SafeCPReadPointer.store(fifo.CPReadPointer.load(std::memory_order_relaxed),
+                                   std::memory_order_relaxed);
+    }
+
+    command_processor.SetCPStatusFromGPU();
+
+    if (m_config_sync_gpu)
+    {
+      cyclesExecuted = (int)(cyclesExecuted / m_config_sync_gpu_overclock);
+      int old = m_sync_ticks.fetch_sub(cyclesExecuted);
+      if (old >= m_config_sync_gpu_max_distance &&
+          old - (int)cyclesExecuted < m_config_sync_gpu_max_distance)
+      {
+        m_sync_wakeup_event.Set();
+      }
+    }
+
+    // This call is pretty important in DualCore mode and must be called in the FIFO Loop.
+    // If we don't, s_swapRequested or s_efbAccessRequested won't be set to false
+    // leading the CPU thread to wait in Video_OutputXFB or Video_AccessEFB thus slowing
+    // things down.
+    AsyncRequests::GetInstance()->PullEvents();
+  }
+
+  // The fifo is empty and it's unlikely we will get any more work in the near future.
+  // Make sure VertexManager finishes drawing any primitives it has stored in it's buffer.
+  // With the decode thread, the video thread does this, and skips the remaining GPU time, once it
+  // gets to this point.
+  if (decode_thread)
+  {
+    if (m_decoded_commands.GetPushedCount() != m_decoded_commands_idle)
+    {
+      PushDecodedCommand({nullptr, 0, 0, 0, OpcodeDecoder::DecodedCommand::Type::Idle, 0});
+      m_decoded_commands_idle = m_decoded_commands.GetPushedCount();
+      PublishDecodedCommands();
+    }
+  }
+  else
+  {
+    // fast skip remaining GPU time if fifo is empty
+    SkipSyncTicksIfIdle();
+
+    g_vertex_manager->Flush();
+    g_framebuffer_manager->RefreshPeekCache();
+  }
+}
+
 void FifoManager::FlushGpu()
 {
   if (!m_system.IsDualCoreMode() || m_use_deterministic_gpu_thread)
     return;
 
+  if (UseDecodeThread())
+    m_decode_loop.Wait();
   m_gpu_mainloop.Wait();
 }
 
 void FifoManager::GpuMaySleep()
 {
   m_gpu_mainloop.AllowSleep();
+  m_decode_loop.AllowSleep();
+}
+
+// The loop which reads the FIFO in dual core mode.
+Common::BlockingLoop& FifoManager::GetFifoReadLoop()
+{
+  return UseDecodeThread() ? m_decode_loop : m_gpu_mainloop;
 }
 
 bool AtBreakpoint(Core::System& system)
@@ -425,7 +755,10 @@ void FifoManager::RunGpu()
   // wake up GPU thread
   if (is_dual_core && !m_use_deterministic_gpu_thread)
   {
-    m_gpu_mainloop.Wakeup();
+    // The video thread may have stopped at an interrupt with decoded commands left.
+    if (UseDecodeThread())
+      m_gpu_mainloop.Wakeup();
+    GetFifoReadLoop().Wakeup();
   }
 
   // if the sync GPU callback is suspended, wake it up.
@@ -527,10 +860,27 @@ void FifoManager::UpdateWantDeterminism(bool want)
     m_use_deterministic_gpu_thread = gpu_thread;
     if (gpu_thread)
     {
+      if (m_use_decode_thread)
+      {
+        // Whatever the decode thread has read ahead of the video thread is read again.
+        m_video_buffer_read_ptr = m_video_buffer_executed_ptr;
+        m_decoded_commands.Reset();
+        m_decoded_commands_idle = 0;
+        m_decode_pending_bytes.store(0);
+      }
       // These haven't been updated in non-deterministic mode.
       m_video_buffer_seen_ptr = m_video_buffer_pp_read_ptr = m_video_buffer_read_ptr;
+      // The decode thread only ever appends to the aux FIFO.
+      m_fifo_aux_write_ptr = m_fifo_aux_read_ptr = m_fifo_aux_data;
+      CopyPreprocessCPStateFromMain();
+      VertexLoaderManager::MarkAllDirty();
+    }
+    else if (m_use_decode_thread)
+    {
+      // The decode thread tracks the vertex formats in the preprocess CP state.
       CopyPreprocessCPStateFromMain();
       VertexLoaderManager::MarkAllDirty();
+      m_video_buffer_executed_ptr = m_video_buffer_read_ptr;
     }
   }
 }
@@ -545,9 +895,13 @@ int FifoManager::WaitForGpuThread(int ticks)
   int old = m_sync_ticks.fetch_add(ticks);
   int now = old + ticks;
 
-  // GPU is idle, so stop polling.
-  if (old >= 0 && m_gpu_mainloop.IsDone())
+  // GPU is idle, so stop polling. With the decode thread, the video thread only runs out of work
+  // after the decode thread, and decoded commands only count once they have been executed.
+  if (old >= 0 && GetFifoReadLoop().IsDone() &&
+      (!UseDecodeThread() || (m_gpu_mainloop.IsDone() && m_decoded_commands.IsEmpty())))
+  {
     return -1;
+  }
 
   // Wakeup GPU
   if (old < m_config_sync_gpu_min_distance && now >= m_config_sync_gpu_min_distance)
@@ -6,6 +6,8 @@
 #include <atomic>
 #include <cstddef>
 #include <optional>
+#include <span>
+#include <vector>
 
 #include "Common/BlockingLoop.h"
 #include "Common/CommonTypes.h"
@@ -23,6 +25,10 @@ namespace CoreTiming
 {
 struct EventType;
 }
+namespace OpcodeDecoder
+{
+struct DecodedCommand;
+}
 
 namespace Fifo
 {
@@ -38,6 +44,50 @@ enum class SyncGPUReason
   AuxSpace,
 };
 
+// Passes commands from the decode thread to the video thread. See FifoManager::ProcessFifo.
+//
+// The decode thread follows every chunk of the FIFO it has decoded with a FifoProgress command.
+// Only the video thread acts on those, once it has executed the commands before them, so the FIFO
+// state the CPU sees (the read pointer, breakpoints, interrupts and SyncGPU ticks) moves in the
+// same steps no matter how far ahead the decode thread is.
+class DecodedCommandQueue
+{
+public:
+  static constexpr size_t SIZE = 0x10000;
+  static constexpr size_t MAX_COMMANDS_PER_RUN = 1024;
+
+  DecodedCommandQueue();
+  ~DecodedCommandQueue();
+
+  void Init(bool enabled);
+  void Reset();
+
+  // Used by the decode thread.
+  bool IsFull() const;
+  void Push(const OpcodeDecoder::DecodedCommand& command);
+  // Makes the pushed commands visible to the video thread.
+  void Publish();
+  // Whether the video thread has run every pushed command.
+  bool IsDrained() const;
+  size_t GetPushedCount() const { return m_write; }
+
+  // Used by the video thread. Returns the next published commands, up to and including the first
+  // FifoProgress or Idle command, which the video thread has to act on before running any more.
+  std::span<const OpcodeDecoder::DecodedCommand> GetNextRun() const;
+  void Pop(size_t count);
+
+  // Whether every published command has been run.
+  bool IsEmpty() const;
+
+private:
+  // The write index is only used by the decode thread, and the other two indices are how the
+  // threads tell each other about their progress.
+  std::vector<OpcodeDecoder::DecodedCommand> m_commands;
+  size_t m_write = 0;
+  std::atomic<size_t> m_end = 0;
+  std::atomic<size_t> m_read = 0;
+};
+
 class FifoManager final
 {
 public:
@@ -56,6 +106,7 @@ public:
   void UpdateWantDeterminism(bool want);
   bool UseDeterministicGPUThread() const { return m_use_deterministic_gpu_thread; }
   bool UseSyncGPU() const { return m_config_sync_gpu; }
+  bool UseDecodeThread() const { return m_use_decode_thread && !m_use_deterministic_gpu_thread; }
 
   // In deterministic GPU thread mode this waits for the GPU to be done with pending work.
   void SyncGPU(SyncGPUReason reason, bool may_move_read_ptr = true);
@@ -64,9 +115,13 @@ public:
   // In dual core mode, this synchronizes with the GPU thread.
   void SyncGPUForRegisterAccess();
 
-  void PushFifoAuxBuffer(const void* ptr, size_t size);
+  // Returns the copy in the aux buffer, or nullptr if the GPU is shutting down.
+  void* PushFifoAuxBuffer(const void* ptr, size_t size);
   void* PopFifoAuxBuffer(size_t size);
 
+  // Called by the decode thread. The commands are passed on to the video thread in batches.
+  void PushDecodedCommand(const OpcodeDecoder::DecodedCommand& command);
+
   void FlushGpu();
   void RunGpu();
   void GpuMaySleep();
@@ -79,6 +134,14 @@ private:
   void RefreshConfig();
   void ReadDataFromFifo(u32 read_ptr);
   void ReadDataFromFifoOnCPU(u32 read_ptr);
+  void RunDecodeLoop();
+  void ProcessFifo();
+  void PublishDecodedCommands();
+  bool DrainDecodedCommands();
+  void RunDecodedCommands();
+  void OnFifoProgress(const OpcodeDecoder::DecodedCommand& command);
+  void SkipSyncTicksIfIdle();
+  Common::BlockingLoop& GetFifoReadLoop();
   int RunGpuOnCpu(int ticks);
   int WaitForGpuThread(int ticks);
   static void SyncGPUCallback(Core::System& system, u64 ticks, s64 cyclesLate);
@@ -98,6 +161,25 @@ private:
   // and can change at runtime.
   bool m_use_deterministic_gpu_thread = false;
 
+  // With the decode thread, dual core mode is split into three stages: the CPU thread writes the
+  // FIFO, the decode thread reads and parses it, and the video thread executes the parsed commands.
+  // The deterministic GPU thread mode takes precedence over this.
+  // The decode thread keeps its own read pointer, and counts the FIFO bytes it has read which the
+  // video thread hasn't executed yet. The CP registers follow the video thread.
+  // Display lists are copied to the aux FIFO, which is reset along with the video buffer once the
+  // video thread has caught up.
+  bool m_use_decode_thread = false;
+  Common::BlockingLoop m_decode_loop;
+  DecodedCommandQueue m_decoded_commands;
+  size_t m_decoded_commands_idle = 0;
+  u32 m_decode_read_pointer = 0;
+  std::atomic<u32> m_decode_pending_bytes = 0;
+  // How far the video thread has executed the video buffer, and the end of the FIFO data read up
+  // to that point, which is what a savestate stores.
+  u8* m_video_buffer_executed_ptr = nullptr;
+  u8* m_video_buffer_executed_write_ptr = nullptr;
+  std::atomic<bool> m_draining_decoded_commands = false;
+
   CoreTiming::EventType* m_event_sync_gpu = nullptr;
 
   // STATE_TO_SAVE
@@ -127,6 +209,7 @@ private:
   int m_config_sync_gpu_max_distance = 0;
   int m_config_sync_gpu_min_distance = 0;
   float m_config_sync_gpu_overclock = 0.0f;
+  bool m_config_decode_thread = false;
 
   Core::System& m_system;
 };
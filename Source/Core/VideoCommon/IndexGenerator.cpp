@@ -12,9 +12,158 @@
 #include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/VideoConfig.h"
 
+#if defined(_M_X86) || defined(_M_X86_64)
+#define USE_SSE
+#elif defined(_M_ARM_64)
+#define USE_NEON
+#else
+#define NO_SIMD
+#endif
+
+#if defined(USE_SSE)
+#include <emmintrin.h>
+#elif defined(USE_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace
 {
 constexpr u16 s_primitive_restart = UINT16_MAX;
+// Marks an index in a pattern which always refers to the first vertex of the primitive
+constexpr u16 s_first_vertex = UINT16_MAX - 1;
+
+// A sequence of indices which repeats every vertex_step vertices, such as the triangles of 4 quads.
+// The offsets are relative to the first vertex of each repetition, except for s_first_vertex and
+// s_primitive_restart.
+template <size_t N>
+struct IndexPattern
+{
+  static_assert(N % 8 == 0, "Patterns are written 8 indices at a time");
+
+  constexpr IndexPattern(const std::array<u16, N>& pattern, u16 vertex_step_)
+      : vertex_step(vertex_step_)
+  {
+    for (size_t i = 0; i < N; i++)
+    {
+      const bool fixed = pattern[i] == s_first_vertex || pattern[i] == s_primitive_restart;
+      offsets[i] = fixed ? 0 : pattern[i];
+      steps[i] = fixed ? 0 : vertex_step_;
+      restart[i] = pattern[i] == s_primitive_restart ? UINT16_MAX : 0;
+    }
+  }
+
+  std::array<u16, N> offsets{};
+  std::array<u16, N> steps{};
+  std::array<u16, N> restart{};
+  u32 vertex_step;
+};
+
+// Writes num_repeats repetitions of the pattern, starting at vertex index. All arithmetic wraps
+// around at 16 bits, which matches storing the u32 index as u16.
+template <size_t N>
+u16* WritePattern(u16* index_ptr, u32 index, u32 num_repeats, const IndexPattern<N>& pattern)
+{
+#if defined(USE_SSE)
+  constexpr size_t num_vectors = N / 8;
+  const __m128i first = _mm_set1_epi16(static_cast<s16>(index));
+  __m128i next[num_vectors], steps[num_vectors], restart[num_vectors];
+  for (size_t i = 0; i < num_vectors; i++)
+  {
+    const auto load = [i](const std::array<u16, N>& lanes) {
+      return _mm_loadu_si128(reinterpret_cast<const __m128i*>(&lanes[i * 8]));
+    };
+    next[i] = _mm_add_epi16(first, load(pattern.offsets));
+    steps[i] = load(pattern.steps);
+    restart[i] = load(pattern.restart);
+  }
+  for (u32 repeat = 0; repeat < num_repeats; repeat++)
+  {
+    for (size_t i = 0; i < num_vectors; i++)
+    {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(index_ptr), _mm_or_si128(next[i], restart[i]));
+      next[i] = _mm_add_epi16(next[i], steps[i]);
+      index_ptr += 8;
+    }
+  }
+#elif defined(USE_NEON)
+  constexpr size_t num_vectors = N / 8;
+  const uint16x8_t first = vdupq_n_u16(static_cast<u16>(index));
+  uint16x8_t next[num_vectors], steps[num_vectors], restart[num_vectors];
+  for (size_t i = 0; i < num_vectors; i++)
+  {
+    next[i] = vaddq_u16(first, vld1q_u16(&pattern.offsets[i * 8]));
+    steps[i] = vld1q_u16(&pattern.steps[i * 8]);
+    restart[i] = vld1q_u16(&pattern.restart[i * 8]);
+  }
+  for (u32 repeat = 0; repeat < num_repeats; repeat++)
+  {
+    for (size_t i = 0; i < num_vectors; i++)
+    {
+      vst1q_u16(index_ptr, vorrq_u16(next[i], restart[i]));
+      next[i] = vaddq_u16(next[i], steps[i]);
+      index_ptr += 8;
+    }
+  }
+#else
+  for (u32 repeat = 0; repeat < num_repeats; repeat++)
+  {
+    const u32 base = index + repeat * pattern.vertex_step;
+    for (size_t i = 0; i < N; i++)
+    {
+      if (pattern.restart[i])
+        *index_ptr++ = s_primitive_restart;
+      else
+        *index_ptr++ = static_cast<u16>((pattern.steps[i] ? base : index) + pattern.offsets[i]);
+    }
+  }
+#endif
+  return index_ptr;
+}
+
+template <bool pr, size_t N, size_t M>
+constexpr const auto& SelectPattern(const IndexPattern<N>& pattern,
+                                    const IndexPattern<M>& pattern_pr)
+{
+  if constexpr (pr)
+    return pattern_pr;
+  else
+    return pattern;
+}
+
+constexpr u16 R = s_primitive_restart;
+constexpr u16 F = s_first_vertex;
+
+// 8 triangles
+constexpr IndexPattern<24> s_list_pattern({0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11,
+                                           12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23},
+                                          24);
+constexpr IndexPattern<32> s_list_pattern_pr({0,  1,  2,  R, 3,  4,  5,  R, 6,  7,  8,
+                                              R,  9,  10, 11, R, 12, 13, 14, R, 15, 16,
+                                              17, R,  18, 19, 20, R, 21, 22, 23, R},
+                                             24);
+// 8 triangles
+constexpr IndexPattern<24> s_strip_pattern({0, 1, 2, 1, 3, 2, 2, 3, 4, 3, 5, 4,
+                                            4, 5, 6, 5, 7, 6, 6, 7, 8, 7, 9, 8},
+                                           8);
+constexpr IndexPattern<8> s_strip_pattern_pr({0, 1, 2, 3, 4, 5, 6, 7}, 8);
+// 8 triangles, starting at the second vertex
+constexpr IndexPattern<24> s_fan_pattern({F, 1, 2, F, 2, 3, F, 3, 4, F, 4, 5,
+                                          F, 5, 6, F, 6, 7, F, 7, 8, F, 8, 9},
+                                         8);
+// 4 groups of 3 triangles, starting at the second vertex
+constexpr IndexPattern<24> s_fan_pattern_pr({1, 2, F, 3, 4,  R, 4,  5,  F, 6,  7,  R,
+                                             7, 8, F, 9, 10, R, 10, 11, F, 12, 13, R},
+                                            12);
+// 4 quads
+constexpr IndexPattern<24> s_quad_pattern({0, 1,  2,  0, 2,  3,  4,  5,  6,  4,  6,  7,
+                                           8, 9,  10, 8, 10, 11, 12, 13, 14, 12, 14, 15},
+                                          16);
+// 8 quads
+constexpr IndexPattern<40> s_quad_pattern_pr({1,  2,  0,  3,  R, 5,  6,  4,  7,  R,
+                                              9,  10, 8,  11, R, 13, 14, 12, 15, R,
+                                              17, 18, 16, 19, R, 21, 22, 20, 23, R,
+                                              25, 26, 24, 27, R, 29, 30, 28, 31, R},
+                                             32);
 
 template <bool pr>
 u16* WriteTriangle(u16* index_ptr, u32 index1, u32 index2, u32 index3)
@@ -30,7 +179,11 @@ u16* WriteTriangle(u16* index_ptr, u32 index1, u32 index2, u32 index3)
 template <bool pr>
 u16* AddList(u16* index_ptr, u32 num_verts, u32 index)
 {
-  for (u32 i = 2; i < num_verts; i += 3)
+  const auto& pattern = SelectPattern<pr>(s_list_pattern, s_list_pattern_pr);
+  const u32 repeats = num_verts / pattern.vertex_step;
+  index_ptr = WritePattern(index_ptr, index, repeats, pattern);
+
+  for (u32 i = repeats * pattern.vertex_step + 2; i < num_verts; i += 3)
   {
     index_ptr = WriteTriangle<pr>(index_ptr, index + i - 2, index + i - 1, index + i);
   }
@@ -42,7 +195,13 @@ u16* AddStrip(u16* index_ptr, u32 num_verts, u32 index)
 {
   if constexpr (pr)
   {
-    for (u32 i = 0; i < num_verts; ++i)
+    // A strip without any triangles would only waste indices.
+    if (num_verts < 3)
+      return index_ptr;
+
+    const u32 repeats = num_verts / s_strip_pattern_pr.vertex_step;
+    index_ptr = WritePattern(index_ptr, index, repeats, s_strip_pattern_pr);
+    for (u32 i = repeats * s_strip_pattern_pr.vertex_step; i < num_verts; ++i)
     {
       *index_ptr++ = index + i;
     }
@@ -50,8 +209,12 @@ u16* AddStrip(u16* index_ptr, u32 num_verts, u32 index)
   }
   else
   {
+    // The pattern covers an even number of triangles, so the winding order is the same after it.
+    const u32 repeats = num_verts > 2 ? (num_verts - 2) / s_strip_pattern.vertex_step : 0;
+    index_ptr = WritePattern(index_ptr, index, repeats, s_strip_pattern);
+
     bool wind = false;
-    for (u32 i = 2; i < num_verts; ++i)
+    for (u32 i = repeats * s_strip_pattern.vertex_step + 2; i < num_verts; ++i)
     {
       index_ptr = WriteTriangle<pr>(index_ptr, index + i - 2, index + i - !wind, index + i - wind);
 
@@ -87,6 +250,10 @@ u16* AddFan(u16* index_ptr, u32 num_verts, u32 index)
 
   if constexpr (pr)
   {
+    const u32 repeats = num_verts > 2 ? (num_verts - 2) / s_fan_pattern_pr.vertex_step : 0;
+    index_ptr = WritePattern(index_ptr, index, repeats, s_fan_pattern_pr);
+    i += repeats * s_fan_pattern_pr.vertex_step;
+
     for (; i + 3 <= num_verts; i += 3)
     {
       *index_ptr++ = index + i - 1;
@@ -106,6 +273,12 @@ u16* AddFan(u16* index_ptr, u32 num_verts, u32 index)
       *index_ptr++ = s_primitive_restart;
     }
   }
+  else
+  {
+    const u32 repeats = num_verts > 2 ? (num_verts - 2) / s_fan_pattern.vertex_step : 0;
+    index_ptr = WritePattern(index_ptr, index, repeats, s_fan_pattern);
+    i += repeats * s_fan_pattern.vertex_step;
+  }
 
   for (; i < num_verts; ++i)
   {
@@ -134,7 +307,11 @@ u16* AddFan(u16* index_ptr, u32 num_verts, u32 index)
 template <bool pr>
 u16* AddQuads(u16* index_ptr, u32 num_verts, u32 index)
 {
-  u32 i = 3;
+  const auto& pattern = SelectPattern<pr>(s_quad_pattern, s_quad_pattern_pr);
+  const u32 repeats = num_verts / pattern.vertex_step;
+  index_ptr = WritePattern(index_ptr, index, repeats, pattern);
+
+  u32 i = repeats * pattern.vertex_step + 3;
   for (; i < num_verts; i += 4)
   {
     if constexpr (pr)
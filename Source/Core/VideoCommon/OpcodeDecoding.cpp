@@ -14,8 +14,12 @@
 
 #include "VideoCommon/OpcodeDecoding.h"
 
+#include <array>
+#include <type_traits>
+
 #include "Common/Assert.h"
 #include "Common/Logging/Log.h"
+#include "Common/MsgHandler.h"
 #include "Core/FifoPlayer/FifoRecorder.h"
 #include "Core/HW/Memmap.h"
 #include "Core/System.h"
@@ -23,10 +27,13 @@
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/DataReader.h"
+#include "VideoCommon/DisplayListCache.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderBase.h"
 #include "VideoCommon/VertexLoaderManager.h"
+#include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/VideoThreadTimings.h"
 #include "VideoCommon/XFMemory.h"
 #include "VideoCommon/XFStateManager.h"
 #include "VideoCommon/XFStructs.h"
@@ -35,16 +42,26 @@ namespace OpcodeDecoder
 {
 bool g_record_fifo_data = false;
 
+// Preprocessing runs on the CPU thread, so it isn't part of the video thread timings.
+struct NoTimingScope
+{
+  explicit NoTimingScope(VideoThreadTimings::Category) {}
+};
+template <bool is_preprocess>
+using TimingScope = std::conditional_t<is_preprocess, NoTimingScope, VideoThreadTimings::Scope>;
+
 template <bool is_preprocess>
 class RunCallback final : public Callback
 {
 public:
   OPCODE_CALLBACK(void OnXF(u16 address, u8 count, const u8* data))
   {
+    const TimingScope<is_preprocess> timing_scope(VideoThreadTimings::Category::Registers);
     m_cycles += 18 + 6 * count;
 
     if constexpr (!is_preprocess)
     {
+      FlushPrimitiveBatch();
       LoadXFReg(address, count, data);
 
       INCSTAT(g_stats.this_frame.num_xf_loads);
@@ -52,10 +69,12 @@ public:
   }
   OPCODE_CALLBACK(void OnCP(u8 command, u32 value))
   {
+    const TimingScope<is_preprocess> timing_scope(VideoThreadTimings::Category::Registers);
     m_cycles += 12;
     const u8 sub_command = command & CP_COMMAND_MASK;
     if constexpr (!is_preprocess)
     {
+      FlushPrimitiveBatch();
       if (sub_command == MATINDEX_A)
       {
         VertexLoaderManager::g_needs_cp_xf_consistency_check = true;
@@ -103,6 +122,7 @@ public:
   }
   OPCODE_CALLBACK(void OnBP(u8 command, u32 value))
   {
+    const TimingScope<is_preprocess> timing_scope(VideoThreadTimings::Category::Registers);
     m_cycles += 12;
 
     if constexpr (is_preprocess)
@@ -111,32 +131,46 @@ public:
     }
     else
     {
+      FlushPrimitiveBatch();
       LoadBPReg(command, value, m_cycles);
       INCSTAT(g_stats.this_frame.num_bp_loads);
     }
   }
   OPCODE_CALLBACK(void OnIndexedLoad(CPArray array, u32 index, u16 address, u8 size))
   {
+    const TimingScope<is_preprocess> timing_scope(VideoThreadTimings::Category::Registers);
     m_cycles += 6;
 
     if constexpr (is_preprocess)
+    {
       PreprocessIndexedXF(array, index, address, size);
+    }
     else
+    {
+      FlushPrimitiveBatch();
       LoadIndexedXF(array, index, address, size);
+    }
   }
   OPCODE_CALLBACK(void OnPrimitiveCommand(OpcodeDecoder::Primitive primitive, u8 vat,
                                           u32 vertex_size, u16 num_vertices, const u8* vertex_data))
   {
+    const TimingScope<is_preprocess> timing_scope(VideoThreadTimings::Category::VertexLoading);
     // load vertices
     const u32 size = vertex_size * num_vertices;
 
+    // 4 GPU ticks per vertex, 3 CPU ticks per GPU tick
+    m_cycles += num_vertices * 4 * 3 + 6;
+
+    if constexpr (!is_preprocess)
+    {
+      if (TryBatchPrimitive(primitive, vat, vertex_size, num_vertices, vertex_data))
+        return;
+    }
+
     const u32 bytes =
         VertexLoaderManager::RunVertices<is_preprocess>(vat, primitive, num_vertices, vertex_data);
 
     ASSERT(bytes == size);
-
-    // 4 GPU ticks per vertex, 3 CPU ticks per GPU tick
-    m_cycles += num_vertices * 4 * 3 + 6;
   }
   // This can't be inlined since it calls Run, which makes it recursive
   // m_in_display_list prevents it from actually recursing infinitely, but there's no real benefit
@@ -145,6 +179,9 @@ public:
   {
     m_cycles += 6;
 
+    if constexpr (!is_preprocess)
+      FlushPrimitiveBatch();
+
     if (m_in_display_list)
     {
       WARN_LOG_FMT(VIDEO, "recursive display list detected");
@@ -188,7 +225,13 @@ public:
           // temporarily swap dl and non-dl (small "hack" for the stats)
           g_stats.SwapDL();
 
-          Run(start_address, size, *this);
+          if (g_ActiveConfig.bDisplayListCache && size != 0)
+            RunCachedDisplayList(address, start_address, size);
+          else
+            Run(start_address, size, *this);
+
+          // The display list's memory may not stay valid after returning
+          FlushPrimitiveBatch();
           INCSTAT(g_stats.this_frame.num_dlists_called);
 
           // un-swap
@@ -219,6 +262,8 @@ public:
     }
     else
     {
+      if constexpr (!is_preprocess)
+        FlushPrimitiveBatch();
       auto& system = Core::System::GetInstance();
       system.GetCommandProcessor().HandleUnknownOpcode(opcode, data, is_preprocess);
       m_cycles += 1;
@@ -253,16 +298,104 @@ public:
     return loader->m_vertex_size;
   }
 
+  // Loads the primitive commands which were held back by TryBatchPrimitive.
+  // Must be called before any command which could change the vertex loading state.
+  void FlushPrimitiveBatch()
+  {
+    if (m_batch_size == 0)
+      return;
+
+    const TimingScope<is_preprocess> timing_scope(VideoThreadTimings::Category::VertexLoading);
+    VertexLoaderManager::RunVerticesBatched(m_batch_vat, m_batch_primitive,
+                                            {m_batch.data(), m_batch_size});
+    m_batch_size = 0;
+  }
+
+  // The decode thread flattens display lists into the decoded commands, so these take the place of
+  // OnDisplayList around them.
+  void OnDecodedDisplayList()
+  {
+    m_cycles += 6;
+    FlushPrimitiveBatch();
+    g_stats.SwapDL();
+  }
+  void OnDecodedDisplayListEnd()
+  {
+    FlushPrimitiveBatch();
+    INCSTAT(g_stats.this_frame.num_dlists_called);
+    g_stats.SwapDL();
+  }
+
   u32 m_cycles = 0;
   bool m_in_display_list = false;
+
+private:
+  // Consecutive primitive commands of the same type and VAT, with no other commands in between,
+  // share their vertex loading state. Collect them so that they can be loaded in one go.
+  bool TryBatchPrimitive(OpcodeDecoder::Primitive primitive, u8 vat, u32 vertex_size,
+                         u16 num_vertices, const u8* vertex_data)
+  {
+    const bool batchable = VertexLoaderManager::CanBatchPrimitive(primitive, num_vertices);
+
+    if (m_batch_size != 0)
+    {
+      const VertexLoaderManager::PrimitiveRun& last = m_batch[m_batch_size - 1];
+      if (batchable && primitive == m_batch_primitive && vat == m_batch_vat &&
+          vertex_size == m_batch_vertex_size && m_batch_size < m_batch.size() &&
+          vertex_data == last.src + last.count * vertex_size + 3 &&
+          m_batch_vertex_count + num_vertices <= 0xFFFF)
+      {
+        m_batch[m_batch_size++] = {vertex_data, num_vertices};
+        m_batch_vertex_count += num_vertices;
+        return true;
+      }
+      FlushPrimitiveBatch();
+    }
+
+    if (!batchable)
+      return false;
+
+    m_batch_primitive = primitive;
+    m_batch_vat = vat;
+    m_batch_vertex_size = vertex_size;
+    m_batch_vertex_count = num_vertices;
+    m_batch[0] = {vertex_data, num_vertices};
+    m_batch_size = 1;
+    return true;
+  }
+
+  std::array<VertexLoaderManager::PrimitiveRun, VertexLoaderManager::MAX_PRIMITIVE_BATCH_SIZE>
+      m_batch;
+  size_t m_batch_size = 0;
+  u32 m_batch_vertex_count = 0;
+  u32 m_batch_vertex_size = 0;
+  OpcodeDecoder::Primitive m_batch_primitive{};
+  u8 m_batch_vat = 0;
+
+  void RunCachedDisplayList(u32 address, const u8* data, u32 size)
+  {
+    if (const auto* display_list = g_display_list_cache.Find(address, size))
+    {
+      if (!DisplayListCache::Replay(*display_list, data, *this))
+        g_display_list_cache.Erase(address);
+      return;
+    }
+
+    DisplayListCache::DisplayList display_list;
+    if (DisplayListCache::Record(data, size, *this, &display_list))
+      g_display_list_cache.Insert(address, std::move(display_list));
+  }
 };
 
 template <bool is_preprocess>
 u8* RunFifo(DataReader src, u32* cycles)
 {
+  const TimingScope<is_preprocess> timing_scope(VideoThreadTimings::Category::OpcodeDecoding);
   using CallbackT = RunCallback<is_preprocess>;
   auto callback = CallbackT{};
   u32 size = Run(src.GetPointer(), static_cast<u32>(src.size()), callback);
+  if constexpr (!is_preprocess)
+    callback.FlushPrimitiveBatch();
 
   if (cycles != nullptr)
     *cycles = callback.m_cycles;
@@ -274,4 +407,216 @@ u8* RunFifo(DataReader src, u32* cycles)
 template u8* RunFifo<true>(DataReader src, u32* cycles);
 template u8* RunFifo<false>(DataReader src, u32* cycles);
 
+// Runs on the decode thread. It parses the commands and tracks the vertex formats in the preprocess
+// CP state, but leaves everything else to the video thread.
+class DecodeCallback final : public Callback
+{
+public:
+  explicit DecodeCallback(Fifo::FifoManager& fifo) : m_fifo(fifo) {}
+
+  OPCODE_CALLBACK(void OnXF(u16 address, u8 count, const u8* data))
+  {
+    m_cycles += 18 + 6 * count;
+    SetPending(DecodedCommand::Type::XF, 0, address, count);
+  }
+  OPCODE_CALLBACK(void OnCP(u8 command, u32 value))
+  {
+    m_cycles += 12;
+    const u8 sub_command = command & CP_COMMAND_MASK;
+    if (sub_command == VCD_LO || sub_command == VCD_HI)
+    {
+      VertexLoaderManager::g_preprocess_vat_dirty = BitSet8::AllTrue(CP_NUM_VAT_REG);
+    }
+    else if (sub_command == CP_VAT_REG_A || sub_command == CP_VAT_REG_B ||
+             sub_command == CP_VAT_REG_C)
+    {
+      VertexLoaderManager::g_preprocess_vat_dirty[command & CP_VAT_MASK] = true;
+    }
+    GetCPState().LoadCPReg(command, value);
+    SetPending(DecodedCommand::Type::CP, value, 0, command);
+  }
+  OPCODE_CALLBACK(void OnBP(u8 command, u32 value))
+  {
+    m_cycles += 12;
+    SetPending(DecodedCommand::Type::BP, value, 0, command);
+  }
+  OPCODE_CALLBACK(void OnIndexedLoad(CPArray array, u32 index, u16 address, u8 size))
+  {
+    m_cycles += 6;
+    // The raw value is taken from the command itself in OnCommand
+    SetPending(DecodedCommand::Type::IndexedLoad, 0, 0, 0);
+  }
+  OPCODE_CALLBACK(void OnPrimitiveCommand(OpcodeDecoder::Primitive primitive, u8 vat,
+                                          u32 vertex_size, u16 num_vertices, const u8* vertex_data))
+  {
+    m_cycles += num_vertices * 4 * 3 + 6;
+    SetPending(DecodedCommand::Type::Primitive, vertex_size, num_vertices, 0);
+  }
+  OPCODE_CALLBACK_NOINLINE(void OnDisplayList(u32 address, u32 size))
+  {
+    m_cycles += 6;
+
+    if (m_in_display_list)
+    {
+      WARN_LOG_FMT(VIDEO, "recursive display list detected");
+      return;
+    }
+
+    // The display list is copied since the CPU may overwrite it before the video thread gets to it.
+    auto& memory = Core::System::GetInstance().GetMemory();
+    const u8* const start_address = memory.GetPointerForRange(address, size);
+    if (start_address == nullptr)
+      return;
+    const u8* const copy = static_cast<u8*>(m_fifo.PushFifoAuxBuffer(start_address, size));
+    if (copy == nullptr)
+      return;
+
+    m_in_display_list = true;
+    m_fifo.PushDecodedCommand({nullptr, 0, 0, 0, DecodedCommand::Type::DisplayList, 0});
+    Run(copy, size, *this);
+    m_fifo.PushDecodedCommand({nullptr, 0, 0, 0, DecodedCommand::Type::DisplayListEnd, 0});
+    m_in_display_list = false;
+  }
+  OPCODE_CALLBACK(void OnNop(u32 count))
+  {
+    m_cycles += 6 * count;
+    SetPending(DecodedCommand::Type::Nop, 0, 0, 0);
+  }
+  OPCODE_CALLBACK(void OnUnknown(u8 opcode, const u8* data))
+  {
+    if (static_cast<Opcode>(opcode) == Opcode::GX_CMD_UNKNOWN_METRICS ||
+        static_cast<Opcode>(opcode) == Opcode::GX_CMD_INVL_VC)
+    {
+      m_cycles += 6;
+    }
+    else
+    {
+      m_cycles += 1;
+    }
+    SetPending(DecodedCommand::Type::Unknown, 0, 0, opcode);
+  }
+
+  OPCODE_CALLBACK(void OnCommand(const u8* data, u32 size))
+  {
+    if (!m_has_pending)
+      return;
+
+    m_pending.data = data;
+    m_pending.size = size;
+    if (m_pending.type == DecodedCommand::Type::IndexedLoad)
+    {
+      m_pending.arg = data[0];
+      m_pending.value = Common::swap32(&data[1]);
+    }
+    else if (m_pending.type == DecodedCommand::Type::Primitive)
+    {
+      m_pending.arg = data[0];
+    }
+    m_fifo.PushDecodedCommand(m_pending);
+    m_has_pending = false;
+  }
+
+  OPCODE_CALLBACK(CPState& GetCPState()) { return g_preprocess_cp_state; }
+
+  OPCODE_CALLBACK(u32 GetVertexSize(u8 vat))
+  {
+    VertexLoaderBase* loader = VertexLoaderManager::RefreshLoader<true>(vat);
+    return loader->m_vertex_size;
+  }
+
+  u32 m_cycles = 0;
+
+private:
+  void SetPending(DecodedCommand::Type type, u32 value, u16 address, u8 arg)
+  {
+    m_pending = {nullptr, 0, value, address, type, arg};
+    m_has_pending = true;
+  }
+
+  Fifo::FifoManager& m_fifo;
+  DecodedCommand m_pending{};
+  bool m_has_pending = false;
+  bool m_in_display_list = false;
+};
+
+u8* DecodeFifo(DataReader src, u32* cycles)
+{
+  auto callback = DecodeCallback{Core::System::GetInstance().GetFifo()};
+  const u32 size = Run(src.GetPointer(), static_cast<u32>(src.size()), callback);
+
+  if (cycles != nullptr)
+    *cycles = callback.m_cycles;
+
+  src.Skip(size);
+  return src.GetPointer();
+}
+
+void RunDecodedCommands(std::span<const DecodedCommand> commands)
+{
+  const TimingScope<false> timing_scope(VideoThreadTimings::Category::OpcodeDecoding);
+  auto callback = RunCallback<false>{};
+  for (const DecodedCommand& command : commands)
+  {
+    switch (command.type)
+    {
+    case DecodedCommand::Type::Nop:
+      callback.OnNop(command.size);
+      break;
+    case DecodedCommand::Type::XF:
+      callback.OnXF(command.address, command.arg, &command.data[5]);
+      break;
+    case DecodedCommand::Type::CP:
+      callback.OnCP(command.arg, command.value);
+      break;
+    case DecodedCommand::Type::BP:
+      callback.OnBP(command.arg, command.value);
+      break;
+    case DecodedCommand::Type::IndexedLoad:
+    {
+      const u32 value = command.value;
+      const auto ref_array = static_cast<CPArray>((command.arg / 8) + 8);
+      callback.OnIndexedLoad(ref_array, value >> 16, value & 0xFFF, ((value >> 12) & 0xF) + 1);
+      break;
+    }
+    case DecodedCommand::Type::Primitive:
+    {
+      const u8 vat = command.arg & GX_VAT_MASK;
+      // The decode thread went through the same CP writes, so the vertex formats have to agree.
+      // If they don't, the decode thread split the FIFO with the wrong vertex size, so neither
+      // this primitive nor the commands after it can be recovered from the decoded data.
+      const u32 vertex_size = callback.GetVertexSize(vat);
+      if (vertex_size != command.value) [[unlikely]]
+      {
+        PanicAlertFmt("GPU decode thread used a vertex size of {} for VAT {}, but the video "
+                      "thread has {}. The primitive was skipped. Disable the GPU decode thread "
+                      "for this game.",
+                      command.value, vat, vertex_size);
+        break;
+      }
+      const auto primitive =
+          static_cast<Primitive>((command.arg & GX_PRIMITIVE_MASK) >> GX_PRIMITIVE_SHIFT);
+      callback.OnPrimitiveCommand(primitive, vat, command.value, command.address,
+                                  &command.data[3]);
+      break;
+    }
+    case DecodedCommand::Type::Unknown:
+      callback.OnUnknown(command.arg, command.data);
+      break;
+    case DecodedCommand::Type::DisplayList:
+      callback.OnDecodedDisplayList();
+      continue;
+    case DecodedCommand::Type::DisplayListEnd:
+      callback.OnDecodedDisplayListEnd();
+      continue;
+    case DecodedCommand::Type::Idle:
+    case DecodedCommand::Type::FifoProgress:
+      continue;
+    }
+
+    callback.OnCommand(command.data, command.size);
+  }
+
+  callback.FlushPrimitiveBatch();
+}
+
 }  // namespace OpcodeDecoder
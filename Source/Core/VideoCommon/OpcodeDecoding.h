@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <span>
 #include <type_traits>
 
 #include "Common/Assert.h"
@@ -277,6 +278,50 @@ DOLPHIN_FORCE_INLINE u32 Run(const u8* data, u32 available, T& callback)
 template <bool is_preprocess = false>
 u8* RunFifo(DataReader src, u32* cycles);
 
+// A command which was parsed by the decode thread, so that the video thread only has to execute it.
+// data points into the video buffer or the aux FIFO, which stay untouched until it has been run.
+struct DecodedCommand
+{
+  enum class Type : u8
+  {
+    Nop,
+    XF,
+    CP,
+    BP,
+    IndexedLoad,
+    Primitive,
+    Unknown,
+    // The commands up to the matching DisplayListEnd come from a display list.
+    DisplayList,
+    DisplayListEnd,
+    // The FIFO ran empty, so the video thread should draw whatever it has stored.
+    Idle,
+    // The commands before this complete a chunk of the FIFO. The CP read pointer moves on to value,
+    // and the chunk took size GPU cycles. data points past the chunk in the video buffer, followed
+    // by partial_size bytes of a command which the next chunks complete.
+    FifoProgress,
+  };
+
+  const u8* data;
+  u32 size;
+  // CP/BP value, raw indexed load value or vertex size
+  u32 value;
+  // XF address or vertex count
+  u16 address;
+  Type type;
+  // CP/BP register, XF count, indexed load opcode, primitive opcode or unknown opcode
+  u8 arg;
+  u32 partial_size = 0;
+};
+
+// Parses the commands in src without executing them, and passes them to
+// FifoManager::PushDecodedCommand. Only the preprocess CP state is updated, which is needed to know
+// the vertex sizes. Display lists are copied to the aux FIFO and decoded inline.
+u8* DecodeFifo(DataReader src, u32* cycles);
+
+// Executes commands from DecodeFifo. Idle and FifoProgress commands are left to the caller.
+void RunDecodedCommands(std::span<const DecodedCommand> commands);
+
 }  // namespace OpcodeDecoder
 
 template <>
@@ -3,18 +3,47 @@
 
 #include "VideoCommon/PerformanceMetrics.h"
 
+#include <algorithm>
 #include <mutex>
 
+#include <fmt/format.h>
 #include <imgui.h>
 #include <implot.h>
 
+#include "Common/FileUtil.h"
+#include "Common/HookableEvent.h"
 #include "Core/CoreTiming.h"
 #include "Core/HW/VideoInterface.h"
 #include "Core/System.h"
 #include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/VideoEvents.h"
 
 PerformanceMetrics g_perf_metrics;
 
+static Common::EventHook s_before_present_event = BeforePresentEvent::Register(
+    [](PresentInfo& present_info) {
+      g_perf_metrics.CountLatencyStage(PerformanceMetrics::LatencyStage::Submit,
+                                       present_info.emulated_timestamp);
+    },
+    "PerformanceMetrics::Submit");
+static Common::EventHook s_after_present_event = AfterPresentEvent::Register(
+    [](PresentInfo& present_info) {
+      g_perf_metrics.CountLatencyStage(PerformanceMetrics::LatencyStage::Present,
+                                       present_info.emulated_timestamp);
+    },
+    "PerformanceMetrics::Present");
+
+// The time between two consecutive latency stages
+static constexpr std::array<const char*, PerformanceMetrics::NUM_LATENCY_STAGES - 1>
+    LATENCY_PHASE_NAMES = {"Emulation", "Video queue", "XFB fetch", "Present"};
+static constexpr std::array<const char*, PerformanceMetrics::NUM_LATENCY_STAGES - 1>
+    LATENCY_PHASE_LABELS = {"Emu:", "Queue:", "XFB:", "Present:"};
+
+PerformanceMetrics::~PerformanceMetrics()
+{
+  CloseLatencyLogs();
+}
+
 void PerformanceMetrics::Reset()
 {
   m_fps_counter.Reset();
@@ -24,6 +53,18 @@ void PerformanceMetrics::Reset()
   m_time_sleeping = DT::zero();
   m_real_times.fill(Clock::now());
   m_cpu_times.fill(Core::System::GetInstance().GetCoreTiming().GetCPUTimePoint(0));
+
+  ResetLatency();
+}
+
+void PerformanceMetrics::ResetLatency()
+{
+  m_latency_queue_write.store(0);
+  m_latency_queue_read.store(0);
+  m_last_input_poll = {};
+  m_latency_history_count = 0;
+  m_latency_epoch = Clock::now();
+  CloseLatencyLogs();
 }
 
 void PerformanceMetrics::CountFrame()
@@ -52,6 +93,125 @@ void PerformanceMetrics::CountPerformanceMarker(Core::System& system, s64 cycles
   m_time_index += 1;
 }
 
+void PerformanceMetrics::CountInputPoll()
+{
+  m_last_input_poll = Clock::now();
+}
+
+void PerformanceMetrics::CountFrameOutput(u64 ticks)
+{
+  const TimePoint time = Clock::now();
+  const size_t write = m_latency_queue_write.load(std::memory_order_relaxed);
+  if (write - m_latency_queue_read.load(std::memory_order_acquire) >= LATENCY_QUEUE_SIZE)
+    return;
+
+  FrameLatency& frame = m_latency_queue[write % LATENCY_QUEUE_SIZE];
+  frame.ticks = ticks;
+  frame.times.fill(TimePoint{});
+  frame.times[static_cast<size_t>(LatencyStage::InputPoll)] =
+      m_last_input_poll == TimePoint{} ? time : m_last_input_poll;
+  frame.times[static_cast<size_t>(LatencyStage::FrameOutput)] = time;
+  m_latency_queue_write.store(write + 1, std::memory_order_release);
+}
+
+void PerformanceMetrics::CountLatencyStage(LatencyStage stage, u64 ticks)
+{
+  const TimePoint time = Clock::now();
+  const size_t write = m_latency_queue_write.load(std::memory_order_acquire);
+  const size_t read = m_latency_queue_read.load(std::memory_order_relaxed);
+
+  // Frames are handled in order, so older frames won't get any further. This happens to duplicate
+  // frames which aren't presented.
+  size_t index = read;
+  while (index != write && m_latency_queue[index % LATENCY_QUEUE_SIZE].ticks < ticks)
+    ++index;
+
+  if (index == write || m_latency_queue[index % LATENCY_QUEUE_SIZE].ticks != ticks)
+  {
+    // This frame wasn't output by the CPU thread, e.g. with immediate XFB. If frames keep piling
+    // up, the emulated time went backwards because a state was loaded.
+    if (write - read > LATENCY_QUEUE_SIZE / 2)
+      m_latency_queue_read.store(write, std::memory_order_release);
+    return;
+  }
+
+  FrameLatency& frame = m_latency_queue[index % LATENCY_QUEUE_SIZE];
+  frame.times[static_cast<size_t>(stage)] = time;
+  if (stage == LatencyStage::Present)
+  {
+    FinishFrameLatency(frame);
+    ++index;
+  }
+  m_latency_queue_read.store(index, std::memory_order_release);
+}
+
+void PerformanceMetrics::FinishFrameLatency(const FrameLatency& frame)
+{
+  if (std::ranges::find(frame.times, TimePoint{}) != frame.times.end())
+    return;
+
+  auto& durations = m_latency_history[m_latency_history_count++ % LATENCY_HISTORY_SIZE];
+  for (size_t i = 0; i < durations.size(); ++i)
+    durations[i] = frame.times[i + 1] - frame.times[i];
+
+  LogFrameLatencyToFile(frame);
+}
+
+void PerformanceMetrics::LogFrameLatencyToFile(const FrameLatency& frame)
+{
+  if (!g_ActiveConfig.bLogLatencyToFile)
+    return;
+
+  const std::string& logs_path = File::GetUserPath(D_LOGS_IDX);
+  if (!m_latency_csv_file.is_open())
+  {
+    File::OpenFStream(m_latency_csv_file, logs_path + "frame_latency.csv", std::ios_base::out);
+    m_latency_csv_file
+        << "ticks,input_poll_ms,frame_output_ms,fifo_drain_ms,submit_ms,present_ms\n";
+  }
+  if (!m_latency_trace_file.is_open())
+  {
+    // Chrome's trace event format, which can be opened in chrome://tracing or Perfetto
+    File::OpenFStream(m_latency_trace_file, logs_path + "frame_latency.json", std::ios_base::out);
+    m_latency_trace_file << '[';
+    for (size_t i = 0; i < LATENCY_PHASE_NAMES.size(); ++i)
+    {
+      m_latency_trace_file << fmt::format(
+          "{}\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},"
+          "\"args\":{{\"name\":\"{}\"}}}}",
+          i == 0 ? "" : ",", i + 1, LATENCY_PHASE_NAMES[i]);
+    }
+  }
+
+  const auto since_epoch = [this](TimePoint time) { return time - m_latency_epoch; };
+
+  m_latency_csv_file << frame.ticks;
+  for (const TimePoint& time : frame.times)
+    m_latency_csv_file << fmt::format(",{:.3f}", DT_ms(since_epoch(time)).count());
+  m_latency_csv_file << std::endl;
+
+  for (size_t i = 0; i < LATENCY_PHASE_NAMES.size(); ++i)
+  {
+    m_latency_trace_file << fmt::format(
+        ",\n{{\"name\":\"{}\",\"cat\":\"latency\",\"ph\":\"X\",\"pid\":1,\"tid\":{},"
+        "\"ts\":{:.3f},\"dur\":{:.3f},\"args\":{{\"ticks\":{}}}}}",
+        LATENCY_PHASE_NAMES[i], i + 1, DT_us(since_epoch(frame.times[i])).count(),
+        DT_us(frame.times[i + 1] - frame.times[i]).count(), frame.ticks);
+  }
+  m_latency_trace_file.flush();
+}
+
+void PerformanceMetrics::CloseLatencyLogs()
+{
+  if (m_latency_trace_file.is_open())
+  {
+    m_latency_trace_file << "\n]\n";
+    m_latency_trace_file.close();
+  }
+  if (m_latency_csv_file.is_open())
+    m_latency_csv_file.close();
+}
+
 double PerformanceMetrics::GetFPS() const
 {
   return m_fps_counter.GetHzAvg();
@@ -269,5 +429,47 @@ void PerformanceMetrics::DrawImGuiStats(const float backbuffer_scale)
     }
   }
 
+  if (g_ActiveConfig.bShowLatency)
+  {
+    const size_t count = std::min(m_latency_history_count, LATENCY_HISTORY_SIZE);
+    std::array<DT, NUM_LATENCY_STAGES - 1> average{};
+    DT total{};
+    for (size_t i = 0; i < count; ++i)
+    {
+      for (size_t j = 0; j < average.size(); ++j)
+        average[j] += m_latency_history[i][j];
+    }
+    for (DT& phase : average)
+    {
+      if (count != 0)
+        phase /= static_cast<DT::rep>(count);
+      total += phase;
+    }
+
+    const float latency_window_width = 1.5f * window_width;
+    float window_height = (12.f + 17.f * (average.size() + 1)) * backbuffer_scale;
+
+    // Position in the top-right corner of the screen.
+    ImGui::SetNextWindowPos(ImVec2(window_x, window_y), ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+    ImGui::SetNextWindowSize(ImVec2(latency_window_width, window_height));
+    ImGui::SetNextWindowBgAlpha(bg_alpha);
+
+    if (stack_vertically)
+      window_y += window_height + window_padding;
+    else
+      window_x -= latency_window_width + window_padding;
+
+    if (ImGui::Begin("LatencyStats", nullptr, imgui_flags))
+    {
+      for (size_t i = 0; i < average.size(); ++i)
+      {
+        ImGui::TextColored(ImVec4(r, g, b, 1.0f), "%-8s%6.2lfms", LATENCY_PHASE_LABELS[i],
+                           DT_ms(average[i]).count());
+      }
+      ImGui::TextColored(ImVec4(r, g, b, 1.0f), "%-8s%6.2lfms", "Total:", DT_ms(total).count());
+      ImGui::End();
+    }
+  }
+
   ImGui::PopStyleVar(2);
 }
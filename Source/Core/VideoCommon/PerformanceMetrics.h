@@ -4,6 +4,8 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <fstream>
 #include <shared_mutex>
 
 #include "Common/CommonTypes.h"
@@ -17,8 +19,25 @@ class System;
 class PerformanceMetrics
 {
 public:
+  // The points in time a frame passes on its way from the input it is based on to the screen.
+  enum class LatencyStage
+  {
+    // The last SI poll before the frame was output (CPU thread)
+    InputPoll,
+    // The XFB was output at the end of the field (CPU thread)
+    FrameOutput,
+    // The video thread has caught up with the FIFO data up to the XFB output
+    FifoDrain,
+    // The video thread starts presenting the frame
+    Submit,
+    // The backend has presented the frame
+    Present,
+    Count,
+  };
+  static constexpr size_t NUM_LATENCY_STAGES = static_cast<size_t>(LatencyStage::Count);
+
   PerformanceMetrics() = default;
-  ~PerformanceMetrics() = default;
+  ~PerformanceMetrics();
 
   PerformanceMetrics(const PerformanceMetrics&) = delete;
   PerformanceMetrics& operator=(const PerformanceMetrics&) = delete;
@@ -33,6 +52,17 @@ public:
   void CountThrottleSleep(DT sleep);
   void CountPerformanceMarker(Core::System& system, s64 cyclesLate);
 
+  // Latency Functions
+  // Frames are identified by the emulated time at which the XFB was output.
+  void CountInputPoll();
+  void CountFrameOutput(u64 ticks);
+  void CountLatencyStage(LatencyStage stage, u64 ticks);
+  // Drops the frames in flight and starts new log files. Only call this while the CPU thread isn't
+  // running, e.g. when a state is loaded.
+  void ResetLatency();
+  // Finishes the log files written with Log Latency to File, e.g. when the option is turned off.
+  void CloseLatencyLogs();
+
   // Getter Functions
   double GetFPS() const;
   double GetVPS() const;
@@ -45,6 +75,15 @@ public:
   void DrawImGuiStats(const float backbuffer_scale);
 
 private:
+  struct FrameLatency
+  {
+    u64 ticks = 0;
+    std::array<TimePoint, NUM_LATENCY_STAGES> times{};
+  };
+
+  void FinishFrameLatency(const FrameLatency& frame);
+  void LogFrameLatencyToFile(const FrameLatency& frame);
+
   PerformanceTracker m_fps_counter{"render_times.txt"};
   PerformanceTracker m_vps_counter{"vblank_times.txt"};
   PerformanceTracker m_speed_counter{std::nullopt, 1000000};
@@ -57,6 +96,23 @@ private:
   std::array<TimePoint, 256> m_real_times{};
   std::array<TimePoint, 256> m_cpu_times{};
   DT m_time_sleeping{};
+
+  // Frames which are on their way to the screen. This is a ring buffer which the CPU thread
+  // appends to, and which the video thread fills in and retires in order.
+  static constexpr size_t LATENCY_QUEUE_SIZE = 256;
+  std::array<FrameLatency, LATENCY_QUEUE_SIZE> m_latency_queue{};
+  std::atomic<size_t> m_latency_queue_write = 0;
+  std::atomic<size_t> m_latency_queue_read = 0;
+  TimePoint m_last_input_poll{};
+
+  // Per stage durations of the last presented frames, used by the on-screen breakdown
+  static constexpr size_t LATENCY_HISTORY_SIZE = 64;
+  std::array<std::array<DT, NUM_LATENCY_STAGES - 1>, LATENCY_HISTORY_SIZE> m_latency_history{};
+  size_t m_latency_history_count = 0;
+
+  TimePoint m_latency_epoch{};
+  std::ofstream m_latency_csv_file;
+  std::ofstream m_latency_trace_file;
 };
 
 extern PerformanceMetrics g_perf_metrics;
@@ -28,6 +28,8 @@ static Common::EventHook s_after_frame_event = AfterFrameEvent::Register(
           .speed_ratio = system.GetSystemTimers().GetEstimatedEmulationPerformance(),
           .num_prims = g_stats.this_frame.num_prims + g_stats.this_frame.num_dl_prims,
           .num_draw_calls = g_stats.this_frame.num_draw_calls,
+          .ticks = system.GetSystemTimers().GetTicksSnapshot(),
+          .idle_ticks = system.GetSystemTimers().GetIdleTicksSnapshot(),
       });
     },
     "Statistics::PerformanceSample");
@@ -97,7 +99,22 @@ void Statistics::Display() const
   draw_statistic("shaders changes", "%d", this_frame.num_shader_changes);
   draw_statistic("dlists called", "%d", this_frame.num_dlists_called);
   draw_statistic("Primitive joins", "%d", this_frame.num_primitive_joins);
+  draw_statistic("Batched primitives", "%d", this_frame.num_batched_primitives);
   draw_statistic("Draw calls", "%d", this_frame.num_draw_calls);
+  if (g_ActiveConfig.bCPUCull)
+  {
+    draw_statistic("CPU cull checks", "%d", this_frame.num_cpu_cull_checks);
+    draw_statistic("CPU culled draws", "%d", this_frame.num_cpu_culled_draws);
+    draw_statistic("CPU culled vertices", "%d", this_frame.num_cpu_culled_vertices);
+    draw_statistic("CPU cull bounds rejects", "%d", this_frame.num_cpu_cull_bounds_rejects);
+    draw_statistic("CPU cull large transforms", "%d", this_frame.num_cpu_cull_large_transforms);
+    if (this_frame.num_cpu_cull_large_transform_vertices > 0)
+    {
+      draw_statistic("CPU cull large transform ns/vertex", "%.2f",
+                     this_frame.cpu_cull_large_transform_us * 1000.0 /
+                         this_frame.num_cpu_cull_large_transform_vertices);
+    }
+  }
   draw_statistic("Primitives", "%d", this_frame.num_prims);
   draw_statistic("Primitives (DL)", "%d", this_frame.num_dl_prims);
   draw_statistic("XF loads", "%d", this_frame.num_xf_loads);
@@ -54,8 +54,17 @@ struct Statistics
     int num_shader_changes = 0;
 
     int num_primitive_joins = 0;
+    int num_batched_primitives = 0;
     int num_draw_calls = 0;
 
+    int num_cpu_cull_checks = 0;
+    int num_cpu_cull_bounds_rejects = 0;
+    int num_cpu_culled_draws = 0;
+    int num_cpu_culled_vertices = 0;
+    int num_cpu_cull_large_transforms = 0;
+    int num_cpu_cull_large_transform_vertices = 0;
+    int cpu_cull_large_transform_us = 0;
+
     int num_dlists_called = 0;
 
     int bytes_vertex_streamed = 0;
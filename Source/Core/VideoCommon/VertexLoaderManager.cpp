@@ -375,78 +375,144 @@ static void CheckCPConfiguration(int vtx_attr_group)
   }
 }
 
-template <bool IsPreprocess>
-int RunVertices(int vtx_attr_group, OpcodeDecoder::Primitive primitive, int count, const u8* src)
+u32 GetListPrimitiveSize(OpcodeDecoder::Primitive primitive)
 {
-  if (count == 0) [[unlikely]]
+  switch (primitive)
+  {
+  case OpcodeDecoder::Primitive::GX_DRAW_QUADS:
+  case OpcodeDecoder::Primitive::GX_DRAW_QUADS_2:
+    return 4;
+  case OpcodeDecoder::Primitive::GX_DRAW_TRIANGLES:
+    return 3;
+  case OpcodeDecoder::Primitive::GX_DRAW_LINES:
+    return 2;
+  case OpcodeDecoder::Primitive::GX_DRAW_POINTS:
+    return 1;
+  default:
     return 0;
-  ASSERT(count > 0);
+  }
+}
 
-  VertexLoaderBase* loader = RefreshLoader<IsPreprocess>(vtx_attr_group);
+bool CanBatchPrimitive(OpcodeDecoder::Primitive primitive, u32 num_vertices)
+{
+  const u32 list_size = GetListPrimitiveSize(primitive);
+  return num_vertices != 0 && list_size != 0 && num_vertices % list_size == 0;
+}
 
-  int size = count * loader->m_vertex_size;
+static void LoadPrimitives(VertexLoaderBase* loader, int vtx_attr_group,
+                           OpcodeDecoder::Primitive primitive, std::span<const PrimitiveRun> runs,
+                           u32 total_count)
+{
+  if (g_needs_cp_xf_consistency_check) [[unlikely]]
+  {
+    CheckCPConfiguration(vtx_attr_group);
+    g_needs_cp_xf_consistency_check = false;
+  }
 
-  if constexpr (!IsPreprocess)
+  // If the native vertex format changed, force a flush.
+  if (loader->m_native_vertex_format != s_current_vtx_fmt ||
+      loader->m_native_components != g_current_components) [[unlikely]]
   {
-    // Doing early return for the opposite case would be cleaner
-    // but triggers a false unreachable code warning in MSVC debug builds.
+    g_vertex_manager->Flush();
+
+    s_current_vtx_fmt = loader->m_native_vertex_format;
+    g_current_components = loader->m_native_components;
+    auto& system = Core::System::GetInstance();
+    auto& vertex_shader_manager = system.GetVertexShaderManager();
+    vertex_shader_manager.SetVertexFormat(loader->m_native_components,
+                                          loader->m_native_vertex_format->GetVertexDeclaration());
+  }
 
-    if (g_needs_cp_xf_consistency_check) [[unlikely]]
-    {
-      CheckCPConfiguration(vtx_attr_group);
-      g_needs_cp_xf_consistency_check = false;
-    }
+  // CPUCull's performance increase comes from encoding fewer GPU commands, not sending less data
+  // Therefore it's only useful to check if culling could remove a flush
+  const bool can_cpu_cull = g_ActiveConfig.bCPUCull &&
+                            primitive < OpcodeDecoder::Primitive::GX_DRAW_LINES &&
+                            !g_vertex_manager->HasSendableVertices();
+
+  // if cull mode is CULL_ALL, tell VertexManager to skip triangles and quads.
+  // They still need to go through vertex loading, because we need to calculate a zfreeze
+  // reference slope.
+  const bool cullall = (bpmem.genMode.cullmode == CullMode::All &&
+                        primitive < OpcodeDecoder::Primitive::GX_DRAW_LINES);
+
+  const int stride = loader->m_native_vtx_decl.stride;
+  DataReader dst = g_vertex_manager->PrepareForAdditionalData(primitive, total_count, stride,
+                                                              cullall || can_cpu_cull);
+
+  std::array<u16, MAX_PRIMITIVE_BATCH_SIZE> loaded_counts;
+  u8* write_ptr = dst.GetPointer();
+  int count = 0;
+  for (size_t i = 0; i < runs.size(); ++i)
+  {
+    const int loaded = loader->RunVertices(runs[i].src, write_ptr, runs[i].count);
+    loaded_counts[i] = static_cast<u16>(loaded);
+    write_ptr += loaded * stride;
+    count += loaded;
+  }
 
-    // If the native vertex format changed, force a flush.
-    if (loader->m_native_vertex_format != s_current_vtx_fmt ||
-        loader->m_native_components != g_current_components) [[unlikely]]
+  if (can_cpu_cull && !cullall)
+  {
+    if (!g_vertex_manager->AreAllVerticesCulled(loader, primitive, dst.GetPointer(), count))
     {
-      g_vertex_manager->Flush();
-
-      s_current_vtx_fmt = loader->m_native_vertex_format;
-      g_current_components = loader->m_native_components;
-      auto& system = Core::System::GetInstance();
-      auto& vertex_shader_manager = system.GetVertexShaderManager();
-      vertex_shader_manager.SetVertexFormat(loader->m_native_components,
-                                            loader->m_native_vertex_format->GetVertexDeclaration());
+      DataReader new_dst = g_vertex_manager->DisableCullAll(stride);
+      memmove(new_dst.GetPointer(), dst.GetPointer(), count * stride);
     }
+  }
 
-    // CPUCull's performance increase comes from encoding fewer GPU commands, not sending less data
-    // Therefore it's only useful to check if culling could remove a flush
-    const bool can_cpu_cull = g_ActiveConfig.bCPUCull &&
-                              primitive < OpcodeDecoder::Primitive::GX_DRAW_LINES &&
-                              !g_vertex_manager->HasSendableVertices();
-
-    // if cull mode is CULL_ALL, tell VertexManager to skip triangles and quads.
-    // They still need to go through vertex loading, because we need to calculate a zfreeze
-    // reference slope.
-    const bool cullall = (bpmem.genMode.cullmode == CullMode::All &&
-                          primitive < OpcodeDecoder::Primitive::GX_DRAW_LINES);
+  // Complete list primitives generate the same indices whether they are split or not. Runs with
+  // skipped vertices need to be kept apart.
+  if (static_cast<u32>(count) == total_count)
+  {
+    g_vertex_manager->AddIndices(primitive, count);
+  }
+  else
+  {
+    for (size_t i = 0; i < runs.size(); ++i)
+      g_vertex_manager->AddIndices(primitive, loaded_counts[i]);
+  }
+  g_vertex_manager->FlushData(count, loader->m_native_vtx_decl.stride);
 
-    const int stride = loader->m_native_vtx_decl.stride;
-    DataReader dst = g_vertex_manager->PrepareForAdditionalData(primitive, count, stride,
-                                                                cullall || can_cpu_cull);
+  ADDSTAT(g_stats.this_frame.num_prims, count);
+  ADDSTAT(g_stats.this_frame.num_primitive_joins, static_cast<int>(runs.size()));
+  ADDSTAT(g_stats.this_frame.num_batched_primitives, static_cast<int>(runs.size() - 1));
+}
 
-    count = loader->RunVertices(src, dst.GetPointer(), count);
+template <bool IsPreprocess>
+int RunVertices(int vtx_attr_group, OpcodeDecoder::Primitive primitive, int count, const u8* src)
+{
+  if (count == 0) [[unlikely]]
+    return 0;
+  ASSERT(count > 0);
 
-    if (can_cpu_cull && !cullall)
-    {
-      if (!g_vertex_manager->AreAllVerticesCulled(loader, primitive, dst.GetPointer(), count))
-      {
-        DataReader new_dst = g_vertex_manager->DisableCullAll(stride);
-        memmove(new_dst.GetPointer(), dst.GetPointer(), count * stride);
-      }
-    }
+  VertexLoaderBase* loader = RefreshLoader<IsPreprocess>(vtx_attr_group);
 
-    g_vertex_manager->AddIndices(primitive, count);
-    g_vertex_manager->FlushData(count, loader->m_native_vtx_decl.stride);
+  int size = count * loader->m_vertex_size;
 
-    ADDSTAT(g_stats.this_frame.num_prims, count);
-    INCSTAT(g_stats.this_frame.num_primitive_joins);
+  if constexpr (!IsPreprocess)
+  {
+    // Doing early return for the opposite case would be cleaner
+    // but triggers a false unreachable code warning in MSVC debug builds.
+    const PrimitiveRun run{src, static_cast<u16>(count)};
+    LoadPrimitives(loader, vtx_attr_group, primitive, {&run, 1}, count);
   }
   return size;
 }
 
+void RunVerticesBatched(int vtx_attr_group, OpcodeDecoder::Primitive primitive,
+                        std::span<const PrimitiveRun> runs)
+{
+  ASSERT(!runs.empty() && runs.size() <= MAX_PRIMITIVE_BATCH_SIZE);
+
+  u32 total_count = 0;
+  for (const PrimitiveRun& run : runs)
+    total_count += run.count;
+  if (total_count == 0) [[unlikely]]
+    return;
+
+  VertexLoaderBase* loader = RefreshLoader<false>(vtx_attr_group);
+  LoadPrimitives(loader, vtx_attr_group, primitive, runs, total_count);
+}
+
 template int RunVertices<false>(int vtx_attr_group, OpcodeDecoder::Primitive primitive, int count,
                                 const u8* src);
 template int RunVertices<true>(int vtx_attr_group, OpcodeDecoder::Primitive primitive, int count,
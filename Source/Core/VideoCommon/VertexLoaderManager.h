@@ -5,6 +5,7 @@
 
 #include <array>
 #include <memory>
+#include <span>
 #include <string>
 #include <unordered_map>
 
@@ -44,6 +45,30 @@ NativeVertexFormat* GetUberVertexFormat(const PortableVertexDeclaration& decl);
 template <bool IsPreprocess = false>
 int RunVertices(int vtx_attr_group, OpcodeDecoder::Primitive primitive, int count, const u8* src);
 
+// The vertex data of a single primitive command
+struct PrimitiveRun
+{
+  const u8* src;
+  u16 count;
+};
+
+constexpr size_t MAX_PRIMITIVE_BATCH_SIZE = 64;
+
+// Returns the number of vertices per primitive for list primitives, and 0 for strips and fans.
+u32 GetListPrimitiveSize(OpcodeDecoder::Primitive primitive);
+
+// Whether a primitive command can be loaded as part of a batch. Only complete list primitives
+// qualify: they need as many indices batched as they do on their own, while every strip or fan
+// needs a few extra indices to separate it from the previous one, which the buffer reservation
+// for the batch doesn't account for.
+bool CanBatchPrimitive(OpcodeDecoder::Primitive primitive, u32 num_vertices);
+
+// Loads back to back primitive commands of the same type and vertex attribute group with a single
+// buffer reservation and a single index generation pass. Every run must pass CanBatchPrimitive.
+// The total vertex count must fit into a u16, like the count of a single primitive command.
+void RunVerticesBatched(int vtx_attr_group, OpcodeDecoder::Primitive primitive,
+                        std::span<const PrimitiveRun> runs);
+
 namespace detail
 {
 // This will look for an existing loader in the global hashmap or create a new one if there is none.
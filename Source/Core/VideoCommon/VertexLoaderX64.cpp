@@ -124,6 +124,27 @@ void VertexLoaderX64::ReadVertex(OpArg data, VertexComponentFormat attribute,
       _mm_set_ps1(1. / (1u << 30)), _mm_set_ps1(1. / (1u << 31)),
   };
 
+  // The same constants for both lanes of a YMM register
+  static const auto wide_shuffle_lut = [] {
+    Common::EnumMap<std::array<std::array<u8, 32>, 3>, ComponentFormat::InvalidFloat7> lut{};
+    for (int format_index = 0; format_index < 8; format_index++)
+    {
+      const auto format_value = static_cast<ComponentFormat>(format_index);
+      for (size_t i = 0; i < 3; i++)
+      {
+        std::memcpy(lut[format_value][i].data(), &shuffle_lut[format_value][i], 16);
+        std::memcpy(lut[format_value][i].data() + 16, &shuffle_lut[format_value][i], 16);
+      }
+    }
+    return lut;
+  }();
+  static const auto wide_scale_factors = [] {
+    std::array<std::array<float, 8>, 32> factors;
+    for (size_t i = 0; i < factors.size(); i++)
+      factors[i].fill(static_cast<float>(1. / (1u << i)));
+    return factors;
+  }();
+
   X64Reg coords = XMM0;
 
   const auto write_zfreeze = [&]() {  // zfreeze
@@ -170,6 +191,66 @@ void VertexLoaderX64::ReadVertex(OpArg data, VertexComponentFormat attribute,
   if (attribute == VertexComponentFormat::Direct)
     m_src_ofs += load_bytes;
 
+  if (m_pair_pass != PairPass::None)
+  {
+    // Both vertices are converted by the first pass, which stores the first one and keeps the
+    // second one in a register until the second pass stores it. This way, everything is stored in
+    // order. Only VEX encoded instructions may be used here. The pair loop stops while at least 3
+    // vertices remain, so the zfreeze caches don't need to be written either.
+    coords = static_cast<X64Reg>(XMM2 + m_pair_attribute++);
+    if (m_pair_pass == PairPass::Second)
+    {
+      VEXTRACTI128(dest, coords, 1);
+      return;
+    }
+
+    OpArg pair_data = data;
+    pair_data.AddMemOffset(m_vertex_size);
+
+    const auto load = [&](X64Reg reg, const OpArg& arg) {
+      if (load_bytes > 8)
+        VMOVDQU(reg, arg);
+      else if (load_bytes > 4)
+        VMOVQ_xmm(reg, arg);
+      else
+        VMOVD_xmm(reg, arg);
+    };
+
+    // Loading the second vertex straight into the upper lane reads 16 bytes, which is fine as long
+    // as they don't go past the vertices which are known to remain.
+    load(coords, data);
+    if (4 * m_vertex_size - (m_src_ofs - load_bytes) >= 16)
+    {
+      VINSERTI128(coords, coords, pair_data, 1);
+    }
+    else
+    {
+      load(XMM1, pair_data);
+      VINSERTI128(coords, coords, R(XMM1), 1);
+    }
+
+    VPSHUFB(256, coords, coords, MPIC(&wide_shuffle_lut[format][count_in - 1]));
+
+    // Sign-extend.
+    if (format == ComponentFormat::Byte)
+      VPSRAD(256, coords, coords, 24);
+    if (format == ComponentFormat::Short)
+      VPSRAD(256, coords, coords, 16);
+
+    if (format < ComponentFormat::Float)
+    {
+      VCVTDQ2PS(256, coords, R(coords));
+
+      if (dequantize && scaling_exponent)
+        VMULPS(256, coords, coords, MPIC(&wide_scale_factors[scaling_exponent]));
+    }
+
+    // Anything written past the attribute is overwritten later on, either by the rest of this
+    // vertex or by the second one.
+    VMOVUPS(dest, coords);
+    return;
+  }
+
   if (cpu_info.bSSSE3)
   {
     if (load_bytes > 8)
@@ -410,31 +491,38 @@ void VertexLoaderX64::ReadColor(OpArg data, VertexComponentFormat attribute, Col
     m_src_ofs += load_bytes;
 }
 
-void VertexLoaderX64::GenerateVertexLoader()
+int VertexLoaderX64::GetPairAttributeCount() const
 {
-  BitSet32 regs = {src_reg,  dst_reg,       scratch1,    scratch2,
-                   scratch3, remaining_reg, skipped_reg, base_reg};
-  regs &= ABI_ALL_CALLEE_SAVED;
-  regs[RBP] = true;  // Give us a stack frame
-  ABI_PushRegistersAndAdjustStack(regs, 0);
-
-  // Backup count since we're going to count it down.
-  PUSH(32, R(ABI_PARAM3));
-
-  // ABI_PARAM3 is one of the lower registers, so free it for scratch2.
-  // We also have it end at a value of 0, to simplify indexing for zfreeze;
-  // this requires subtracting 1 at the start.
-  LEA(32, remaining_reg, MDisp(ABI_PARAM3, -1));
-
-  MOV(64, R(base_reg), R(ABI_PARAM4));
-
-  if (IsIndexed(m_VtxDesc.low.Position))
-    XOR(32, R(skipped_reg), R(skipped_reg));
-
-  // TODO: load constants into registers outside the main loop
+  if (!cpu_info.bAVX2)
+    return 0;
+
+  // Vertices can't be skipped in the middle of a pair. Other indexed attributes and texture
+  // matrix indices would need SSE code, which is slow while the YMM registers are in use.
+  const auto direct_or_absent = [](VertexComponentFormat attribute) {
+    return attribute == VertexComponentFormat::NotPresent ||
+           attribute == VertexComponentFormat::Direct;
+  };
+  if (m_VtxDesc.low.Position != VertexComponentFormat::Direct ||
+      !direct_or_absent(m_VtxDesc.low.Normal))
+  {
+    return 0;
+  }
 
-  const u8* loop_start = GetCodePtr();
+  int count = 1;
+  if (m_VtxDesc.low.Normal != VertexComponentFormat::NotPresent)
+    count += m_VtxAttr.g0.NormalElements == NormalComponentCount::NTB ? 3 : 1;
+  for (u8 i = 0; i < m_VtxDesc.high.TexCoord.Size(); i++)
+  {
+    if (!direct_or_absent(m_VtxDesc.high.TexCoord[i]) || m_VtxDesc.low.TexMatIdx[i])
+      return 0;
+    if (m_VtxDesc.high.TexCoord[i] != VertexComponentFormat::NotPresent)
+      count++;
+  }
+  return count;
+}
 
+void VertexLoaderX64::GenerateVertexBody()
+{
   if (m_VtxDesc.low.PosMatIdx)
   {
     MOVZX(32, 8, scratch1, MDisp(src_reg, m_src_ofs));
@@ -563,6 +651,43 @@ void VertexLoaderX64::GenerateVertexLoader()
       }
     }
   }
+}
+
+void VertexLoaderX64::GenerateVertexLoader()
+{
+  BitSet32 regs = {src_reg,  dst_reg,       scratch1,    scratch2,
+                   scratch3, remaining_reg, skipped_reg, base_reg};
+  // The pair loop keeps one register per attribute, starting at XMM2.
+  const int pair_attribute_count = GetPairAttributeCount();
+  for (int i = 0; i < pair_attribute_count; i++)
+    regs[XMM2 + i + 16] = true;
+  regs &= ABI_ALL_CALLEE_SAVED;
+  regs[RBP] = true;  // Give us a stack frame
+  ABI_PushRegistersAndAdjustStack(regs, 0);
+
+  // Backup count since we're going to count it down.
+  PUSH(32, R(ABI_PARAM3));
+
+  // ABI_PARAM3 is one of the lower registers, so free it for scratch2.
+  // We also have it end at a value of 0, to simplify indexing for zfreeze;
+  // this requires subtracting 1 at the start.
+  LEA(32, remaining_reg, MDisp(ABI_PARAM3, -1));
+
+  MOV(64, R(base_reg), R(ABI_PARAM4));
+
+  if (IsIndexed(m_VtxDesc.low.Position))
+    XOR(32, R(skipped_reg), R(skipped_reg));
+
+  // TODO: load constants into registers outside the main loop
+
+  const bool use_pairs = pair_attribute_count != 0;
+  FixupBranch to_pair_loop;
+  if (use_pairs)
+    to_pair_loop = J(Jump::Near);
+
+  const u8* loop_start = GetCodePtr();
+
+  GenerateVertexBody();
 
   // Prepare for the next vertex.
   ADD(64, R(dst_reg), Imm32(m_dst_ofs));
@@ -597,6 +722,42 @@ void VertexLoaderX64::GenerateVertexLoader()
              m_src_ofs, m_vertex_size, m_VtxDesc.low.Hex, m_VtxDesc.high.Hex, m_VtxAttr.g0.Hex,
              m_VtxAttr.g1.Hex, m_VtxAttr.g2.Hex);
   m_native_vtx_decl.stride = m_dst_ofs;
+
+  if (!use_pairs)
+    return;
+
+  // The pair loop runs while neither vertex is one of the last three, which have to be stored in
+  // the zfreeze caches. The remaining vertices are left to the loop above.
+  SetJumpTarget(to_pair_loop);
+  CMP(32, R(remaining_reg), Imm8(4));
+  J_CC(CC_B, loop_start);
+
+  const u8* pair_loop_start = GetCodePtr();
+
+  m_pair_pass = PairPass::First;
+  m_pair_attribute = 0;
+  m_src_ofs = 0;
+  m_dst_ofs = 0;
+  GenerateVertexBody();
+  ADD(64, R(src_reg), Imm32(m_src_ofs));
+  ADD(64, R(dst_reg), Imm32(m_dst_ofs));
+
+  m_pair_pass = PairPass::Second;
+  m_pair_attribute = 0;
+  m_src_ofs = 0;
+  m_dst_ofs = 0;
+  GenerateVertexBody();
+  ADD(64, R(src_reg), Imm32(m_src_ofs));
+  ADD(64, R(dst_reg), Imm32(m_dst_ofs));
+
+  m_pair_pass = PairPass::None;
+
+  SUB(32, R(remaining_reg), Imm8(2));
+  CMP(32, R(remaining_reg), Imm8(4));
+  J_CC(CC_AE, pair_loop_start);
+
+  VZEROUPPER();
+  JMP(loop_start, Jump::Near);
 }
 
 int VertexLoaderX64::RunVertices(const u8* src, u8* dst, int count)
@@ -21,13 +21,29 @@ protected:
   int RunVertices(const u8* src, u8* dst, int count) override;
 
 private:
+  // With AVX2, vertices are processed in pairs while enough of them remain. The body is then
+  // generated twice: the first pass converts the direct attributes of both vertices at once in
+  // YMM registers, and both passes store the attributes of their own vertex.
+  enum class PairPass
+  {
+    None,
+    First,
+    Second,
+  };
+
   u32 m_src_ofs = 0;
   u32 m_dst_ofs = 0;
+  PairPass m_pair_pass = PairPass::None;
+  int m_pair_attribute = 0;
   Gen::FixupBranch m_skip_vertex;
   Gen::OpArg GetVertexAddr(CPArray array, VertexComponentFormat attribute);
   void ReadVertex(Gen::OpArg data, VertexComponentFormat attribute, ComponentFormat format,
                   int count_in, int count_out, bool dequantize, u8 scaling_exponent,
                   AttributeFormat* native_format);
   void ReadColor(Gen::OpArg data, VertexComponentFormat attribute, ColorFormat format);
+  // Returns the number of attributes converted for both vertices of a pair, or 0 if vertices
+  // can't be processed in pairs.
+  int GetPairAttributeCount() const;
+  void GenerateVertexBody();
   void GenerateVertexLoader();
 };
@@ -41,6 +41,7 @@
 #include "VideoCommon/VideoBackendBase.h"
 #include "VideoCommon/VideoCommon.h"
 #include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/VideoThreadTimings.h"
 #include "VideoCommon/XFMemory.h"
 #include "VideoCommon/XFStateManager.h"
 
@@ -439,6 +440,8 @@ void VertexManagerBase::Flush()
 
   m_is_flushed = true;
 
+  const VideoThreadTimings::Scope timing_scope(VideoThreadTimings::Category::Backend);
+
   if (m_draw_counter == 0)
   {
     // This is more or less the start of the Frame
@@ -179,6 +179,8 @@ struct VideoConfig final
   bool bTexFmtOverlayEnable = false;
   bool bTexFmtOverlayCenter = false;
   bool bLogRenderTimeToFile = false;
+  bool bShowLatency = false;
+  bool bLogLatencyToFile = false;
 
   // Render
   bool bWireFrame = false;
@@ -215,6 +217,7 @@ struct VideoConfig final
   bool bBBoxEnable = false;
   bool bForceProgressive = false;
   bool bCPUCull = false;
+  bool bDisplayListCache = false;
 
   bool bEFBEmulateFormatChanges = false;
   bool bSkipEFBCopyToRam = false;
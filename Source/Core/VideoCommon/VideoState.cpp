@@ -16,6 +16,7 @@
 #include "VideoCommon/FrameDumper.h"
 #include "VideoCommon/FramebufferManager.h"
 #include "VideoCommon/GeometryShaderManager.h"
+#include "VideoCommon/PerformanceMetrics.h"
 #include "VideoCommon/PixelEngine.h"
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/Present.h"
@@ -115,5 +116,8 @@ void VideoCommon_DoState(PointerWrap& p)
     // Inform backend of new state from registers.
     BPReload();
     VertexLoaderManager::MarkAllDirty();
+
+    // Frames from before the load can't be matched up with the emulated time anymore.
+    g_perf_metrics.ResetLatency();
   }
 }
@@ -0,0 +1,68 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "VideoCommon/VideoThreadTimings.h"
+
+#include <utility>
+
+#include "Common/HookableEvent.h"
+#include "VideoCommon/VideoEvents.h"
+
+VideoThreadTimings g_video_thread_timings;
+
+static Common::EventHook s_after_frame_event = AfterFrameEvent::Register(
+    [](Core::System&) {
+      if (g_video_thread_timings.IsActive())
+        g_video_thread_timings.EndFrame();
+    },
+    "VideoThreadTimings::EndFrame");
+
+std::string_view VideoThreadTimings::GetCategoryName(Category category)
+{
+  static constexpr std::array<std::string_view, NUM_CATEGORIES> names = {
+      "opcode_decoding",
+      "vertex_loading",
+      "bp_xf",
+      "backend",
+  };
+  return names[static_cast<size_t>(category)];
+}
+
+void VideoThreadTimings::Start()
+{
+  m_current = Category::None;
+  m_frame = {};
+  m_frames.clear();
+  m_active.store(true, std::memory_order_relaxed);
+}
+
+std::vector<VideoThreadTimings::Frame> VideoThreadTimings::Stop()
+{
+  m_active.store(false, std::memory_order_relaxed);
+  return std::exchange(m_frames, {});
+}
+
+void VideoThreadTimings::EndFrame()
+{
+  Accumulate(Clock::now());
+  m_frames.push_back(std::exchange(m_frame, {}));
+}
+
+VideoThreadTimings::Category VideoThreadTimings::Enter(Category category)
+{
+  Accumulate(Clock::now());
+  return std::exchange(m_current, category);
+}
+
+void VideoThreadTimings::Leave(Category previous)
+{
+  Accumulate(Clock::now());
+  m_current = previous;
+}
+
+void VideoThreadTimings::Accumulate(Clock::time_point now)
+{
+  if (m_current != Category::None)
+    m_frame.time_spent[static_cast<size_t>(m_current)] += now - m_last_switch;
+  m_last_switch = now;
+}
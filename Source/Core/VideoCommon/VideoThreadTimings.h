@@ -0,0 +1,92 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string_view>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+// Breaks the time the video thread spends on each frame down into the stages of FIFO processing.
+// This is meant for benchmarking (see the FIFO benchmark mode of DolphinNoGUI) and costs a single
+// relaxed atomic load per scope while it isn't active.
+class VideoThreadTimings
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  enum class Category : u8
+  {
+    OpcodeDecoding,
+    VertexLoading,
+    Registers,  // BP, CP and XF register loads
+    Backend,    // Draw calls and presentation
+    Count,
+    None = Count,
+  };
+  static constexpr size_t NUM_CATEGORIES = static_cast<size_t>(Category::Count);
+
+  struct Frame
+  {
+    std::array<Clock::duration, NUM_CATEGORIES> time_spent{};
+  };
+
+  // Time inside a scope is attributed to its category, excluding the time spent in nested scopes.
+  class Scope
+  {
+  public:
+    explicit Scope(Category category);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+  private:
+    Category m_previous = Category::None;
+    bool m_active;
+  };
+
+  static std::string_view GetCategoryName(Category category);
+
+  bool IsActive() const { return m_active.load(std::memory_order_relaxed); }
+
+  // Only call these while the video thread isn't running.
+  void Start();
+  std::vector<Frame> Stop();
+
+  // Called by the video thread at the end of each frame.
+  void EndFrame();
+
+private:
+  Category Enter(Category category);
+  void Leave(Category previous);
+  void Accumulate(Clock::time_point now);
+
+  std::atomic<bool> m_active = false;
+
+  Category m_current = Category::None;
+  Clock::time_point m_last_switch;
+  Frame m_frame;
+  std::vector<Frame> m_frames;
+};
+
+extern VideoThreadTimings g_video_thread_timings;
+
+// Scopes are entered on the hottest paths of the video thread, so these are inline to keep the
+// inactive case down to the load and a branch.
+inline VideoThreadTimings::Scope::Scope(Category category)
+    : m_active(g_video_thread_timings.IsActive())
+{
+  if (m_active) [[unlikely]]
+    m_previous = g_video_thread_timings.Enter(category);
+}
+
+inline VideoThreadTimings::Scope::~Scope()
+{
+  if (m_active) [[unlikely]]
+    g_video_thread_timings.Leave(m_previous);
+}
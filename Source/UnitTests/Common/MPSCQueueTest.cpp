@@ -0,0 +1,95 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <thread>
+#include <vector>
+
+#include "Common/MPSCQueue.h"
+
+TEST(MPSCQueue, Simple)
+{
+  Common::MPSCQueue<u32, 16> q;
+
+  EXPECT_TRUE(q.Empty());
+
+  EXPECT_TRUE(q.TryPush(1));
+  EXPECT_FALSE(q.Empty());
+
+  u32 v;
+  EXPECT_TRUE(q.Pop(v));
+  EXPECT_EQ(1u, v);
+  EXPECT_TRUE(q.Empty());
+  EXPECT_FALSE(q.Pop(v));
+
+  // Test the FIFO order and the wrap around.
+  for (u32 lap = 0; lap < 3; ++lap)
+  {
+    for (u32 i = 0; i < 16; ++i)
+      EXPECT_TRUE(q.TryPush(i));
+    EXPECT_FALSE(q.TryPush(16));
+    for (u32 i = 0; i < 16; ++i)
+    {
+      u32 v2;
+      EXPECT_TRUE(q.Pop(v2));
+      EXPECT_EQ(i, v2);
+    }
+    EXPECT_TRUE(q.Empty());
+  }
+
+  for (u32 i = 0; i < 10; ++i)
+    q.TryPush(i);
+  std::vector<u32> popped;
+  EXPECT_EQ(10u, q.PopAll([&popped](u32 x) { popped.push_back(x); }));
+  for (u32 i = 0; i < 10; ++i)
+    EXPECT_EQ(i, popped[i]);
+
+  for (u32 i = 0; i < 10; ++i)
+    q.TryPush(i);
+  EXPECT_FALSE(q.Empty());
+  q.Clear();
+  EXPECT_TRUE(q.Empty());
+}
+
+TEST(MPSCQueue, MultiThreaded)
+{
+  constexpr u32 PRODUCERS = 4;
+  constexpr u32 COUNT = 100000;
+  Common::MPSCQueue<u32, 256> q;
+
+  auto inserter = [&q](u32 producer) {
+    for (u32 i = 0; i < COUNT; ++i)
+    {
+      while (!q.TryPush(producer << 24 | i))
+        std::this_thread::yield();
+    }
+  };
+
+  std::vector<std::thread> inserter_threads;
+  for (u32 i = 0; i < PRODUCERS; ++i)
+    inserter_threads.emplace_back(inserter, i);
+
+  // Every producer's values must arrive in order, without losses or duplicates.
+  std::array<u32, PRODUCERS> next{};
+  for (u32 received = 0; received < PRODUCERS * COUNT;)
+  {
+    u32 v;
+    if (!q.Pop(v))
+    {
+      std::this_thread::yield();
+      continue;
+    }
+    const u32 producer = v >> 24;
+    ASSERT_LT(producer, PRODUCERS);
+    EXPECT_EQ(next[producer], v & 0xFFFFFF);
+    next[producer] = (v & 0xFFFFFF) + 1;
+    ++received;
+  }
+
+  for (std::thread& thread : inserter_threads)
+    thread.join();
+
+  EXPECT_TRUE(q.Empty());
+}
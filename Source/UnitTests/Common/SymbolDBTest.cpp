@@ -0,0 +1,82 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/SymbolDB.h"
+
+namespace
+{
+Common::Symbol MakeSymbol(const std::string& name, u32 address, u32 size)
+{
+  Common::Symbol symbol(name);
+  symbol.address = address;
+  symbol.size = size;
+  return symbol;
+}
+
+std::string GetName(Common::SymbolDB& db, u32 address)
+{
+  const Common::Symbol* symbol = db.GetSymbolFromAddr(address);
+  return symbol ? symbol->name : "";
+}
+}  // namespace
+
+TEST(SymbolDB, GetSymbolFromAddr)
+{
+  Common::SymbolDB db;
+  EXPECT_EQ(nullptr, db.GetSymbolFromAddr(0x80003100));
+
+  db.AddCompleteSymbol(MakeSymbol("outer", 0x80003100, 0x100));
+  // Symbols can be nested, in which case only the inner one is found for its addresses.
+  db.AddCompleteSymbol(MakeSymbol("inner", 0x80003140, 0x20));
+  db.AddCompleteSymbol(MakeSymbol("empty", 0x80003300, 0));
+
+  EXPECT_EQ("", GetName(db, 0x800030FC));
+  EXPECT_EQ("outer", GetName(db, 0x80003100));
+  EXPECT_EQ("outer", GetName(db, 0x8000313C));
+  EXPECT_EQ("inner", GetName(db, 0x80003140));
+  EXPECT_EQ("inner", GetName(db, 0x8000315C));
+  EXPECT_EQ("", GetName(db, 0x80003160));
+  EXPECT_EQ("", GetName(db, 0x80003200));
+  EXPECT_EQ("empty", GetName(db, 0x80003300));
+  EXPECT_EQ("", GetName(db, 0x80003304));
+}
+
+TEST(SymbolDB, GetSymbolFromAddrAfterChanges)
+{
+  Common::SymbolDB db;
+  db.AddCompleteSymbol(MakeSymbol("first", 0x80004000, 0x10));
+  EXPECT_EQ("first", GetName(db, 0x80004000));
+
+  db.AddCompleteSymbol(MakeSymbol("second", 0x80004010, 0x10));
+  EXPECT_EQ("second", GetName(db, 0x80004010));
+
+  // Sizes are read from the symbols themselves.
+  for (Common::Symbol& symbol : db.AccessSymbols())
+  {
+    if (symbol.address == 0x80004010)
+      symbol.size = 0x20;
+  }
+  EXPECT_EQ("second", GetName(db, 0x8000402C));
+
+  EXPECT_TRUE(db.RemoveSymbol(0x80004000));
+  EXPECT_FALSE(db.RemoveSymbol(0x80004000));
+  EXPECT_EQ("", GetName(db, 0x80004000));
+  EXPECT_EQ("second", GetName(db, 0x80004010));
+  db.AddCompleteSymbol(MakeSymbol("first", 0x80004000, 0x10));
+
+  // Symbols which are added out of order, or again, end up in the right place.
+  db.AddCompleteSymbol(MakeSymbol("before", 0x80003FF0, 0x10));
+  db.AddCompleteSymbol(MakeSymbol("again", 0x80004000, 0x10));
+  EXPECT_EQ("before", GetName(db, 0x80003FFC));
+  EXPECT_EQ("first", GetName(db, 0x80004000));
+  EXPECT_EQ("second", GetName(db, 0x80004010));
+  EXPECT_EQ(3u, db.Symbols().size());
+
+  db.Clear();
+  EXPECT_EQ("", GetName(db, 0x80004010));
+}
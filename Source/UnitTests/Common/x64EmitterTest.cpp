@@ -105,6 +105,7 @@ protected:
     cpu_info.bSSE4_2 = true;
     cpu_info.bLZCNT = true;
     cpu_info.bAVX = true;
+    cpu_info.bAVX2 = true;
     cpu_info.bBMI1 = true;
     cpu_info.bBMI2 = true;
     cpu_info.bBMI2FastParallelBitOps = true;
@@ -1362,6 +1363,51 @@ FMA4_TEST(VFNMSUB, S, false)
 FMA4_TEST(VFMADDSUB, P, true)
 FMA4_TEST(VFMSUBADD, P, true)
 
+TEST_F(x64EmitterTest, AVX_256Bit)
+{
+  emitter->VCVTDQ2PS(256, XMM0, R(XMM1));
+  emitter->VCVTDQ2PS(128, XMM9, MatR(R12));
+  emitter->VMULPS(256, XMM0, XMM0, MDisp(RBX, 64));
+  emitter->VPSHUFB(256, XMM0, XMM0, R(XMM10));
+  emitter->VPSHUFB(128, XMM0, XMM1, MatR(RAX));
+  emitter->VPSRAD(256, XMM0, XMM11, 16);
+  emitter->VPSRAD(128, XMM12, XMM0, 24);
+  emitter->VZEROUPPER();
+  ExpectDisassembly("vcvtdq2ps ymm0, ymm1 "
+                    "vcvtdq2ps xmm9, dqword ptr ds:[r12] "
+                    "vmulps ymm0, ymm0, qqword ptr ds:[rbx+64] "
+                    "vpshufb ymm0, ymm0, ymm10 "
+                    "vpshufb xmm0, xmm1, dqword ptr ds:[rax] "
+                    "vpsrad ymm0, ymm11, 0x10 "
+                    "vpsrad xmm12, xmm0, 0x18 "
+                    "vzeroupper");
+}
+
+TEST_F(x64EmitterTest, AVX2_Lanes)
+{
+  // Bochs prints the 128-bit operands of these instructions with their 256-bit names.
+  emitter->VINSERTI128(XMM0, XMM0, R(XMM1), 1);
+  emitter->VINSERTI128(XMM8, XMM3, MatR(R9), 1);
+  emitter->VEXTRACTI128(R(XMM1), XMM0, 1);
+  emitter->VEXTRACTI128(MDisp(RSI, 8), XMM13, 1);
+  ExpectDisassembly("vinserti128 ymm0, ymm0, ymm1, 0x01 "
+                    "vinserti128 ymm8, ymm3, qqword ptr ds:[r9], 0x01 "
+                    "vextracti128 ymm1, ymm0, 0x01 "
+                    "vextracti128 qqword ptr ds:[rsi+8], ymm13, 0x01");
+}
+
+TEST_F(x64EmitterTest, AVX_Moves)
+{
+  emitter->VMOVD_xmm(XMM0, MDisp(RDI, 6));
+  emitter->VMOVQ_xmm(XMM9, MatR(RDI));
+  emitter->VMOVDQU(XMM1, MDisp(R8, 3));
+  emitter->VMOVUPS(MDisp(RSI, 12), XMM10);
+  ExpectDisassembly("vmovd xmm0, dword ptr ds:[rdi+6] "
+                    "vmovq xmm9, qword ptr ds:[rdi] "
+                    "vmovdqu xmm1, dqword ptr ds:[r8+3] "
+                    "vmovups dqword ptr ds:[rsi+12], xmm10");
+}
+
 }  // namespace Gen
 
 #ifdef _MSC_VER
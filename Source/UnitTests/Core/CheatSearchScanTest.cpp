@@ -0,0 +1,248 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <optional>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/CheatSearch.h"
+#include "Core/CheatSearchScan.h"
+
+using Cheats::MemoryRange;
+using Cheats::SearchResult;
+using Cheats::SearchResultValueState;
+using Cheats::Scan::Chunk;
+using Cheats::Scan::NEW_SEARCH_CHUNK_SIZE;
+using Cheats::Scan::PAGE_SIZE;
+using Cheats::Scan::PageMap;
+
+namespace
+{
+constexpr u32 BASE_ADDRESS = 0x80000000;
+constexpr u32 NUM_PAGES = 8;
+constexpr SearchResultValueState VALUE_STATE = SearchResultValueState::ValueFromVirtualMemory;
+
+// Emulated memory with some pages missing, and with the host memory of the pages in a different
+// order than their addresses, so that nothing can rely on neighbouring pages being contiguous.
+struct TestMemory
+{
+  TestMemory()
+  {
+    for (u32 i = 0; i < host.size(); ++i)
+      host[i] = static_cast<u8>(i * 7 + i / PAGE_SIZE);
+  }
+
+  static bool IsMapped(u32 page) { return page != 3 && page != 6; }
+  static u32 GetHostPage(u32 page) { return (page + 5) % NUM_PAGES; }
+
+  PageMap MakePageMap() const
+  {
+    PageMap page_map;
+    for (u32 page = 0; page < NUM_PAGES; ++page)
+    {
+      if (IsMapped(page))
+        page_map.AddPage(BASE_ADDRESS + page * PAGE_SIZE, &host[GetHostPage(page) * PAGE_SIZE]);
+    }
+    return page_map;
+  }
+
+  std::optional<u8> ReadByte(u64 address) const
+  {
+    if (address < BASE_ADDRESS || address >= BASE_ADDRESS + NUM_PAGES * PAGE_SIZE)
+      return std::nullopt;
+    const u32 offset = static_cast<u32>(address - BASE_ADDRESS);
+    if (!IsMapped(offset / PAGE_SIZE))
+      return std::nullopt;
+    return host[GetHostPage(offset / PAGE_SIZE) * PAGE_SIZE + offset % PAGE_SIZE];
+  }
+
+  template <typename T>
+  std::optional<T> Read(u64 address) const
+  {
+    T value = 0;
+    for (u32 i = 0; i < sizeof(T); ++i)
+    {
+      const std::optional<u8> byte = ReadByte(address + i);
+      if (!byte)
+        return std::nullopt;
+      value = static_cast<T>(value << 8 | *byte);
+    }
+    return value;
+  }
+
+  std::array<u8, NUM_PAGES * PAGE_SIZE> host;
+};
+
+template <typename T>
+bool IsMatch(T value)
+{
+  return value % 5 == 0;
+}
+
+template <typename T>
+void ExpectEqualResults(const std::vector<SearchResult<T>>& expected,
+                        const std::vector<SearchResult<T>>& results)
+{
+  ASSERT_EQ(expected.size(), results.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    EXPECT_EQ(expected[i].m_address, results[i].m_address);
+    EXPECT_EQ(expected[i].m_value, results[i].m_value);
+    EXPECT_EQ(expected[i].m_value_state, results[i].m_value_state);
+  }
+}
+
+template <typename T, u32 Stride>
+void TestScanPage(u32 offset, u32 count)
+{
+  TestMemory memory;
+  const u8* data = memory.host.data() + offset;
+  const u32 address = BASE_ADDRESS + offset;
+
+  std::vector<SearchResult<T>> expected;
+  for (u32 i = 0; i < count; ++i)
+  {
+    const T value = Cheats::Scan::LoadBigEndian<T>(data + i * Stride);
+    if (IsMatch(value))
+      expected.push_back({value, VALUE_STATE, address + i * Stride});
+  }
+  ASSERT_FALSE(expected.empty());
+
+  std::vector<SearchResult<T>> results;
+  Cheats::Scan::ScanPage<T, Stride>(data, address, count, VALUE_STATE, IsMatch<T>, results);
+  ExpectEqualResults(expected, results);
+}
+
+template <typename T, u32 Stride>
+void TestScanChunk(const Chunk& chunk)
+{
+  const TestMemory memory;
+  const PageMap page_map = memory.MakePageMap();
+
+  std::vector<SearchResult<T>> expected;
+  for (u64 address = chunk.begin; address < chunk.end; address += Stride)
+  {
+    const std::optional<T> value = memory.Read<T>(address);
+    if (value && IsMatch(*value))
+      expected.push_back({*value, VALUE_STATE, static_cast<u32>(address)});
+  }
+  ASSERT_FALSE(expected.empty());
+
+  std::vector<SearchResult<T>> results;
+  Cheats::Scan::ScanChunk<T, Stride>(page_map, chunk, VALUE_STATE, IsMatch<T>, results);
+  ExpectEqualResults(expected, results);
+}
+}  // namespace
+
+TEST(CheatSearchScan, PageMapRead)
+{
+  const TestMemory memory;
+  const PageMap page_map = memory.MakePageMap();
+
+  for (u32 offset = PAGE_SIZE - 8; offset < PAGE_SIZE + 4; ++offset)
+  {
+    for (u32 page = 0; page < NUM_PAGES; ++page)
+    {
+      const u32 address = BASE_ADDRESS + page * PAGE_SIZE + offset;
+      EXPECT_EQ(memory.Read<u8>(address), page_map.Read<u8>(address));
+      EXPECT_EQ(memory.Read<u16>(address), page_map.Read<u16>(address));
+      EXPECT_EQ(memory.Read<u32>(address), page_map.Read<u32>(address));
+      EXPECT_EQ(memory.Read<u64>(address), page_map.Read<u64>(address));
+    }
+  }
+
+  // Values that cross into a missing page, or into the end of the map.
+  EXPECT_FALSE(page_map.Read<u32>(BASE_ADDRESS + 3 * PAGE_SIZE - 2).has_value());
+  EXPECT_TRUE(page_map.Read<u32>(BASE_ADDRESS + 3 * PAGE_SIZE - 4).has_value());
+  EXPECT_FALSE(page_map.Read<u16>(BASE_ADDRESS + NUM_PAGES * PAGE_SIZE - 1).has_value());
+  EXPECT_FALSE(page_map.Read<u8>(BASE_ADDRESS - 1).has_value());
+}
+
+TEST(CheatSearchScan, PageMapCopiedPages)
+{
+  std::array<u8, PAGE_SIZE> first{};
+  std::array<u8, PAGE_SIZE> second{};
+  first.back() = 0x12;
+  second.front() = 0x34;
+
+  PageMap page_map;
+  page_map.AddCopiedPage(BASE_ADDRESS, first);
+  page_map.AddCopiedPage(BASE_ADDRESS + PAGE_SIZE, second);
+  // The map keeps its own copy.
+  first.back() = 0;
+
+  EXPECT_EQ(0x1234, page_map.Read<u16>(BASE_ADDRESS + PAGE_SIZE - 1));
+}
+
+TEST(CheatSearchScan, ScanPage)
+{
+  // Counts that aren't multiples of the block size leave a tail.
+  TestScanPage<u8, 1>(0, PAGE_SIZE);
+  TestScanPage<u8, 1>(5, 100);
+  TestScanPage<u16, 2>(0, PAGE_SIZE / 2);
+  TestScanPage<u16, 1>(1, PAGE_SIZE - 2);
+  TestScanPage<u32, 4>(8, 71);
+  TestScanPage<u32, 1>(3, PAGE_SIZE - 6);
+  TestScanPage<u64, 8>(0, PAGE_SIZE / 8);
+  TestScanPage<u64, 1>(7, 200);
+}
+
+TEST(CheatSearchScan, ScanChunk)
+{
+  // Whole memory, so that values cross both mapped and missing pages.
+  const Chunk all{BASE_ADDRESS, BASE_ADDRESS + NUM_PAGES * PAGE_SIZE};
+  TestScanChunk<u8, 1>(all);
+  TestScanChunk<u16, 1>(all);
+  TestScanChunk<u16, 2>(all);
+  TestScanChunk<u32, 1>(all);
+  TestScanChunk<u32, 4>(all);
+  TestScanChunk<u64, 1>(all);
+  TestScanChunk<u64, 8>(all);
+
+  // Chunks that start and end in the middle of pages, including right before a page boundary.
+  TestScanChunk<u32, 1>({BASE_ADDRESS + PAGE_SIZE - 3, BASE_ADDRESS + 2 * PAGE_SIZE + 5});
+  TestScanChunk<u32, 4>({BASE_ADDRESS + PAGE_SIZE - 4, BASE_ADDRESS + 2 * PAGE_SIZE + 4});
+  TestScanChunk<u16, 1>({BASE_ADDRESS + 2 * PAGE_SIZE + 1, BASE_ADDRESS + 5 * PAGE_SIZE - 1});
+}
+
+TEST(CheatSearchScan, SplitIntoChunks)
+{
+  std::vector<Chunk> chunks;
+  std::vector<MemoryRange> ranges{{BASE_ADDRESS + 1, 2 * NEW_SEARCH_CHUNK_SIZE}};
+
+  // Unaligned values start anywhere, and the last one ends with the range.
+  std::vector<u32> pages = Cheats::Scan::SplitIntoChunks(ranges, 4, false, &chunks);
+  EXPECT_EQ((std::vector<Chunk>{{BASE_ADDRESS + 1, BASE_ADDRESS + NEW_SEARCH_CHUNK_SIZE},
+                                {BASE_ADDRESS + NEW_SEARCH_CHUNK_SIZE,
+                                 BASE_ADDRESS + 2 * NEW_SEARCH_CHUNK_SIZE - 2}}),
+            chunks);
+  // The range touches one byte of the page after the second chunk.
+  ASSERT_EQ(2 * NEW_SEARCH_CHUNK_SIZE / PAGE_SIZE + 1, pages.size());
+  for (u32 i = 0; i < pages.size(); ++i)
+    EXPECT_EQ(BASE_ADDRESS + i * PAGE_SIZE, pages[i]);
+
+  // Aligned values start at the next multiple of their size.
+  chunks.clear();
+  Cheats::Scan::SplitIntoChunks(ranges, 4, true, &chunks);
+  EXPECT_EQ((std::vector<Chunk>{{BASE_ADDRESS + 4, BASE_ADDRESS + NEW_SEARCH_CHUNK_SIZE},
+                                {BASE_ADDRESS + NEW_SEARCH_CHUNK_SIZE,
+                                 BASE_ADDRESS + 2 * NEW_SEARCH_CHUNK_SIZE - 2}}),
+            chunks);
+
+  // Ranges too short to hold a value are skipped, including once they have been aligned.
+  chunks.clear();
+  ranges = {{BASE_ADDRESS, 3}, {BASE_ADDRESS + 0x101, 6}, {BASE_ADDRESS + 0x201, 7}};
+  pages = Cheats::Scan::SplitIntoChunks(ranges, 4, true, &chunks);
+  EXPECT_EQ((std::vector<Chunk>{{BASE_ADDRESS + 0x204, BASE_ADDRESS + 0x205}}), chunks);
+  EXPECT_EQ((std::vector<u32>{BASE_ADDRESS}), pages);
+
+  // A range that ends at the top of the address space.
+  chunks.clear();
+  ranges = {{0xFFFFF000, PAGE_SIZE}};
+  pages = Cheats::Scan::SplitIntoChunks(ranges, 8, false, &chunks);
+  EXPECT_EQ((std::vector<Chunk>{{0xFFFFF000, 0xFFFFFFF9}}), chunks);
+  EXPECT_EQ((std::vector<u32>{0xFFFFF000}), pages);
+}
@@ -0,0 +1,100 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Core/Debugger/CodeTrace.h"
+#include "Core/Debugger/CodeTraceFile.h"
+
+using CodeTraceFile::Record;
+
+namespace
+{
+Record MakeRecord(u32 address, u32 hex)
+{
+  return {.address = address, .hex = hex};
+}
+
+Record MakeRecord(u32 address, u32 hex, u32 memory_target)
+{
+  return {.address = address,
+          .hex = hex,
+          .memory_target = memory_target,
+          .flags = Record::HAS_MEMORY_TARGET};
+}
+
+// stw r3, 0x10(r1); lwz r5, 0x10(r1); addi r6, r5, 1; li r5, 0
+const std::vector<Record> TRACE{
+    MakeRecord(0x80003100, 0x90610010, 0x80004010),
+    MakeRecord(0x80003104, 0x80A10010, 0x80004010),
+    MakeRecord(0x80003108, 0x38C50001),
+    MakeRecord(0x8000310C, 0x38A00000),
+};
+}  // namespace
+
+TEST(CodeTraceFile, WriteAndRead)
+{
+  const std::string directory = File::CreateTempDir();
+  ASSERT_FALSE(directory.empty());
+  const std::string path = directory + "/trace.dtrc";
+
+  CodeTraceFile::Writer writer;
+  ASSERT_TRUE(writer.Open(path));
+  // Enough records to fill more than one buffer.
+  for (u32 i = 0; i < 0x30000; i++)
+    writer.Write(MakeRecord(i * 4, i, i * 8));
+  EXPECT_TRUE(writer.Close());
+
+  CodeTraceFile::Reader reader;
+  ASSERT_TRUE(reader.Open(path));
+  ASSERT_EQ(0x30000u, reader.GetRecords().size());
+  for (u32 i = 0; i < 0x30000; i++)
+  {
+    const Record& record = reader.GetRecords()[i];
+    ASSERT_EQ(i * 4, record.address);
+    ASSERT_EQ(i, record.hex);
+    ASSERT_EQ(i * 8, record.memory_target);
+  }
+  reader.Close();
+
+  EXPECT_FALSE(reader.Open(directory + "/missing.dtrc"));
+  File::DeleteDirRecursively(directory);
+}
+
+TEST(CodeTraceFile, Decode)
+{
+  const TraceOutput store = CodeTraceFile::Decode(TRACE[0]);
+  EXPECT_EQ(0x80003100u, store.address);
+  EXPECT_EQ("stw\tr3, 0x0010 (sp)", store.instruction);
+  EXPECT_EQ(0x80004010u, store.memory_target);
+
+  EXPECT_EQ(std::nullopt, CodeTraceFile::Decode(TRACE[2]).memory_target);
+}
+
+TEST(CodeTraceFile, AutoStepping)
+{
+  // The stored value is loaded back into r5 straight away.
+  CodeTrace code_trace;
+  AutoStepResults results = code_trace.AutoStepping(TRACE);
+  EXPECT_EQ(1u, results.count);
+  EXPECT_FALSE(results.timed_out);
+  EXPECT_EQ((std::vector<std::string>{"r3", "r5"}), results.reg_tracked);
+
+  // It's first changed when r6 is computed from it.
+  results = code_trace.AutoStepping(TRACE, false, CodeTrace::AutoStop::Changed);
+  EXPECT_EQ(2u, results.count);
+  EXPECT_FALSE(results.timed_out);
+  EXPECT_EQ((std::vector<std::string>{"r3", "r5", "r6"}), results.reg_tracked);
+
+  // Overwriting r5 isn't a use, so the trace runs out.
+  results = code_trace.AutoStepping(std::span(TRACE).subspan(2), true,
+                                    CodeTrace::AutoStop::Changed);
+  EXPECT_EQ(1u, results.count);
+  EXPECT_TRUE(results.timed_out);
+  EXPECT_EQ((std::vector<std::string>{"r3", "r6"}), results.reg_tracked);
+}
@@ -6,7 +6,10 @@
 #include <array>
 #include <bitset>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include "Common/ChunkFile.h"
 #include "Common/Config/Config.h"
 #include "Common/FileUtil.h"
 #include "Core/Config/MainSettings.h"
@@ -327,6 +330,55 @@ TEST(CoreTiming, ScheduleIntoPast)
   AdvanceAndCheck(system, 0, MAX_SLICE_LENGTH, 1000);
 }
 
+static u32 s_thread_safe_callbacks_ran = 0;
+
+static void CountingCallback(Core::System& system, u64 userdata, s64 lateness)
+{
+  s_thread_safe_callbacks_ran++;
+}
+
+// Events scheduled from other threads while a state is being saved must neither be lost nor end
+// up in the queue twice.
+TEST(CoreTiming, ScheduleDuringDoState)
+{
+  auto& system = Core::System::GetInstance();
+
+  ScopeInit guard(system);
+  ASSERT_TRUE(guard.UserDirectoryExists());
+
+  auto& core_timing = system.GetCoreTiming();
+  CoreTiming::EventType* cb = core_timing.RegisterEvent("callbackCount", CountingCallback);
+
+  // Enter slice 0
+  core_timing.Advance();
+
+  // More than fit into the ring at once, so the overflow list gets used as well.
+  constexpr u32 NUM_EVENTS = 20000;
+  s_thread_safe_callbacks_ran = 0;
+  std::thread producer([&] {
+    for (u32 i = 0; i < NUM_EVENTS; i++)
+      core_timing.ScheduleEvent(0, cb, i, CoreTiming::FromThread::NON_CPU);
+  });
+
+  std::vector<u8> buffer;
+  for (int i = 0; i < 100; i++)
+  {
+    u8* ptr = nullptr;
+    PointerWrap measure(&ptr, 0, PointerWrap::Mode::Measure);
+    core_timing.DoState(measure);
+    buffer.resize(reinterpret_cast<size_t>(ptr));
+
+    ptr = buffer.data();
+    PointerWrap write(&ptr, buffer.size(), PointerWrap::Mode::Write);
+    core_timing.DoState(write);
+  }
+  producer.join();
+
+  system.GetPPCState().downcount = 0;
+  core_timing.Advance();
+  EXPECT_EQ(NUM_EVENTS, s_thread_safe_callbacks_ran);
+}
+
 TEST(CoreTiming, Overclocking)
 {
   auto& system = Core::System::GetInstance();
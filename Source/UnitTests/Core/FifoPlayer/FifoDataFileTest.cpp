@@ -0,0 +1,196 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Core/FifoPlayer/FifoDataFile.h"
+
+namespace
+{
+// Random contents, so that compression can't hide whether data was stored more than once.
+std::shared_ptr<const std::vector<u8>> MakeData(size_t size, u32 seed)
+{
+  auto data = std::make_shared<std::vector<u8>>(size);
+  u32 state = seed * 2654435761u + 1;
+  for (u8& byte : *data)
+  {
+    state = state * 1664525 + 1013904223;
+    byte = static_cast<u8>(state >> 24);
+  }
+  return data;
+}
+
+FifoFrameInfo MakeFrame(u32 index, std::vector<std::shared_ptr<const std::vector<u8>>> updates)
+{
+  FifoFrameInfo frame;
+  frame.fifoData = *MakeData(0x100 + index * 0x20, index);
+  frame.fifoStart = 0x1000 * index;
+  frame.fifoEnd = frame.fifoStart + static_cast<u32>(frame.fifoData.size());
+  frame.cpMem.resize(FifoDataFile::CP_MEM_SIZE);
+  for (u32 i = 0; i < frame.cpMem.size(); ++i)
+    frame.cpMem[i] = index * 0x1000 + i;
+  frame.objectCount = index + 3;
+  for (u32 i = 0; i < updates.size(); ++i)
+  {
+    MemoryUpdate& update = frame.memoryUpdates.emplace_back();
+    update.fifoPosition = i * 0x20;
+    update.address = 0x80000000 + index * 0x10000 + i * 0x1000;
+    update.data = std::move(updates[i]);
+    update.type = i % 2 ? MemoryUpdate::Type::VertexStream : MemoryUpdate::Type::TextureMap;
+  }
+  return frame;
+}
+
+void ExpectEqualFrames(const FifoFrameInfo& expected, const FifoFrameInfo& frame)
+{
+  EXPECT_EQ(expected.fifoData, frame.fifoData);
+  EXPECT_EQ(expected.fifoStart, frame.fifoStart);
+  EXPECT_EQ(expected.fifoEnd, frame.fifoEnd);
+  EXPECT_EQ(expected.cpMem, frame.cpMem);
+  EXPECT_EQ(expected.objectCount, frame.objectCount);
+  ASSERT_EQ(expected.memoryUpdates.size(), frame.memoryUpdates.size());
+  for (size_t i = 0; i < expected.memoryUpdates.size(); ++i)
+  {
+    const MemoryUpdate& expected_update = expected.memoryUpdates[i];
+    const MemoryUpdate& update = frame.memoryUpdates[i];
+    EXPECT_EQ(expected_update.fifoPosition, update.fifoPosition);
+    EXPECT_EQ(expected_update.address, update.address);
+    EXPECT_EQ(expected_update.type, update.type);
+    ASSERT_NE(nullptr, update.data);
+    EXPECT_EQ(*expected_update.data, *update.data);
+  }
+}
+}  // namespace
+
+class FifoDataFileTest : public testing::Test
+{
+protected:
+  FifoDataFileTest() : m_temp_dir{File::CreateTempDir()} {}
+  ~FifoDataFileTest() override { File::DeleteDirRecursively(m_temp_dir); }
+
+  void SetUp() override { ASSERT_FALSE(m_temp_dir.empty()); }
+
+  std::string GetPath(const std::string& name) const { return m_temp_dir + "/" + name; }
+
+private:
+  std::string m_temp_dir;
+};
+
+TEST_F(FifoDataFileTest, SaveAndLoad)
+{
+  std::vector<FifoFrameInfo> frames;
+  FifoDataFile file;
+  file.SetIsWii(true);
+  file.GetBPMem()[0x45] = 0x12345678;
+  file.GetTexMem()[0x1234] = 0x56;
+  for (u32 i = 0; i < 3; ++i)
+  {
+    frames.push_back(MakeFrame(i, {MakeData(0x40, i * 2 + 100), MakeData(0x300, i * 2 + 101)}));
+    file.AddFrame(frames.back());
+  }
+  // Frames can be read back before the recording is saved.
+  ExpectEqualFrames(frames[1], *file.GetFrame(1));
+
+  const std::string path = GetPath("test.dff");
+  ASSERT_TRUE(file.Save(path));
+
+  const std::unique_ptr<FifoDataFile> loaded = FifoDataFile::Load(path, false);
+  ASSERT_NE(nullptr, loaded);
+  EXPECT_TRUE(loaded->HasFrameAnalysisInfo());
+  EXPECT_TRUE(loaded->GetIsWii());
+  EXPECT_EQ(0x12345678u, loaded->GetBPMem()[0x45]);
+  EXPECT_EQ(0x56, loaded->GetTexMem()[0x1234]);
+  ASSERT_EQ(frames.size(), loaded->GetFrameCount());
+  for (u32 i = 0; i < frames.size(); ++i)
+  {
+    EXPECT_EQ(frames[i].fifoData.size(), loaded->GetFrameFifoDataSize(i));
+    EXPECT_EQ(0x340u, loaded->GetFrameMemoryUpdateSize(i));
+    EXPECT_EQ(frames[i].objectCount, loaded->GetFrameObjectCount(i));
+    ExpectEqualFrames(frames[i], *loaded->GetFrame(i));
+  }
+}
+
+TEST_F(FifoDataFileTest, IdenticalMemoryUpdatesAreStoredOnce)
+{
+  constexpr size_t DATA_SIZE = 0x10000;
+  constexpr u32 NUM_FRAMES = 8;
+
+  FifoDataFile single;
+  single.AddFrame(MakeFrame(0, {MakeData(DATA_SIZE, 1)}));
+  const std::string single_path = GetPath("single.dff");
+  ASSERT_TRUE(single.Save(single_path));
+
+  // Each frame has its own copy of the same contents, and a second update that differs from it in
+  // a single byte.
+  std::vector<FifoFrameInfo> frames;
+  FifoDataFile repeated;
+  for (u32 i = 0; i < NUM_FRAMES; ++i)
+  {
+    auto changed = std::make_shared<std::vector<u8>>(*MakeData(DATA_SIZE, 1));
+    (*changed)[i * 0x100] ^= 1;
+    frames.push_back(MakeFrame(0, {MakeData(DATA_SIZE, 1), changed}));
+    repeated.AddFrame(frames.back());
+  }
+  const std::string repeated_path = GetPath("repeated.dff");
+  ASSERT_TRUE(repeated.Save(repeated_path));
+
+  // Only the changed updates add to the size of the file.
+  EXPECT_LT(File::GetSize(repeated_path) - File::GetSize(single_path),
+            (NUM_FRAMES + 1) * DATA_SIZE);
+
+  const std::unique_ptr<FifoDataFile> loaded = FifoDataFile::Load(repeated_path, false);
+  ASSERT_NE(nullptr, loaded);
+  ASSERT_EQ(NUM_FRAMES, loaded->GetFrameCount());
+  const auto first = loaded->GetFrame(0);
+  for (u32 i = 0; i < NUM_FRAMES; ++i)
+  {
+    const auto frame = loaded->GetFrame(i);
+    ExpectEqualFrames(frames[i], *frame);
+    // Frames which are loaded at the same time share the data of identical updates.
+    EXPECT_EQ(first->memoryUpdates[0].data, frame->memoryUpdates[0].data);
+  }
+}
+
+TEST_F(FifoDataFileTest, FramesAreLoadedOnDemand)
+{
+  // More frames than are kept decompressed at a time.
+  constexpr u32 NUM_FRAMES = 40;
+
+  std::vector<FifoFrameInfo> frames;
+  FifoDataFile file;
+  for (u32 i = 0; i < NUM_FRAMES; ++i)
+  {
+    frames.push_back(MakeFrame(i, {MakeData(0x80, i % 3)}));
+    file.AddFrame(frames.back());
+  }
+  const std::string path = GetPath("test.dff");
+  ASSERT_TRUE(file.Save(path));
+
+  const std::unique_ptr<FifoDataFile> loaded = FifoDataFile::Load(path, false);
+  ASSERT_NE(nullptr, loaded);
+  ASSERT_EQ(NUM_FRAMES, loaded->GetFrameCount());
+
+  // A frame stays valid while it is held, even once it has been evicted from the cache.
+  const auto held = loaded->GetFrame(NUM_FRAMES - 1);
+  for (u32 i = 0; i < NUM_FRAMES; ++i)
+    ExpectEqualFrames(frames[(i * 7) % NUM_FRAMES], *loaded->GetFrame((i * 7) % NUM_FRAMES));
+  ExpectEqualFrames(frames.back(), *held);
+
+  // Saving a loaded file copies its chunks.
+  const std::string copy_path = GetPath("copy.dff");
+  ASSERT_TRUE(loaded->Save(copy_path));
+  const std::unique_ptr<FifoDataFile> copy = FifoDataFile::Load(copy_path, false);
+  ASSERT_NE(nullptr, copy);
+  ASSERT_EQ(NUM_FRAMES, copy->GetFrameCount());
+  for (u32 i = 0; i < NUM_FRAMES; ++i)
+  {
+    EXPECT_EQ(frames[i].objectCount, copy->GetFrameObjectCount(i));
+    ExpectEqualFrames(frames[i], *copy->GetFrame(i));
+  }
+}
@@ -3,14 +3,22 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <filesystem>
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
+#include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
 #include "Common/FileUtil.h"
+#include "Common/ScopeGuard.h"
+#include "Common/StringUtil.h"
+#include "Core/Config/MainSettings.h"
 #include "Core/IOS/FS/FileSystem.h"
 #include "Core/IOS/IOS.h"
 #include "UICommon/UICommon.h"
@@ -468,3 +476,285 @@ TEST_F(FileSystemTest, CreateFullPath)
   EXPECT_EQ(m_fs->CreateFullPath(Uid{0x1000}, Gid{1}, "/shared2/wc24/mbox/Readme.txt", 0, modes),
             ResultCode::Success);
 }
+
+TEST_F(FileSystemTest, SaveStateRestoresTmp)
+{
+  const std::vector<u8> TEST_DATA{{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}};
+
+  // Both files have the same contents, so the savestate only stores them once.
+  for (const std::string path : {"/tmp/a", "/tmp/b"})
+  {
+    ASSERT_EQ(m_fs->CreateFile(Uid{0}, Gid{0}, path, 0, modes), ResultCode::Success);
+    const Result<FileHandle> file = m_fs->OpenFile(Uid{0}, Gid{0}, path, Mode::Write);
+    ASSERT_TRUE(file.Succeeded());
+    ASSERT_TRUE(file->Write(TEST_DATA.data(), TEST_DATA.size()).Succeeded());
+  }
+
+  u8* ptr = nullptr;
+  PointerWrap p_measure(&ptr, 0, PointerWrap::Mode::Measure);
+  m_fs->DoState(p_measure);
+  std::vector<u8> state(reinterpret_cast<size_t>(ptr));
+  ptr = state.data();
+  PointerWrap p_write(&ptr, state.size(), PointerWrap::Mode::Write);
+  m_fs->DoState(p_write);
+  ASSERT_TRUE(p_write.IsWriteMode());
+
+  // Modify, delete and create files after saving.
+  {
+    const Result<FileHandle> file = m_fs->OpenFile(Uid{0}, Gid{0}, "/tmp/a", Mode::Write);
+    ASSERT_TRUE(file.Succeeded());
+    ASSERT_TRUE(file->Write(std::vector<u8>(20).data(), 20).Succeeded());
+  }
+  ASSERT_EQ(m_fs->Delete(Uid{0}, Gid{0}, "/tmp/b"), ResultCode::Success);
+  ASSERT_EQ(m_fs->CreateFile(Uid{0}, Gid{0}, "/tmp/c", 0, modes), ResultCode::Success);
+
+  ptr = state.data();
+  PointerWrap p_read(&ptr, state.size(), PointerWrap::Mode::Read);
+  m_fs->DoState(p_read);
+  ASSERT_TRUE(p_read.IsReadMode());
+
+  for (const std::string path : {"/tmp/a", "/tmp/b"})
+  {
+    const Result<FileHandle> file = m_fs->OpenFile(Uid{0}, Gid{0}, path, Mode::Read);
+    ASSERT_TRUE(file.Succeeded());
+    EXPECT_EQ(file->GetStatus()->size, TEST_DATA.size());
+    std::vector<u8> read_buffer(TEST_DATA.size());
+    ASSERT_TRUE(file->Read(read_buffer.data(), read_buffer.size()).Succeeded());
+    EXPECT_EQ(TEST_DATA, read_buffer);
+  }
+  EXPECT_EQ(m_fs->GetMetadata(Uid{0}, Gid{0}, "/tmp/c").Error(), ResultCode::NotFound);
+}
+
+TEST_F(FileSystemTest, SaveStateNoticesHostChanges)
+{
+  const std::vector<u8> OLD_DATA{{0, 1, 2, 3}};
+  const std::vector<u8> NEW_DATA{{4, 5, 6, 7}};
+  const std::string host_path = File::GetUserPath(D_SESSION_WIIROOT_IDX) + "/tmp/a";
+
+  const auto save_state = [&] {
+    u8* ptr = nullptr;
+    PointerWrap p_measure(&ptr, 0, PointerWrap::Mode::Measure);
+    m_fs->DoState(p_measure);
+    std::vector<u8> state(reinterpret_cast<size_t>(ptr));
+    ptr = state.data();
+    PointerWrap p_write(&ptr, state.size(), PointerWrap::Mode::Write);
+    m_fs->DoState(p_write);
+    EXPECT_TRUE(p_write.IsWriteMode());
+    return state;
+  };
+  const auto load_state = [&](std::vector<u8>& state) {
+    u8* ptr = state.data();
+    PointerWrap p_read(&ptr, state.size(), PointerWrap::Mode::Read);
+    m_fs->DoState(p_read);
+    EXPECT_TRUE(p_read.IsReadMode());
+  };
+  // Changes the host file behind the FS without changing its size.
+  const auto replace_host_file = [&](const std::vector<u8>& data) {
+    const auto old_time = std::filesystem::last_write_time(StringToPath(host_path));
+    ASSERT_TRUE(File::WriteStringToFile(host_path, std::string(data.begin(), data.end())));
+    std::filesystem::last_write_time(StringToPath(host_path), old_time + std::chrono::seconds(1));
+  };
+  const auto read_host_file = [&] {
+    std::string contents;
+    File::ReadFileToString(host_path, contents);
+    return std::vector<u8>(contents.begin(), contents.end());
+  };
+
+  ASSERT_EQ(m_fs->CreateFile(Uid{0}, Gid{0}, "/tmp/a", 0, modes), ResultCode::Success);
+  {
+    const Result<FileHandle> file = m_fs->OpenFile(Uid{0}, Gid{0}, "/tmp/a", Mode::Write);
+    ASSERT_TRUE(file.Succeeded());
+    ASSERT_TRUE(file->Write(OLD_DATA.data(), OLD_DATA.size()).Succeeded());
+  }
+  save_state();
+
+  // The next savestate has to store the new contents.
+  replace_host_file(NEW_DATA);
+  std::vector<u8> state = save_state();
+  replace_host_file(OLD_DATA);
+  load_state(state);
+  EXPECT_EQ(NEW_DATA, read_host_file());
+
+  // Loading the same savestate again has to restore the file.
+  replace_host_file(OLD_DATA);
+  load_state(state);
+  EXPECT_EQ(NEW_DATA, read_host_file());
+}
+
+TEST_F(FileSystemTest, HostFilesChangedOutsideFS)
+{
+  ASSERT_EQ(m_fs->CreateDirectory(Uid{0}, Gid{0}, "/host", 0, modes), ResultCode::Success);
+  ASSERT_EQ(m_fs->CreateFile(Uid{0}, Gid{0}, "/host/f", 0, modes), ResultCode::Success);
+  ASSERT_TRUE(m_fs->GetMetadata(Uid{0}, Gid{0}, "/host/f").Succeeded());
+
+  // Looked up paths must not be assumed to still exist, or to still be files.
+  const std::string host_path = File::GetUserPath(D_SESSION_WIIROOT_IDX) + "/host/f";
+  ASSERT_TRUE(File::Delete(host_path));
+  EXPECT_EQ(m_fs->GetMetadata(Uid{0}, Gid{0}, "/host/f").Error(), ResultCode::NotFound);
+
+  ASSERT_TRUE(File::CreateDir(host_path));
+  const Result<Metadata> metadata = m_fs->GetMetadata(Uid{0}, Gid{0}, "/host/f");
+  ASSERT_TRUE(metadata.Succeeded());
+  EXPECT_FALSE(metadata->is_file);
+}
+
+TEST_F(FileSystemTest, HostFilesReplacedOutsideFS)
+{
+  const std::vector<u8> OLD_DATA{{0, 1, 2, 3}};
+  const std::vector<u8> NEW_DATA{{4, 5, 6, 7, 8}};
+  ASSERT_EQ(m_fs->CreateDirectory(Uid{0}, Gid{0}, "/host", 0, modes), ResultCode::Success);
+  ASSERT_EQ(m_fs->CreateFile(Uid{0}, Gid{0}, "/host/f", 0, modes), ResultCode::Success);
+  {
+    const Result<FileHandle> file = m_fs->OpenFile(Uid{0}, Gid{0}, "/host/f", Mode::Write);
+    ASSERT_TRUE(file.Succeeded());
+    ASSERT_TRUE(file->Write(OLD_DATA.data(), OLD_DATA.size()).Succeeded());
+  }
+
+  // The closed file is still cached, but it must not be read once the host file is replaced.
+  const std::string host_path = File::GetUserPath(D_SESSION_WIIROOT_IDX) + "/host/f";
+  ASSERT_TRUE(File::WriteStringToFile(host_path + ".new",
+                                      std::string(NEW_DATA.begin(), NEW_DATA.end())));
+  ASSERT_TRUE(File::Rename(host_path + ".new", host_path));
+
+  const Result<FileHandle> file = m_fs->OpenFile(Uid{0}, Gid{0}, "/host/f", Mode::Read);
+  ASSERT_TRUE(file.Succeeded());
+  EXPECT_EQ(file->GetStatus()->size, NEW_DATA.size());
+  std::vector<u8> read_buffer(NEW_DATA.size());
+  ASSERT_TRUE(file->Read(read_buffer.data(), read_buffer.size()).Succeeded());
+  EXPECT_EQ(NEW_DATA, read_buffer);
+}
+
+TEST_F(FileSystemTest, WriteBack)
+{
+  Config::Init();
+  Common::ScopeGuard config_guard{[] { Config::Shutdown(); }};
+  Config::SetCurrent(Config::MAIN_NAND_WRITE_BACK, true);
+  m_fs = IOS::HLE::Kernel{}.GetFS();
+
+  const std::vector<u8> TEST_DATA{{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}};
+  // FS clears /tmp when it starts, so use a directory that survives the restart below.
+  ASSERT_EQ(m_fs->CreateDirectory(Uid{0}, Gid{0}, "/wb", 0, modes), ResultCode::Success);
+  ASSERT_EQ(m_fs->CreateFile(Uid{0}, Gid{0}, "/wb/f", 0, modes), ResultCode::Success);
+  {
+    const Result<FileHandle> file = m_fs->OpenFile(Uid{0}, Gid{0}, "/wb/f", Mode::Write);
+    ASSERT_TRUE(file.Succeeded());
+    ASSERT_TRUE(file->Write(TEST_DATA.data(), TEST_DATA.size()).Succeeded());
+  }
+
+  // Written data must be visible right away, even if it has not been written back yet.
+  const auto check_contents = [&] {
+    const Result<FileHandle> file = m_fs->OpenFile(Uid{0}, Gid{0}, "/wb/f", Mode::Read);
+    ASSERT_TRUE(file.Succeeded());
+    std::vector<u8> read_buffer(TEST_DATA.size());
+    ASSERT_TRUE(file->Read(read_buffer.data(), read_buffer.size()).Succeeded());
+    EXPECT_EQ(TEST_DATA, read_buffer);
+    EXPECT_EQ(m_fs->GetMetadata(Uid{0}, Gid{0}, "/wb/f")->size, TEST_DATA.size());
+  };
+  check_contents();
+
+  // Shutting the file system down writes everything back.
+  m_fs.reset();
+  Config::SetCurrent(Config::MAIN_NAND_WRITE_BACK, false);
+  m_fs = IOS::HLE::Kernel{}.GetFS();
+  check_contents();
+}
+
+TEST_F(FileSystemTest, WriteBackPartialWrites)
+{
+  const std::vector<u8> TEST_DATA{{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}};
+  ASSERT_EQ(m_fs->CreateDirectory(Uid{0}, Gid{0}, "/wb", 0, modes), ResultCode::Success);
+  ASSERT_EQ(m_fs->CreateFile(Uid{0}, Gid{0}, "/wb/f", 0, modes), ResultCode::Success);
+  {
+    const Result<FileHandle> file = m_fs->OpenFile(Uid{0}, Gid{0}, "/wb/f", Mode::Write);
+    ASSERT_TRUE(file.Succeeded());
+    ASSERT_TRUE(file->Write(TEST_DATA.data(), TEST_DATA.size()).Succeeded());
+  }
+
+  Config::Init();
+  Common::ScopeGuard config_guard{[] { Config::Shutdown(); }};
+  Config::SetCurrent(Config::MAIN_NAND_WRITE_BACK, true);
+  m_fs.reset();
+  m_fs = IOS::HLE::Kernel{}.GetFS();
+
+  // Only parts of the file are written, so the rest has to come from the host file.
+  const auto write = [&](u32 offset, const std::vector<u8>& data) {
+    const Result<FileHandle> file = m_fs->OpenFile(Uid{0}, Gid{0}, "/wb/f", Mode::ReadWrite);
+    ASSERT_TRUE(file.Succeeded());
+    ASSERT_TRUE(file->Seek(offset, SeekMode::Set).Succeeded());
+    ASSERT_TRUE(file->Write(data.data(), data.size()).Succeeded());
+  };
+  std::vector<u8> expected = TEST_DATA;
+  const auto check_contents = [&] {
+    const Result<FileHandle> file = m_fs->OpenFile(Uid{0}, Gid{0}, "/wb/f", Mode::Read);
+    ASSERT_TRUE(file.Succeeded());
+    EXPECT_EQ(file->GetStatus()->size, expected.size());
+    std::vector<u8> read_buffer(expected.size());
+    ASSERT_TRUE(file->Read(read_buffer.data(), read_buffer.size()).Succeeded());
+    EXPECT_EQ(expected, read_buffer);
+  };
+
+  write(3, {0xAA, 0xBB});
+  expected[3] = 0xAA;
+  expected[4] = 0xBB;
+  check_contents();
+
+  // The second write may change contents that the first commit is still writing back.
+  write(8, {0xCC, 0xDD, 0xEE});
+  expected[8] = 0xCC;
+  expected[9] = 0xDD;
+  expected.push_back(0xEE);
+  check_contents();
+
+  m_fs.reset();
+  Config::SetCurrent(Config::MAIN_NAND_WRITE_BACK, false);
+  m_fs = IOS::HLE::Kernel{}.GetFS();
+  check_contents();
+}
+
+TEST_F(FileSystemTest, WriteBackFailures)
+{
+  Config::Init();
+  Common::ScopeGuard config_guard{[] { Config::Shutdown(); }};
+  Config::SetCurrent(Config::MAIN_NAND_WRITE_BACK, true);
+  m_fs = IOS::HLE::Kernel{}.GetFS();
+
+  // A directory in place of the temporary file makes every write-back of the file fail.
+  const std::string host_path = File::GetUserPath(D_SESSION_WIIROOT_IDX) + "/tmp/f";
+  ASSERT_EQ(m_fs->CreateFile(Uid{0}, Gid{0}, "/tmp/f", 0, modes), ResultCode::Success);
+  ASSERT_TRUE(File::CreateDir(File::GetTempFilenameForAtomicWrite(host_path)));
+
+  const std::vector<u8> TEST_DATA(3 * CLUSTER_SIZE, 0xAB);
+  {
+    const Result<FileHandle> file = m_fs->OpenFile(Uid{0}, Gid{0}, "/tmp/f", Mode::Write);
+    ASSERT_TRUE(file.Succeeded());
+    ASSERT_TRUE(file->Write(TEST_DATA.data(), TEST_DATA.size()).Succeeded());
+  }
+
+  // Pending writes take up space as well.
+  const Result<DirectoryStats> stats = m_fs->GetDirectoryStats("/tmp");
+  ASSERT_TRUE(stats.Succeeded());
+  EXPECT_EQ(stats->used_clusters, 3u);
+
+  // The savestate has to store the pending contents, since the host file is still empty.
+  u8* ptr = nullptr;
+  PointerWrap p_measure(&ptr, 0, PointerWrap::Mode::Measure);
+  m_fs->DoState(p_measure);
+  std::vector<u8> state(reinterpret_cast<size_t>(ptr));
+  ptr = state.data();
+  PointerWrap p_write(&ptr, state.size(), PointerWrap::Mode::Write);
+  m_fs->DoState(p_write);
+  ASSERT_TRUE(p_write.IsWriteMode());
+  EXPECT_EQ(File::GetSize(host_path), 0u);
+
+  // Loading it writes the file directly, and the failed write is dropped.
+  ptr = state.data();
+  PointerWrap p_read(&ptr, state.size(), PointerWrap::Mode::Read);
+  m_fs->DoState(p_read);
+  ASSERT_TRUE(p_read.IsReadMode());
+  std::string contents;
+  ASSERT_TRUE(File::ReadFileToString(host_path, contents));
+  EXPECT_EQ(std::vector<u8>(contents.begin(), contents.end()), TEST_DATA);
+
+  m_fs.reset();
+  Config::SetCurrent(Config::MAIN_NAND_WRITE_BACK, false);
+}
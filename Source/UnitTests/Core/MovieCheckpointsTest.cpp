@@ -0,0 +1,54 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/FileUtil.h"
+#include "Core/MovieCheckpoints.h"
+
+using Movie::Checkpoint;
+
+TEST(MovieCheckpoints, SaveAndLoad)
+{
+  const std::string directory = File::CreateTempDir();
+  ASSERT_FALSE(directory.empty());
+  const std::string path = Movie::GetCheckpointsPath(directory + "/movie.dtm");
+
+  // Hashes don't fit into the doubles JSON numbers are read as.
+  const std::vector<Checkpoint> checkpoints{{60, 0xFFFFFFFFFFFFFFFF}, {120, 0x0123456789ABCDEF}};
+  EXPECT_TRUE(Movie::SaveCheckpoints(path, checkpoints));
+  EXPECT_EQ(checkpoints, Movie::LoadCheckpoints(path));
+
+  EXPECT_FALSE(Movie::LoadCheckpoints(directory + "/missing.json"));
+  File::DeleteDirRecursively(directory);
+}
+
+TEST(MovieCheckpoints, FindMismatchedCheckpoint)
+{
+  const std::vector<Checkpoint> expected{{60, 1}, {120, 2}, {180, 3}, {240, 4}};
+
+  EXPECT_EQ(std::nullopt, Movie::FindMismatchedCheckpoint(expected, expected, 250));
+  EXPECT_EQ((Checkpoint{180, 3}), Movie::FindMismatchedCheckpoint(
+                                      expected, {{{60, 1}, {120, 2}, {180, 5}, {240, 6}}}, 250));
+
+  // Checkpoints that weren't expected don't matter, but missing ones do.
+  EXPECT_EQ(std::nullopt, Movie::FindMismatchedCheckpoint(
+                              expected,
+                              {{{30, 9}, {60, 1}, {90, 9}, {120, 2}, {180, 3}, {240, 4}}}, 250));
+  EXPECT_EQ((Checkpoint{60, 1}), Movie::FindMismatchedCheckpoint(
+                                     expected, {{{30, 9}, {120, 2}, {180, 3}, {240, 4}}}, 250));
+  EXPECT_EQ((Checkpoint{180, 3}),
+            Movie::FindMismatchedCheckpoint(expected, {{{60, 1}, {120, 2}, {240, 4}}}, 250));
+  EXPECT_EQ((Checkpoint{60, 1}), Movie::FindMismatchedCheckpoint(expected, {}, 250));
+
+  // Checkpoints after the last replayed frame can't have been reached.
+  EXPECT_EQ(std::nullopt,
+            Movie::FindMismatchedCheckpoint(expected, {{{60, 1}, {120, 2}, {180, 3}}}, 239));
+  EXPECT_EQ((Checkpoint{240, 4}),
+            Movie::FindMismatchedCheckpoint(expected, {{{60, 1}, {120, 2}, {180, 3}}}, 240));
+  EXPECT_EQ(std::nullopt, Movie::FindMismatchedCheckpoint(expected, {}, 59));
+}
@@ -0,0 +1,218 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/FileUtil.h"
+#include "Common/IOFile.h"
+#include "Core/Movie.h"
+#include "Core/MovieInputStorage.h"
+
+class MovieInputStorageTest : public testing::Test
+{
+protected:
+  MovieInputStorageTest()
+      : m_directory(File::CreateTempDir()), m_storage(m_directory + "/recording.dtm")
+  {
+  }
+
+  ~MovieInputStorageTest() override
+  {
+    m_storage.Clear();
+    if (!m_directory.empty())
+      File::DeleteDirRecursively(m_directory);
+  }
+
+  void SetUp() override
+  {
+    if (m_directory.empty())
+      FAIL();
+  }
+
+  // Records more input than is kept in memory, so that some of it has to come from the disk.
+  std::vector<u8> Record(size_t size)
+  {
+    std::vector<u8> input(size);
+    for (size_t i = 0; i < size; ++i)
+      input[i] = static_cast<u8>(i * 7 + i / 256);
+
+    for (size_t offset = 0; offset < size; offset += 8)
+    {
+      const size_t count = std::min<size_t>(8, size - offset);
+      EXPECT_TRUE(m_storage.Write(offset, input.data() + offset, count));
+    }
+    return input;
+  }
+
+  std::vector<u8> ReadAll()
+  {
+    std::vector<u8> input(m_storage.GetSize());
+    EXPECT_TRUE(m_storage.Read(0, input.data(), input.size()));
+    return input;
+  }
+
+  const std::string m_directory;
+  Movie::InputStorage m_storage;
+};
+
+TEST_F(MovieInputStorageTest, RecordAndRead)
+{
+  const std::vector<u8> input = Record(300000);
+  EXPECT_EQ(input.size(), m_storage.GetSize());
+  EXPECT_EQ(input, ReadAll());
+
+  u8 byte;
+  EXPECT_TRUE(m_storage.Read(input.size() - 1, &byte, 1));
+  EXPECT_EQ(input.back(), byte);
+  EXPECT_FALSE(m_storage.Read(input.size(), &byte, 1));
+}
+
+TEST_F(MovieInputStorageTest, WriteDiscardsFollowingInput)
+{
+  std::vector<u8> input = Record(200000);
+
+  // Like recording after loading an earlier savestate.
+  const u8 new_input[] = {1, 2, 3};
+  ASSERT_TRUE(m_storage.Write(1000, new_input, sizeof(new_input)));
+  input.resize(1000);
+  input.insert(input.end(), std::begin(new_input), std::end(new_input));
+  EXPECT_EQ(input, ReadAll());
+
+  ASSERT_TRUE(m_storage.Patch(500, new_input));
+  std::copy(std::begin(new_input), std::end(new_input), input.begin() + 500);
+  EXPECT_EQ(input, ReadAll());
+}
+
+TEST_F(MovieInputStorageTest, SaveAndMap)
+{
+  const std::vector<u8> input = Record(100000);
+
+  Movie::DTMHeader header{};
+  header.filetype = {'D', 'T', 'M', 0x1A};
+  header.frameCount = 1234;
+  const std::string path = m_directory + "/movie.dtm";
+  ASSERT_TRUE(m_storage.SaveAs(path, header));
+
+  ASSERT_TRUE(m_storage.Map(path));
+  EXPECT_EQ(input, ReadAll());
+  EXPECT_FALSE(m_storage.FindMismatch(input));
+
+  std::vector<u8> other = input;
+  other[4321] ^= 1;
+  EXPECT_EQ(4321u, m_storage.FindMismatch(other));
+
+  // Saving over the mapped file and recording on top of played back input both have to work.
+  ASSERT_TRUE(m_storage.SaveAs(path, header));
+  ASSERT_TRUE(m_storage.Write(input.size(), input.data(), 10));
+  EXPECT_EQ(input.size() + 10, m_storage.GetSize());
+
+  File::IOFile file(path, "rb");
+  Movie::DTMHeader saved_header;
+  ASSERT_TRUE(file.ReadArray(&saved_header, 1));
+  EXPECT_EQ(1234u, saved_header.frameCount);
+  EXPECT_EQ(sizeof(header) + input.size(), file.GetSize());
+}
+
+TEST_F(MovieInputStorageTest, FlushWritesValidMovie)
+{
+  const std::vector<u8> input = Record(1000);
+
+  Movie::DTMHeader header{};
+  header.filetype = {'D', 'T', 'M', 0x1A};
+  header.frameCount = 10;
+  m_storage.Flush(header);
+
+  // The work file can be played back as is, even if Dolphin never gets to save the recording.
+  Movie::InputStorage recovered(m_directory + "/recovered.dtm");
+  ASSERT_TRUE(recovered.Map(m_directory + "/recording.dtm"));
+  std::vector<u8> recovered_input(recovered.GetSize());
+  ASSERT_TRUE(recovered.Read(0, recovered_input.data(), recovered_input.size()));
+  EXPECT_EQ(input, recovered_input);
+
+  File::IOFile file(m_directory + "/recording.dtm", "rb");
+  Movie::DTMHeader saved_header;
+  ASSERT_TRUE(file.ReadArray(&saved_header, 1));
+  EXPECT_EQ(10u, saved_header.frameCount);
+}
+
+TEST_F(MovieInputStorageTest, LoadCopiesInput)
+{
+  const std::vector<u8> input = Record(300000);
+  Movie::DTMHeader header{};
+  header.filetype = {'D', 'T', 'M', 0x1A};
+  const std::string path = m_directory + "/movie.dtm";
+  ASSERT_TRUE(m_storage.SaveAs(path, header));
+
+  // Like loading a savestate in read-write mode.
+  ASSERT_TRUE(m_storage.Load(path));
+  EXPECT_EQ(input, ReadAll());
+
+  u8 byte;
+  ASSERT_TRUE(m_storage.Read(0, &byte, 1));
+  EXPECT_EQ(input.front(), byte);
+}
+
+TEST_F(MovieInputStorageTest, RecordAfterMap)
+{
+  std::vector<u8> input = Record(100000);
+  Movie::DTMHeader header{};
+  header.filetype = {'D', 'T', 'M', 0x1A};
+  const std::string path = m_directory + "/movie.dtm";
+  ASSERT_TRUE(m_storage.SaveAs(path, header));
+  ASSERT_TRUE(m_storage.Map(path));
+
+  // Like continuing to record once playback reaches the end of the movie.
+  const u8 new_input[] = {1, 2, 3, 4};
+  ASSERT_TRUE(m_storage.Write(input.size(), new_input, sizeof(new_input)));
+  input.insert(input.end(), std::begin(new_input), std::end(new_input));
+  EXPECT_EQ(input, ReadAll());
+
+  // Saving over the movie that was mapped keeps its input too.
+  ASSERT_TRUE(m_storage.SaveAs(path, header));
+  Movie::InputStorage saved(m_directory + "/saved.dtm");
+  ASSERT_TRUE(saved.Map(path));
+  std::vector<u8> saved_input(saved.GetSize());
+  ASSERT_TRUE(saved.Read(0, saved_input.data(), saved_input.size()));
+  EXPECT_EQ(input, saved_input);
+}
+
+TEST_F(MovieInputStorageTest, SaveAsIncludesPendingInput)
+{
+  // Less input than gets written to the work file at once, so the work file is never opened.
+  const std::vector<u8> input = Record(5000);
+  EXPECT_FALSE(File::Exists(m_directory + "/recording.dtm"));
+
+  Movie::DTMHeader header{};
+  header.filetype = {'D', 'T', 'M', 0x1A};
+  const std::string path = m_directory + "/movie.dtm";
+  ASSERT_TRUE(m_storage.SaveAs(path, header));
+
+  ASSERT_TRUE(m_storage.Load(path));
+  EXPECT_EQ(input, ReadAll());
+}
+
+TEST_F(MovieInputStorageTest, FailedWriteKeepsInput)
+{
+  const std::vector<u8> input = Record(100000);
+  Movie::DTMHeader header{};
+  header.filetype = {'D', 'T', 'M', 0x1A};
+  const std::string path = m_directory + "/movie.dtm";
+  ASSERT_TRUE(m_storage.SaveAs(path, header));
+
+  // The work file can't be created, so the mapped input has to stay where it is.
+  Movie::InputStorage storage(m_directory + "/missing/recording.dtm");
+  ASSERT_TRUE(storage.Map(path));
+  const u8 new_input[] = {1, 2, 3, 4};
+  EXPECT_FALSE(storage.Write(input.size(), new_input, sizeof(new_input)));
+  EXPECT_FALSE(storage.Patch(0, new_input));
+  std::vector<u8> mapped_input(storage.GetSize());
+  ASSERT_TRUE(storage.Read(0, mapped_input.data(), mapped_input.size()));
+  EXPECT_EQ(input, mapped_input);
+
+  // Input past the end would leave a gap.
+  EXPECT_FALSE(m_storage.Write(input.size() + 1, new_input, sizeof(new_input)));
+  EXPECT_EQ(input.size(), m_storage.GetSize());
+}
@@ -0,0 +1,120 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <SFML/Network/Packet.hpp>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/NetPlayCommon.h"
+
+namespace
+{
+constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+// Data that barely compresses, like most save data.
+std::vector<u8> MakeData(size_t size, u32 seed)
+{
+  std::vector<u8> data(size);
+  u32 state = seed;
+  for (u8& byte : data)
+  {
+    state = state * 1664525 + 1013904223;
+    byte = static_cast<u8>(state >> 24);
+  }
+  return data;
+}
+
+std::vector<u8> GetPacketData(const sf::Packet& packet)
+{
+  const u8* data = static_cast<const u8*>(packet.getData());
+  return {data, data + packet.getDataSize()};
+}
+}  // namespace
+
+TEST(NetPlayCommon, BufferRoundTrip)
+{
+  for (const size_t size : {size_t{0}, size_t{1}, BLOCK_SIZE - 1, BLOCK_SIZE, BLOCK_SIZE + 1,
+                            3 * BLOCK_SIZE + 12345})
+  {
+    const std::vector<u8> data = MakeData(size, static_cast<u32>(size));
+    sf::Packet packet;
+    ASSERT_TRUE(NetPlay::CompressBufferIntoPacket(data, packet));
+    EXPECT_EQ(data, NetPlay::DecompressPacketIntoBuffer(packet)) << size;
+    EXPECT_TRUE(packet.endOfPacket()) << size;
+  }
+}
+
+TEST(NetPlayCommon, UnchangedBlocksCompressTheSame)
+{
+  const std::vector<u8> base = MakeData(8 * BLOCK_SIZE, 1);
+  std::vector<u8> data = base;
+  data[5 * BLOCK_SIZE + 100] ^= 0xff;
+
+  sf::Packet base_packet;
+  sf::Packet packet;
+  ASSERT_TRUE(NetPlay::CompressBufferIntoPacket(base, base_packet));
+  ASSERT_TRUE(NetPlay::CompressBufferIntoPacket(data, packet));
+  const std::vector<u8> base_bytes = GetPacketData(base_packet);
+  const std::vector<u8> bytes = GetPacketData(packet);
+
+  // Only the changed block has to be sent again.
+  const std::optional<std::vector<u8>> delta = NetPlay::CompressDelta(bytes, base_bytes);
+  ASSERT_TRUE(delta);
+  EXPECT_LT(delta->size(), 2 * BLOCK_SIZE);
+  EXPECT_EQ(bytes, NetPlay::DecompressDelta(*delta, base_bytes, bytes.size()));
+}
+
+TEST(NetPlayCommon, DeltaRoundTrip)
+{
+  const std::vector<u8> base = MakeData(300000, 2);
+  std::vector<u8> data(base.begin() + 1000, base.end());
+  data.insert(data.begin() + 5000, {1, 2, 3, 4});
+  const std::vector<u8> appended = MakeData(20000, 3);
+  data.insert(data.end(), appended.begin(), appended.end());
+
+  const std::optional<std::vector<u8>> delta = NetPlay::CompressDelta(data, base);
+  ASSERT_TRUE(delta);
+  EXPECT_LT(delta->size(), 2 * appended.size());
+  EXPECT_EQ(data, NetPlay::DecompressDelta(*delta, base, data.size()));
+
+  // Neither the base nor the data have to be there.
+  for (const auto& [from, to] : {std::pair{base, std::vector<u8>{}}, {std::vector<u8>{}, data}})
+  {
+    const std::optional<std::vector<u8>> other_delta = NetPlay::CompressDelta(to, from);
+    ASSERT_TRUE(other_delta);
+    EXPECT_EQ(to, NetPlay::DecompressDelta(*other_delta, from, to.size()));
+  }
+}
+
+TEST(NetPlayCommon, DeltaWithWrongBase)
+{
+  const std::vector<u8> base = MakeData(100000, 4);
+  std::vector<u8> data = base;
+  data[50000] ^= 0xff;
+  const std::optional<std::vector<u8>> delta = NetPlay::CompressDelta(data, base);
+  ASSERT_TRUE(delta);
+
+  std::vector<u8> wrong_base = base;
+  wrong_base[20000] ^= 0xff;
+  EXPECT_EQ(std::nullopt, NetPlay::DecompressDelta(*delta, wrong_base, data.size()));
+  EXPECT_EQ(std::nullopt, NetPlay::DecompressDelta(*delta, MakeData(100000, 5), data.size()));
+  EXPECT_EQ(std::nullopt,
+            NetPlay::DecompressDelta(*delta, std::span(base).first(50000), data.size()));
+}
+
+TEST(NetPlayCommon, DeltaWithWrongSize)
+{
+  const std::vector<u8> base = MakeData(100000, 6);
+  const std::vector<u8> data = MakeData(1000, 7);
+  const std::optional<std::vector<u8>> delta = NetPlay::CompressDelta(data, base);
+  ASSERT_TRUE(delta);
+
+  EXPECT_EQ(std::nullopt, NetPlay::DecompressDelta(*delta, base, data.size() - 1));
+  EXPECT_EQ(std::nullopt, NetPlay::DecompressDelta(*delta, base, data.size() + 1));
+  EXPECT_EQ(std::nullopt, NetPlay::DecompressDelta(std::span(*delta).first(delta->size() / 2),
+                                                   base, data.size()));
+}
@@ -0,0 +1,89 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <vector>
+
+#include <SFML/Network/Packet.hpp>
+#include <gtest/gtest.h>
+
+#include "Core/NetPlayStateHash.h"
+
+using namespace NetPlay;
+
+TEST(NetPlayStateHash, ReportRoundTrip)
+{
+  StateHashReport report;
+  report.frame = 1234;
+  report.timebase = 0x0123456789abcdef;
+  report.cpu_hash = 1;
+  report.gpu_hash = 2;
+  for (u32 i = 0; i < STATE_HASH_RAM_BLOCKS; ++i)
+    report.ram_block_hashes[i] = 0xfedcba9876543210 + i;
+
+  sf::Packet packet;
+  WriteStateHashReport(packet, report);
+  EXPECT_EQ(report, ReadStateHashReport(packet));
+  EXPECT_TRUE(packet.endOfPacket());
+
+  // Dual core reports don't include the GPU registers.
+  report.gpu_hash.reset();
+  WriteStateHashReport(packet, report);
+  EXPECT_EQ(report, ReadStateHashReport(packet));
+  EXPECT_TRUE(packet.endOfPacket());
+}
+
+TEST(NetPlayStateHash, FindsFirstMismatch)
+{
+  StateHashReport a;
+  StateHashReport b;
+  EXPECT_FALSE(FindStateHashMismatch(a, b));
+
+  b.ram_block_hashes[9] = 1;
+  b.ram_block_hashes[3] = 1;
+  auto mismatch = FindStateHashMismatch(a, b);
+  ASSERT_TRUE(mismatch);
+  EXPECT_EQ(DesyncComponent::RAM, mismatch->component);
+  EXPECT_EQ(3u, mismatch->ram_block);
+
+  // Registers are reported before RAM, as a diverging register usually causes the RAM to diverge.
+  b.cpu_hash = 1;
+  mismatch = FindStateHashMismatch(a, b);
+  ASSERT_TRUE(mismatch);
+  EXPECT_EQ(DesyncComponent::CPU, mismatch->component);
+
+  b.timebase = 1;
+  mismatch = FindStateHashMismatch(a, b);
+  ASSERT_TRUE(mismatch);
+  EXPECT_EQ(DesyncComponent::TimeBase, mismatch->component);
+}
+
+TEST(NetPlayStateHash, GPUHashOnlyComparedIfPresent)
+{
+  StateHashReport a;
+  StateHashReport b;
+  a.gpu_hash = 1;
+  EXPECT_FALSE(FindStateHashMismatch(a, b));
+
+  b.gpu_hash = 2;
+  const auto mismatch = FindStateHashMismatch(a, b);
+  ASSERT_TRUE(mismatch);
+  EXPECT_EQ(DesyncComponent::GPU, mismatch->component);
+}
+
+TEST(NetPlayStateHash, FindsMismatchedPage)
+{
+  std::vector<StateHashPage> a;
+  for (u32 i = 0; i < 8; ++i)
+    a.push_back({i * STATE_HASH_PAGE_SIZE, i});
+  std::vector<StateHashPage> b = a;
+  EXPECT_FALSE(FindMismatchedPage(a, b));
+
+  b[5].hash = 100;
+  EXPECT_EQ(5u, FindMismatchedPage(a, b));
+  b[2].hash = 100;
+  EXPECT_EQ(2u, FindMismatchedPage(a, b));
+
+  b = a;
+  b.pop_back();
+  EXPECT_EQ(7u, FindMismatchedPage(a, b));
+}
@@ -0,0 +1,130 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+
+#include "Common/CommonTypes.h"
+#include "Core/PowerPC/CachedInterpreter/CachedInterpreter.h"
+#include "Core/PowerPC/Gekko.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/System.h"
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+namespace
+{
+constexpr u32 BRANCH_PC = 0x80003004;
+constexpr u32 RA = 3;
+constexpr u32 INITIAL_CR = 0x12345678;
+
+struct State
+{
+  u32 cr;
+  u32 pc;
+  u32 npc;
+
+  bool operator==(const State&) const = default;
+};
+
+class TestCachedInterpreter : public CachedInterpreter
+{
+public:
+  // Runs the compare and the branch the way the Interpreter does, one instruction at a time.
+  static State RunInterpreter(Core::System& system, UGeckoInstruction compare,
+                              UGeckoInstruction branch)
+  {
+    auto& ppc_state = system.GetPPCState();
+    auto& interpreter = system.GetInterpreter();
+
+    ppc_state.pc = BRANCH_PC - 4;
+    ppc_state.npc = BRANCH_PC;
+    if (compare.OPCD == 11)
+      Interpreter::cmpi(interpreter, compare);
+    else
+      Interpreter::cmpli(interpreter, compare);
+
+    ppc_state.pc = BRANCH_PC;
+    ppc_state.npc = BRANCH_PC + 4;
+    Interpreter::bcx(interpreter, branch);
+    return {ppc_state.cr.Get(), ppc_state.pc, ppc_state.npc};
+  }
+
+  // Runs both instructions through the superinstruction callback the CachedInterpreter emits.
+  static State RunSuperinstruction(Core::System& system, UGeckoInstruction compare,
+                                   UGeckoInstruction branch)
+  {
+    auto& ppc_state = system.GetPPCState();
+    const CompareAndBranchOperands operands = DecodeCompareAndBranch(
+        system.GetPowerPC().GetBranchWatch(), compare, branch, BRANCH_PC);
+
+    ppc_state.pc = BRANCH_PC - 4;
+    ppc_state.npc = BRANCH_PC;
+    if (compare.OPCD == 11)
+      CompareAndBranch<true>(ppc_state, operands);
+    else
+      CompareAndBranch<false>(ppc_state, operands);
+    return {ppc_state.cr.Get(), ppc_state.pc, ppc_state.npc};
+  }
+};
+
+void ResetState(PowerPC::PowerPCState& ppc_state, u32 ra_value, bool summary_overflow)
+{
+  ppc_state.cr.Set(INITIAL_CR);
+  ppc_state.gpr[RA] = ra_value;
+  ppc_state.xer_so_ov = 0;
+  ppc_state.SetXER_SO(summary_overflow);
+}
+}  // namespace
+
+TEST(CachedInterpreter, CompareAndBranch)
+{
+  auto& system = Core::System::GetInstance();
+  auto& ppc_state = system.GetPPCState();
+
+  constexpr std::array<u32, 10> ra_values = {0,          1,          5,          0x7fff,
+                                             0x8000,     0xffff,     0x7fffffff, 0x80000000,
+                                             0xffff8000, 0xffffffff};
+  constexpr std::array<u32, 6> immediates = {0, 1, 5, 0x7fff, 0x8000, 0xffff};
+  // A forward and a backward branch
+  constexpr std::array<u32, 2> displacements = {0x0010, 0xffe0};
+
+  for (const u32 opcode : {10u, 11u})
+  {
+    for (const u32 crf : {0u, 3u, 7u})
+    {
+      for (const u32 immediate : immediates)
+      {
+        UGeckoInstruction compare(opcode << 26 | crf << 23 | RA << 16 | immediate);
+        for (const u32 bi : {crf * 4, crf * 4 + 1, crf * 4 + 2, crf * 4 + 3, (crf * 4 + 9) % 32})
+        {
+          // Branch if false and branch if true, without decrementing CTR.
+          for (const u32 bo : {0b00100u, 0b01100u})
+          {
+            for (const u32 displacement : displacements)
+            {
+              UGeckoInstruction branch(16u << 26 | bo << 21 | bi << 16 | displacement);
+              for (const u32 ra_value : ra_values)
+              {
+                for (const bool summary_overflow : {false, true})
+                {
+                  ResetState(ppc_state, ra_value, summary_overflow);
+                  const State expected = TestCachedInterpreter::RunInterpreter(system, compare,
+                                                                               branch);
+                  ResetState(ppc_state, ra_value, summary_overflow);
+                  const State actual =
+                      TestCachedInterpreter::RunSuperinstruction(system, compare, branch);
+
+                  EXPECT_EQ(expected, actual)
+                      << fmt::format("{:08x} {:08x} with r{} = {:08x}, SO = {}", compare.hex,
+                                     branch.hex, RA, ra_value, summary_overflow);
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
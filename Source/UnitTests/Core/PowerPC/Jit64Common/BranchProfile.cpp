@@ -0,0 +1,94 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "Common/CommonTypes.h"
+#include "Common/ScopeGuard.h"
+#include "Common/x64ABI.h"
+#include "Core/Core.h"
+#include "Core/PowerPC/Jit64/Jit.h"
+#include "Core/System.h"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+constexpr u32 BRANCH_ADDRESS = 0x80003000;
+
+class TestJit64 : public Jit64
+{
+public:
+  explicit TestJit64(Core::System& system) : Jit64(system) { AllocCodeSpace(4096); }
+
+  // Emits a function which counts one execution of the given path of the branch, the way bcx
+  // does it.
+  void (*EmitCounter(bool taken, u64 check_interval))()
+  {
+    using namespace Gen;
+
+    const auto function = reinterpret_cast<void (*)()>(AlignCode4());
+    // Generated code runs with the stack aligned, as set up by the dispatcher.
+    ABI_PushRegistersAndAdjustStack(ABI_ALL_CALLEE_SAVED, 8, 16);
+    WriteBranchProfileCounter(BRANCH_ADDRESS, taken, check_interval);
+    ABI_PopRegistersAndAdjustStack(ABI_ALL_CALLEE_SAVED, 8, 16);
+    RET();
+    return function;
+  }
+
+  void SetProfile(u64 taken, u64 not_taken)
+  {
+    m_branch_profiles[BRANCH_ADDRESS] = {taken, not_taken};
+  }
+
+  BranchProfile GetProfile() const { return m_branch_profiles.at(BRANCH_ADDRESS); }
+  bool IsHotBranch() const { return analyzer.IsHotBranch(BRANCH_ADDRESS); }
+
+  static constexpr u64 SIDE_EXIT_INTERVAL = SIDE_EXIT_CHECK_INTERVAL;
+  static constexpr u64 RATIO = HOT_BRANCH_RATIO;
+};
+}  // namespace
+
+TEST(Jit64, BranchProfileCounters)
+{
+  Core::DeclareAsCPUThread();
+  Common::ScopeGuard cpu_thread_guard([] { Core::UndeclareAsCPUThread(); });
+
+  TestJit64 jit(Core::System::GetInstance());
+  const auto count_taken = jit.EmitCounter(true, 0);
+  // The periodic check calls into the JitInterface, which has no JIT to update here.
+  const auto count_not_taken = jit.EmitCounter(false, TestJit64::SIDE_EXIT_INTERVAL);
+
+  for (u32 i = 0; i < 1000; ++i)
+    count_taken();
+  for (u32 i = 0; i < TestJit64::SIDE_EXIT_INTERVAL * 2 + 3; ++i)
+    count_not_taken();
+
+  EXPECT_EQ(1000u, jit.GetProfile().taken);
+  EXPECT_EQ(TestJit64::SIDE_EXIT_INTERVAL * 2 + 3, jit.GetProfile().not_taken);
+}
+
+TEST(Jit64, UpdateHotBranch)
+{
+  TestJit64 jit(Core::System::GetInstance());
+
+  // Branches without a profile are left alone.
+  EXPECT_FALSE(jit.UpdateHotBranch(BRANCH_ADDRESS));
+
+  jit.SetProfile(TestJit64::RATIO - 1, 1);
+  EXPECT_FALSE(jit.UpdateHotBranch(BRANCH_ADDRESS));
+  EXPECT_FALSE(jit.IsHotBranch());
+
+  jit.SetProfile(TestJit64::RATIO, 1);
+  EXPECT_TRUE(jit.UpdateHotBranch(BRANCH_ADDRESS));
+  EXPECT_TRUE(jit.IsHotBranch());
+  // Nothing changes while the branch stays hot.
+  EXPECT_FALSE(jit.UpdateHotBranch(BRANCH_ADDRESS));
+  EXPECT_TRUE(jit.IsHotBranch());
+
+  // Leaving through the side exit too often stops tracing the branch for good.
+  jit.SetProfile(TestJit64::RATIO, 2);
+  EXPECT_TRUE(jit.UpdateHotBranch(BRANCH_ADDRESS));
+  EXPECT_FALSE(jit.IsHotBranch());
+  jit.SetProfile(TestJit64::RATIO * 100, 2);
+  EXPECT_FALSE(jit.UpdateHotBranch(BRANCH_ADDRESS));
+  EXPECT_FALSE(jit.IsHotBranch());
+}
@@ -0,0 +1,148 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/Gekko.h"
+#include "Core/PowerPC/MMU.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/System.h"
+
+namespace
+{
+// Read/write access in the PP field of BATs and page table entries
+constexpr u32 PP_READ_WRITE = 2;
+// A 128 KiB block at 0x80000000
+constexpr u32 DBAT_UPPER = 0x80000003;
+
+constexpr u32 PAGE_TABLE_BASE = 0x00100000;
+constexpr u32 SEGMENT = 1;
+constexpr u32 PAGE_ADDRESS = 0x10005000;
+constexpr u32 PAGE_INDEX = (PAGE_ADDRESS >> 12) & 0xffff;
+
+constexpr u32 PTE_R = 0x100;
+constexpr u32 PTE_C = 0x80;
+
+// Accesses which hit in the software TLB skip the BATs and the emulated TLB, so these tests make
+// sure that every change to either of them is still seen by the next access.
+class MMUTest : public testing::Test
+{
+protected:
+  MMUTest()
+      : m_system(Core::System::GetInstance()), m_memory(m_system.GetMemory()),
+        m_mmu(m_system.GetMMU()), m_ppc_state(m_system.GetPPCState())
+  {
+  }
+
+  void SetUp() override
+  {
+    m_memory.Init();
+
+    for (auto& tlb : m_ppc_state.tlb)
+    {
+      for (PowerPC::TLBEntry& entry : tlb)
+        entry.Invalidate();
+    }
+    m_ppc_state.msr.Hex = 0;
+    m_ppc_state.msr.DR = 1;
+    m_ppc_state.Exceptions = 0;
+    m_ppc_state.spr[SPR_DBAT0U] = DBAT_UPPER;
+    m_ppc_state.spr[SPR_DBAT0L] = PP_READ_WRITE;
+    m_mmu.DBATUpdated();
+
+    m_ppc_state.spr[SPR_SDR] = PAGE_TABLE_BASE;
+    m_mmu.SDRUpdated();
+  }
+
+  void TearDown() override
+  {
+    EXPECT_EQ(0u, m_ppc_state.Exceptions);
+    m_ppc_state.msr.Hex = 0;
+    m_ppc_state.spr[SPR_DBAT0U] = 0;
+    m_ppc_state.spr[SPR_DBAT0L] = 0;
+    m_mmu.DBATUpdated();
+    m_memory.Shutdown();
+  }
+
+  // Writes the primary page table entry which maps PAGE_ADDRESS for the given VSID, and returns
+  // its physical address.
+  u32 WritePageTableEntry(u32 vsid, u32 physical_page)
+  {
+    const u32 hash = vsid ^ PAGE_INDEX;
+    const u32 pte_address = PAGE_TABLE_BASE | ((hash & 0x3ff) << 6);
+    UPTE_Lo pte1;
+    pte1.V = 1;
+    pte1.VSID = vsid;
+    pte1.API = PAGE_INDEX >> 10;
+    m_memory.Write_U32(pte1.Hex, pte_address);
+    m_memory.Write_U32(physical_page | PP_READ_WRITE, pte_address + 4);
+    return pte_address;
+  }
+
+  Core::System& m_system;
+  Memory::MemoryManager& m_memory;
+  PowerPC::MMU& m_mmu;
+  PowerPC::PowerPCState& m_ppc_state;
+};
+}  // namespace
+
+TEST_F(MMUTest, BATChanges)
+{
+  m_mmu.Write_U32(0x12345678, 0x80001000);
+  EXPECT_EQ(0x12345678u, m_memory.Read_U32(0x00001000));
+  EXPECT_EQ(0x12345678u, m_mmu.Read_U32(0x80001000));
+  EXPECT_EQ(0x5678u, m_mmu.Read_U16(0x80001002));
+
+  // Move the block to a different physical address.
+  m_memory.Write_U32(0x9abcdef0, 0x00801000);
+  m_ppc_state.spr[SPR_DBAT0L] = 0x00800000 | PP_READ_WRITE;
+  m_mmu.DBATUpdated();
+  EXPECT_EQ(0x9abcdef0u, m_mmu.Read_U32(0x80001000));
+  m_mmu.Write_U8(0x11, 0x80001003);
+  EXPECT_EQ(0x9abcde11u, m_memory.Read_U32(0x00801000));
+  EXPECT_EQ(0x12345678u, m_memory.Read_U32(0x00001000));
+}
+
+TEST_F(MMUTest, PageTableChanges)
+{
+  constexpr u32 vsid = 0x123;
+  m_ppc_state.sr[SEGMENT] = vsid;
+  const u32 pte_address = WritePageTableEntry(vsid, 0x00200000);
+  m_memory.Write_U32(0x01020304, 0x00200004);
+
+  EXPECT_EQ(0x01020304u, m_mmu.Read_U32(PAGE_ADDRESS + 4));
+  EXPECT_EQ(0x01020304u, m_mmu.Read_U32(PAGE_ADDRESS + 4));
+  EXPECT_EQ(PTE_R, m_memory.Read_U32(pte_address + 4) & (PTE_R | PTE_C));
+
+  // Stores have to set the C bit first, and can only then take the fast path.
+  m_mmu.Write_U32(0x05060708, PAGE_ADDRESS + 8);
+  EXPECT_EQ(PTE_R | PTE_C, m_memory.Read_U32(pte_address + 4) & (PTE_R | PTE_C));
+  m_mmu.Write_U32(0x090a0b0c, PAGE_ADDRESS + 8);
+  EXPECT_EQ(0x090a0b0cu, m_memory.Read_U32(0x00200008));
+
+  // Remapping the page only shows after tlbie.
+  WritePageTableEntry(vsid, 0x00300000);
+  m_memory.Write_U32(0x0d0e0f10, 0x00300004);
+  EXPECT_EQ(0x01020304u, m_mmu.Read_U32(PAGE_ADDRESS + 4));
+  m_mmu.InvalidateTLBEntry(PAGE_ADDRESS);
+  EXPECT_EQ(0x0d0e0f10u, m_mmu.Read_U32(PAGE_ADDRESS + 4));
+}
+
+TEST_F(MMUTest, SegmentRegisterChanges)
+{
+  m_ppc_state.sr[SEGMENT] = 0x123;
+  WritePageTableEntry(0x123, 0x00200000);
+  WritePageTableEntry(0x456, 0x00300000);
+  m_memory.Write_U32(0x11111111, 0x00200000);
+  m_memory.Write_U32(0x22222222, 0x00300000);
+
+  EXPECT_EQ(0x11111111u, m_mmu.Read_U32(PAGE_ADDRESS));
+
+  // Some JITs write the segment registers directly, without telling the MMU.
+  m_ppc_state.sr[SEGMENT] = 0x456;
+  EXPECT_EQ(0x22222222u, m_mmu.Read_U32(PAGE_ADDRESS));
+  m_ppc_state.sr[SEGMENT] = 0x123;
+  EXPECT_EQ(0x11111111u, m_mmu.Read_U32(PAGE_ADDRESS));
+}
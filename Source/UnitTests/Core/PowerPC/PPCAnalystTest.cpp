@@ -0,0 +1,98 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/PowerPC/PPCAnalyst.h"
+#include "Core/PowerPC/PPCTables.h"
+
+namespace
+{
+constexpr u32 LOOP_ADDRESS = 0x80001000;
+
+// Each instruction is given with its address, since calls can be inlined through branch following.
+bool IsBusyWaitLoop(const std::vector<std::pair<u32, u32>>& instructions)
+{
+  PPCAnalyst::BlockStats stats{};
+  PPCAnalyst::BlockRegStats gpa{};
+  PPCAnalyst::BlockRegStats fpa{};
+  PPCAnalyst::CodeBlock block;
+  block.m_address = LOOP_ADDRESS;
+  block.m_stats = &stats;
+  block.m_gpa = &gpa;
+  block.m_fpa = &fpa;
+
+  PPCAnalyst::PPCAnalyzer analyzer;
+  std::vector<PPCAnalyst::CodeOp> code(instructions.size());
+  for (size_t i = 0; i < instructions.size(); ++i)
+  {
+    code[i].address = instructions[i].first;
+    code[i].inst.hex = instructions[i].second;
+    code[i].opinfo = PPCTables::GetOpInfo(code[i].inst, code[i].address);
+    analyzer.SetInstructionStats(&block, &code[i], code[i].opinfo);
+  }
+  return analyzer.IsBusyWaitLoop(&block, code.data(), code.size() - 1);
+}
+
+// Lays the instructions out one after another from the start of the loop.
+bool IsBusyWaitLoop(const std::vector<u32>& instructions)
+{
+  std::vector<std::pair<u32, u32>> code;
+  for (u32 i = 0; i < instructions.size(); ++i)
+    code.emplace_back(LOOP_ADDRESS + i * 4, instructions[i]);
+  return IsBusyWaitLoop(code);
+}
+}  // namespace
+
+TEST(PPCAnalyst, BusyWaitLoopPollingMemory)
+{
+  // lwz r3, 0(r4); cmpwi r3, 0; beq <loop>
+  EXPECT_TRUE(IsBusyWaitLoop({0x80640000, 0x2C030000, 0x4182FFF8}));
+  // lwz r3, 0(r4); sync; cmpwi r3, 0; beq <loop>
+  EXPECT_TRUE(IsBusyWaitLoop({0x80640000, 0x7C0004AC, 0x2C030000, 0x4182FFF4}));
+  // lwz r3, 0(r4); eieio; cmpwi r3, 0; beq <loop>
+  EXPECT_TRUE(IsBusyWaitLoop({0x80640000, 0x7C0006AC, 0x2C030000, 0x4182FFF4}));
+}
+
+TEST(PPCAnalyst, BusyWaitLoopWithSideEffects)
+{
+  // lwz r3, 0(r4); stw r3, 4(r4); b <loop>
+  EXPECT_FALSE(IsBusyWaitLoop({0x80640000, 0x90640004, 0x4BFFFFF8}));
+  // lwz r3, 0(r4); cmpwi r3, 0; bdnz <loop>
+  EXPECT_FALSE(IsBusyWaitLoop({0x80640000, 0x2C030000, 0x4200FFF8}));
+}
+
+TEST(PPCAnalyst, BusyWaitLoopCarriedState)
+{
+  // A counter: addi r3, r3, 1; cmpwi r3, 100; blt <loop>
+  EXPECT_FALSE(IsBusyWaitLoop({0x38630001, 0x2C030064, 0x4180FFF8}));
+
+  // The carry flag is read before it is set: lwz r3, 0(r4); addze r5, r3; addic r6, r3, -1;
+  // cmpwi r5, 0; beq <loop>
+  EXPECT_FALSE(IsBusyWaitLoop({0x80640000, 0x7CA30194, 0x30C3FFFF, 0x2C050000, 0x4182FFF0}));
+  // It is set first: lwz r3, 0(r4); addic r6, r3, -1; addze r5, r3; cmpwi r5, 0; beq <loop>
+  EXPECT_TRUE(IsBusyWaitLoop({0x80640000, 0x30C3FFFF, 0x7CA30194, 0x2C050000, 0x4182FFF0}));
+
+  // cr1 is read before it is set: lwz r3, 0(r4); bne cr1, <exit>; cmpwi cr1, r3, 0; b <loop>
+  EXPECT_FALSE(IsBusyWaitLoop({0x80640000, 0x40860100, 0x2C830000, 0x4BFFFFF4}));
+  // It is set first: lwz r3, 0(r4); cmpwi cr1, r3, 0; bne cr1, <exit>; b <loop>
+  EXPECT_TRUE(IsBusyWaitLoop({0x80640000, 0x2C830000, 0x40860100, 0x4BFFFFF4}));
+}
+
+TEST(PPCAnalyst, BusyWaitLoopWithCall)
+{
+  // A call to a function that reads a hardware register, inlined through branch following:
+  // bl 0x80002000; lwz r3, 0(r4); blr; cmpwi r3, 0; bne <loop>
+  EXPECT_TRUE(IsBusyWaitLoop({{LOOP_ADDRESS, 0x48001001},
+                              {0x80002000, 0x80640000},
+                              {0x80002004, 0x4E800020},
+                              {LOOP_ADDRESS + 4, 0x2C030000},
+                              {LOOP_ADDRESS + 8, 0x4082FFF8}}));
+
+  // The same call, but not inlined.
+  EXPECT_FALSE(IsBusyWaitLoop({0x48001001, 0x2C030000, 0x4082FFF8}));
+}
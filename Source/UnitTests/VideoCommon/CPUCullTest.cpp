@@ -0,0 +1,218 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "Common/Inline.h"
+#include "Core/System.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/CPMemory.h"
+#include "VideoCommon/CPUCull.h"
+#include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/VertexLoaderBase.h"
+#include "VideoCommon/VertexShaderManager.h"
+#include "VideoCommon/XFMemory.h"
+#include "VideoCommon/XFStateManager.h"
+
+// The scalar version, which only CPUCull.cpp uses on platforms without SIMD support. The real
+// path's results have to match it no matter which shortcuts it takes.
+#define NO_SIMD
+#include "VideoCommon/CPUCullImpl.h"
+#undef NO_SIMD
+
+using OpcodeDecoder::Primitive;
+
+namespace
+{
+// Moves everything it's applied to out of the view volume.
+constexpr u32 OFFSCREEN_MATRIX = 3;
+
+struct Vertex
+{
+  u32 posmtx;
+  float x, y, z;
+};
+
+class TestVertexLoader final : public VertexLoaderBase
+{
+public:
+  explicit TestVertexLoader(bool per_vertex_posmtx) : VertexLoaderBase(TVtxDesc{}, VAT{})
+  {
+    m_native_vtx_decl.stride = per_vertex_posmtx ? sizeof(Vertex) : 3 * sizeof(float);
+    m_native_vtx_decl.position.components = 3;
+    m_native_vtx_decl.posmtx.enable = per_vertex_posmtx;
+  }
+  int RunVertices(const u8* src, u8* dst, int count) override { return count; }
+};
+
+class CPUCullTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    // Clip space is object space, so the view volume is -1 to 1 in x and y.
+    xfmem.projection.type = ProjectionType::Orthographic;
+    xfmem.projection.rawProjection = {1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f};
+    xfmem.viewport.ht = -1.0f;
+    auto& system = Core::System::GetInstance();
+    system.GetVertexShaderManager().Init();
+    system.GetXFStateManager().SetProjectionChanged();
+
+    std::memset(xfmem.posMatrices, 0, sizeof(xfmem.posMatrices));
+    for (u32 matrix : {0u, OFFSCREEN_MATRIX})
+    {
+      for (u32 i = 0; i < 3; i++)
+        xfmem.posMatrices[matrix * 4 + i * 4 + i] = 1.0f;
+    }
+    xfmem.posMatrices[OFFSCREEN_MATRIX * 4 + 3] = 10.0f;
+    g_main_cp_state.matrix_index_a.PosNormalMtxIdx = 0;
+
+    bpmem.genMode.cullmode = CullMode::Back;
+    m_cull.Init();
+  }
+
+  // A small triangle at (x, y) which faces the camera, or is culled by CullMode::Back if flipped.
+  void AddTriangle(float x, float y, bool flipped = false, u32 posmtx = 0)
+  {
+    const Vertex b{posmtx, x, y + 0.01f, 0.0f};
+    const Vertex c{posmtx, x + 0.01f, y, 0.0f};
+    m_vertices.push_back({posmtx, x, y, 0.0f});
+    m_vertices.push_back(flipped ? c : b);
+    m_vertices.push_back(flipped ? b : c);
+  }
+
+  void AddTriangles(u32 count, float x, float y, bool flipped = false, u32 posmtx = 0)
+  {
+    for (u32 i = 0; i < count; i++)
+      AddTriangle(x, y, flipped, posmtx);
+  }
+
+  std::vector<u8> GetVertexData(bool per_vertex_posmtx) const
+  {
+    std::vector<u8> data;
+    for (const Vertex& vertex : m_vertices)
+    {
+      const u8* begin = reinterpret_cast<const u8*>(&vertex);
+      data.insert(data.end(), per_vertex_posmtx ? begin : begin + sizeof(u32),
+                  begin + sizeof(Vertex));
+    }
+    return data;
+  }
+
+  template <bool PerVertexPosMtx>
+  bool AreAllVerticesCulledScalar(const std::vector<u8>& data, u32 stride)
+  {
+    const int count = static_cast<int>(m_vertices.size());
+    std::vector<CPUCull::TransformedVertex> transformed(count);
+    CPUCull_Scalar::TransformVertices<true, PerVertexPosMtx>(transformed.data(), data.data(),
+                                                             stride, count);
+    return CPUCull_Scalar::AreAllVerticesCulled<Primitive::GX_DRAW_TRIANGLES, CullMode::Back>(
+        transformed.data(), count);
+  }
+
+  // Checks the real path against the scalar one, and returns the result.
+  bool AreAllVerticesCulled(bool per_vertex_posmtx)
+  {
+    TestVertexLoader loader(per_vertex_posmtx);
+    const std::vector<u8> data = GetVertexData(per_vertex_posmtx);
+    const u32 count = static_cast<u32>(m_vertices.size());
+    const bool culled = m_cull.AreAllVerticesCulled(&loader, Primitive::GX_DRAW_TRIANGLES,
+                                                    data.data(), count);
+
+    const u32 stride = loader.m_native_vtx_decl.stride;
+    const bool scalar_culled = per_vertex_posmtx ? AreAllVerticesCulledScalar<true>(data, stride) :
+                                                   AreAllVerticesCulledScalar<false>(data, stride);
+    EXPECT_EQ(scalar_culled, culled) << count << " vertices";
+    return culled;
+  }
+
+  CPUCull m_cull;
+  std::vector<Vertex> m_vertices;
+};
+}  // namespace
+
+TEST_F(CPUCullTest, BoundingBox)
+{
+  // Large enough for the bounding box check, and entirely to the right of the view volume.
+  AddTriangles(CPUCull::BOUNDS_CHECK_THRESHOLD / 3 + 1, 2.0f, 0.0f);
+  EXPECT_TRUE(AreAllVerticesCulled(false));
+
+  // Outside of different sides, so only the triangles themselves are culled.
+  AddTriangles(10, -2.0f, 0.0f);
+  AddTriangles(10, 0.0f, 2.0f);
+  EXPECT_TRUE(AreAllVerticesCulled(false));
+
+  AddTriangle(0.0f, 0.0f);
+  EXPECT_FALSE(AreAllVerticesCulled(false));
+
+  // A triangle that is only flipped is culled by CullMode::Back, not by the bounding box.
+  m_vertices.resize(m_vertices.size() - 3);
+  AddTriangle(0.0f, 0.0f, true);
+  EXPECT_TRUE(AreAllVerticesCulled(false));
+}
+
+TEST_F(CPUCullTest, BoundingBoxWithNaN)
+{
+  constexpr float nan = std::numeric_limits<float>::quiet_NaN();
+  AddTriangles(CPUCull::BOUNDS_CHECK_THRESHOLD / 3 + 1, 2.0f, 0.0f);
+  for (float* coordinate : {&m_vertices[7].x, &m_vertices[7].y, &m_vertices[7].z})
+  {
+    const float old_value = *coordinate;
+    *coordinate = nan;
+    // A NaN coordinate is never culled.
+    EXPECT_FALSE(AreAllVerticesCulled(false));
+    *coordinate = old_value;
+  }
+  EXPECT_TRUE(AreAllVerticesCulled(false));
+}
+
+TEST_F(CPUCullTest, PerVertexPosMtx)
+{
+  // The vertices are in view, but their matrix moves them out, which the bounding box can't see.
+  AddTriangles(CPUCull::BOUNDS_CHECK_THRESHOLD / 3 + 1, 0.0f, 0.0f, false, OFFSCREEN_MATRIX);
+  EXPECT_TRUE(AreAllVerticesCulled(true));
+
+  AddTriangle(0.0f, 0.0f);
+  EXPECT_FALSE(AreAllVerticesCulled(true));
+
+  // And the other way around.
+  m_vertices.clear();
+  AddTriangles(CPUCull::BOUNDS_CHECK_THRESHOLD / 3, 2.0f, 0.0f);
+  AddTriangle(-10.0f, 0.0f, false, OFFSCREEN_MATRIX);
+  EXPECT_FALSE(AreAllVerticesCulled(true));
+}
+
+TEST_F(CPUCullTest, ParallelTransform)
+{
+  // Pretend there are enough cores for all of the workers.
+  const int num_cores = cpu_info.num_cores;
+  cpu_info.num_cores = CPUCull::MAX_WORKERS + 2;
+
+  // Every part of the split has to be transformed, so a single visible triangle has to be found
+  // wherever it is. The batches alternate with fully culled ones, so that a part which wasn't
+  // transformed would still hold a visible triangle from the previous batch.
+  constexpr u32 NUM_TRIANGLES = CPUCull::PARALLEL_TRANSFORM_THRESHOLD / 3 * 2 + 1;
+  for (bool per_vertex_posmtx : {false, true})
+  {
+    for (u32 visible = 0; visible < NUM_TRIANGLES; visible += NUM_TRIANGLES / 16)
+    {
+      m_vertices.clear();
+      AddTriangles(NUM_TRIANGLES, 0.0f, 0.0f, true);
+      EXPECT_TRUE(AreAllVerticesCulled(per_vertex_posmtx));
+
+      m_vertices.clear();
+      AddTriangles(visible, 0.0f, 0.0f, true);
+      AddTriangle(0.0f, 0.0f);
+      AddTriangles(NUM_TRIANGLES - visible - 1, 0.0f, 0.0f, true);
+      EXPECT_FALSE(AreAllVerticesCulled(per_vertex_posmtx)) << "visible triangle " << visible;
+    }
+  }
+
+  cpu_info.num_cores = num_cores;
+}
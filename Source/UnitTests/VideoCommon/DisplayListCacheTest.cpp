@@ -0,0 +1,316 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/CPMemory.h"
+#include "VideoCommon/DisplayListCache.h"
+#include "VideoCommon/OpcodeDecoding.h"
+
+using OpcodeDecoder::DisplayListCache;
+using OpcodeDecoder::Opcode;
+
+namespace
+{
+constexpr u32 ADDRESS = 0x80001000;
+
+using VertexSizes = std::array<u32, CP_NUM_VAT_REG>;
+constexpr VertexSizes DEFAULT_VERTEX_SIZES{4, 4, 4, 4, 4, 4, 4, 4};
+
+// Offsets of the commands in MakeDisplayList
+constexpr size_t CP_OFFSET = 0;
+constexpr size_t NOP_OFFSET = 11;
+constexpr size_t XF_OFFSET = 14;
+constexpr size_t PRIMITIVE_OFFSET = 32;
+
+// Logs everything the decoder passes on, including the XF and vertex data.
+class LoggingCallback final : public OpcodeDecoder::Callback
+{
+public:
+  explicit LoggingCallback(const u8* start) : m_start(start) {}
+
+  OPCODE_CALLBACK(void OnXF(u16 address, u8 count, const u8* data))
+  {
+    Log(fmt::format("XF {:04x} {}", address, count), data, count * 4u);
+  }
+  OPCODE_CALLBACK(void OnCP(u8 command, u32 value))
+  {
+    Log(fmt::format("CP {:02x} {:08x}", command, value));
+  }
+  OPCODE_CALLBACK(void OnBP(u8 command, u32 value))
+  {
+    Log(fmt::format("BP {:02x} {:06x}", command, value));
+  }
+  OPCODE_CALLBACK(void OnIndexedLoad(CPArray array, u32 index, u16 address, u8 size))
+  {
+    Log(fmt::format("Indexed {} {} {:03x} {}", static_cast<u8>(array), index, address, size));
+  }
+  OPCODE_CALLBACK(void OnPrimitiveCommand(OpcodeDecoder::Primitive primitive, u8 vat,
+                                          u32 vertex_size, u16 num_vertices, const u8* vertex_data))
+  {
+    Log(fmt::format("Primitive {} {} {} {}", static_cast<u8>(primitive), vat, vertex_size,
+                    num_vertices),
+        vertex_data, vertex_size * num_vertices);
+  }
+  OPCODE_CALLBACK(void OnDisplayList(u32 address, u32 size))
+  {
+    Log(fmt::format("DisplayList {:08x} {}", address, size));
+  }
+  OPCODE_CALLBACK(void OnNop(u32 count)) { Log(fmt::format("Nop {}", count)); }
+  OPCODE_CALLBACK(void OnUnknown(u8 opcode, const u8*))
+  {
+    Log(fmt::format("Unknown {:02x}", opcode));
+  }
+  OPCODE_CALLBACK(void OnCommand(const u8* data, u32 size))
+  {
+    Log(fmt::format("Command {} {}", data - m_start, size));
+  }
+  OPCODE_CALLBACK(CPState& GetCPState()) { return m_cp_state; }
+  OPCODE_CALLBACK(u32 GetVertexSize(u8 vat)) { return vertex_sizes[vat]; }
+
+  VertexSizes vertex_sizes = DEFAULT_VERTEX_SIZES;
+  std::vector<std::string> log;
+
+private:
+  void Log(std::string entry, const u8* data = nullptr, u32 size = 0)
+  {
+    for (u32 i = 0; i < size; ++i)
+      entry += fmt::format(" {:02x}", data[i]);
+    log.push_back(std::move(entry));
+  }
+
+  const u8* const m_start;
+  CPState m_cp_state;
+};
+
+class DisplayListBuilder
+{
+public:
+  DisplayListBuilder& CP(u8 command, u32 value)
+  {
+    Append({static_cast<u8>(Opcode::GX_LOAD_CP_REG), command});
+    return Append32(value);
+  }
+  DisplayListBuilder& BP(u8 command, u32 value)
+  {
+    Append({static_cast<u8>(Opcode::GX_LOAD_BP_REG), command, static_cast<u8>(value >> 16),
+            static_cast<u8>(value >> 8), static_cast<u8>(value)});
+    return *this;
+  }
+  DisplayListBuilder& XF(u16 address, std::vector<u32> values)
+  {
+    Append({static_cast<u8>(Opcode::GX_LOAD_XF_REG)});
+    Append32(static_cast<u32>(values.size() - 1) << 16 | address);
+    for (u32 value : values)
+      Append32(value);
+    return *this;
+  }
+  DisplayListBuilder& IndexedLoad(Opcode opcode, u32 value)
+  {
+    Append({static_cast<u8>(opcode)});
+    return Append32(value);
+  }
+  DisplayListBuilder& Primitive(u8 opcode, u16 num_vertices, u32 vertex_size)
+  {
+    Append({opcode, static_cast<u8>(num_vertices >> 8), static_cast<u8>(num_vertices)});
+    for (u32 i = 0; i < num_vertices * vertex_size; ++i)
+      Append({static_cast<u8>(i + 1)});
+    return *this;
+  }
+  DisplayListBuilder& Call(u32 address, u32 size)
+  {
+    Append({static_cast<u8>(Opcode::GX_CMD_CALL_DL)});
+    Append32(address);
+    return Append32(size);
+  }
+  DisplayListBuilder& Nop(u32 count)
+  {
+    m_data.resize(m_data.size() + count, static_cast<u8>(Opcode::GX_NOP));
+    return *this;
+  }
+
+  std::vector<u8> Build() const { return m_data; }
+
+private:
+  DisplayListBuilder& Append(std::initializer_list<u8> bytes)
+  {
+    m_data.insert(m_data.end(), bytes);
+    return *this;
+  }
+  DisplayListBuilder& Append32(u32 value)
+  {
+    return Append({static_cast<u8>(value >> 24), static_cast<u8>(value >> 16),
+                   static_cast<u8>(value >> 8), static_cast<u8>(value)});
+  }
+
+  std::vector<u8> m_data;
+};
+
+std::vector<u8> MakeDisplayList()
+{
+  return DisplayListBuilder()
+      .CP(0x50, 0x12345678)
+      .BP(0x20, 0xABCDEF)
+      .Nop(3)
+      .XF(0x1000, {0x11111111, 0x22222222})
+      .IndexedLoad(Opcode::GX_LOAD_INDX_B, 0x00050123)
+      .Primitive(0x91, 3, 4)
+      .Primitive(0x80, 4, 4)
+      .Nop(2)
+      .Build();
+}
+
+std::vector<std::string> Interpret(const std::vector<u8>& data,
+                                   const VertexSizes& vertex_sizes = DEFAULT_VERTEX_SIZES)
+{
+  LoggingCallback callback(data.data());
+  callback.vertex_sizes = vertex_sizes;
+  OpcodeDecoder::Run(data.data(), static_cast<u32>(data.size()), callback);
+  return callback.log;
+}
+
+DisplayListCache::DisplayList Record(const std::vector<u8>& data)
+{
+  LoggingCallback callback(data.data());
+  DisplayListCache::DisplayList display_list;
+  EXPECT_TRUE(DisplayListCache::Record(data.data(), static_cast<u32>(data.size()), callback,
+                                       &display_list));
+  // Recording must not change what the display list does.
+  EXPECT_EQ(Interpret(data), callback.log);
+  return display_list;
+}
+
+// Replays the recording against data, which has to behave exactly like interpreting data.
+bool Replay(const DisplayListCache::DisplayList& display_list, const std::vector<u8>& data,
+            const VertexSizes& vertex_sizes = DEFAULT_VERTEX_SIZES)
+{
+  LoggingCallback callback(data.data());
+  callback.vertex_sizes = vertex_sizes;
+  const bool unchanged = DisplayListCache::Replay(display_list, data.data(), callback);
+  EXPECT_EQ(Interpret(data, vertex_sizes), callback.log);
+  return unchanged;
+}
+}  // namespace
+
+TEST(DisplayListCache, ReplayUnchanged)
+{
+  const std::vector<u8> data = MakeDisplayList();
+  EXPECT_TRUE(Replay(Record(data), data));
+}
+
+TEST(DisplayListCache, ReplayChangedData)
+{
+  std::vector<u8> data = MakeDisplayList();
+  const DisplayListCache::DisplayList display_list = Record(data);
+
+  // XF and vertex data are read from memory, so changing them doesn't invalidate the recording.
+  data[XF_OFFSET + 5] ^= 0xFF;
+  data[data.size() - 3] ^= 0xFF;
+  EXPECT_TRUE(Replay(display_list, data));
+}
+
+TEST(DisplayListCache, ReplayChangedCommands)
+{
+  const std::vector<u8> original = MakeDisplayList();
+  const DisplayListCache::DisplayList display_list = Record(original);
+
+  // A register write.
+  std::vector<u8> data = original;
+  data[CP_OFFSET + 2] ^= 0x01;
+  EXPECT_FALSE(Replay(display_list, data));
+
+  // A vertex count, which moves all of the following commands.
+  data = original;
+  data[PRIMITIVE_OFFSET + 2] = 2;
+  EXPECT_FALSE(Replay(display_list, data));
+
+  // NOPs that turn into a command.
+  data = original;
+  data[NOP_OFFSET + 1] = static_cast<u8>(Opcode::GX_LOAD_BP_REG);
+  EXPECT_FALSE(Replay(display_list, data));
+
+  // A command that turns into NOPs.
+  data = original;
+  std::fill(data.begin() + CP_OFFSET, data.begin() + CP_OFFSET + 6,
+            static_cast<u8>(Opcode::GX_NOP));
+  EXPECT_FALSE(Replay(display_list, data));
+}
+
+TEST(DisplayListCache, ReplayChangedVertexSize)
+{
+  const std::vector<u8> data = MakeDisplayList();
+  const DisplayListCache::DisplayList display_list = Record(data);
+
+  // The rest of the display list is decoded with the new vertex size, without dropping the
+  // recording.
+  EXPECT_TRUE(Replay(display_list, data, {4, 2, 4, 4, 4, 4, 4, 4}));
+  EXPECT_TRUE(Replay(display_list, data, {2, 4, 4, 4, 4, 4, 4, 4}));
+}
+
+TEST(DisplayListCache, ReplayIncompleteCommand)
+{
+  // The last primitive doesn't fit with the vertex size it was recorded with, but does with a
+  // smaller one.
+  std::vector<u8> data = DisplayListBuilder().CP(0x50, 1).Primitive(0x80, 4, 2).Build();
+  const DisplayListCache::DisplayList display_list = Record(data);
+  EXPECT_EQ(6u, display_list.decoded_size);
+
+  EXPECT_TRUE(Replay(display_list, data));
+  EXPECT_TRUE(Replay(display_list, data, {2, 4, 4, 4, 4, 4, 4, 4}));
+}
+
+TEST(DisplayListCache, NotCacheable)
+{
+  const auto is_cacheable = [](const std::vector<u8>& data) {
+    LoggingCallback callback(data.data());
+    DisplayListCache::DisplayList display_list;
+    return DisplayListCache::Record(data.data(), static_cast<u32>(data.size()), callback,
+                                    &display_list);
+  };
+
+  EXPECT_TRUE(is_cacheable(DisplayListBuilder().CP(0x50, 1).Nop(1).Build()));
+  EXPECT_FALSE(is_cacheable(DisplayListBuilder().CP(0x50, 1).Call(0x1000, 32).Build()));
+  std::vector<u8> unknown = DisplayListBuilder().CP(0x50, 1).Nop(1).Build();
+  unknown.back() = static_cast<u8>(Opcode::GX_CMD_UNKNOWN_METRICS);
+  EXPECT_FALSE(is_cacheable(unknown));
+}
+
+TEST(DisplayListCache, Lookup)
+{
+  DisplayListCache cache;
+  const std::vector<u8> data = MakeDisplayList();
+  const u32 size = static_cast<u32>(data.size());
+  cache.Insert(ADDRESS, Record(data));
+
+  EXPECT_NE(nullptr, cache.Find(ADDRESS, size));
+  EXPECT_EQ(nullptr, cache.Find(ADDRESS, size + 32));
+  EXPECT_EQ(nullptr, cache.Find(ADDRESS + 32, size));
+
+  cache.Erase(ADDRESS);
+  EXPECT_EQ(nullptr, cache.Find(ADDRESS, size));
+}
+
+TEST(DisplayListCache, DropsUnusedDisplayLists)
+{
+  DisplayListCache cache;
+  const std::vector<u8> data = MakeDisplayList();
+  const u32 size = static_cast<u32>(data.size());
+  cache.Insert(ADDRESS, Record(data));
+  cache.Insert(ADDRESS + 32, Record(data));
+
+  for (u32 frame = 0; frame < 1200; ++frame)
+  {
+    // Only the first display list keeps being used.
+    EXPECT_NE(nullptr, cache.Find(ADDRESS, size));
+    cache.EndFrame();
+  }
+  EXPECT_NE(nullptr, cache.Find(ADDRESS, size));
+  EXPECT_EQ(nullptr, cache.Find(ADDRESS + 32, size));
+}
@@ -0,0 +1,236 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/ChunkFile.h"
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Core/Config/MainSettings.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/GPFifo.h"
+#include "Core/HW/MMIO.h"
+#include "Core/HW/Memmap.h"
+#include "Core/System.h"
+#include "VideoCommon/CommandProcessor.h"
+#include "VideoCommon/Fifo.h"
+#include "VideoCommon/FramebufferManager.h"
+#include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/VertexManagerBase.h"
+
+using Fifo::DecodedCommandQueue;
+using OpcodeDecoder::DecodedCommand;
+
+namespace
+{
+DecodedCommand MakeCommand(u32 value)
+{
+  return {nullptr, 0, value, 0, DecodedCommand::Type::BP, 0x45};
+}
+
+DecodedCommand MakeProgress(u32 read_pointer, u32 cycles)
+{
+  return {nullptr, cycles, read_pointer, 0, DecodedCommand::Type::FifoProgress, 0};
+}
+
+constexpr u32 FIFO_BASE = 0x00100000;
+constexpr u32 FIFO_END = FIFO_BASE + 0x8000 - GPFifo::GATHER_PIPE_SIZE;
+constexpr u32 NUM_FIFO_CHUNKS = 16;
+// The CPU gets an underflow interrupt once fewer chunks than this are left.
+constexpr u32 LOW_WATERMARK_CHUNKS = 8;
+constexpr u32 CHUNKS_BEFORE_INTERRUPT = NUM_FIFO_CHUNKS - LOW_WATERMARK_CHUNKS + 1;
+
+// Runs the FIFO in dual core mode with the decode thread, with a video thread that doesn't draw.
+class FifoManagerTest : public testing::Test
+{
+protected:
+  FifoManagerTest()
+      : m_system(Core::System::GetInstance()), m_memory(m_system.GetMemory()),
+        m_command_processor(m_system.GetCommandProcessor()), m_fifo(m_system.GetFifo())
+  {
+  }
+
+  void SetUp() override
+  {
+    Config::Init();
+    Config::SetCurrent(Config::MAIN_CPU_THREAD, true);
+    Config::SetCurrent(Config::MAIN_GPU_DECODE_THREAD, true);
+    m_system.Initialize();
+    ASSERT_TRUE(m_system.IsDualCoreMode());
+
+    m_memory.Init();
+    m_system.GetCoreTiming().Init();
+    m_command_processor.Init();
+    g_vertex_manager = std::make_unique<VertexManagerBase>();
+    g_framebuffer_manager = std::make_unique<FramebufferManager>();
+    m_fifo.Init();
+    ASSERT_TRUE(m_fifo.UseDecodeThread());
+
+    // The FIFO only holds NOPs.
+    m_memory.Memset(FIFO_BASE, 0, FIFO_END + GPFifo::GATHER_PIPE_SIZE - FIFO_BASE);
+    auto& fifo = m_command_processor.GetFifo();
+    fifo.CPBase = FIFO_BASE;
+    fifo.CPEnd = FIFO_END;
+    fifo.CPReadPointer = FIFO_BASE;
+    fifo.CPWritePointer = FIFO_BASE;
+    fifo.CPHiWatermark = FIFO_END - FIFO_BASE;
+    fifo.CPLoWatermark = LOW_WATERMARK_CHUNKS * GPFifo::GATHER_PIPE_SIZE;
+
+    m_fifo.EmulatorState(true);
+    m_video_thread = std::thread([this] { m_fifo.RunGpuLoop(); });
+  }
+
+  void TearDown() override
+  {
+    m_fifo.ExitGpuLoop();
+    m_video_thread.join();
+    m_fifo.Shutdown();
+    g_framebuffer_manager.reset();
+    g_vertex_manager.reset();
+    m_system.GetCoreTiming().Shutdown();
+    m_memory.Shutdown();
+
+    Config::SetCurrent(Config::MAIN_CPU_THREAD, false);
+    m_system.Initialize();
+    Config::Shutdown();
+  }
+
+  void WriteControlRegister(u16 value)
+  {
+    m_memory.GetMMIOMapping()->Write<u16>(m_system, 0x0C000000 | CommandProcessor::CTRL_REGISTER,
+                                          value);
+  }
+
+  // Like the gather pipe, which makes the GPU read what the CPU has written to the FIFO.
+  void WriteChunks(u32 count)
+  {
+    auto& fifo = m_command_processor.GetFifo();
+    fifo.CPWritePointer += count * GPFifo::GATHER_PIPE_SIZE;
+    fifo.CPReadWriteDistance += count * GPFifo::GATHER_PIPE_SIZE;
+    m_fifo.RunGpu();
+  }
+
+  std::vector<u8> SaveState()
+  {
+    u8* ptr = nullptr;
+    PointerWrap p_measure(&ptr, 0, PointerWrap::Mode::Measure);
+    m_fifo.DoState(p_measure);
+    std::vector<u8> state(reinterpret_cast<size_t>(ptr));
+    ptr = state.data();
+    PointerWrap p_write(&ptr, state.size(), PointerWrap::Mode::Write);
+    m_fifo.DoState(p_write);
+    EXPECT_TRUE(p_write.IsWriteMode());
+    return state;
+  }
+
+  void LoadState(std::vector<u8>& state)
+  {
+    u8* ptr = state.data();
+    PointerWrap p_read(&ptr, state.size(), PointerWrap::Mode::Read);
+    m_fifo.DoState(p_read);
+    EXPECT_TRUE(p_read.IsReadMode());
+  }
+
+  // The state ends with how far the video buffer was written and executed, followed by the sync
+  // ticks and whether syncing was suspended.
+  static std::pair<ptrdiff_t, ptrdiff_t> GetVideoBufferOffsets(const std::vector<u8>& state)
+  {
+    std::array<ptrdiff_t, 2> offsets;
+    const size_t end = state.size() - sizeof(u8) - sizeof(int);
+    std::memcpy(offsets.data(), state.data() + end - sizeof(offsets), sizeof(offsets));
+    return {offsets[0], offsets[1]};
+  }
+
+  u32 GetReadChunks() const
+  {
+    const auto& fifo = m_command_processor.GetFifo();
+    return (fifo.CPReadPointer.load() - FIFO_BASE) / GPFifo::GATHER_PIPE_SIZE;
+  }
+
+  Core::System& m_system;
+  Memory::MemoryManager& m_memory;
+  CommandProcessor::CommandProcessorManager& m_command_processor;
+  Fifo::FifoManager& m_fifo;
+  std::thread m_video_thread;
+};
+}  // namespace
+
+TEST(DecodedCommandQueue, RunsEndAtSyncPoints)
+{
+  DecodedCommandQueue queue;
+  queue.Init(true);
+
+  queue.Push(MakeCommand(0));
+  queue.Push(MakeCommand(1));
+  queue.Push(MakeProgress(0x20, 10));
+  queue.Push(MakeCommand(2));
+  queue.Push(MakeProgress(0x40, 10));
+  queue.Push({nullptr, 0, 0, 0, DecodedCommand::Type::Idle, 0});
+
+  // Nothing is visible before it's published.
+  EXPECT_TRUE(queue.GetNextRun().empty());
+  EXPECT_TRUE(queue.IsEmpty());
+  EXPECT_FALSE(queue.IsDrained());
+
+  queue.Publish();
+  EXPECT_FALSE(queue.IsEmpty());
+  for (size_t expected_size : {3, 2, 1})
+  {
+    const auto run = queue.GetNextRun();
+    ASSERT_EQ(expected_size, run.size());
+    EXPECT_NE(DecodedCommand::Type::BP, run.back().type);
+    queue.Pop(run.size());
+  }
+  EXPECT_TRUE(queue.GetNextRun().empty());
+  EXPECT_TRUE(queue.IsEmpty());
+  EXPECT_TRUE(queue.IsDrained());
+}
+
+TEST_F(FifoManagerTest, StopsAtInterrupts)
+{
+  CommandProcessor::UCPCtrlReg control;
+  control.GPReadEnable = 1;
+  control.FifoUnderflowIntEnable = 1;
+  WriteControlRegister(control.Hex);
+  WriteChunks(NUM_FIFO_CHUNKS);
+  m_fifo.FlushGpu();
+
+  // The decode thread may have read further, but the CPU only sees what has been executed.
+  const auto& fifo = m_command_processor.GetFifo();
+  EXPECT_TRUE(m_command_processor.IsInterruptWaiting());
+  EXPECT_EQ(CHUNKS_BEFORE_INTERRUPT, GetReadChunks());
+  EXPECT_EQ((NUM_FIFO_CHUNKS - CHUNKS_BEFORE_INTERRUPT) * GPFifo::GATHER_PIPE_SIZE,
+            fifo.CPReadWriteDistance.load());
+
+  // A savestate leaves out what was read ahead, since it is read from the FIFO again.
+  m_fifo.PauseAndLock(true, false);
+  std::vector<u8> state = SaveState();
+  const ptrdiff_t executed_size = CHUNKS_BEFORE_INTERRUPT * GPFifo::GATHER_PIPE_SIZE;
+  EXPECT_EQ(std::make_pair(executed_size, executed_size), GetVideoBufferOffsets(state));
+  LoadState(state);
+  m_fifo.PauseAndLock(false, true);
+
+  // What the CPU thread does once the interrupt event runs.
+  m_command_processor.UpdateInterrupts(1);
+  m_fifo.FlushGpu();
+
+  EXPECT_FALSE(m_command_processor.IsInterruptWaiting());
+  EXPECT_EQ(NUM_FIFO_CHUNKS, GetReadChunks());
+  EXPECT_EQ(0u, fifo.CPReadWriteDistance.load());
+
+  // Every chunk was read once after loading the state.
+  m_fifo.PauseAndLock(true, false);
+  const ptrdiff_t fifo_size = NUM_FIFO_CHUNKS * GPFifo::GATHER_PIPE_SIZE;
+  EXPECT_EQ(std::make_pair(fifo_size, fifo_size), GetVideoBufferOffsets(SaveState()));
+  m_fifo.PauseAndLock(false, true);
+
+  m_command_processor.UpdateInterrupts(0);
+}
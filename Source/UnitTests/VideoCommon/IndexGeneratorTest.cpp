@@ -0,0 +1,265 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <tuple>
+#include <vector>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/VertexLoaderManager.h"
+#include "VideoCommon/VideoConfig.h"
+
+using OpcodeDecoder::Primitive;
+using Triangle = std::array<u32, 3>;
+
+namespace
+{
+// Rotates the triangle so that it starts with its lowest index, which keeps the winding order.
+Triangle Canonical(Triangle triangle)
+{
+  std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()),
+              triangle.end());
+  return triangle;
+}
+
+// The triangles the GPU draws for a primitive, in order.
+std::vector<Triangle> ExpectedTriangles(Primitive primitive, u32 num_verts, u32 base)
+{
+  std::vector<Triangle> triangles;
+  switch (primitive)
+  {
+  case Primitive::GX_DRAW_QUADS:
+  case Primitive::GX_DRAW_QUADS_2:
+  {
+    u32 i = 0;
+    for (; i + 4 <= num_verts; i += 4)
+    {
+      triangles.push_back({base + i, base + i + 1, base + i + 2});
+      triangles.push_back({base + i, base + i + 2, base + i + 3});
+    }
+    if (i + 3 == num_verts)
+      triangles.push_back({base + i, base + i + 1, base + i + 2});
+    break;
+  }
+  case Primitive::GX_DRAW_TRIANGLES:
+    for (u32 i = 0; i + 3 <= num_verts; i += 3)
+      triangles.push_back({base + i, base + i + 1, base + i + 2});
+    break;
+  case Primitive::GX_DRAW_TRIANGLE_STRIP:
+    for (u32 i = 0; i + 3 <= num_verts; i++)
+    {
+      if (i % 2 == 0)
+        triangles.push_back({base + i, base + i + 1, base + i + 2});
+      else
+        triangles.push_back({base + i + 1, base + i, base + i + 2});
+    }
+    break;
+  case Primitive::GX_DRAW_TRIANGLE_FAN:
+    for (u32 i = 2; i < num_verts; i++)
+      triangles.push_back({base, base + i - 1, base + i});
+    break;
+  default:
+    break;
+  }
+  std::ranges::transform(triangles, triangles.begin(), Canonical);
+  return triangles;
+}
+
+// Decodes the index buffer as a triangle list, or as restart separated triangle strips.
+std::vector<Triangle> DecodeTriangles(const u16* indices, u32 num_indices, bool primitive_restart)
+{
+  std::vector<Triangle> triangles;
+  if (!primitive_restart)
+  {
+    for (u32 i = 0; i + 3 <= num_indices; i += 3)
+      triangles.push_back(Canonical({indices[i], indices[i + 1], indices[i + 2]}));
+    return triangles;
+  }
+
+  u32 strip_start = 0;
+  for (u32 i = 0; i < num_indices; i++)
+  {
+    if (indices[i] == UINT16_MAX)
+    {
+      strip_start = i + 1;
+      continue;
+    }
+    const u32 position = i - strip_start;
+    if (position < 2)
+      continue;
+    if (position % 2 == 0)
+      triangles.push_back(Canonical({indices[i - 2], indices[i - 1], indices[i]}));
+    else
+      triangles.push_back(Canonical({indices[i - 1], indices[i - 2], indices[i]}));
+  }
+  return triangles;
+}
+}  // namespace
+
+class IndexGeneratorTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_old_primitive_restart = g_Config.backend_info.bSupportsPrimitiveRestart;
+    m_indices.resize(1 << 20);
+  }
+
+  void TearDown() override
+  {
+    g_Config.backend_info.bSupportsPrimitiveRestart = m_old_primitive_restart;
+  }
+
+  void Init(bool primitive_restart)
+  {
+    g_Config.backend_info.bSupportsPrimitiveRestart = primitive_restart;
+    m_generator.Init();
+    m_generator.Start(m_indices.data());
+  }
+
+  IndexGenerator m_generator;
+  std::vector<u16> m_indices;
+  bool m_old_primitive_restart = false;
+};
+
+class IndexGeneratorPrimitiveTest : public IndexGeneratorTest,
+                                    public testing::WithParamInterface<std::tuple<Primitive, bool>>
+{
+};
+INSTANTIATE_TEST_SUITE_P(TrianglePrimitives, IndexGeneratorPrimitiveTest,
+                         testing::Combine(testing::Values(Primitive::GX_DRAW_QUADS,
+                                                          Primitive::GX_DRAW_TRIANGLES,
+                                                          Primitive::GX_DRAW_TRIANGLE_STRIP,
+                                                          Primitive::GX_DRAW_TRIANGLE_FAN),
+                                          testing::Bool()));
+
+TEST_P(IndexGeneratorPrimitiveTest, MatchesPrimitive)
+{
+  const auto [primitive, primitive_restart] = GetParam();
+
+  for (u32 num_verts = 0; num_verts < 150; num_verts++)
+  {
+    Init(primitive_restart);
+    // Start at an odd vertex so that the primitive doesn't begin at index 0.
+    m_generator.AddIndices(Primitive::GX_DRAW_TRIANGLES, 7);
+    const u32 start = m_generator.GetIndexLen();
+
+    m_generator.AddIndices(primitive, num_verts);
+    EXPECT_EQ(7 + num_verts, m_generator.GetNumVerts());
+
+    const u32 num_indices = m_generator.GetIndexLen() - start;
+    const u16* indices = m_indices.data() + start;
+    EXPECT_EQ(ExpectedTriangles(primitive, num_verts, 7),
+              DecodeTriangles(indices, num_indices, primitive_restart))
+        << fmt::format("{} vertices", num_verts);
+
+    // Every strip has to draw something.
+    if (primitive_restart)
+    {
+      u32 strip_length = 0;
+      for (u32 i = 0; i < num_indices; i++)
+      {
+        if (indices[i] != UINT16_MAX)
+        {
+          strip_length++;
+          continue;
+        }
+        EXPECT_GE(strip_length, 3u) << fmt::format("{} vertices, index {}", num_verts, i);
+        strip_length = 0;
+      }
+      EXPECT_EQ(0u, strip_length) << fmt::format("{} vertices", num_verts);
+    }
+  }
+}
+
+TEST_F(IndexGeneratorTest, LargeBaseIndex)
+{
+  // Ends right at the last usable index.
+  for (bool primitive_restart : {false, true})
+  {
+    for (Primitive primitive : {Primitive::GX_DRAW_QUADS, Primitive::GX_DRAW_TRIANGLE_STRIP,
+                                Primitive::GX_DRAW_TRIANGLE_FAN})
+    {
+      Init(primitive_restart);
+      m_generator.AddIndices(Primitive::GX_DRAW_TRIANGLES, 0xFF00);
+      const u32 start = m_generator.GetIndexLen();
+      m_generator.AddIndices(primitive, 0xFF);
+      EXPECT_EQ(ExpectedTriangles(primitive, 0xFF, 0xFF00),
+                DecodeTriangles(m_indices.data() + start, m_generator.GetIndexLen() - start,
+                                primitive_restart));
+    }
+  }
+}
+
+TEST_F(IndexGeneratorTest, BatchedPrimitives)
+{
+  // A batch reserves index space for its total vertex count, as if it was a single primitive, so
+  // the runs it's split into mustn't need more indices than that.
+  for (bool primitive_restart : {false, true})
+  {
+    for (Primitive primitive :
+         {Primitive::GX_DRAW_QUADS, Primitive::GX_DRAW_QUADS_2, Primitive::GX_DRAW_TRIANGLES,
+          Primitive::GX_DRAW_TRIANGLE_STRIP, Primitive::GX_DRAW_TRIANGLE_FAN,
+          Primitive::GX_DRAW_LINES, Primitive::GX_DRAW_LINE_STRIP, Primitive::GX_DRAW_POINTS})
+    {
+      for (u32 run_size = 1; run_size <= 12; run_size++)
+      {
+        constexpr u32 num_runs = VertexLoaderManager::MAX_PRIMITIVE_BATCH_SIZE;
+
+        Init(primitive_restart);
+        m_generator.AddIndices(primitive, run_size * num_runs);
+        const u32 single_len = m_generator.GetIndexLen();
+
+        Init(primitive_restart);
+        for (u32 i = 0; i < num_runs; i++)
+          m_generator.AddIndices(primitive, run_size);
+        const u32 batched_len = m_generator.GetIndexLen();
+
+        const bool can_batch = VertexLoaderManager::CanBatchPrimitive(primitive, run_size);
+        if (can_batch)
+        {
+          EXPECT_EQ(single_len, batched_len)
+              << fmt::format("primitive {}, {} vertices", primitive, run_size);
+        }
+
+        // 64 three vertex strips take 256 indices with primitive restart, but only 192 are
+        // reserved for them, so they must never be batched.
+        if (batched_len > single_len)
+        {
+          EXPECT_FALSE(can_batch)
+              << fmt::format("primitive {}, {} vertices", primitive, run_size);
+        }
+      }
+    }
+  }
+
+  EXPECT_FALSE(VertexLoaderManager::CanBatchPrimitive(Primitive::GX_DRAW_TRIANGLE_STRIP, 3));
+  EXPECT_FALSE(VertexLoaderManager::CanBatchPrimitive(Primitive::GX_DRAW_TRIANGLE_FAN, 3));
+  EXPECT_FALSE(VertexLoaderManager::CanBatchPrimitive(Primitive::GX_DRAW_TRIANGLES, 4));
+  EXPECT_FALSE(VertexLoaderManager::CanBatchPrimitive(Primitive::GX_DRAW_QUADS, 0));
+  EXPECT_TRUE(VertexLoaderManager::CanBatchPrimitive(Primitive::GX_DRAW_QUADS, 8));
+}
+
+TEST_F(IndexGeneratorTest, Speed)
+{
+  for (bool primitive_restart : {false, true})
+  {
+    for (int i = 0; i < 2000; i++)
+    {
+      Init(primitive_restart);
+      for (Primitive primitive : {Primitive::GX_DRAW_QUADS, Primitive::GX_DRAW_TRIANGLES,
+                                  Primitive::GX_DRAW_TRIANGLE_STRIP,
+                                  Primitive::GX_DRAW_TRIANGLE_FAN})
+      {
+        for (int j = 0; j < 16; j++)
+          m_generator.AddIndices(primitive, 1000);
+      }
+    }
+  }
+}
@@ -4,17 +4,20 @@
 #include <bit>
 #include <limits>
 #include <memory>
+#include <random>
 #include <tuple>
 #include <type_traits>
 #include <unordered_set>
 
 #include <gtest/gtest.h>  // NOLINT
 
+#include "Common/CPUDetect.h"
 #include "Common/Common.h"
 #include "Common/MathUtil.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/VertexLoader.h"
 #include "VideoCommon/VertexLoaderBase.h"
 #include "VideoCommon/VertexLoaderManager.h"
 
@@ -1065,6 +1068,132 @@ TEST_P(VertexLoaderSkippedTexCoordsTest, SkippedTextures)
   }
 }
 
+// Compares the loader returned by CreateVertexLoader (the JIT on x86-64 and ARM64) against the
+// generic VertexLoader on random input. On CPUs with AVX2 the JIT is checked both with and without
+// the loop that processes two vertices at once.
+class VertexLoaderCrossCheckTest
+    : public VertexLoaderTest,
+      public ::testing::WithParamInterface<std::tuple<VertexComponentFormat, ComponentFormat, bool>>
+{
+protected:
+  void TearDown() override { cpu_info = CPUInfo(); }
+
+  void CrossCheck(int count)
+  {
+    const std::unique_ptr<VertexLoaderBase> generic =
+        std::make_unique<VertexLoader>(m_vtx_desc, m_vtx_attr);
+    ASSERT_EQ(generic->m_native_vtx_decl.stride, m_loader->m_native_vtx_decl.stride);
+    const int stride = generic->m_native_vtx_decl.stride;
+    const size_t size = count * stride;
+
+    const auto old_position_cache = VertexLoaderManager::position_cache;
+    const int expected_count = generic->RunVertices(input_memory, output_memory, count);
+    const std::vector<u8> expected(output_memory, output_memory + size);
+    const auto expected_position_cache = VertexLoaderManager::position_cache;
+
+    VertexLoaderManager::position_cache = old_position_cache;
+    memset(output_memory, 0xFF, size);
+    EXPECT_EQ(expected_count, m_loader->RunVertices(input_memory, output_memory, count));
+    EXPECT_EQ(0, memcmp(expected.data(), output_memory, expected_count * stride));
+    // Components past the loaded ones are allowed to be garbage
+    const size_t components = m_vtx_attr.g0.PosElements == CoordComponentCount::XYZ ? 3 : 2;
+    for (size_t i = 0; i < expected_position_cache.size(); i++)
+    {
+      EXPECT_EQ(0, memcmp(expected_position_cache[i].data(),
+                          VertexLoaderManager::position_cache[i].data(),
+                          components * sizeof(float)));
+    }
+  }
+};
+INSTANTIATE_TEST_SUITE_P(
+    AllFormats, VertexLoaderCrossCheckTest,
+    ::testing::Combine(::testing::Values(VertexComponentFormat::Direct,
+                                         VertexComponentFormat::Index8,
+                                         VertexComponentFormat::Index16),
+                       ::testing::Values(ComponentFormat::UByte, ComponentFormat::Byte,
+                                         ComponentFormat::UShort, ComponentFormat::Short,
+                                         ComponentFormat::Float),
+                       ::testing::Values(false, true)));
+
+TEST_P(VertexLoaderCrossCheckTest, MatchesGenericLoader)
+{
+  VertexComponentFormat addr;
+  ComponentFormat format;
+  bool all_elements;
+  std::tie(addr, format, all_elements) = GetParam();
+
+  // Random data, except for the matrix index which is always in range in practice.
+  std::mt19937 rng(static_cast<u32>(addr) * 16 + static_cast<u32>(format) * 2 + all_elements);
+  for (size_t i = 0; i < 1024 * 1024; i++)
+    input_memory[i] = static_cast<u8>(rng());
+
+  m_vtx_desc.low.PosMatIdx = true;
+  m_vtx_desc.low.Position = addr;
+  m_vtx_desc.low.Normal = addr;
+  m_vtx_desc.low.Color0 = addr;
+  m_vtx_desc.high.Tex0Coord = addr;
+  m_vtx_desc.high.Tex1Coord = VertexComponentFormat::Direct;
+
+  m_vtx_attr.g0.ByteDequant = true;
+  m_vtx_attr.g0.PosElements = all_elements ? CoordComponentCount::XYZ : CoordComponentCount::XY;
+  m_vtx_attr.g0.PosFormat = format;
+  m_vtx_attr.g0.PosFrac = 5;
+  m_vtx_attr.g0.NormalElements = all_elements ? NormalComponentCount::NTB : NormalComponentCount::N;
+  m_vtx_attr.g0.NormalFormat = format;
+  m_vtx_attr.g0.Color0Elements = ColorComponentCount::RGBA;
+  m_vtx_attr.g0.Color0Comp = static_cast<ColorFormat>(format);
+  m_vtx_attr.g0.Tex0CoordElements = all_elements ? TexComponentCount::ST : TexComponentCount::S;
+  m_vtx_attr.g0.Tex0CoordFormat = format;
+  m_vtx_attr.g0.Tex0Frac = 3;
+  m_vtx_attr.g1.Tex1CoordElements = TexComponentCount::ST;
+  m_vtx_attr.g1.Tex1CoordFormat = format;
+  m_vtx_attr.g1.Tex1Frac = 31;
+
+  for (int i = 0; i < NUM_VERTEX_COMPONENT_ARRAYS; i++)
+  {
+    VertexLoaderManager::cached_arraybases[static_cast<CPArray>(i)] = input_memory;
+    g_main_cp_state.array_strides[static_cast<CPArray>(i)] = 37;
+  }
+
+  const bool has_avx2 = cpu_info.bAVX2;
+  for (const bool use_avx2 : {false, true})
+  {
+    if (use_avx2 && !has_avx2)
+      continue;
+    cpu_info.bAVX2 = use_avx2;
+    m_loader = VertexLoaderBase::CreateVertexLoader(m_vtx_desc, m_vtx_attr);
+    for (int count : {1, 4, 5, 6, 67})
+      CrossCheck(count);
+  }
+}
+
+TEST_F(VertexLoaderTest, DirectQuantizedVertexSpeed)
+{
+  // A typical vertex format of games with many vertices, with everything sent directly.
+  m_vtx_desc.low.PosMatIdx = true;
+  m_vtx_desc.low.Position = VertexComponentFormat::Direct;
+  m_vtx_desc.low.Normal = VertexComponentFormat::Direct;
+  m_vtx_desc.low.Color0 = VertexComponentFormat::Direct;
+  m_vtx_desc.high.Tex0Coord = VertexComponentFormat::Direct;
+
+  m_vtx_attr.g0.ByteDequant = true;
+  m_vtx_attr.g0.PosElements = CoordComponentCount::XYZ;
+  m_vtx_attr.g0.PosFormat = ComponentFormat::Short;
+  m_vtx_attr.g0.PosFrac = 8;
+  m_vtx_attr.g0.NormalElements = NormalComponentCount::N;
+  m_vtx_attr.g0.NormalFormat = ComponentFormat::Byte;
+  m_vtx_attr.g0.Color0Elements = ColorComponentCount::RGBA;
+  m_vtx_attr.g0.Color0Comp = ColorFormat::RGBA8888;
+  m_vtx_attr.g0.Tex0CoordElements = TexComponentCount::ST;
+  m_vtx_attr.g0.Tex0CoordFormat = ComponentFormat::Short;
+  m_vtx_attr.g0.Tex0Frac = 10;
+
+  CreateAndCheckSizes(1 + 6 + 3 + 4 + 4, 4 + 12 + 12 + 4 + 8);
+
+  for (int i = 0; i < 1000; ++i)
+    RunVertices(100000);
+}
+
 // For gtest, which doesn't know about our fmt::formatters by default
 static void PrintTo(const VertexComponentFormat& t, std::ostream* os)
 {